@@ -242,6 +242,8 @@ private:
      * Called by CreateDrawGL_List()
      * Populates the OpenGL GL_ID_BOARD draw list with board items only on copper layers.
      * 3D footprint shapes, tech layers and aux layers are not on this list
+     * The layer polygons are cut and triangulated by BuildLayerMeshes(), one layer
+     * per thread, and the triangles are then copied to the lists.
      * Fills aErrorMessages with error messages created by some calculation function
      * display activity state
      * @param aBoardList =
@@ -256,7 +258,8 @@ private:
     /**
      * Function buildTechLayers3DView
      * Called by CreateDrawGL_List()
-     * Populates the OpenGL GL_ID_TECH_LAYERS draw list with items on tech layers
+     * Populates the OpenGL GL_ID_TECH_LAYERS draw list with items on tech layers,
+     * built like in buildBoard3DView()
      * @param aErrorMessages = a REPORTER to add error and warning messages
      * created by the build process (can be NULL)
      * @param aActivity = a REPORTER to display activity state
@@ -349,9 +352,18 @@ private:
                                  bool aIsRenderingJustNonTransparentObjects,
                                  bool aIsRenderingJustTransparentObjects );
 
+    /**
+     * function load3DModelFiles
+     * reads the 3D model files used by the footprints of the board, each one once,
+     * by several threads, and fills m_model_parsers_list and m_model_filename_list.
+     * The meshes are taken from the S3D_MESH_CACHE when it is up to date.
+     */
+    void load3DModelFiles();
+
     /**
      * function read3DComponentShape
-     * read the 3D component shape(s) of the footprint (physical shape).
+     * gives to the 3D component shape(s) of the footprint (physical shape)
+     * the models read by load3DModelFiles().
      * @param module
      * @return true if load was succeeded, false otherwise
      */
@@ -59,6 +59,13 @@
 
 #include <CImage.h>
 #include <reporter.h>
+#include <modelparsers.h>
+#include <3d_mesh_cache.h>
+
+#include <algorithm>
+#include <map>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 
 
 extern SHAPE_POLY_SET::POLYGON_MODE polygonsCalcMode;
@@ -992,6 +999,8 @@ void EDA_3D_CANVAS::buildFootprintShape3DList( GLuint aOpaqueList,
 
     BOARD* pcb = GetBoard();
 
+    load3DModelFiles();
+
     for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
         read3DComponentShape( module );
 
@@ -1040,6 +1049,103 @@ void EDA_3D_CANVAS::buildFootprintShape3DList( GLuint aOpaqueList,
 }
 
 
+// A 3D model file to load, by the parser of the first shape using it
+struct MODEL_LOAD_JOB
+{
+    S3D_MASTER*         m_Shape;
+    S3D_MODEL_PARSER*   m_Parser;
+    bool                m_Loaded;
+};
+
+
+static void loadModelFiles( std::vector<MODEL_LOAD_JOB>* aJobs, const S3D_MESH_CACHE* aCache,
+                            unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aJobs->size(); ii += aStep )
+    {
+        MODEL_LOAD_JOB& job = (*aJobs)[ii];
+
+        // Each job reads into its own shape and parser, and writes its own cache file
+        job.m_Loaded = job.m_Shape->ReadData( job.m_Parser, aCache ) == 0;
+    }
+}
+
+
+void EDA_3D_CANVAS::load3DModelFiles()
+{
+    BOARD* pcb = GetBoard();
+    std::vector<MODEL_LOAD_JOB> jobs;
+    std::map<wxString, unsigned> jobIndex;
+
+    for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
+    {
+        for( S3D_MASTER* shape3D = module->Models(); shape3D; shape3D = shape3D->Next() )
+        {
+            if( !shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) )
+                continue;
+
+            wxString shape_filename = shape3D->GetShape3DFullFilename();
+
+            if( jobIndex.count( shape_filename ) )
+                continue;
+
+            S3D_MODEL_PARSER* parser = S3D_MODEL_PARSER::Create( shape3D,
+                                                   shape3D->GetShape3DExtension() );
+
+            if( !parser )
+                continue;
+
+            MODEL_LOAD_JOB job = { shape3D, parser, false };
+
+            jobIndex[shape_filename] = jobs.size();
+            jobs.push_back( job );
+        }
+    }
+
+    if( jobs.empty() )
+        return;
+
+    S3D_MESH_CACHE cache;
+
+    {
+        // Keep LOCALE_IO::C_count at 1 or greater for the duration of all worker threads,
+        // see FOOTPRINT_LIST::ReadFootprintFiles()
+        LOCALE_IO   top_most_nesting;
+
+        unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+        threadCount = std::min( threadCount, (unsigned) jobs.size() );
+
+        // Something which will not invoke a thread copy constructor
+        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+        MYTHREADS threads;
+
+        for( unsigned ii = 1; ii < threadCount; ii++ )
+            threads.push_back( new boost::thread( &loadModelFiles, &jobs, &cache,
+                                                  ii, threadCount ) );
+
+        loadModelFiles( &jobs, &cache, 0, threadCount );
+
+        for( unsigned ii = 0; ii < threads.size(); ++ii )
+            threads[ii].join();
+    }
+
+    // Store the couples filename / parsed file, for read3DComponentShape()
+    for( unsigned ii = 0; ii < jobs.size(); ii++ )
+    {
+        if( jobs[ii].m_Loaded )
+        {
+            m_model_filename_list.push_back( jobs[ii].m_Shape->GetShape3DFullFilename() );
+            m_model_parsers_list.push_back( jobs[ii].m_Parser );
+        }
+        else
+        {
+            delete jobs[ii].m_Parser;
+        }
+    }
+}
+
+
 bool EDA_3D_CANVAS::read3DComponentShape( MODULE* module )
 {
     if( module )
@@ -1050,42 +1156,19 @@ bool EDA_3D_CANVAS::read3DComponentShape( MODULE* module )
         {
             if( shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) )
             {
-                bool found = false;
-
-                unsigned int i;
                 wxString shape_filename = shape3D->GetShape3DFullFilename();
 
-                // Search for already loaded files
-                for( i = 0; i < m_model_filename_list.size(); i++ )
+                // Search for already loaded files; the files which could not
+                // be read are not tried again
+                for( unsigned int i = 0; i < m_model_filename_list.size(); i++ )
                 {
                     if( shape_filename.Cmp(m_model_filename_list[i]) == 0 )
                     {
-                        found = true;
+                        // Reusing file
+                        shape3D->m_parser = m_model_parsers_list[i];
                         break;
                     }
                 }
-
-                if( found == false )
-                {
-                    // Create a new parser
-                    S3D_MODEL_PARSER *newParser = S3D_MODEL_PARSER::Create( shape3D, shape3D->GetShape3DExtension() );
-
-                    if( newParser )
-                    {
-                        // Read file
-                        if( shape3D->ReadData( newParser ) == 0 )
-                        {
-                            // Store this couple filename / parsed file
-                            m_model_filename_list.push_back( shape_filename );
-                            m_model_parsers_list.push_back( newParser );
-                        }
-                    }
-                }
-                else
-                {
-                    // Reusing file
-                    shape3D->m_parser = m_model_parsers_list[i];
-                }
             }
         }
     }
@@ -34,6 +34,7 @@
 #include <info3d_visu.h>
 #include <3d_draw_basic_functions.h>
 #include <modelparsers.h>
+#include <3d_layer_mesh.h>
 
 // Number of segments to approximate a circle by segments
 #define SEGM_PER_CIRCLE 24
@@ -239,6 +240,46 @@ void Draw3D_SolidHorizontalPolyPolygons( const SHAPE_POLY_SET& aPolysList,
 }
 
 
+void Draw3D_LayerMesh( const LAYER_MESH& aMesh, bool aUseTextures )
+{
+    if( aMesh.IsEmpty() )
+        return;
+
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glEnableClientState( GL_NORMAL_ARRAY );
+    glVertexPointer( 3, GL_FLOAT, 0, &aMesh.m_Vertices[0] );
+    glNormalPointer( GL_FLOAT, 0, &aMesh.m_Normals[0] );
+
+    // Texture coordinates are the X, Y vertex coordinates, scaled like in tessCPolyPt2Vertex
+    std::vector<GLfloat> texCoords;
+
+    if( aUseTextures )
+    {
+        unsigned count = aMesh.GetVertexCount();
+        texCoords.resize( count * 2 );
+
+        for( unsigned ii = 0; ii < count; ++ii )
+        {
+            texCoords[ii * 2]     = aMesh.m_Vertices[ii * 3] * s_textureScale;
+            texCoords[ii * 2 + 1] = aMesh.m_Vertices[ii * 3 + 1] * s_textureScale;
+        }
+
+        glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+        glTexCoordPointer( 2, GL_FLOAT, 0, &texCoords[0] );
+    }
+
+    // When compiling a display list, the arrays are read now, and stored in the list
+    glDrawElements( GL_TRIANGLES, aMesh.m_Triangles.size(), GL_UNSIGNED_INT,
+                    &aMesh.m_Triangles[0] );
+
+    if( aUseTextures )
+        glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+
+    glDisableClientState( GL_NORMAL_ARRAY );
+    glDisableClientState( GL_VERTEX_ARRAY );
+}
+
+
 /* draw a cylinder (a tube) using 3D primitives.
  * the cylinder axis is parallel to the Z axis
  * If aHeight = height of the cylinder is 0, only one ring will be drawn
@@ -31,6 +31,8 @@
 // angle increment to draw a circle, approximated by segments
 #define ANGLE_INC( x ) ( 3600 / (x) )
 
+class LAYER_MESH;
+
 /** draw all solid polygons found in aPolysList
  * @param aPolysList = the poligon list to draw
  * @param aZpos = z position in board internal units
@@ -48,6 +50,14 @@ void    Draw3D_SolidHorizontalPolyPolygons( const SHAPE_POLY_SET& aPolysList,
                                             bool aUseTextures,
                                             float aNormal_Z_Orientation );
 
+/** draw the triangles of a mesh built by LAYER_MESH
+ * @param aMesh = the mesh to draw, in 3D units
+ * @param aUseTextures = true to use the texture set by SetGLTexture() for the triangles
+ * The current color is used. The mesh buffers are copied by OpenGL, therefore
+ * aMesh can be deleted once the display list containing it is compiled.
+ */
+void    Draw3D_LayerMesh( const LAYER_MESH& aMesh, bool aUseTextures );
+
 /** draw a thick segment using 3D primitives, in a XY plane
  * @param aStart = YX position of start point in board units
  * @param aEnd = YX position of end point in board units
@@ -58,6 +58,9 @@
 #include <3d_draw_basic_functions.h>
 #include <geometry/shape_poly_set.h>
 #include <geometry/shape_file_io.h>
+#include <3d_layer_mesh.h>
+
+#include <memory>
 
 
 #include <CImage.h>
@@ -176,12 +179,14 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
                                                 // a fine representation
     double          correctionFactorLQ  = 1.0 / cos( M_PI / (segcountLowQuality * 2.0) );
 
-    SHAPE_POLY_SET  bufferPolys;        // copper areas: tracks, pads and filled zones areas
-                                        // when holes are removed from zones
-    SHAPE_POLY_SET  bufferPcbOutlines;  // stores the board main outlines
-    SHAPE_POLY_SET  bufferZonesPolys;   // copper filled zones areas
-                                        // when holes are not removed from zones
-    SHAPE_POLY_SET  currLayerHoles;     // Contains holes for the current layer
+    // The polygons of each layer are collected here, and cut and converted to
+    // triangles by BuildLayerMeshes(), layers in parallel, outside of any GL list.
+    LAYER_MESH_JOBS jobs;
+    LAYER_MESH_JOB* bodyJob = new LAYER_MESH_JOB;
+
+    jobs.push_back( bodyJob );
+
+    SHAPE_POLY_SET& bufferPcbOutlines = bodyJob->m_Polys;  // stores the board main outlines
     SHAPE_POLY_SET  allLayerHoles;      // Contains holes for all layers
 
     // Build a polygon from edge cut items
@@ -203,8 +208,6 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
 
     LSET            cu_set = LSET::AllCuMask( GetPrm3DVisu().m_CopperLayersCount );
 
-    glNewList( aBoardList, GL_COMPILE );
-
     for( LSEQ cu = cu_set.CuStack();  cu;  ++cu )
     {
         LAYER_ID layer = *cu;
@@ -217,9 +220,14 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
         if( aActivity )
             aActivity->Report( wxString::Format( _( "Build layer %s" ), LSET::Name( layer ) ) );
 
-        bufferPolys.RemoveAllContours();
-        bufferZonesPolys.RemoveAllContours();
-        currLayerHoles.RemoveAllContours();
+        std::auto_ptr<LAYER_MESH_JOB> job( new LAYER_MESH_JOB );
+
+        // copper areas: tracks, pads and filled zones areas when holes are removed from zones
+        SHAPE_POLY_SET& bufferPolys = job->m_Polys;
+        // copper filled zones areas when holes are not removed from zones
+        SHAPE_POLY_SET& bufferZonesPolys = job->m_UncutPolys;
+        // Contains holes for the current layer
+        SHAPE_POLY_SET& currLayerHoles = job->m_Cuts;
 
         // Draw track shapes:
         for( TRACK* track = pcb->m_Track;  track;  track = track->Next() )
@@ -315,19 +323,12 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
         }
 
         // bufferPolys contains polygons to merge. Many overlaps .
-        // Calculate merged polygons
+        // Merged polygons are calculated by BuildLayerMeshes()
         if( bufferPolys.IsEmpty() )
             continue;
 
-        // Use Clipper lib to subtract holes to copper areas
-        if( currLayerHoles.OutlineCount() )
-        {
-            currLayerHoles.Append(allLayerHoles);
-            currLayerHoles.Simplify( polygonsCalcMode );
-            bufferPolys.BooleanSubtract( currLayerHoles, polygonsCalcMode );
-        }
-        else
-            bufferPolys.BooleanSubtract( allLayerHoles, polygonsCalcMode );
+        // Clipper lib will subtract currLayerHoles and allLayerHoles to copper areas
+        job->m_Holes = &allLayerHoles;
 
         int thickness = GetPrm3DVisu().GetLayerObjectThicknessBIU( layer );
         int zpos = GetPrm3DVisu().GetLayerZcoordBIU( layer );
@@ -339,35 +340,65 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
         if( !thickness )
             zNormal = Get3DLayer_Z_Orientation( layer );
 
+        // If holes are removed from copper zones, bufferPolys contains all polygons
+        // to draw (tracks+zones+texts).
+        // If holes are not removed from copper zones (for calculation time reasons,
+        // the zone polygons are stored in bufferZonesPolys and are drawn without cut.
+        job->m_Layer = layer;
+        job->m_Zpos = zpos;
+        job->m_Thickness = thickness;
+        job->m_NormalZ = zNormal;
+        jobs.push_back( job.release() );
+    }
+
+    if( aActivity )
+        aActivity->Report( _( "Build board body" ) );
+
+    float copper_thickness = GetPrm3DVisu().GetCopperThicknessBIU();
+
+    // a small offset between substrate and external copper layer to avoid artifacts
+    // when drawing copper items on board
+    float epsilon = Millimeter2iu( 0.01 );
+    float zpos = GetPrm3DVisu().GetLayerZcoordBIU( B_Cu );
+    float board_thickness = GetPrm3DVisu().GetLayerZcoordBIU( F_Cu )
+                        - GetPrm3DVisu().GetLayerZcoordBIU( B_Cu );
+
+    // items on copper layers and having a thickness = copper_thickness
+    // are drawn from zpos - copper_thickness/2 to zpos + copper_thickness
+    // therefore substrate position is copper_thickness/2 to
+    // substrate_height - copper_thickness/2
+    zpos += (copper_thickness + epsilon) / 2.0f;
+    board_thickness -= copper_thickness + epsilon;
+
+    bodyJob->m_Layer = Edge_Cuts;
+    bodyJob->m_Holes = &allLayerHoles;
+    bodyJob->m_Zpos = zpos + board_thickness / 2.0;
+    bodyJob->m_Thickness = board_thickness;
+    bodyJob->m_NormalZ = 1.0f;
+
+    // Merge and cut the polygons, and build the triangles of all layers
+    BuildLayerMeshes( jobs, GetPrm3DVisu().m_BiuTo3Dunits, polygonsCalcMode );
+
+    glNewList( aBoardList, GL_COMPILE );
+
+    for( unsigned ii = 0; ii < jobs.size(); ++ii )
+    {
+        if( &jobs[ii] == bodyJob )
+            continue;
+
         if( realistic_mode )
         {
             setGLCopperColor();
         }
         else
         {
-            EDA_COLOR_T color = g_ColorsSettings.GetLayerColor( layer );
+            EDA_COLOR_T color = g_ColorsSettings.GetLayerColor( (LAYER_ID) jobs[ii].m_Layer );
             SetGLColor( color );
         }
 
-        // If holes are removed from copper zones, bufferPolys contains all polygons
-        // to draw (tracks+zones+texts).
-        Draw3D_SolidHorizontalPolyPolygons( bufferPolys, zpos, thickness,
-                                            GetPrm3DVisu().m_BiuTo3Dunits, useTextures,
-                                            zNormal );
-
-        // If holes are not removed from copper zones (for calculation time reasons,
-        // the zone polygons are stored in bufferZonesPolys and have to be drawn now:
-        if( !bufferZonesPolys.IsEmpty() )
-        {
-            Draw3D_SolidHorizontalPolyPolygons( bufferZonesPolys, zpos, thickness,
-                                    GetPrm3DVisu().m_BiuTo3Dunits, useTextures,
-                                    zNormal );
-        }
+        Draw3D_LayerMesh( jobs[ii].m_Mesh, useTextures );
     }
 
-    if( aActivity )
-        aActivity->Report( _( "Build board body" ) );
-
     // Draw plated vertical holes inside the board, but not always. They are drawn:
     // - if the board body is not shown, to show the holes.
     // - or if the copper thickness is shown
@@ -407,30 +438,7 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
         SetGLColor( color, 0.7 );
     }
 
-    float copper_thickness = GetPrm3DVisu().GetCopperThicknessBIU();
-
-    // a small offset between substrate and external copper layer to avoid artifacts
-    // when drawing copper items on board
-    float epsilon = Millimeter2iu( 0.01 );
-    float zpos = GetPrm3DVisu().GetLayerZcoordBIU( B_Cu );
-    float board_thickness = GetPrm3DVisu().GetLayerZcoordBIU( F_Cu )
-                        - GetPrm3DVisu().GetLayerZcoordBIU( B_Cu );
-
-    // items on copper layers and having a thickness = copper_thickness
-    // are drawn from zpos - copper_thickness/2 to zpos + copper_thickness
-    // therefore substrate position is copper_thickness/2 to
-    // substrate_height - copper_thickness/2
-    zpos += (copper_thickness + epsilon) / 2.0f;
-    board_thickness -= copper_thickness + epsilon;
-
-    bufferPcbOutlines.BooleanSubtract( allLayerHoles, polygonsCalcMode );
-
-    if( !bufferPcbOutlines.IsEmpty() )
-    {
-        Draw3D_SolidHorizontalPolyPolygons( bufferPcbOutlines, zpos + board_thickness / 2.0,
-                                            board_thickness, GetPrm3DVisu().m_BiuTo3Dunits, useTextures,
-                                            1.0f );
-    }
+    Draw3D_LayerMesh( bodyJob->m_Mesh, useTextures );
 
     glEndList();
 }
@@ -456,7 +464,7 @@ void EDA_3D_CANVAS::buildTechLayers3DView( REPORTER* aErrorMessages, REPORTER* a
     // many segments per circle.
     const int       segcountInStrokeFont = 8;
 
-    SHAPE_POLY_SET bufferPolys;
+    LAYER_MESH_JOBS jobs;                      // polygons and triangles of each layer
     SHAPE_POLY_SET allLayerHoles;              // Contains through holes, calculated only once
     SHAPE_POLY_SET bufferPcbOutlines;          // stores the board main outlines
 
@@ -504,7 +512,8 @@ void EDA_3D_CANVAS::buildTechLayers3DView( REPORTER* aErrorMessages, REPORTER* a
         if( aActivity )
             aActivity->Report( wxString::Format( _( "Build layer %s" ), LSET::Name( layer ) ) );
 
-        bufferPolys.RemoveAllContours();
+        std::auto_ptr<LAYER_MESH_JOB> job( new LAYER_MESH_JOB );
+        SHAPE_POLY_SET& bufferPolys = job->m_Polys;
 
         for( BOARD_ITEM* item = pcb->m_Drawings; item; item = item->Next() )
         {
@@ -571,7 +580,8 @@ void EDA_3D_CANVAS::buildTechLayers3DView( REPORTER* aErrorMessages, REPORTER* a
         }
 
         // bufferPolys contains polygons to merge. Many overlaps .
-        // Calculate merged polygons and remove pads and vias holes
+        // Merged polygons are calculated, and pads and vias holes removed,
+        // by BuildLayerMeshes()
         if( bufferPolys.IsEmpty() )
             continue;
 
@@ -579,19 +589,15 @@ void EDA_3D_CANVAS::buildTechLayers3DView( REPORTER* aErrorMessages, REPORTER* a
         // Shapes should be removed from the full board area.
         if( layer == B_Mask || layer == F_Mask )
         {
-            SHAPE_POLY_SET cuts = bufferPolys;
+            job->m_Cuts = bufferPolys;
             bufferPolys = bufferPcbOutlines;
-
-            cuts.Append(allLayerHoles);
-            cuts.Simplify( polygonsCalcMode );
-
-            bufferPolys.BooleanSubtract( cuts, polygonsCalcMode );
+            job->m_Holes = &allLayerHoles;
         }
         // Remove holes from Solder paste layers and silkscreen
         else if( layer == B_Paste || layer == F_Paste
                  || layer == B_SilkS || layer == F_SilkS  )
         {
-            bufferPolys.BooleanSubtract( allLayerHoles, polygonsCalcMode );
+            job->m_Holes = &allLayerHoles;
         }
 
         int thickness = 0;
@@ -629,9 +635,18 @@ void EDA_3D_CANVAS::buildTechLayers3DView( REPORTER* aErrorMessages, REPORTER* a
             zNormal = Get3DLayer_Z_Orientation( layer );
 
 
-        setGLTechLayersColor( layer );
-        Draw3D_SolidHorizontalPolyPolygons( bufferPolys, zpos,
-                thickness, GetPrm3DVisu().m_BiuTo3Dunits, useTextures,
-                zNormal );
+        job->m_Layer = layer;
+        job->m_Zpos = zpos;
+        job->m_Thickness = thickness;
+        job->m_NormalZ = zNormal;
+        jobs.push_back( job.release() );
+    }
+
+    BuildLayerMeshes( jobs, GetPrm3DVisu().m_BiuTo3Dunits, polygonsCalcMode );
+
+    for( unsigned ii = 0; ii < jobs.size(); ++ii )
+    {
+        setGLTechLayersColor( jobs[ii].m_Layer );
+        Draw3D_LayerMesh( jobs[ii].m_Mesh, useTextures );
     }
 }
@@ -0,0 +1,316 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_layer_mesh.cpp
+ */
+
+#include <wx/glcanvas.h>    // CALLBACK definition, needed on Windows
+
+#ifdef __WXMAC__
+#  ifdef __DARWIN__
+#    include <OpenGL/glu.h>
+#  else
+#    include <glu.h>
+#  endif
+#else
+#  include <GL/glu.h>
+#endif
+
+#include <cmath>
+#include <algorithm>
+#include <boost/thread.hpp>
+
+#include <3d_layer_mesh.h>
+
+#ifndef CALLBACK
+#define CALLBACK
+#endif
+
+#define GLCALLBACK(x) (( void (CALLBACK*)() )&(x))
+
+
+// The state of a tesselation, given to the GLU_TESS callbacks.
+// The tesselator vertex data is the index of the vertex in the mesh.
+struct TESS_CONTEXT
+{
+    LAYER_MESH*             m_Mesh;
+    std::vector<unsigned>*  m_Triangles;
+    float                   m_Zpos;
+    float                   m_NormalZ;
+};
+
+
+static void CALLBACK tessVertexCB( void* aVertexData, void* aContext )
+{
+    TESS_CONTEXT* ctx = (TESS_CONTEXT*) aContext;
+
+    ctx->m_Triangles->push_back( (unsigned) (size_t) aVertexData );
+}
+
+
+static void CALLBACK tessCombineCB( GLdouble aCoords[3], void* aVertexData[4],
+                                    GLfloat aWeight[4], void** aOutData, void* aContext )
+{
+    TESS_CONTEXT* ctx = (TESS_CONTEXT*) aContext;
+
+    unsigned idx = ctx->m_Mesh->AddVertex( aCoords[0], aCoords[1], ctx->m_Zpos,
+                                           0.0f, 0.0f, ctx->m_NormalZ );
+
+    *aOutData = (void*) (size_t) idx;
+}
+
+
+// Registering an edge flag callback makes the tesselator output only GL_TRIANGLES
+static void CALLBACK tessEdgeFlagCB( GLboolean aFlag, void* aContext )
+{
+}
+
+
+static void CALLBACK tessErrorCB( GLenum aErrorCode, void* aContext )
+{
+}
+
+
+void LAYER_MESH::Clear()
+{
+    m_Vertices.clear();
+    m_Normals.clear();
+    m_Triangles.clear();
+}
+
+
+unsigned LAYER_MESH::AddVertex( float aX, float aY, float aZ, float aNx, float aNy, float aNz )
+{
+    unsigned idx = GetVertexCount();
+
+    m_Vertices.push_back( aX );
+    m_Vertices.push_back( aY );
+    m_Vertices.push_back( aZ );
+    m_Normals.push_back( aNx );
+    m_Normals.push_back( aNy );
+    m_Normals.push_back( aNz );
+
+    return idx;
+}
+
+
+void LAYER_MESH::AddSolidHorizontalPolyPolygons( const SHAPE_POLY_SET& aPolysList,
+                                                 int aZpos, int aThickness, double aBiuTo3DUnits,
+                                                 float aNormal_Z_Orientation )
+{
+    if( aPolysList.IsEmpty() )
+        return;
+
+    double zTop = ( aZpos + (aThickness / 2.0) ) * aBiuTo3DUnits;
+    double zBottom = ( aZpos - (aThickness / 2.0) ) * aBiuTo3DUnits;
+
+    unsigned firstVertex = GetVertexCount();
+    std::vector<unsigned> triangles;
+
+    TESS_CONTEXT ctx = { this, &triangles, (float) zTop, aNormal_Z_Orientation };
+
+    GLUtesselator* tess = gluNewTess();
+
+    gluTessCallback( tess, GLU_TESS_VERTEX_DATA, GLCALLBACK( tessVertexCB ) );
+    gluTessCallback( tess, GLU_TESS_COMBINE_DATA, GLCALLBACK( tessCombineCB ) );
+    gluTessCallback( tess, GLU_TESS_EDGE_FLAG_DATA, GLCALLBACK( tessEdgeFlagCB ) );
+    gluTessCallback( tess, GLU_TESS_ERROR_DATA, GLCALLBACK( tessErrorCB ) );
+    gluTessProperty( tess, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_ODD );
+    gluTessNormal( tess, 0.0, 0.0, 1.0 );
+
+    GLdouble v_data[3];
+    v_data[2] = zTop;
+
+    // The top side is tesselated once: the bottom side uses the same triangles
+    for( int idx = 0; idx < aPolysList.OutlineCount(); ++idx )
+    {
+        const SHAPE_POLY_SET::POLYGON& curr_polywithholes = aPolysList.CPolygon( idx );
+
+        gluTessBeginPolygon( tess, &ctx );
+
+        for( unsigned ipoly = 0; ipoly < curr_polywithholes.size(); ipoly++ )
+        {
+            const SHAPE_LINE_CHAIN& curr_poly = curr_polywithholes[ipoly];
+
+            gluTessBeginContour( tess );
+
+            for( int ipt = 0; ipt < curr_poly.PointCount(); ipt++ )
+            {
+                v_data[0] = curr_poly.CPoint( ipt ).x * aBiuTo3DUnits;
+                v_data[1] = -curr_poly.CPoint( ipt ).y * aBiuTo3DUnits;
+
+                // the tesselator copies the coordinates, and keeps only the vertex data
+                unsigned vertex = AddVertex( v_data[0], v_data[1], v_data[2],
+                                             0.0f, 0.0f, aNormal_Z_Orientation );
+
+                gluTessVertex( tess, v_data, (void*) (size_t) vertex );
+            }
+
+            gluTessEndContour( tess );
+        }
+
+        gluTessEndPolygon( tess );
+    }
+
+    gluDeleteTess( tess );
+
+    m_Triangles.insert( m_Triangles.end(), triangles.begin(), triangles.end() );
+
+    if( aThickness == 0 )
+        return;
+
+    // Bottom side: a copy of the top side vertices, with the opposite normal
+    unsigned topVertexCount = GetVertexCount() - firstVertex;
+
+    for( unsigned ii = firstVertex; ii < firstVertex + topVertexCount; ++ii )
+        AddVertex( m_Vertices[ii * 3], m_Vertices[ii * 3 + 1], zBottom,
+                   0.0f, 0.0f, -aNormal_Z_Orientation );
+
+    for( unsigned ii = 0; ii < triangles.size(); ++ii )
+        m_Triangles.push_back( triangles[ii] + topVertexCount );
+
+    addVerticalSides( aPolysList, zBottom, zTop, aBiuTo3DUnits );
+}
+
+
+void LAYER_MESH::addVerticalSides( const SHAPE_POLY_SET& aPolysList, double aZbottom,
+                                   double aZtop, double aBiuTo3DUnits )
+{
+    for( int idx = 0; idx < aPolysList.OutlineCount(); idx++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& curr_polywithholes = aPolysList.CPolygon( idx );
+
+        for( unsigned ipoly = 0; ipoly < curr_polywithholes.size(); ipoly++ )
+        {
+            const SHAPE_LINE_CHAIN& path = curr_polywithholes[ipoly];
+
+            for( int jj = 0; jj < path.PointCount(); jj++ )
+            {
+                const VECTOR2I& a = path.CPoint( jj );
+                const VECTOR2I& b = path.CPoint( jj + 1 );
+
+                float ax = a.x * aBiuTo3DUnits;
+                float ay = -a.y * aBiuTo3DUnits;
+                float bx = b.x * aBiuTo3DUnits;
+                float by = -b.y * aBiuTo3DUnits;
+
+                // The quad is a -> a top -> b top -> b, its normal is
+                // (a top - a) ^ (b top - a), as TransfertToGLlist() calculates it
+                float nx = -( by - ay );
+                float ny = bx - ax;
+                float r = sqrt( nx * nx + ny * ny );
+
+                if( r < 1e-9 )      // null segment
+                    continue;
+
+                nx /= r;
+                ny /= r;
+
+                unsigned first = AddVertex( ax, ay, aZbottom, nx, ny, 0.0f );
+                AddVertex( ax, ay, aZtop, nx, ny, 0.0f );
+                AddVertex( bx, by, aZtop, nx, ny, 0.0f );
+                AddVertex( bx, by, aZbottom, nx, ny, 0.0f );
+
+                m_Triangles.push_back( first );
+                m_Triangles.push_back( first + 1 );
+                m_Triangles.push_back( first + 2 );
+                m_Triangles.push_back( first );
+                m_Triangles.push_back( first + 2 );
+                m_Triangles.push_back( first + 3 );
+            }
+        }
+    }
+}
+
+
+LAYER_MESH_JOB::LAYER_MESH_JOB() :
+    m_Layer( 0 ),
+    m_Holes( NULL ),
+    m_Zpos( 0 ),
+    m_Thickness( 0 ),
+    m_NormalZ( 1.0f )
+{
+}
+
+
+void LAYER_MESH_JOB::Build( double aBiuTo3DUnits, SHAPE_POLY_SET::POLYGON_MODE aPolygonMode )
+{
+    m_Mesh.Clear();
+
+    if( !m_Polys.IsEmpty() )
+    {
+        if( m_Cuts.OutlineCount() )
+        {
+            if( m_Holes )
+                m_Cuts.Append( *m_Holes );
+
+            m_Cuts.Simplify( aPolygonMode );
+            m_Polys.BooleanSubtract( m_Cuts, aPolygonMode );
+        }
+        else if( m_Holes )
+        {
+            m_Polys.BooleanSubtract( *m_Holes, aPolygonMode );
+        }
+
+        m_Mesh.AddSolidHorizontalPolyPolygons( m_Polys, m_Zpos, m_Thickness,
+                                               aBiuTo3DUnits, m_NormalZ );
+    }
+
+    m_Mesh.AddSolidHorizontalPolyPolygons( m_UncutPolys, m_Zpos, m_Thickness,
+                                           aBiuTo3DUnits, m_NormalZ );
+}
+
+
+static void buildLayerMeshes( LAYER_MESH_JOBS* aJobs, double aBiuTo3DUnits,
+                              SHAPE_POLY_SET::POLYGON_MODE aPolygonMode,
+                              unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aJobs->size(); ii += aStep )
+        (*aJobs)[ii].Build( aBiuTo3DUnits, aPolygonMode );
+}
+
+
+void BuildLayerMeshes( LAYER_MESH_JOBS& aJobs, double aBiuTo3DUnits,
+                       SHAPE_POLY_SET::POLYGON_MODE aPolygonMode )
+{
+    if( aJobs.empty() )
+        return;
+
+    unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+    threadCount = std::min( threadCount, (unsigned) aJobs.size() );
+
+    // Something which will not invoke a thread copy constructor
+    typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+    MYTHREADS threads;
+
+    for( unsigned ii = 1; ii < threadCount; ii++ )
+        threads.push_back( new boost::thread( &buildLayerMeshes, &aJobs, aBiuTo3DUnits,
+                                              aPolygonMode, ii, threadCount ) );
+
+    buildLayerMeshes( &aJobs, aBiuTo3DUnits, aPolygonMode, 0, threadCount );
+
+    for( unsigned ii = 0; ii < threads.size(); ++ii )
+        threads[ii].join();
+}
@@ -0,0 +1,130 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_layer_mesh.h
+ */
+
+#ifndef __3D_LAYER_MESH_H__
+#define __3D_LAYER_MESH_H__
+
+#include <vector>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <geometry/shape_poly_set.h>
+
+
+/**
+ * Class LAYER_MESH
+ * holds the triangles of the 3D shape of a board layer, as vertex, normal and index
+ * buffers, ready to be handed to OpenGL by Draw3D_LayerMesh().
+ * <p>
+ * The mesh is built without any OpenGL call (only the GLU tesselator is used),
+ * so it can be built by worker threads, and outside a 3D canvas.
+ */
+class LAYER_MESH
+{
+public:
+    std::vector<float>      m_Vertices;     ///< x, y, z of each vertex, in 3D units
+    std::vector<float>      m_Normals;      ///< x, y, z of the normal of each vertex
+    std::vector<unsigned>   m_Triangles;    ///< 3 vertex indices per triangle
+
+    void Clear();
+
+    bool IsEmpty() const { return m_Triangles.empty(); }
+
+    unsigned GetVertexCount() const { return m_Vertices.size() / 3; }
+
+    /**
+     * Function AddSolidHorizontalPolyPolygons
+     * adds the solid shape of all polygons found in aPolysList,
+     * like Draw3D_SolidHorizontalPolyPolygons() draws it.
+     * @param aPolysList = the polygons to add
+     * @param aZpos = z position in board internal units
+     * @param aThickness = thickness in board internal units
+     * @param aBiuTo3DUnits = board internal units to 3D units scaling value
+     * @param aNormal_Z_Orientation = the normal Z orientation of the top side
+     * If aThickness = 0, a polygon area is added in a XY plane at Z position = aZpos.
+     * If aThickness > 0, a solid object is added.
+     *  The top side is located at aZpos + aThickness / 2
+     *  The bottom side is located at aZpos - aThickness / 2
+     */
+    void AddSolidHorizontalPolyPolygons( const SHAPE_POLY_SET& aPolysList,
+                                         int aZpos, int aThickness, double aBiuTo3DUnits,
+                                         float aNormal_Z_Orientation );
+
+    /// Used by the tesselator callbacks: adds a vertex and returns its index.
+    unsigned AddVertex( float aX, float aY, float aZ, float aNx, float aNy, float aNz );
+
+private:
+    /**
+     * Function addVerticalSides
+     * adds the vertical sides of the outlines of aPolysList,
+     * from aZbottom to aZtop (in 3D units).
+     */
+    void addVerticalSides( const SHAPE_POLY_SET& aPolysList, double aZbottom, double aZtop,
+                           double aBiuTo3DUnits );
+};
+
+
+/**
+ * Struct LAYER_MESH_JOB
+ * the polygons of a layer, and the mesh built from them by BuildLayerMeshes().
+ * The polygon calculations (merge of the holes, hole subtraction) are made by
+ * BuildLayerMeshes(), because they are the longest part of the 3D view build.
+ */
+struct LAYER_MESH_JOB
+{
+    LAYER_MESH_JOB();
+
+    int                     m_Layer;        ///< the layer id, for the caller
+    SHAPE_POLY_SET          m_Polys;        ///< shapes of the layer, cut by m_Cuts and m_Holes
+    SHAPE_POLY_SET          m_Cuts;         ///< shapes to remove from m_Polys, merged with
+                                            ///< m_Holes when not empty
+    SHAPE_POLY_SET          m_UncutPolys;   ///< shapes added to the mesh without any cut
+    const SHAPE_POLY_SET*   m_Holes;        ///< through holes, shared by all jobs, or NULL
+    int                     m_Zpos;         ///< see LAYER_MESH::AddSolidHorizontalPolyPolygons()
+    int                     m_Thickness;
+    float                   m_NormalZ;
+    LAYER_MESH              m_Mesh;         ///< the result
+
+    /**
+     * Function Build
+     * cuts m_Polys and fills m_Mesh.
+     * @param aBiuTo3DUnits = board internal units to 3D units scaling value
+     * @param aPolygonMode = the mode of the polygon calculations
+     */
+    void Build( double aBiuTo3DUnits, SHAPE_POLY_SET::POLYGON_MODE aPolygonMode );
+};
+
+typedef boost::ptr_vector<LAYER_MESH_JOB> LAYER_MESH_JOBS;
+
+
+/**
+ * Function BuildLayerMeshes
+ * builds the meshes of all jobs in aJobs, each layer in its own worker thread when
+ * several CPU cores are available.  m_Holes can be shared by the jobs: it is only read.
+ */
+void BuildLayerMeshes( LAYER_MESH_JOBS& aJobs, double aBiuTo3DUnits,
+                       SHAPE_POLY_SET::POLYGON_MODE aPolygonMode );
+
+#endif  // __3D_LAYER_MESH_H__
@@ -0,0 +1,560 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.cpp
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <macros.h>
+#include <wx/filename.h>
+#include <wx/filefn.h>
+#include <wx/utils.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "3d_struct.h"
+#include "3d_mesh_model.h"
+#include "modelparsers.h"
+#include "3d_mesh_cache.h"
+
+
+// The first bytes of a cache file
+static const char cacheMagic[8] = { 'K', 'I', '3', 'D', 'M', 'E', 'S', 'H' };
+
+// To be incremented each time the cache file format or the meshes change
+#define CACHE_VERSION   3
+
+
+/**
+ * Class CACHE_WRITER
+ * builds the content of a cache file in memory, in the byte order of the machine.
+ */
+class CACHE_WRITER
+{
+public:
+    std::vector<char>   m_Data;
+
+    void Put( const void* aData, size_t aSize )
+    {
+        const char* data = (const char*) aData;
+        m_Data.insert( m_Data.end(), data, data + aSize );
+    }
+
+    void PutInt( int aValue )                   { Put( &aValue, sizeof( aValue ) ); }
+    void PutLong( long long aValue )            { Put( &aValue, sizeof( aValue ) ); }
+
+    void PutString( const wxString& aText )
+    {
+        std::string utf8 = TO_UTF8( aText );
+
+        PutInt( utf8.size() );
+        Put( utf8.data(), utf8.size() );
+    }
+
+    template <class T> void PutVector( const std::vector<T>& aVector )
+    {
+        PutInt( aVector.size() );
+
+        if( !aVector.empty() )
+            Put( &aVector[0], aVector.size() * sizeof( T ) );
+    }
+
+    void PutIndexes( const S3D_INDEX_LIST& aIndexes )
+    {
+        PutVector( aIndexes.Indexes() );
+        PutVector( aIndexes.FaceStarts() );
+    }
+};
+
+
+/**
+ * Class CACHE_READER
+ * reads back what a CACHE_WRITER wrote.  Reading past the end of the data, or a size
+ * larger than the remaining data sets the failed state, checked once at the end.
+ */
+class CACHE_READER
+{
+public:
+    CACHE_READER( const std::vector<char>& aData ) :
+        m_next( aData.empty() ? NULL : &aData[0] ),
+        m_end( m_next + aData.size() ),
+        m_failed( false )
+    {
+    }
+
+    bool Failed() const                 { return m_failed; }
+
+    bool Get( void* aData, size_t aSize )
+    {
+        if( m_failed || size_t( m_end - m_next ) < aSize )
+        {
+            m_failed = true;
+            memset( aData, 0, aSize );
+            return false;
+        }
+
+        memcpy( aData, m_next, aSize );
+        m_next += aSize;
+        return true;
+    }
+
+    int GetInt()
+    {
+        int value;
+        Get( &value, sizeof( value ) );
+        return value;
+    }
+
+    long long GetLong()
+    {
+        long long value;
+        Get( &value, sizeof( value ) );
+        return value;
+    }
+
+    wxString GetString()
+    {
+        int len = GetInt();
+
+        if( !checkCount( len, 1 ) )
+            return wxEmptyString;
+
+        wxString text = wxString::FromUTF8( m_next, len );
+        m_next += len;
+        return text;
+    }
+
+    template <class T> void GetVector( std::vector<T>& aVector )
+    {
+        int count = GetInt();
+
+        if( !checkCount( count, sizeof( T ) ) )
+            return;
+
+        aVector.resize( count );
+
+        if( count )
+            Get( &aVector[0], count * sizeof( T ) );
+    }
+
+    void GetIndexes( S3D_INDEX_LIST& aIndexes )
+    {
+        std::vector<int>        indexes;
+        std::vector<unsigned>   faceStarts;
+
+        GetVector( indexes );
+        GetVector( faceStarts );
+
+        if( !m_failed && !aIndexes.Set( indexes, faceStarts ) )
+            m_failed = true;
+    }
+
+private:
+    // check that aCount items of aSize bytes can be read
+    bool checkCount( int aCount, size_t aSize )
+    {
+        if( m_failed || aCount < 0 || size_t( m_end - m_next ) / aSize < size_t( aCount ) )
+            m_failed = true;
+
+        return !m_failed;
+    }
+
+    const char* m_next;
+    const char* m_end;
+    bool        m_failed;
+};
+
+
+// the modification time and size of a model file, which must match the ones
+// recorded in its cache file
+static bool getFileStamp( const wxString& aFileName, long long& aTime, long long& aSize )
+{
+    wxStructStat st;
+
+    if( wxStat( aFileName, &st ) != 0 )
+        return false;
+
+    aTime = st.st_mtime;
+    aSize = st.st_size;
+
+    return true;
+}
+
+
+// the stamp of a file included by a model file: a missing file has a stamp too, so the
+// cache file is out of date when it is created
+static void getIncludedFileStamp( const wxString& aFileName, long long& aTime,
+                                  long long& aSize )
+{
+    if( !getFileStamp( aFileName, aTime, aSize ) )
+        aTime = aSize = -1;
+}
+
+
+// number the meshes and the materials of the tree of aMesh; a mesh used several
+// times (VRML USE) is numbered once, so it is shared again when the cache is read
+static void collectMeshes( S3D_MESH* aMesh,
+                           std::map<S3D_MESH*, int>& aMeshIds,
+                           std::vector<S3D_MESH*>& aMeshes,
+                           std::map<S3D_MATERIAL*, int>& aMaterialIds,
+                           std::vector<S3D_MATERIAL*>& aMaterials )
+{
+    if( aMeshIds.count( aMesh ) )
+        return;
+
+    aMeshIds[aMesh] = aMeshes.size();
+    aMeshes.push_back( aMesh );
+
+    if( aMesh->m_Materials && !aMaterialIds.count( aMesh->m_Materials ) )
+    {
+        aMaterialIds[aMesh->m_Materials] = aMaterials.size();
+        aMaterials.push_back( aMesh->m_Materials );
+    }
+
+    for( unsigned ii = 0; ii < aMesh->childs.size(); ii++ )
+        collectMeshes( aMesh->childs[ii].get(), aMeshIds, aMeshes, aMaterialIds, aMaterials );
+}
+
+
+S3D_MESH_CACHE::S3D_MESH_CACHE( const wxString& aCacheDir )
+{
+    wxFileName dir;
+
+    if( aCacheDir.IsEmpty() )
+    {
+        dir.AssignDir( GetKicadConfigPath() );
+        dir.AppendDir( wxT( "3d_cache" ) );
+    }
+    else
+    {
+        dir.AssignDir( aCacheDir );
+    }
+
+    if( dir.DirExists() || dir.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+        m_cacheDir = dir.GetPath();
+}
+
+
+wxString S3D_MESH_CACHE::cacheFileName( const wxString& aModelFile ) const
+{
+    // FNV-1a hash of the model file name
+    std::string name = TO_UTF8( aModelFile );
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for( unsigned ii = 0; ii < name.size(); ii++ )
+    {
+        hash ^= (unsigned char) name[ii];
+        hash *= 1099511628211ULL;
+    }
+
+    wxFileName fn( m_cacheDir, wxString::Format( wxT( "%08x%08x" ),
+                                                 (unsigned) ( hash >> 32 ),
+                                                 (unsigned) hash ),
+                   wxT( "mesh" ) );
+
+    return fn.GetFullPath();
+}
+
+
+bool S3D_MESH_CACHE::Load( const wxString& aModelFile, S3D_MODEL_PARSER* aParser ) const
+{
+    long long   modelTime, modelSize;
+
+    if( !IsEnabled() || !getFileStamp( aModelFile, modelTime, modelSize ) )
+        return false;
+
+    FILE* file = wxFopen( cacheFileName( aModelFile ), wxT( "rb" ) );
+
+    if( !file )
+        return false;
+
+    std::vector<char> data;
+    char    buffer[65536];
+    size_t  count;
+
+    while( ( count = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 )
+        data.insert( data.end(), buffer, buffer + count );
+
+    fclose( file );
+
+    CACHE_READER reader( data );
+    char magic[sizeof( cacheMagic )];
+
+    // an other model file can have the same cache file name: check the name too
+    if( !reader.Get( magic, sizeof( magic ) )
+        || memcmp( magic, cacheMagic, sizeof( magic ) ) != 0
+        || reader.GetInt() != CACHE_VERSION
+        || reader.GetString() != aModelFile
+        || reader.GetLong() != modelTime
+        || reader.GetLong() != modelSize )
+        return false;
+
+    // The files included by the model file (VRML Inline) must be unchanged too
+    int includedCount = reader.GetInt();
+
+    if( includedCount < 0 || size_t( includedCount ) > data.size() )
+        return false;
+
+    for( int ii = 0; ii < includedCount; ii++ )
+    {
+        wxString    includedFile = reader.GetString();
+        long long   includedTime, includedSize;
+
+        getIncludedFileStamp( includedFile, includedTime, includedSize );
+
+        if( reader.Failed()
+            || reader.GetLong() != includedTime
+            || reader.GetLong() != includedSize )
+            return false;
+    }
+
+    S3D_MASTER* master = aParser->GetMaster();
+
+    int materialCount = reader.GetInt();
+
+    if( materialCount < 0 || size_t( materialCount ) > data.size() )
+        return false;
+
+    // Materials are owned by the master: they are given to it only once the whole
+    // file is read, and deleted on failure
+    std::vector<S3D_MATERIAL*> materials( materialCount, (S3D_MATERIAL*) NULL );
+
+    for( unsigned ii = 0; ii < materials.size() && !reader.Failed(); ii++ )
+    {
+        S3D_MATERIAL* material = new S3D_MATERIAL( master, reader.GetString() );
+
+        materials[ii] = material;
+
+        reader.GetVector( material->m_AmbientColor );
+        reader.GetVector( material->m_DiffuseColor );
+        reader.GetVector( material->m_EmissiveColor );
+        reader.GetVector( material->m_SpecularColor );
+        reader.GetVector( material->m_Shininess );
+        reader.GetVector( material->m_Transparency );
+        material->m_ColorPerVertex = reader.GetInt() != 0;
+    }
+
+    int meshCount = reader.GetInt();
+    bool ok = !reader.Failed() && meshCount > 0 && size_t( meshCount ) <= data.size();
+
+    if( !ok )
+        meshCount = 0;
+
+    S3D_MESH_PTRS meshes;
+
+    for( int ii = 0; ii < meshCount; ii++ )
+        meshes.push_back( S3D_MESH_PTR( new S3D_MESH() ) );
+
+    std::vector<int> ids;
+
+    for( int ii = 0; ok && ii < meshCount; ii++ )
+    {
+        S3D_MESH* mesh = meshes[ii].get();
+        int materialId = reader.GetInt();
+
+        if( materialId >= (int) materials.size() )
+        {
+            ok = false;
+            break;
+        }
+
+        if( materialId >= 0 )
+            mesh->m_Materials = materials[materialId];
+
+        reader.GetVector( mesh->m_Point );
+        reader.GetIndexes( mesh->m_CoordIndex );
+        reader.GetIndexes( mesh->m_NormalIndex );
+        reader.GetVector( mesh->m_PerFaceColor );
+        reader.GetVector( mesh->m_PerFaceNormalsNormalized );
+        reader.GetVector( mesh->m_PerVertexNormalsNormalized );
+        reader.GetVector( mesh->m_MaterialIndexPerFace );
+        reader.GetIndexes( mesh->m_MaterialIndexPerVertex );
+        reader.Get( &mesh->m_translation, sizeof( mesh->m_translation ) );
+        reader.Get( &mesh->m_rotation, sizeof( mesh->m_rotation ) );
+        reader.Get( &mesh->m_scale, sizeof( mesh->m_scale ) );
+
+        reader.GetVector( ids );
+
+        for( unsigned jj = 0; ok && jj < ids.size(); jj++ )
+        {
+            if( ids[jj] < 0 || ids[jj] >= meshCount )
+                ok = false;
+            else
+                mesh->childs.push_back( meshes[ids[jj]] );
+        }
+
+        ok = ok && !reader.Failed();
+    }
+
+    reader.GetVector( ids );
+    ok = ok && !reader.Failed();
+
+    S3D_MESH_PTRS childs;
+
+    for( unsigned jj = 0; ok && jj < ids.size(); jj++ )
+    {
+        if( ids[jj] < 0 || ids[jj] >= meshCount )
+            ok = false;
+        else
+            childs.push_back( meshes[ids[jj]] );
+    }
+
+    if( !ok )
+    {
+        for( unsigned ii = 0; ii < materials.size(); ii++ )
+            delete materials[ii];
+
+        return false;
+    }
+
+    for( unsigned ii = materials.size(); ii > 0; ii-- )
+        master->Insert( materials[ii - 1] );
+
+    aParser->childs = childs;
+
+    return true;
+}
+
+
+bool S3D_MESH_CACHE::Save( const wxString& aModelFile, S3D_MODEL_PARSER* aParser ) const
+{
+    long long   modelTime, modelSize;
+
+    if( !IsEnabled() || !getFileStamp( aModelFile, modelTime, modelSize ) )
+        return false;
+
+    std::map<S3D_MESH*, int>        meshIds;
+    std::vector<S3D_MESH*>          meshes;
+    std::map<S3D_MATERIAL*, int>    materialIds;
+    std::vector<S3D_MATERIAL*>      materials;
+
+    for( unsigned ii = 0; ii < aParser->childs.size(); ii++ )
+        collectMeshes( aParser->childs[ii].get(), meshIds, meshes, materialIds, materials );
+
+    if( meshes.empty() )
+        return false;
+
+    CACHE_WRITER writer;
+
+    writer.Put( cacheMagic, sizeof( cacheMagic ) );
+    writer.PutInt( CACHE_VERSION );
+    writer.PutString( aModelFile );
+    writer.PutLong( modelTime );
+    writer.PutLong( modelSize );
+
+    const std::vector<wxString>& includedFiles = aParser->GetIncludedFiles();
+
+    writer.PutInt( includedFiles.size() );
+
+    for( unsigned ii = 0; ii < includedFiles.size(); ii++ )
+    {
+        long long includedTime, includedSize;
+
+        getIncludedFileStamp( includedFiles[ii], includedTime, includedSize );
+
+        writer.PutString( includedFiles[ii] );
+        writer.PutLong( includedTime );
+        writer.PutLong( includedSize );
+    }
+
+    writer.PutInt( materials.size() );
+
+    for( unsigned ii = 0; ii < materials.size(); ii++ )
+    {
+        S3D_MATERIAL* material = materials[ii];
+
+        writer.PutString( material->m_Name );
+        writer.PutVector( material->m_AmbientColor );
+        writer.PutVector( material->m_DiffuseColor );
+        writer.PutVector( material->m_EmissiveColor );
+        writer.PutVector( material->m_SpecularColor );
+        writer.PutVector( material->m_Shininess );
+        writer.PutVector( material->m_Transparency );
+        writer.PutInt( material->m_ColorPerVertex );
+    }
+
+    writer.PutInt( meshes.size() );
+
+    std::vector<int> ids;
+
+    for( unsigned ii = 0; ii < meshes.size(); ii++ )
+    {
+        S3D_MESH* mesh = meshes[ii];
+
+        writer.PutInt( mesh->m_Materials ? materialIds[mesh->m_Materials] : -1 );
+        writer.PutVector( mesh->m_Point );
+        writer.PutIndexes( mesh->m_CoordIndex );
+        writer.PutIndexes( mesh->m_NormalIndex );
+        writer.PutVector( mesh->m_PerFaceColor );
+        writer.PutVector( mesh->m_PerFaceNormalsNormalized );
+        writer.PutVector( mesh->m_PerVertexNormalsNormalized );
+        writer.PutVector( mesh->m_MaterialIndexPerFace );
+        writer.PutIndexes( mesh->m_MaterialIndexPerVertex );
+        writer.Put( &mesh->m_translation, sizeof( mesh->m_translation ) );
+        writer.Put( &mesh->m_rotation, sizeof( mesh->m_rotation ) );
+        writer.Put( &mesh->m_scale, sizeof( mesh->m_scale ) );
+
+        ids.clear();
+
+        for( unsigned jj = 0; jj < mesh->childs.size(); jj++ )
+            ids.push_back( meshIds[mesh->childs[jj].get()] );
+
+        writer.PutVector( ids );
+    }
+
+    ids.clear();
+
+    for( unsigned ii = 0; ii < aParser->childs.size(); ii++ )
+        ids.push_back( meshIds[aParser->childs[ii].get()] );
+
+    writer.PutVector( ids );
+
+    // Write a temporary file and rename it, so an other instance never reads
+    // a partially written cache file
+    wxString cacheFile = cacheFileName( aModelFile );
+    wxString tmpFile = cacheFile + wxString::Format( wxT( ".%lu" ), wxGetProcessId() );
+
+    FILE* file = wxFopen( tmpFile, wxT( "wb" ) );
+
+    if( !file )
+        return false;
+
+    bool ok = fwrite( &writer.m_Data[0], 1, writer.m_Data.size(), file )
+              == writer.m_Data.size();
+
+    ok = ( fclose( file ) == 0 ) && ok;
+
+    if( !ok || !wxRenameFile( tmpFile, cacheFile, true ) )
+    {
+        wxRemoveFile( tmpFile );
+        return false;
+    }
+
+    return true;
+}
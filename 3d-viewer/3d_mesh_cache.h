@@ -0,0 +1,86 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.h
+ */
+
+#ifndef __3D_MESH_CACHE_H__
+#define __3D_MESH_CACHE_H__
+
+#include <wx/string.h>
+
+class S3D_MODEL_PARSER;
+
+
+/**
+ * Class S3D_MESH_CACHE
+ * keeps the meshes read from the 3D model files in a binary file per model file,
+ * in a cache directory of the user configuration.  A cache file is used as long as
+ * the modification time and the size of its model file, and of the files included by
+ * the model file (see S3D_MODEL_PARSER::AddIncludedFile()), are unchanged, so the model
+ * files are parsed once, and not each time the 3D viewer is opened.
+ * <p>
+ * Load() and Save() can be called by several threads at the same time, for different
+ * model files.
+ */
+class S3D_MESH_CACHE
+{
+public:
+    /**
+     * Constructor
+     * @param aCacheDir is the directory of the cache files, created if needed.
+     * By default, the directory "3d_cache" of the KiCad configuration path is used.
+     */
+    S3D_MESH_CACHE( const wxString& aCacheDir = wxEmptyString );
+
+    /**
+     * Function IsEnabled
+     * @return false if the cache directory cannot be created; Load() and Save()
+     * then do nothing.
+     */
+    bool IsEnabled() const { return !m_cacheDir.IsEmpty(); }
+
+    /**
+     * Function Load
+     * fills \a aParser with the meshes cached for \a aModelFile.  The materials are
+     * inserted in the S3D_MASTER of \a aParser, as a parser does.
+     * @return true if the cache file was up to date and has been read.
+     */
+    bool Load( const wxString& aModelFile, S3D_MODEL_PARSER* aParser ) const;
+
+    /**
+     * Function Save
+     * writes the meshes just read by \a aParser from \a aModelFile to the cache.
+     * @return true if the cache file has been written.
+     */
+    bool Save( const wxString& aModelFile, S3D_MODEL_PARSER* aParser ) const;
+
+private:
+    /// @return the name of the cache file of \a aModelFile.
+    wxString cacheFileName( const wxString& aModelFile ) const;
+
+    wxString    m_cacheDir;     ///< the cache directory, empty if disabled
+};
+
+#endif  // __3D_MESH_CACHE_H__
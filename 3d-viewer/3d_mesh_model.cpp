@@ -50,6 +50,30 @@
 
 #include "info3d_visu.h"
 
+#include <algorithm>
+#include <string.h>
+
+
+bool S3D_INDEX_LIST::Set( const std::vector<int>& aIndexes,
+                          const std::vector<unsigned>& aFaceStart )
+{
+    bool ok = !aFaceStart.empty() && aFaceStart.front() == 0
+              && aFaceStart.back() == aIndexes.size();
+
+    for( unsigned ii = 1; ok && ii < aFaceStart.size(); ii++ )
+        ok = aFaceStart[ii - 1] <= aFaceStart[ii];
+
+    if( !ok )
+    {
+        clear();
+        return false;
+    }
+
+    m_Indexes = aIndexes;
+    m_FaceStart = aFaceStart;
+    return true;
+}
+
 
 S3D_MESH::S3D_MESH()
 {
@@ -57,6 +81,7 @@ S3D_MESH::S3D_MESH()
     isPointNormalizedComputed   = false;
     isPerPointNormalsComputed   = false;
     isPerVertexNormalsVerified  = false;
+    m_PointNormalizeFactor      = 1.0f;
     m_Materials = NULL;
     childs.clear();
 
@@ -117,16 +142,17 @@ void S3D_MESH::calcBBox( )
     bool firstBBox = true;
 
     // Calc boudingbox for all coords
-    for( unsigned int idx = 0; idx < m_CoordIndex.size(); idx++ )
+    const std::vector<int>& coords = m_CoordIndex.Indexes();
+
+    for( unsigned int ii = 0; ii < coords.size(); ii++ )
     {
-        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-            if( firstBBox )
-            {
-                firstBBox = false;
-                tmpBBox = CBBOX( m_Point[m_CoordIndex[idx][ii]] );              // Initialize with the first vertex found
-            }
-            else
-                tmpBBox.Union( m_Point[m_CoordIndex[idx][ii]] );
+        if( firstBBox )
+        {
+            firstBBox = false;
+            tmpBBox = CBBOX( m_Point[coords[ii]] );              // Initialize with the first vertex found
+        }
+        else
+            tmpBBox.Union( m_Point[coords[ii]] );
     }
 
     m_BBox = tmpBBox;
@@ -258,12 +284,12 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
             //glNormal3fv( &normal.x );
 
             glm::vec3 point = m_Point[m_CoordIndex[idx][0]];
-            for( unsigned int ii = 1; ii < m_CoordIndex[idx].size(); ii++ )
+            for( unsigned int ii = 1; ii < m_CoordIndex.FaceSize( idx ); ii++ )
             {
                 point += m_Point[m_CoordIndex[idx][ii]];
             }
 
-            point /= m_CoordIndex[idx].size();
+            point /= m_CoordIndex.FaceSize( idx );
 
             glBegin( GL_LINES );
             glVertex3fv( &point.x );
@@ -290,7 +316,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
             if( (m_PerVertexNormalsNormalized.size() > 0) &&
                 g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
             {
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                 {
                     glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
                     //glNormal3fv( &normal.x );
@@ -305,10 +331,9 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
             }
             else
             {
-                std::vector< glm::vec3 > normals_list;
-                normals_list = m_PerFaceVertexNormals[idx];
+                const S3D_VERTEX* normals_list = &m_PerFaceVertexNormals[m_CoordIndex.FaceStart( idx )];
 
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                 {
                     glm::vec3 normal = normals_list[ii];
                     printf("normal(%f, %f, %f), ", normal.x, normal.y, normal.z );
@@ -391,7 +416,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
             }
         }
 
-        switch( m_CoordIndex[idx].size() )
+        switch( m_CoordIndex.FaceSize( idx ) )
         {
         case 3:
             glBegin( GL_TRIANGLES );
@@ -430,7 +455,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                         if( (m_PerVertexNormalsNormalized.size() > 0) &&
                             g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
                         {
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                            for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                             {
                                 S3D_VERTEX color = m_Materials->m_DiffuseColor[m_MaterialIndexPerVertex[idx][ii]];
                                 glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
@@ -444,10 +469,9 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                         }
                         else
                         {
-                            std::vector< glm::vec3 > normals_list;
-                            normals_list = m_PerFaceVertexNormals[idx];
+                            const S3D_VERTEX* normals_list = &m_PerFaceVertexNormals[m_CoordIndex.FaceStart( idx )];
 
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                            for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                             {
                                 S3D_VERTEX color = m_Materials->m_DiffuseColor[m_MaterialIndexPerVertex[idx][ii]];
                                 glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
@@ -472,7 +496,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                         if( (m_PerVertexNormalsNormalized.size() > 0) &&
                             g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
                         {
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                            for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                             {
                                 S3D_VERTEX color = m_Materials->m_DiffuseColor[m_CoordIndex[idx][ii]];
                                 glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
@@ -486,10 +510,9 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                         }
                         else
                         {
-                            std::vector< glm::vec3 > normals_list;
-                            normals_list = m_PerFaceVertexNormals[idx];
+                            const S3D_VERTEX* normals_list = &m_PerFaceVertexNormals[m_CoordIndex.FaceStart( idx )];
 
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                            for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                             {
                                 S3D_VERTEX color = m_Materials->m_DiffuseColor[m_CoordIndex[idx][ii]];
                                 glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
@@ -508,7 +531,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                     if( (m_PerVertexNormalsNormalized.size() > 0) &&
                         g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
                     {
-                        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                        for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                         {
                             glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
                             glNormal3fv( &normal.x );
@@ -519,10 +542,9 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                     }
                     else
                     {
-                        std::vector< glm::vec3 > normals_list;
-                        normals_list = m_PerFaceVertexNormals[idx];
+                        const S3D_VERTEX* normals_list = &m_PerFaceVertexNormals[m_CoordIndex.FaceStart( idx )];
 
-                        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                        for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                         {
                             glm::vec3 normal = normals_list[ii];
                             glNormal3fv( &normal.x );
@@ -538,7 +560,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                 if( (m_PerVertexNormalsNormalized.size() > 0) &&
                     g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
                 {
-                    for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                    for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                     {
                         glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
                         glNormal3fv( &normal.x );
@@ -549,10 +571,9 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                 }
                 else
                 {
-                    std::vector< glm::vec3 > normals_list;
-                    normals_list = m_PerFaceVertexNormals[idx];
+                    const S3D_VERTEX* normals_list = &m_PerFaceVertexNormals[m_CoordIndex.FaceStart( idx )];
 
-                    for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                    for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                     {
                         glm::vec3 normal = normals_list[ii];
                         glNormal3fv( &normal.x );
@@ -591,7 +612,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                         // be N+1 colours in the Color node."
                         if ( m_MaterialIndexPerVertex.size() != 0 )
                         {
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                            for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                             {
                                 S3D_VERTEX color = m_Materials->m_DiffuseColor[m_MaterialIndexPerVertex[idx][ii]];
                                 glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
@@ -608,7 +629,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                             // coordIndex field is N, then there must be N+1
                             // colours in the Color node."
 
-                            for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                            for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                             {
                                 S3D_VERTEX color = m_Materials->m_DiffuseColor[m_CoordIndex[idx][ii]];
                                 glColor4f( color.x, color.y, color.z, 1.0f - lastTransparency_value );
@@ -620,7 +641,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                     }
                     else
                     {
-                        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                        for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                         {
                             S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
                             glVertex3fv( &point.x );
@@ -629,7 +650,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
                 }
                 else
                 {
-                    for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                    for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                     {
                         S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
                         glVertex3fv( &point.x );
@@ -638,7 +659,7 @@ void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
             }
             else
             {
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                 {
                     S3D_VERTEX point = m_Point[m_CoordIndex[idx][ii]];
                     glVertex3fv( &point.x );
@@ -724,9 +745,7 @@ void S3D_MESH::calcPointNormalized()
 
     isPointNormalizedComputed = true;
 
-    m_PointNormalized.clear();
-    m_PointNormalized.resize( m_Point.size() );
-
+    // Only the factor is stored: the normalized points are calculated when needed
     float biggerPoint = 0.0f;
     for( unsigned int i = 0; i < m_Point.size(); i++ )
     {
@@ -744,10 +763,7 @@ void S3D_MESH::calcPointNormalized()
             biggerPoint = v;
     }
 
-    for( unsigned int i = 0; i < m_Point.size(); i++ )
-    {
-        m_PointNormalized[i] = m_Point[i] / biggerPoint;
-    }
+    m_PointNormalizeFactor = biggerPoint;
 }
 
 
@@ -791,7 +807,7 @@ void S3D_MESH::calcPerFaceNormals()
     m_PerFaceNormalsRaw_X_PerFaceSquaredArea.resize( m_CoordIndex.size() );
 
     // There are no points defined for the coordIndex
-    if( m_PointNormalized.size() == 0 )
+    if( m_Point.size() == 0 )
     {
         m_CoordIndex.clear();
         return;
@@ -806,11 +822,12 @@ void S3D_MESH::calcPerFaceNormals()
         // http://tog.acm.org/resources/GraphicsGems/gemsiii/newell.c
         // http://www.iquilezles.org/www/articles/areas/areas.htm
 
-        for( unsigned int i = 0; i < m_CoordIndex[idx].size(); i++ )
+        for( unsigned int i = 0; i < m_CoordIndex.FaceSize( idx ); i++ )
         {
 
-            glm::dvec3 u = glm::dvec3( m_PointNormalized[m_CoordIndex[idx][i]] );
-            glm::dvec3 v = glm::dvec3( m_PointNormalized[m_CoordIndex[idx][(i + 1) % m_CoordIndex[idx].size()]] );
+            glm::dvec3 u = glm::dvec3( m_Point[m_CoordIndex[idx][i]] / m_PointNormalizeFactor );
+            glm::dvec3 v = glm::dvec3( m_Point[m_CoordIndex[idx][(i + 1) % m_CoordIndex.FaceSize( idx )]]
+                                       / m_PointNormalizeFactor );
 
             cross_prod.x +=  (u.y - v.y) * (u.z + v.z);
             cross_prod.y +=  (u.z - v.z) * (u.x + v.x);
@@ -835,7 +852,7 @@ void S3D_MESH::calcPerFaceNormals()
             {
                 glm::dvec3 normalSum;
 
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( idx ); ii++ )
                 {
                     normalSum += glm::dvec3( m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]] );
                 }
@@ -889,7 +906,7 @@ void S3D_MESH::calcPerFaceNormals()
                 {
 
                     /*
-                    for( unsigned int i = 0; i < m_CoordIndex[idx].size(); i++ )
+                    for( unsigned int i = 0; i < m_CoordIndex.FaceSize( idx ); i++ )
                     {
                         glm::vec3 v = m_Point[m_CoordIndex[idx][i]];
                         DBG( printf( "v[%u](%f, %f, %f)", i, v.x, v.y, v.z ) );
@@ -898,7 +915,7 @@ void S3D_MESH::calcPerFaceNormals()
                             idx,
                             cross_prod.x, cross_prod.y, cross_prod.z,
                             l,
-                            (unsigned int)m_CoordIndex[idx].size()) );
+                            (unsigned int)m_CoordIndex.FaceSize( idx )) );
 
                     */
 
@@ -936,6 +953,54 @@ void S3D_MESH::calcPerFaceNormals()
 }
 
 
+// Orders the points by their coordinates bits, to find the identical points
+struct POINT_BITS_LESS
+{
+    POINT_BITS_LESS( const std::vector< S3D_VERTEX >& aPoints ) : m_points( aPoints ) {}
+
+    bool operator()( unsigned a, unsigned b ) const
+    {
+        int diff = memcmp( &m_points[a].x, &m_points[b].x, sizeof( S3D_VERTEX ) );
+
+        return diff ? diff < 0 : a < b;
+    }
+
+    const std::vector< S3D_VERTEX >& m_points;
+};
+
+
+void S3D_MESH::calcWeldedPoints( std::vector<unsigned>& aPointIds ) const
+{
+    unsigned pointCount = m_Point.size();
+    std::vector<unsigned> order( pointCount );
+
+    for( unsigned ii = 0; ii < pointCount; ii++ )
+        order[ii] = ii;
+
+    // Compare the bits: no tolerance, and no trouble with NaN coordinates
+    std::sort( order.begin(), order.end(), POINT_BITS_LESS( m_Point ) );
+
+    aPointIds.resize( pointCount );
+
+    for( unsigned ii = 0; ii < pointCount; )
+    {
+        // the first of identical points is the one having the smallest index
+        unsigned first = order[ii];
+        unsigned jj = ii;
+
+        for( ; jj < pointCount; jj++ )
+        {
+            if( memcmp( &m_Point[order[jj]].x, &m_Point[first].x, sizeof( S3D_VERTEX ) ) )
+                break;
+
+            aPointIds[order[jj]] = first;
+        }
+
+        ii = jj;
+    }
+}
+
+
 // Documentation literature
 // http://www.bytehazard.com/code/vertnorm.html
 // http://www.emeyex.com/site/tuts/VertexNormals.pdf
@@ -948,30 +1013,45 @@ void S3D_MESH::calcPerPointNormals()
 
     isPerPointNormalsComputed = true;
 
-    m_PerFaceVertexNormals.clear();
+    const std::vector<int>& coords = m_CoordIndex.Indexes();
+    unsigned pointCount = m_Point.size();
 
-    // Pre-allocate space for the entire vector of vertex normals so we can do parallel writes
-    m_PerFaceVertexNormals.resize( m_CoordIndex.size() );
+    // Identical points are merged, so faces which do not share their points
+    // in the file are smoothed together
+    std::vector<unsigned> pointIds;
+    calcWeldedPoints( pointIds );
 
-    for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
+    // The faces using each point: pointFaces[pointFacesStart[id]] up to
+    // pointFaces[pointFacesStart[id + 1]], in increasing face order.
+    // This replaces a search of each vertex in all faces of the mesh.
+    std::vector<unsigned> pointFacesStart( pointCount + 1, 0 );
+
+    for( unsigned ii = 0; ii < coords.size(); ii++ )
     {
-        m_PerFaceVertexNormals[each_face_A_idx].resize( m_CoordIndex[each_face_A_idx].size() );
+        if( unsigned( coords[ii] ) < pointCount )
+            pointFacesStart[pointIds[coords[ii]] + 1]++;
     }
 
+    for( unsigned ii = 0; ii < pointCount; ii++ )
+        pointFacesStart[ii + 1] += pointFacesStart[ii];
 
-    // Initialize each vertex normal
-    for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
-    {
-        glm::vec3 initVertexFaceNormal = m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_A_idx];
+    std::vector<unsigned> pointFaces( pointFacesStart[pointCount] );
+    std::vector<unsigned> fillPos( pointFacesStart.begin(), pointFacesStart.end() - 1 );
 
-        std::vector< glm::vec3 >& face_A_normals = m_PerFaceVertexNormals[each_face_A_idx];
+    for( unsigned int face = 0; face < m_CoordIndex.size(); face++ )
+    {
+        const int* face_coords = m_CoordIndex[face];
 
-        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < m_CoordIndex[each_face_A_idx].size(); each_vert_A_idx++ )
+        for( unsigned int ii = 0; ii < m_CoordIndex.FaceSize( face ); ii++ )
         {
-            face_A_normals[each_vert_A_idx] = initVertexFaceNormal;
+            if( unsigned( face_coords[ii] ) < pointCount )
+                pointFaces[fillPos[pointIds[face_coords[ii]]]++] = face;
         }
     }
 
+    // One normal per face vertex, stored like m_CoordIndex indexes
+    m_PerFaceVertexNormals.clear();
+    m_PerFaceVertexNormals.resize( coords.size() );
 
     #ifdef USE_OPENMP
     #pragma omp parallel for
@@ -980,60 +1060,44 @@ void S3D_MESH::calcPerPointNormals()
     // for each face A in mesh
     for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
     {
-        // n = face A facet normal
-        std::vector< glm::vec3 >& face_A_normals = m_PerFaceVertexNormals[each_face_A_idx];
+        const glm::vec3 vector_face_A = m_PerFaceNormalsNormalized[each_face_A_idx];
+        const int* face_A_coords = m_CoordIndex[each_face_A_idx];
+        S3D_VERTEX* face_A_normals = &m_PerFaceVertexNormals[m_CoordIndex.FaceStart( each_face_A_idx )];
 
-        // loop through all vertices
         // for each vert in face A
-        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < m_CoordIndex[each_face_A_idx].size(); each_vert_A_idx++ )
+        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < m_CoordIndex.FaceSize( each_face_A_idx ); each_vert_A_idx++ )
         {
-            int vertexIndexFromFaceA = (int)(m_CoordIndex[each_face_A_idx][each_vert_A_idx]);
-            glm::vec3 vector_face_A = m_PerFaceNormalsNormalized[each_face_A_idx];
+            glm::vec3 normal = m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_A_idx];
 
-            // for each face B in mesh
-            for( unsigned int each_face_B_idx = 0; each_face_B_idx < m_CoordIndex.size(); each_face_B_idx++ )
+            if( unsigned( face_A_coords[each_vert_A_idx] ) < pointCount )
             {
-                //if A != B { // ignore self
-                if( each_face_A_idx != each_face_B_idx )
+                unsigned id = pointIds[face_A_coords[each_vert_A_idx]];
+                unsigned previous_face_B_idx = each_face_A_idx;
+
+                // for each other face B which touches this vertex, once
+                for( unsigned ii = pointFacesStart[id]; ii < pointFacesStart[id + 1]; ii++ )
                 {
-                    for( unsigned int ii = 0; ii < m_CoordIndex[each_face_B_idx].size(); ii++ )
-                    {
-                        // Check if there is any vertice in the face B that touch the vertice in face A
-                        if( m_CoordIndex[each_face_B_idx][ii] == vertexIndexFromFaceA )
-                        {
-                            glm::vec3 vector_face_B = m_PerFaceNormalsNormalized[each_face_B_idx];
+                    unsigned each_face_B_idx = pointFaces[ii];
 
-                            float dot_prod = glm::dot( vector_face_A, vector_face_B );
+                    if( each_face_B_idx == each_face_A_idx || each_face_B_idx == previous_face_B_idx )
+                        continue;
 
-                            if( dot_prod > 0.05f )
-                                face_A_normals[each_vert_A_idx] += m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_B_idx] * dot_prod;
+                    previous_face_B_idx = each_face_B_idx;
 
-                            // For each face, only one vertice can touch / share
-                            // another vertice from the other face, so we exit here
-                            break;
-                        }
-                    }
+                    float dot_prod = glm::dot( vector_face_A, m_PerFaceNormalsNormalized[each_face_B_idx] );
+
+                    if( dot_prod > 0.05f )
+                        normal += m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_B_idx] * dot_prod;
                 }
             }
-        }
-    }
 
-
-    #ifdef USE_OPENMP
-    #pragma omp parallel for
-    #endif /* USE_OPENMP */
-
-    // Normalize
-    for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
-    {
-        std::vector< glm::vec3 >& face_A_normals = m_PerFaceVertexNormals[each_face_A_idx];
-
-        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < m_CoordIndex[each_face_A_idx].size(); each_vert_A_idx++ )
-        {
-            float l = glm::length( face_A_normals[each_vert_A_idx] );
+            // Normalize
+            float l = glm::length( normal );
 
             if( l > FLT_EPSILON ) // avoid division by zero
-                face_A_normals[each_vert_A_idx] /= l;
+                normal /= l;
+
+            face_A_normals[each_vert_A_idx] = normal;
         }
     }
 }
@@ -47,6 +47,76 @@ typedef boost::shared_ptr<S3D_MESH> S3D_MESH_PTR;
 /** A container of smar S3D_MESH object pointers */
 typedef std::vector<S3D_MESH_PTR> S3D_MESH_PTRS;
 
+
+/**
+ * Class S3D_INDEX_LIST
+ * stores a list of faces, each face being a list of indexes, in two flat arrays
+ * instead of a std::vector per face: the indexes of all faces, and the position
+ * of the first index of each face.
+ * A face index is read as in a std::vector< std::vector<int> >: list[face][ii],
+ * and FaceSize( face ) is the number of indexes of the face.
+ */
+class S3D_INDEX_LIST
+{
+public:
+    S3D_INDEX_LIST() : m_FaceStart( 1, 0 ) {}
+
+    /// @return the number of faces
+    size_t size() const { return m_FaceStart.size() - 1; }
+
+    bool empty() const { return m_FaceStart.size() == 1; }
+
+    void clear()
+    {
+        m_Indexes.clear();
+        m_FaceStart.resize( 1 );
+    }
+
+    void reserve( size_t aFaceCount ) { m_FaceStart.reserve( aFaceCount + 1 ); }
+
+    /// Adds a face, having the indexes of aFace
+    void push_back( const std::vector<int>& aFace )
+    {
+        m_Indexes.insert( m_Indexes.end(), aFace.begin(), aFace.end() );
+        m_FaceStart.push_back( m_Indexes.size() );
+    }
+
+    const int* operator[]( unsigned aFace ) const
+    {
+        return m_Indexes.empty() ? NULL : &m_Indexes[0] + m_FaceStart[aFace];
+    }
+
+    int* operator[]( unsigned aFace )
+    {
+        return m_Indexes.empty() ? NULL : &m_Indexes[0] + m_FaceStart[aFace];
+    }
+
+    unsigned FaceSize( unsigned aFace ) const
+    {
+        return m_FaceStart[aFace + 1] - m_FaceStart[aFace];
+    }
+
+    /// @return the position of the first index of aFace in Indexes()
+    unsigned FaceStart( unsigned aFace ) const { return m_FaceStart[aFace]; }
+
+    const std::vector<int>&         Indexes() const     { return m_Indexes; }
+    const std::vector<unsigned>&    FaceStarts() const  { return m_FaceStart; }
+
+    /**
+     * Function Set
+     * replaces the list by aIndexes and aFaceStart, as returned by Indexes() and
+     * FaceStarts().
+     * @return false, and leaves the list empty, if they are not consistent.
+     */
+    bool Set( const std::vector<int>& aIndexes, const std::vector<unsigned>& aFaceStart );
+
+private:
+    std::vector<int>        m_Indexes;      ///< the indexes of all faces
+    std::vector<unsigned>   m_FaceStart;    ///< first index of each face, and the
+                                            ///< index count as last item
+};
+
+
 class S3D_MESH
 {
 public:
@@ -61,13 +131,13 @@ public:
 
     // Point and index list
     std::vector< S3D_VERTEX >       m_Point;
-    std::vector< std::vector<int> > m_CoordIndex;
-    std::vector< std::vector<int> > m_NormalIndex;
+    S3D_INDEX_LIST                  m_CoordIndex;
+    S3D_INDEX_LIST                  m_NormalIndex;
     std::vector< S3D_VERTEX >       m_PerFaceColor;
     std::vector< S3D_VERTEX >       m_PerFaceNormalsNormalized;
     std::vector< S3D_VERTEX >       m_PerVertexNormalsNormalized;
     std::vector< int >              m_MaterialIndexPerFace;
-    std::vector< std::vector<int> > m_MaterialIndexPerVertex;
+    S3D_INDEX_LIST                  m_MaterialIndexPerVertex;
     S3D_MESH_PTRS                   childs;
 
     S3D_VERTEX  m_translation;
@@ -78,10 +148,13 @@ public:
 
 private:
     std::vector< S3D_VERTEX >                 m_PerFaceNormalsRaw_X_PerFaceSquaredArea;
-    std::vector< std::vector< S3D_VERTEX > >  m_PerFaceVertexNormals;
-    std::vector< S3D_VERTEX >                 m_PointNormalized;
 
-    std::vector< std::vector<int> >           m_InvalidCoordIndexes; //!TODO: check for invalid CoordIndex in file and remove the index and the same material index
+    /// the smoothed normal of each face vertex, at the position of the vertex in
+    /// m_CoordIndex.Indexes()
+    std::vector< S3D_VERTEX >                 m_PerFaceVertexNormals;
+
+    /// m_Point coordinates are divided by this value to calculate the face normals
+    float   m_PointNormalizeFactor;
 
     bool isPerFaceNormalsComputed;
     void calcPerFaceNormals ();
@@ -89,6 +162,14 @@ private:
     bool isPointNormalizedComputed;
     void calcPointNormalized();
 
+    /**
+     * Function calcWeldedPoints
+     * gives the same id to the points of m_Point having the same coordinates,
+     * so faces using different but identical points are smoothed together.
+     * @param aPointIds = the id of each point, the index of its first copy in m_Point
+     */
+    void calcWeldedPoints( std::vector<unsigned>& aPointIds ) const;
+
     bool isPerPointNormalsComputed;
     void calcPerPointNormals();
 
@@ -39,6 +39,7 @@
 #include <info3d_visu.h>
 #include "3d_struct.h"
 #include "modelparsers.h"
+#include "3d_mesh_cache.h"
 
 
 S3D_MODEL_PARSER *S3D_MODEL_PARSER::Create( S3D_MASTER* aMaster,
@@ -53,7 +54,7 @@ S3D_MODEL_PARSER *S3D_MODEL_PARSER::Create( S3D_MASTER* aMaster,
  }
 
 
-int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
+int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser, const S3D_MESH_CACHE* aCache )
 {
     if( m_Shape3DFullFilename.IsEmpty() || aParser == NULL )
         return -1;
@@ -68,9 +69,17 @@ int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
 
     if( wxFileName::FileExists( filename ) )
     {
-        wxFileName fn( filename );
+        bool loaded = aCache && aCache->Load( filename, aParser );
 
-        if( aParser->Load( filename ) )
+        if( !loaded && aParser->Load( filename ) )
+        {
+            loaded = true;
+
+            if( aCache )
+                aCache->Save( filename, aParser );
+        }
+
+        if( loaded )
         {
             // Invalidate bounding boxes
             m_fastAABBox.Reset();
@@ -41,6 +41,7 @@
 class S3D_MASTER;
 class STRUCT_3D_SHAPE;
 class S3D_MODEL_PARSER;
+class S3D_MESH_CACHE;
 
 // Master structure for a 3D footprint shape description
 class S3D_MASTER : public EDA_ITEM
@@ -92,8 +93,10 @@ public:
      * Select the parser to read the 3D data file (vrml, x3d ...)
      * and build the description objects list
      * @param aParser the parser that should be used to read model data and stored in
+     * @param aCache is an optional cache of the meshes already read from the file,
+     * used instead of parsing the file again when up to date, and updated otherwise
      */
-    int  ReadData( S3D_MODEL_PARSER* aParser );
+    int  ReadData( S3D_MODEL_PARSER* aParser, const S3D_MESH_CACHE* aCache = NULL );
 
     void Render( bool aIsRenderingJustNonTransparentObjects,
                  bool aIsRenderingJustTransparentObjects );
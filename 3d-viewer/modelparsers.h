@@ -77,10 +77,32 @@ public:
         return false;
     };
 
+    /**
+     * Function AddIncludedFile
+     * records a file which is read (or looked for) by Load(), in addition to the model
+     * file itself, e.g. the file of a VRML Inline node.
+     * Files which do not exist are also recorded: they are part of the model if they
+     * are created later.
+     */
+    void AddIncludedFile( const wxString& aFilename )
+    {
+        m_includedFiles.push_back( aFilename );
+    }
+
+    /**
+     * Function GetIncludedFiles
+     * @return the files recorded by AddIncludedFile() since the parser was created.
+     */
+    const std::vector<wxString>& GetIncludedFiles() const
+    {
+        return m_includedFiles;
+    }
+
     S3D_MESH_PTRS childs;
 
 private:
     S3D_MASTER* master;
+    std::vector<wxString> m_includedFiles;
 };
 
 
@@ -637,6 +637,10 @@ int VRML2_MODEL_PARSER::read_Inline()
 
                 bool fileExists = false;
 
+                // The mesh cache must know the inlined files (even the missing ones)
+                // to check that the cached meshes are up to date
+                m_ModelParser->AddIncludedFile( filename );
+
                 if( wxFileName::FileExists( filename ) )
                 {
                     fileExists = true;
@@ -651,6 +655,7 @@ int VRML2_MODEL_PARSER::read_Inline()
                         filename = m_Filename.GetPath() + '/' + filename;
                     #endif
 
+                    m_ModelParser->AddIncludedFile( filename );
 
                     if( wxFileName::FileExists( filename ) )
                     {
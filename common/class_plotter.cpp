@@ -93,6 +93,20 @@ bool PLOTTER::OpenFile( const wxString& aFullFilename )
 }
 
 
+bool PLOTTER::closeOutputFile()
+{
+    // Write errors are sticky: test them before fclose() flushes the last buffer
+    bool success = !ferror( outputFile );
+
+    if( fclose( outputFile ) != 0 )
+        success = false;
+
+    outputFile = NULL;
+
+    return success;
+}
+
+
 DPOINT PLOTTER::userToDeviceCoordinates( const wxPoint& aCoordinate )
 {
     wxPoint pos = aCoordinate - plotOffset;
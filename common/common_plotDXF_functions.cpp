@@ -265,10 +265,8 @@ bool DXF_PLOTTER::EndPlot()
            "ENDSEC\n"
            "  0\n"
            "EOF\n", outputFile );
-    fclose( outputFile );
-    outputFile = NULL;
 
-    return true;
+    return closeOutputFile();
 }
 
 
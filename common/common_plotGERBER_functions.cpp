@@ -40,10 +40,33 @@
 #include <build_version.h>
 
 
+/**
+ * Append to aBuffer the decimal representation of aValue.
+ * Coordinates are the bulk of a gerber file, so this is used instead of sprintf
+ */
+static void appendInt( std::string& aBuffer, int aValue )
+{
+    char  buf[16];
+    char* end = buf + sizeof( buf );
+    char* ptr = end;
+
+    unsigned int absval = aValue < 0 ? 0U - (unsigned int) aValue : (unsigned int) aValue;
+
+    do
+    {
+        *--ptr = '0' + absval % 10;
+        absval /= 10;
+    } while( absval );
+
+    if( aValue < 0 )
+        *--ptr = '-';
+
+    aBuffer.append( ptr, end - ptr );
+}
+
+
 GERBER_PLOTTER::GERBER_PLOTTER()
 {
-    workFile  = 0;
-    finalFile = 0;
     currentAperture = apertures.end();
 
     // number of digits after the point (number of digits of the mantissa
@@ -95,9 +118,18 @@ void GERBER_PLOTTER::SetGerberCoordinatesFormat( int aResolution, bool aUseInche
 
 void GERBER_PLOTTER::emitDcode( const DPOINT& pt, int dcode )
 {
-
-    fprintf( outputFile, "X%dY%dD%02d*\n",
-	    KiROUND( pt.x ), KiROUND( pt.y ), dcode );
+    // Same as "X%dY%dD%02d*\n"
+    m_body += 'X';
+    appendInt( m_body, KiROUND( pt.x ) );
+    m_body += 'Y';
+    appendInt( m_body, KiROUND( pt.y ) );
+    m_body += 'D';
+
+    if( dcode < 10 )
+        m_body += '0';
+
+    appendInt( m_body, dcode );
+    m_body += "*\n";
 }
 
 
@@ -105,17 +137,9 @@ bool GERBER_PLOTTER::StartPlot()
 {
     wxASSERT( outputFile );
 
-    finalFile = outputFile;     // the actual gerber file will be created later
-
-    // Create a temporary filename to store gerber file
-    // note tmpfile() does not work under Vista and W7 in user mode
-    m_workFilename = filename + wxT(".tmp");
-    workFile   = wxFopen( m_workFilename, wxT( "wt" ));
-    outputFile = workFile;
-    wxASSERT( outputFile );
-
-    if( outputFile == NULL )
-        return false;
+    // The header is written directly to the plot file; the body is built
+    // in m_body, and written after the aperture list by EndPlot()
+    m_body.clear();
 
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
@@ -159,38 +183,20 @@ bool GERBER_PLOTTER::StartPlot()
 
 bool GERBER_PLOTTER::EndPlot()
 {
-    char     line[1024];
-    wxString msg;
-
     wxASSERT( outputFile );
 
-    /* Outfile is actually a temporary file i.e. workFile */
-    fputs( "M02*\n", outputFile );
-    fflush( outputFile );
-
-    fclose( workFile );
-    workFile   = wxFopen( m_workFilename, wxT( "rt" ));
-    wxASSERT( workFile );
-    outputFile = finalFile;
-
-    // Placement of apertures in RS274X
-    while( fgets( line, 1024, workFile ) )
-    {
-        fputs( line, outputFile );
+    // Placement of apertures in RS274X: the header ends with
+    // "G04 APERTURE LIST*", so the aperture list is written now, then the body
+    writeApertureList();
+    fputs( "G04 APERTURE END LIST*\n", outputFile );
 
-        if( strcmp( strtok( line, "\n\r" ), "G04 APERTURE LIST*" ) == 0 )
-        {
-            writeApertureList();
-            fputs( "G04 APERTURE END LIST*\n", outputFile );
-        }
-    }
+    m_body += "M02*\n";
+    fwrite( m_body.data(), 1, m_body.size(), outputFile );
 
-    fclose( workFile );
-    fclose( finalFile );
-    ::wxRemoveFile( m_workFilename );
-    outputFile = 0;
+    // Release the body memory
+    std::string().swap( m_body );
 
-    return true;
+    return closeOutputFile();
 }
 
 
@@ -254,7 +260,9 @@ void GERBER_PLOTTER::selectAperture( const wxSize&           size,
     {
         // Pick an existing aperture or create a new one
         currentAperture = getAperture( size, type );
-        fprintf( outputFile, "D%d*\n", currentAperture->DCode );
+        m_body += 'D';
+        appendInt( m_body, currentAperture->DCode );
+        m_body += "*\n";
     }
 }
 
@@ -372,17 +380,23 @@ void GERBER_PLOTTER::Arc( const wxPoint& aCenter, double aStAngle, double aEndAn
     DPOINT devEnd = userToDeviceCoordinates( end );
     DPOINT devCenter = userToDeviceCoordinates( aCenter ) - userToDeviceCoordinates( start );
 
-    fprintf( outputFile, "G75*\n" ); // Multiquadrant mode
+    m_body += "G75*\n"; // Multiquadrant mode
 
     if( aStAngle < aEndAngle )
-        fprintf( outputFile, "G03" );
+        m_body += "G03";
     else
-        fprintf( outputFile, "G02" );
-
-    fprintf( outputFile, "X%dY%dI%dJ%dD01*\n",
-             KiROUND( devEnd.x ), KiROUND( devEnd.y ),
-             KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
-    fprintf( outputFile, "G01*\n" ); // Back to linear interp.
+        m_body += "G02";
+
+    m_body += 'X';
+    appendInt( m_body, KiROUND( devEnd.x ) );
+    m_body += 'Y';
+    appendInt( m_body, KiROUND( devEnd.y ) );
+    m_body += 'I';
+    appendInt( m_body, KiROUND( devCenter.x ) );
+    m_body += 'J';
+    appendInt( m_body, KiROUND( devCenter.y ) );
+    m_body += "D01*\n";
+    m_body += "G01*\n"; // Back to linear interp.
 }
 
 
@@ -400,7 +414,7 @@ void GERBER_PLOTTER:: PlotPoly( const std::vector< wxPoint >& aCornerList,
 
     if( aFill )
     {
-        fputs( "G36*\n", outputFile );
+        m_body += "G36*\n";
 
         MoveTo( aCornerList[0] );
 
@@ -408,7 +422,7 @@ void GERBER_PLOTTER:: PlotPoly( const std::vector< wxPoint >& aCornerList,
             LineTo( aCornerList[ii] );
 
         FinishTo( aCornerList[0] );
-        fputs( "G37*\n", outputFile );
+        m_body += "G37*\n";
     }
 
     if( aWidth > 0 )
@@ -589,7 +603,7 @@ void GERBER_PLOTTER::FlashPadTrapez( const wxPoint& aPadPos,  const wxPoint* aCo
 void GERBER_PLOTTER::SetLayerPolarity( bool aPositive )
 {
     if( aPositive )
-        fprintf( outputFile, "%%LPD*%%\n" );
+        m_body += "%LPD*%\n";
     else
-        fprintf( outputFile, "%%LPC*%%\n" );
+        m_body += "%LPC*%\n";
 }
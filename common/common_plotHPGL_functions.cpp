@@ -246,9 +246,7 @@ bool HPGL_PLOTTER::EndPlot()
 {
     wxASSERT( outputFile );
     fputs( "PU;PA;SP0;\n", outputFile );
-    fclose( outputFile );
-    outputFile = NULL;
-    return true;
+    return closeOutputFile();
 }
 
 
@@ -37,7 +37,90 @@
 #include <macros.h>
 #include <kicad_string.h>
 #include <wx/zstream.h>
-#include <wx/mstream.h>
+
+
+/// Size of the content stream data accumulated before being deflated
+static const size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+
+/**
+ * A wxOutputStream writing to the PDF file: page content streams are
+ * deflated straight into the PDF file, without temporary file
+ */
+class PDF_FILE_OUTPUT_STREAM : public wxOutputStream
+{
+public:
+    PDF_FILE_OUTPUT_STREAM( FILE* aFile ) : m_file( aFile ) {}
+
+protected:
+    virtual size_t OnSysWrite( const void* aBuffer, size_t aSize )
+    {
+        size_t written = fwrite( aBuffer, 1, aSize, m_file );
+
+        if( written != aSize )
+            m_lasterror = wxSTREAM_WRITE_ERROR;
+
+        return written;
+    }
+
+private:
+    FILE* m_file;
+};
+
+
+/**
+ * Append a number to a content stream, as a fixed point value with at most
+ * 4 decimals (trailing zeros removed). Much faster than the %g format
+ * used elsewhere, it is used for the (possibly huge) polygons of zone fills.
+ */
+static void appendNumber( std::string& aBuffer, double aValue )
+{
+    // Should not happen for coordinates, but keep the output valid
+    if( aValue > 1e12 || aValue < -1e12 )
+    {
+        char buf[64];
+        sprintf( buf, "%f", aValue );
+        aBuffer += buf;
+        return;
+    }
+
+    double   rounded = aValue * 10000.0;
+    long long scaled = (long long) ( rounded < 0 ? rounded - 0.5 : rounded + 0.5 );
+
+    if( scaled < 0 )
+    {
+        aBuffer += '-';
+        scaled = -scaled;
+    }
+
+    long long intpart = scaled / 10000;
+    int       decimals = (int) ( scaled % 10000 );
+
+    char  buf[32];
+    char* end = buf + sizeof( buf );
+    char* ptr = end;
+
+    do
+    {
+        *--ptr = '0' + (int) ( intpart % 10 );
+        intpart /= 10;
+    } while( intpart );
+
+    aBuffer.append( ptr, end - ptr );
+
+    if( decimals )
+    {
+        char frac[5] = { char( '0' + decimals / 1000 ), char( '0' + decimals / 100 % 10 ),
+                         char( '0' + decimals / 10 % 10 ), char( '0' + decimals % 10 ), 0 };
+        int  len = 4;
+
+        while( frac[len - 1] == '0' )
+            len--;
+
+        aBuffer += '.';
+        aBuffer.append( frac, len );
+    }
+}
 
 
 /*
@@ -63,14 +146,14 @@ bool PDF_PLOTTER::OpenFile( const wxString& aFullFilename )
 
 void PDF_PLOTTER::SetPageSettings( const PAGE_INFO& aPageSettings )
 {
-    wxASSERT( !workFile );
+    wxASSERT( !m_zlibStream );
     pageInfo = aPageSettings;
 }
 
 void PDF_PLOTTER::SetViewport( const wxPoint& aOffset, double aIusPerDecimil,
                               double aScale, bool aMirror )
 {
-    wxASSERT( !workFile );
+    wxASSERT( !m_zlibStream );
     m_plotMirror = aMirror;
     plotOffset = aOffset;
     plotScale = aScale;
@@ -96,7 +179,7 @@ void PDF_PLOTTER::SetViewport( const wxPoint& aOffset, double aIusPerDecimil,
  */
 void PDF_PLOTTER::SetCurrentLineWidth( int width )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     int pen_width;
 
     if( width > 0 )
@@ -107,8 +190,7 @@ void PDF_PLOTTER::SetCurrentLineWidth( int width )
         pen_width = defaultPenWidth;
 
     if( pen_width != currentPenWidth )
-        fprintf( workFile, "%g w\n",
-                 userToDeviceSize( pen_width ) );
+        streamPrintf( "%g w\n", userToDeviceSize( pen_width ) );
 
     currentPenWidth = pen_width;
 }
@@ -125,9 +207,9 @@ void PDF_PLOTTER::SetCurrentLineWidth( int width )
  */
 void PDF_PLOTTER::emitSetRGBColor( double r, double g, double b )
 {
-    wxASSERT( workFile );
-    fprintf( workFile, "%g %g %g rg %g %g %g RG\n",
-             r, g, b, r, g, b );
+    wxASSERT( m_zlibStream );
+    streamPrintf( "%g %g %g rg %g %g %g RG\n",
+                  r, g, b, r, g, b );
 }
 
 /**
@@ -135,12 +217,12 @@ void PDF_PLOTTER::emitSetRGBColor( double r, double g, double b )
  */
 void PDF_PLOTTER::SetDash( bool dashed )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     if( dashed )
-        fprintf( workFile, "[%d %d] 0 d\n",
-                 (int) GetDashMarkLenIU(), (int) GetDashGapLenIU() );
+        streamPrintf( "[%d %d] 0 d\n",
+                      (int) GetDashMarkLenIU(), (int) GetDashGapLenIU() );
     else
-        fputs( "[] 0 d\n", workFile );
+        streamPuts( "[] 0 d\n" );
 }
 
 
@@ -149,14 +231,14 @@ void PDF_PLOTTER::SetDash( bool dashed )
  */
 void PDF_PLOTTER::Rect( const wxPoint& p1, const wxPoint& p2, FILL_T fill, int width )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     DPOINT p1_dev = userToDeviceCoordinates( p1 );
     DPOINT p2_dev = userToDeviceCoordinates( p2 );
 
     SetCurrentLineWidth( width );
-    fprintf( workFile, "%g %g %g %g re %c\n", p1_dev.x, p1_dev.y,
-             p2_dev.x - p1_dev.x, p2_dev.y - p1_dev.y,
-             fill == NO_FILL ? 'S' : 'B' );
+    streamPrintf( "%g %g %g %g re %c\n", p1_dev.x, p1_dev.y,
+                  p2_dev.x - p1_dev.x, p2_dev.y - p1_dev.y,
+                  fill == NO_FILL ? 'S' : 'B' );
 }
 
 
@@ -165,7 +247,7 @@ void PDF_PLOTTER::Rect( const wxPoint& p1, const wxPoint& p2, FILL_T fill, int w
  */
 void PDF_PLOTTER::Circle( const wxPoint& pos, int diametre, FILL_T aFill, int width )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     DPOINT pos_dev = userToDeviceCoordinates( pos );
     double radius = userToDeviceSize( diametre / 2.0 );
 
@@ -179,30 +261,30 @@ void PDF_PLOTTER::Circle( const wxPoint& pos, int diametre, FILL_T aFill, int wi
     double magic = radius * 0.551784; // You don't want to know where this come from
 
     // This is the convex hull for the bezier approximated circle
-    fprintf( workFile, "%g %g m "
-                       "%g %g %g %g %g %g c "
-                       "%g %g %g %g %g %g c "
-                       "%g %g %g %g %g %g c "
-                       "%g %g %g %g %g %g c %c\n",
-             pos_dev.x - radius, pos_dev.y,
-
-             pos_dev.x - radius, pos_dev.y + magic,
-             pos_dev.x - magic, pos_dev.y + radius,
-             pos_dev.x, pos_dev.y + radius,
-
-             pos_dev.x + magic, pos_dev.y + radius,
-             pos_dev.x + radius, pos_dev.y + magic,
-             pos_dev.x + radius, pos_dev.y,
-
-             pos_dev.x + radius, pos_dev.y - magic,
-             pos_dev.x + magic, pos_dev.y - radius,
-             pos_dev.x, pos_dev.y - radius,
-
-             pos_dev.x - magic, pos_dev.y - radius,
-             pos_dev.x - radius, pos_dev.y - magic,
-             pos_dev.x - radius, pos_dev.y,
-
-             aFill == NO_FILL ? 's' : 'b' );
+    streamPrintf( "%g %g m "
+                  "%g %g %g %g %g %g c "
+                  "%g %g %g %g %g %g c "
+                  "%g %g %g %g %g %g c "
+                  "%g %g %g %g %g %g c %c\n",
+                  pos_dev.x - radius, pos_dev.y,
+
+                  pos_dev.x - radius, pos_dev.y + magic,
+                  pos_dev.x - magic, pos_dev.y + radius,
+                  pos_dev.x, pos_dev.y + radius,
+
+                  pos_dev.x + magic, pos_dev.y + radius,
+                  pos_dev.x + radius, pos_dev.y + magic,
+                  pos_dev.x + radius, pos_dev.y,
+
+                  pos_dev.x + radius, pos_dev.y - magic,
+                  pos_dev.x + magic, pos_dev.y - radius,
+                  pos_dev.x, pos_dev.y - radius,
+
+                  pos_dev.x - magic, pos_dev.y - radius,
+                  pos_dev.x - radius, pos_dev.y - magic,
+                  pos_dev.x - radius, pos_dev.y,
+
+                  aFill == NO_FILL ? 's' : 'b' );
 }
 
 
@@ -213,7 +295,7 @@ void PDF_PLOTTER::Circle( const wxPoint& pos, int diametre, FILL_T aFill, int wi
 void PDF_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle, int radius,
                       FILL_T fill, int width )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     if( radius <= 0 )
         return;
 
@@ -231,30 +313,30 @@ void PDF_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle, i
     start.x = centre.x + KiROUND( cosdecideg( radius, -StAngle ) );
     start.y = centre.y + KiROUND( sindecideg( radius, -StAngle ) );
     DPOINT pos_dev = userToDeviceCoordinates( start );
-    fprintf( workFile, "%g %g m ", pos_dev.x, pos_dev.y );
+    streamPoint( pos_dev, 'm', ' ' );
     for( int ii = StAngle + delta; ii < EndAngle; ii += delta )
     {
         end.x = centre.x + KiROUND( cosdecideg( radius, -ii ) );
         end.y = centre.y + KiROUND( sindecideg( radius, -ii ) );
         pos_dev = userToDeviceCoordinates( end );
-        fprintf( workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+        streamPoint( pos_dev, 'l', ' ' );
     }
 
     end.x = centre.x + KiROUND( cosdecideg( radius, -EndAngle ) );
     end.y = centre.y + KiROUND( sindecideg( radius, -EndAngle ) );
     pos_dev = userToDeviceCoordinates( end );
-    fprintf( workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+    streamPoint( pos_dev, 'l', ' ' );
 
     // The arc is drawn... if not filled we stroke it, otherwise we finish
     // closing the pie at the center
     if( fill == NO_FILL )
     {
-        fputs( "S\n", workFile );
+        streamPuts( "S\n" );
     }
     else
     {
         pos_dev = userToDeviceCoordinates( centre );
-        fprintf( workFile, "%g %g l b\n", pos_dev.x, pos_dev.y );
+        streamPrintf( "%g %g l b\n", pos_dev.x, pos_dev.y );
     }
 }
 
@@ -265,34 +347,35 @@ void PDF_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle, i
 void PDF_PLOTTER::PlotPoly( const std::vector< wxPoint >& aCornerList,
                            FILL_T aFill, int aWidth )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     if( aCornerList.size() <= 1 )
         return;
 
     SetCurrentLineWidth( aWidth );
 
     DPOINT pos = userToDeviceCoordinates( aCornerList[0] );
-    fprintf( workFile, "%g %g m\n", pos.x, pos.y );
+    streamPoint( pos, 'm' );
 
+    // Zone fills can have a lot of corners: use the fast path writer
     for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
     {
         pos = userToDeviceCoordinates( aCornerList[ii] );
-        fprintf( workFile, "%g %g l\n", pos.x, pos.y );
+        streamPoint( pos, 'l' );
     }
 
     // Close path and stroke(/fill)
-    fprintf( workFile, "%c\n", aFill == NO_FILL ? 'S' : 'b' );
+    streamPuts( aFill == NO_FILL ? "S\n" : "b\n" );
 }
 
 
 void PDF_PLOTTER::PenTo( const wxPoint& pos, char plume )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     if( plume == 'Z' )
     {
         if( penState != 'Z' )
         {
-            fputs( "S\n", workFile );
+            streamPuts( "S\n" );
             penState     = 'Z';
             penLastpos.x = -1;
             penLastpos.y = -1;
@@ -303,9 +386,7 @@ void PDF_PLOTTER::PenTo( const wxPoint& pos, char plume )
     if( penState != plume || pos != penLastpos )
     {
         DPOINT pos_dev = userToDeviceCoordinates( pos );
-        fprintf( workFile, "%g %g %c\n",
-                 pos_dev.x, pos_dev.y,
-                 ( plume=='D' ) ? 'l' : 'm' );
+        streamPoint( pos_dev, ( plume=='D' ) ? 'l' : 'm' );
     }
     penState   = plume;
     penLastpos = pos;
@@ -317,7 +398,7 @@ void PDF_PLOTTER::PenTo( const wxPoint& pos, char plume )
 void PDF_PLOTTER::PlotImage( const wxImage & aImage, const wxPoint& aPos,
                             double aScaleFactor )
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
     wxSize pix_size( aImage.GetWidth(), aImage.GetHeight() );
 
     // Requested size (in IUs)
@@ -340,22 +421,21 @@ void PDF_PLOTTER::PlotImage( const wxImage & aImage, const wxPoint& aPos,
        3) restore the CTM
        4) profit
      */
-    fprintf( workFile, "q %g 0 0 %g %g %g cm\n", // Step 1
-            userToDeviceSize( drawsize.x ),
-            userToDeviceSize( drawsize.y ),
-            dev_start.x, dev_start.y );
+    streamPrintf( "q %g 0 0 %g %g %g cm\n", // Step 1
+                  userToDeviceSize( drawsize.x ),
+                  userToDeviceSize( drawsize.y ),
+                  dev_start.x, dev_start.y );
 
     /* An inline image is a cross between a dictionary and a stream.
        A real ugly construct (compared with the elegance of the PDF
        format). Also it accepts some 'abbreviations', which is stupid
        since the content stream is usually compressed anyway... */
-    fprintf( workFile,
-             "BI\n"
-             "  /BPC 8\n"
-             "  /CS %s\n"
-             "  /W %d\n"
-             "  /H %d\n"
-             "ID\n", colorMode ? "/RGB" : "/G", pix_size.x, pix_size.y );
+    streamPrintf( "BI\n"
+                  "  /BPC 8\n"
+                  "  /CS %s\n"
+                  "  /W %d\n"
+                  "  /H %d\n"
+                  "ID\n", colorMode ? "/RGB" : "/G", pix_size.x, pix_size.y );
 
     /* Here comes the stream (in binary!). I *could* have hex or ascii84
        encoded it, but who cares? I'll go through zlib anyway */
@@ -366,22 +446,24 @@ void PDF_PLOTTER::PlotImage( const wxImage & aImage, const wxPoint& aPos,
             unsigned char r = aImage.GetRed( x, y ) & 0xFF;
             unsigned char g = aImage.GetGreen( x, y ) & 0xFF;
             unsigned char b = aImage.GetBlue( x, y ) & 0xFF;
-            // As usual these days, stdio buffering has to suffeeeeerrrr
             if( colorMode )
             {
-            putc( r, workFile );
-            putc( g, workFile );
-            putc( b, workFile );
+                m_streamBuffer += (char) r;
+                m_streamBuffer += (char) g;
+                m_streamBuffer += (char) b;
             }
             else
             {
                 // Grayscale conversion
-                putc( (r + g + b) / 3, workFile );
+                m_streamBuffer += (char) ( (r + g + b) / 3 );
             }
         }
+
+        if( m_streamBuffer.size() >= STREAM_CHUNK_SIZE )
+            flushStream();
     }
 
-    fputs( "EI Q\n", workFile ); // Finish step 2 and do step 3
+    streamPuts( "EI Q\n" ); // Finish step 2 and do step 3
 }
 
 
@@ -404,7 +486,7 @@ int PDF_PLOTTER::allocPdfObject()
 int PDF_PLOTTER::startPdfObject(int handle)
 {
     wxASSERT( outputFile );
-    wxASSERT( !workFile );
+    wxASSERT( !m_zlibStream );
     if( handle < 0)
         handle = allocPdfObject();
 
@@ -420,7 +502,7 @@ int PDF_PLOTTER::startPdfObject(int handle)
 void PDF_PLOTTER::closePdfObject()
 {
     wxASSERT( outputFile );
-    wxASSERT( !workFile );
+    wxASSERT( !m_zlibStream );
     fputs( "endobj\n", outputFile );
 }
 
@@ -434,7 +516,7 @@ void PDF_PLOTTER::closePdfObject()
 int PDF_PLOTTER::startPdfStream(int handle)
 {
     wxASSERT( outputFile );
-    wxASSERT( !workFile );
+    wxASSERT( !m_zlibStream );
     handle = startPdfObject( handle );
 
     // This is guaranteed to be handle+1 but needs to be allocated since
@@ -444,10 +526,20 @@ int PDF_PLOTTER::startPdfStream(int handle)
              "<< /Length %d 0 R /Filter /FlateDecode >>\n" // Length is deferred
              "stream\n", handle + 1 );
 
-    // Open a temporary file to accumulate the stream
-    workFilename = filename + wxT(".tmp");
-    workFile = wxFopen( workFilename, wxT( "w+b" ));
-    wxASSERT( workFile );
+    /* The stream is deflated on the fly, straight into the PDF file.
+     * Somewhat standard parameters to compress in DEFLATE. The PDF spec is
+     * misleading, it says it wants a DEFLATE stream but it really want a ZLIB
+     * stream! (a DEFLATE stream would be generated with -15 instead of 15)
+     * The default compression level is used: the best compression level is
+     * much slower, for a few percent smaller streams
+     */
+    fflush( outputFile );
+    m_streamStart = ftell( outputFile );
+    m_fileStream  = new PDF_FILE_OUTPUT_STREAM( outputFile );
+    m_zlibStream  = new wxZlibOutputStream( *m_fileStream, wxZ_DEFAULT_COMPRESSION,
+                                            wxZLIB_ZLIB );
+    m_streamBuffer.clear();
+
     return handle;
 }
 
@@ -457,61 +549,100 @@ int PDF_PLOTTER::startPdfStream(int handle)
  */
 void PDF_PLOTTER::closePdfStream()
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
 
-    long stream_len = ftell( workFile );
+    flushStream();
 
-    if( stream_len < 0 )
-    {
-        wxASSERT( false );
+    // Flush the zip stream and release the memory
+    m_zlibStream->Close();
+    delete m_zlibStream;
+    m_zlibStream = NULL;
+    delete m_fileStream;
+    m_fileStream = NULL;
+    std::string().swap( m_streamBuffer );
+
+    long out_count = ftell( outputFile ) - m_streamStart;
+
+    fputs( "endstream\n", outputFile );
+    closePdfObject();
+
+    // Writing the deferred length as an indirect object
+    startPdfObject( streamLengthHandle );
+    fprintf( outputFile, "%ld\n", out_count );
+    closePdfObject();
+}
+
+
+void PDF_PLOTTER::flushStream()
+{
+    wxASSERT( m_zlibStream );
+
+    if( m_streamBuffer.empty() )
         return;
-    }
 
-    // Rewind the file, read in the page stream and DEFLATE it
-    fseek( workFile, 0, SEEK_SET );
-    unsigned char *inbuf = new unsigned char[stream_len];
+    m_zlibStream->Write( m_streamBuffer.data(), m_streamBuffer.size() );
+    m_streamBuffer.clear();
+}
+
+
+void PDF_PLOTTER::streamPrintf( const char* aFormat, ... )
+{
+    wxASSERT( m_zlibStream );
 
-    int rc = fread( inbuf, 1, stream_len, workFile );
-    wxASSERT( rc == stream_len );
-    (void) rc;
+    char    buf[1024];
+    va_list args;
 
-    // We are done with the temporary file, junk it
-    fclose( workFile );
-    workFile = 0;
-    ::wxRemoveFile( workFilename );
+    va_start( args, aFormat );
+    int len = vsnprintf( buf, sizeof( buf ), aFormat, args );
+    va_end( args );
 
-    // NULL means memos owns the memory, but provide a hint on optimum size needed.
-    wxMemoryOutputStream    memos( NULL, std::max( 2000l, stream_len ) ) ;
+    if( len < 0 )
+        return;
 
+    if( len < (int) sizeof( buf ) )
+    {
+        m_streamBuffer.append( buf, len );
+    }
+    else
     {
-        /* Somewhat standard parameters to compress in DEFLATE. The PDF spec is
-         * misleading, it says it wants a DEFLATE stream but it really want a ZLIB
-         * stream! (a DEFLATE stream would be generated with -15 instead of 15)
-         * rc = deflateInit2( &zstrm, Z_BEST_COMPRESSION, Z_DEFLATED, 15,
-         *                    8, Z_DEFAULT_STRATEGY );
-         */
+        std::vector<char> bigbuf( len + 1 );
 
-        wxZlibOutputStream      zos( memos, wxZ_BEST_COMPRESSION, wxZLIB_ZLIB );
+        va_start( args, aFormat );
+        vsnprintf( &bigbuf[0], bigbuf.size(), aFormat, args );
+        va_end( args );
 
-        zos.Write( inbuf, stream_len );
+        m_streamBuffer.append( &bigbuf[0], len );
+    }
 
-        delete[] inbuf;
+    if( m_streamBuffer.size() >= STREAM_CHUNK_SIZE )
+        flushStream();
+}
 
-    }   // flush the zip stream using zos destructor
 
-    wxStreamBuffer* sb = memos.GetOutputStreamBuffer();
+void PDF_PLOTTER::streamPuts( const char* aText )
+{
+    wxASSERT( m_zlibStream );
 
-    unsigned out_count = sb->Tell();
+    m_streamBuffer += aText;
 
-    fwrite( sb->GetBufferStart(), 1, out_count, outputFile );
+    if( m_streamBuffer.size() >= STREAM_CHUNK_SIZE )
+        flushStream();
+}
 
-    fputs( "endstream\n", outputFile );
-    closePdfObject();
 
-    // Writing the deferred length as an indirect object
-    startPdfObject( streamLengthHandle );
-    fprintf( outputFile, "%u\n", out_count );
-    closePdfObject();
+void PDF_PLOTTER::streamPoint( const DPOINT& aPos, char aOperator, char aSeparator )
+{
+    wxASSERT( m_zlibStream );
+
+    appendNumber( m_streamBuffer, aPos.x );
+    m_streamBuffer += ' ';
+    appendNumber( m_streamBuffer, aPos.y );
+    m_streamBuffer += ' ';
+    m_streamBuffer += aOperator;
+    m_streamBuffer += aSeparator;
+
+    if( m_streamBuffer.size() >= STREAM_CHUNK_SIZE )
+        flushStream();
 }
 
 /**
@@ -520,7 +651,7 @@ void PDF_PLOTTER::closePdfStream()
 void PDF_PLOTTER::StartPage()
 {
     wxASSERT( outputFile );
-    wxASSERT( !workFile );
+    wxASSERT( !m_zlibStream );
 
     // Compute the paper size in IUs
     paperSize = pageInfo.GetSizeMils();
@@ -530,14 +661,13 @@ void PDF_PLOTTER::StartPage()
     // Open the content stream; the page object will go later
     pageStreamHandle = startPdfStream();
 
-    /* Now, until ClosePage *everything* must be wrote in workFile, to be
-       compressed later in closePdfStream */
+    /* Now, until ClosePage *everything* must be wrote in the content stream
+       (see streamPrintf), which is compressed on the fly */
 
     // Default graphic settings (coordinate system, default color and line style)
-    fprintf( workFile,
-             "%g 0 0 %g 0 0 cm 1 J 1 j 0 0 0 rg 0 0 0 RG %g w\n",
-             0.0072 * plotScaleAdjX, 0.0072 * plotScaleAdjY,
-             userToDeviceSize( defaultPenWidth ) );
+    streamPrintf( "%g 0 0 %g 0 0 cm 1 J 1 j 0 0 0 rg 0 0 0 RG %g w\n",
+                  0.0072 * plotScaleAdjX, 0.0072 * plotScaleAdjY,
+                  userToDeviceSize( defaultPenWidth ) );
 }
 
 /**
@@ -545,7 +675,7 @@ void PDF_PLOTTER::StartPage()
  */
 void PDF_PLOTTER::ClosePage()
 {
-    wxASSERT( workFile );
+    wxASSERT( m_zlibStream );
 
     // Close the page stream (and compress it)
     closePdfStream();
@@ -740,10 +870,7 @@ bool PDF_PLOTTER::EndPlot()
              "%%%%EOF\n",
              (unsigned long) xrefTable.size(), catalogHandle, infoDictHandle, xref_start );
 
-    fclose( outputFile );
-    outputFile = NULL;
-
-    return true;
+    return closeOutputFile();
 }
 
 void PDF_PLOTTER::Text( const wxPoint&              aPos,
@@ -788,15 +915,16 @@ void PDF_PLOTTER::Text( const wxPoint&              aPos,
            for the trig part of the matrix to avoid %g going in exponential
            format (which is not supported)
            Rendermode 0 shows the text, rendermode 3 is invisible */
-        fprintf( workFile, "q %f %f %f %f %g %g cm BT %s %g Tf %d Tr %g Tz ",
-                ctm_a, ctm_b, ctm_c, ctm_d, ctm_e, ctm_f,
-                fontname, heightFactor,
-                (m_textMode == PLOTTEXTMODE_NATIVE) ? 0 : 3,
-                wideningFactor * 100 );
+        streamPrintf( "q %f %f %f %f %g %g cm BT %s %g Tf %d Tr %g Tz ",
+                      ctm_a, ctm_b, ctm_c, ctm_d, ctm_e, ctm_f,
+                      fontname, heightFactor,
+                      (m_textMode == PLOTTEXTMODE_NATIVE) ? 0 : 3,
+                      wideningFactor * 100 );
 
         // The text must be escaped correctly
-        fputsPostscriptString( workFile, aText );
-        fputs( " Tj ET\n", workFile );
+        std::string encoded = encodePostscriptString( aText );
+        m_streamBuffer.append( encoded );
+        streamPuts( " Tj ET\n" );
 
         /* We are still in text coordinates, plot the overbars (if we're
          * not doing phantom text) */
@@ -813,13 +941,13 @@ void PDF_PLOTTER::Text( const wxPoint&              aPos,
                    is the right function to use here... */
                 DPOINT dev_from = userToDeviceSize( wxSize( pos_pairs[i], overbar_y ) );
                 DPOINT dev_to = userToDeviceSize( wxSize( pos_pairs[i + 1], overbar_y ) );
-                fprintf( workFile, "%g %g m %g %g l ",
-                        dev_from.x, dev_from.y, dev_to.x, dev_to.y );
+                streamPrintf( "%g %g m %g %g l ",
+                              dev_from.x, dev_from.y, dev_to.x, dev_to.y );
             }
         }
 
         // Stroke and restore the CTM
-        fputs( "S Q\n", workFile );
+        streamPuts( "S Q\n" );
     }
 
     // Plot the stroked text (if requested)
@@ -142,9 +142,8 @@ void PSLIKE_PLOTTER::FlashPadCircle( const wxPoint& aPadPos, int aDiameter,
 void PSLIKE_PLOTTER::FlashPadRect( const wxPoint& aPadPos, const wxSize& aSize,
                                    double aPadOrient, EDA_DRAW_MODE_T aTraceMode )
 {
-    static std::vector< wxPoint > cornerList;
+    std::vector< wxPoint > cornerList;
     wxSize size( aSize );
-    cornerList.clear();
 
     if( aTraceMode == FILLED )
         SetCurrentLineWidth( 0 );
@@ -192,8 +191,7 @@ void PSLIKE_PLOTTER::FlashPadRect( const wxPoint& aPadPos, const wxSize& aSize,
 void PSLIKE_PLOTTER::FlashPadTrapez( const wxPoint& aPadPos, const wxPoint *aCorners,
                                      double aPadOrient, EDA_DRAW_MODE_T aTraceMode )
 {
-    static std::vector< wxPoint > cornerList;
-    cornerList.clear();
+    std::vector< wxPoint > cornerList;
 
     for( int ii = 0; ii < 4; ii++ )
         cornerList.push_back( aCorners[ii] );
@@ -240,10 +238,19 @@ void PSLIKE_PLOTTER::FlashPadTrapez( const wxPoint& aPadPos, const wxPoint *aCor
  */
 void PSLIKE_PLOTTER::fputsPostscriptString(FILE *fout, const wxString& txt)
 {
-    putc( '(', fout );
+    std::string encoded = encodePostscriptString( txt );
+
+    fwrite( encoded.data(), 1, encoded.size(), fout );
+}
+
+
+std::string PSLIKE_PLOTTER::encodePostscriptString( const wxString& txt )
+{
+    std::string encoded;
+
+    encoded += '(';
     for( unsigned i = 0; i < txt.length(); i++ )
     {
-        // Lazyness made me use stdio buffering yet another time...
         wchar_t ch = txt[i];
 
         if( ch < 256 )
@@ -257,17 +264,19 @@ void PSLIKE_PLOTTER::fputsPostscriptString(FILE *fout, const wxString& txt)
             case '(':
             case ')':
             case '\\':
-                putc( '\\', fout );
+                encoded += '\\';
 
                 // FALLTHRU
             default:
-                putc( ch, fout );
+                encoded += (char) ch;
                 break;
             }
         }
     }
 
-    putc( ')', fout );
+    encoded += ')';
+
+    return encoded;
 }
 
 
@@ -847,10 +856,8 @@ bool PS_PLOTTER::EndPlot()
     fputs( "showpage\n"
            "grestore\n"
            "%%EOF\n", outputFile );
-    fclose( outputFile );
-    outputFile = NULL;
 
-    return true;
+    return closeOutputFile();
 }
 
 
@@ -594,10 +594,8 @@ bool SVG_PLOTTER::StartPlot()
 bool SVG_PLOTTER::EndPlot()
 {
     fputs( "</g> \n</svg>\n", outputFile );
-    fclose( outputFile );
-    outputFile = NULL;
 
-    return true;
+    return closeOutputFile();
 }
 
 
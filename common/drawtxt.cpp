@@ -205,7 +205,9 @@ static void DrawGraphicTextPline( EDA_RECT* aClipBox,
                                   bool aSketchMode,
                                   int point_count,
                                   wxPoint* coord,
-                                  void (* aCallback)( int x0, int y0, int xf, int yf ),
+                                  void (* aCallback)( int x0, int y0, int xf, int yf,
+                                                      void* aData ),
+                                  void* aCallbackData,
                                   PLOTTER* aPlotter )
 {
     if( aPlotter )
@@ -224,7 +226,7 @@ static void DrawGraphicTextPline( EDA_RECT* aClipBox,
         for( int ik = 0; ik < (point_count - 1); ik++ )
         {
             aCallback( coord[ik].x, coord[ik].y,
-                       coord[ik + 1].x, coord[ik + 1].y );
+                       coord[ik + 1].x, coord[ik + 1].y, aCallbackData );
         }
     }
     else if( aDC )
@@ -263,6 +265,7 @@ static void DrawGraphicTextPline( EDA_RECT* aClipBox,
  *                  used to draw 3D texts or for plotting, NULL for normal drawings
  *  @param aPlotter = a pointer to a PLOTTER instance, when this function is used to plot
  *                  the text. NULL to draw this text.
+ *  @param aCallbackData = the last parameter given to aCallback
  */
 void DrawGraphicText( EDA_RECT* aClipBox,
                       wxDC* aDC,
@@ -276,8 +279,9 @@ void DrawGraphicText( EDA_RECT* aClipBox,
                       int aWidth,
                       bool aItalic,
                       bool aBold,
-                      void (* aCallback)( int x0, int y0, int xf, int yf ),
-                      PLOTTER* aPlotter )
+                      void (* aCallback)( int x0, int y0, int xf, int yf, void* aData ),
+                      PLOTTER* aPlotter,
+                      void* aCallbackData )
 {
     int         AsciiCode;
     int         x0, y0;
@@ -404,7 +408,7 @@ void DrawGraphicText( EDA_RECT* aClipBox,
         }
         else if( aCallback )
         {
-            aCallback( current_char_pos.x, current_char_pos.y, end.x, end.y );
+            aCallback( current_char_pos.x, current_char_pos.y, end.x, end.y, aCallbackData );
         }
         else
             GRLine( aClipBox, aDC,
@@ -462,7 +466,8 @@ void DrawGraphicText( EDA_RECT* aClipBox,
                     coord[1] = overbar_pos;
                     // Plot the overbar segment
                     DrawGraphicTextPline( aClipBox, aDC, aColor, aWidth,
-                                          sketch_mode, 2, coord, aCallback, aPlotter );
+                                          sketch_mode, 2, coord, aCallback, aCallbackData,
+                              aPlotter );
                 }
 
                 continue;    // Skip ~ processing
@@ -510,7 +515,7 @@ void DrawGraphicText( EDA_RECT* aClipBox,
 
                     DrawGraphicTextPline( aClipBox, aDC, aColor, aWidth,
                                           sketch_mode, point_count, coord,
-                                          aCallback, aPlotter );
+                                          aCallback, aCallbackData, aPlotter );
                 }
 
                 point_count = 0;
@@ -555,7 +560,8 @@ void DrawGraphicText( EDA_RECT* aClipBox,
 
         // Plot the overbar segment
         DrawGraphicTextPline( aClipBox, aDC, aColor, aWidth,
-                              sketch_mode, 2, coord, aCallback, aPlotter );
+                              sketch_mode, 2, coord, aCallback, aCallbackData,
+                              aPlotter );
     }
 }
 
@@ -570,8 +576,8 @@ void DrawGraphicHaloText( EDA_RECT* aClipBox, wxDC * aDC,
                           enum EDA_TEXT_HJUSTIFY_T aH_justify,
                           enum EDA_TEXT_VJUSTIFY_T aV_justify,
                           int aWidth, bool aItalic, bool aBold,
-                          void (*aCallback)( int x0, int y0, int xf, int yf ),
-                          PLOTTER * aPlotter )
+                          void (*aCallback)( int x0, int y0, int xf, int yf, void* aData ),
+                          PLOTTER * aPlotter, void* aCallbackData )
 {
     // Swap color if contrast would be better
     if( ColorIsLight( aBgColor ) )
@@ -583,11 +589,11 @@ void DrawGraphicHaloText( EDA_RECT* aClipBox, wxDC * aDC,
 
     DrawGraphicText( aClipBox, aDC, aPos, aColor1, aText, aOrient, aSize,
                      aH_justify, aV_justify, aWidth, aItalic, aBold,
-                     aCallback, aPlotter );
+                     aCallback, aPlotter, aCallbackData );
 
     DrawGraphicText( aClipBox, aDC, aPos, aColor2, aText, aOrient, aSize,
                      aH_justify, aV_justify, aWidth / 4, aItalic, aBold,
-                     aCallback, aPlotter );
+                     aCallback, aPlotter, aCallbackData );
 }
 
 /**
@@ -463,13 +463,14 @@ void EDA_TEXT::Format( OUTPUTFORMATTER* aFormatter, int aNestLevel, int aControl
 // each segment is stored as 2 wxPoints: its starting point and its ending point
 // we are using DrawGraphicText to create the segments.
 // and therefore a call-back function is needed
-static std::vector<wxPoint>* s_cornerBuffer;
 
 // This is a call back function, used by DrawGraphicText to put each segment in buffer
-static void addTextSegmToBuffer( int x0, int y0, int xf, int yf )
+// aData is the buffer, a std::vector<wxPoint>
+static void addTextSegmToBuffer( int x0, int y0, int xf, int yf, void* aData )
 {
-    s_cornerBuffer->push_back( wxPoint( x0, y0 ) );
-    s_cornerBuffer->push_back( wxPoint( xf, yf ) );
+    std::vector<wxPoint>* cornerBuffer = (std::vector<wxPoint>*) aData;
+    cornerBuffer->push_back( wxPoint( x0, y0 ) );
+    cornerBuffer->push_back( wxPoint( xf, yf ) );
 }
 
 void EDA_TEXT::TransformTextShapeToSegmentList( std::vector<wxPoint>& aCornerBuffer ) const
@@ -479,7 +480,6 @@ void EDA_TEXT::TransformTextShapeToSegmentList( std::vector<wxPoint>& aCornerBuf
     if( IsMirrored() )
         size.x = -size.x;
 
-    s_cornerBuffer = &aCornerBuffer;
     EDA_COLOR_T color = BLACK;  // not actually used, but needed by DrawGraphicText
 
     if( IsMultilineAllowed() )
@@ -497,7 +497,7 @@ void EDA_TEXT::TransformTextShapeToSegmentList( std::vector<wxPoint>& aCornerBuf
                              txt, GetOrientation(), size,
                              GetHorizJustify(), GetVertJustify(),
                              GetThickness(), IsItalic(),
-                             true, addTextSegmToBuffer );
+                             true, addTextSegmToBuffer, NULL, &aCornerBuffer );
         }
     }
     else
@@ -506,6 +506,6 @@ void EDA_TEXT::TransformTextShapeToSegmentList( std::vector<wxPoint>& aCornerBuf
                          GetText(), GetOrientation(), size,
                          GetHorizJustify(), GetVertJustify(),
                          GetThickness(), IsItalic(),
-                         true, addTextSegmToBuffer );
+                         true, addTextSegmToBuffer, NULL, &aCornerBuffer );
     }
 }
@@ -0,0 +1,242 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file line_scanner.cpp
+ */
+
+#include <math.h>
+
+#include <line_scanner.h>
+
+
+bool LINE_SCANNER::AtEnd()
+{
+    skipBlanks();
+
+    return *m_next == 0;
+}
+
+
+int LINE_SCANNER::FieldCount() const
+{
+    const char* p = m_next;
+    int         count = 0;
+
+    for( ; ; )
+    {
+        while( isBlank( *p ) )
+            p++;
+
+        if( *p == 0 )
+            return count;
+
+        count++;
+
+        while( *p && !isBlank( *p ) )
+            p++;
+    }
+}
+
+
+bool LINE_SCANNER::SkipFields( int aCount )
+{
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        if( AtEnd() )
+            return false;
+
+        skipField();
+    }
+
+    return true;
+}
+
+
+bool LINE_SCANNER::ParseInt( int& aValue )
+{
+    skipBlanks();
+
+    const char* p = m_next;
+    bool        negative = false;
+
+    if( *p == '-' || *p == '+' )
+        negative = ( *p++ == '-' );
+
+    if( *p < '0' || *p > '9' )
+        return false;
+
+    long long value = 0;
+
+    while( *p >= '0' && *p <= '9' )
+        value = value * 10 + ( *p++ - '0' );
+
+    aValue = (int) ( negative ? -value : value );
+    m_next = p;
+
+    return true;
+}
+
+
+bool LINE_SCANNER::ParseDouble( double& aValue )
+{
+    skipBlanks();
+
+    const char* p = m_next;
+    bool        negative = false;
+
+    if( *p == '-' || *p == '+' )
+        negative = ( *p++ == '-' );
+
+    double value = 0.0;
+    int    digits = 0;
+    int    exponent = 0;
+
+    for( ; *p >= '0' && *p <= '9'; p++, digits++ )
+        value = value * 10.0 + ( *p - '0' );
+
+    if( *p == '.' )
+    {
+        for( p++; *p >= '0' && *p <= '9'; p++, digits++ )
+        {
+            value = value * 10.0 + ( *p - '0' );
+            exponent--;
+        }
+    }
+
+    if( digits == 0 )
+        return false;
+
+    // The exponent is only consumed if it has digits, as strtod() does
+    if( *p == 'e' || *p == 'E' )
+    {
+        const char* e = p + 1;
+        bool        negativeExp = false;
+
+        if( *e == '-' || *e == '+' )
+            negativeExp = ( *e++ == '-' );
+
+        if( *e >= '0' && *e <= '9' )
+        {
+            int exp = 0;
+
+            for( ; *e >= '0' && *e <= '9'; e++ )
+            {
+                if( exp < 10000 )
+                    exp = exp * 10 + ( *e - '0' );
+            }
+
+            exponent += negativeExp ? -exp : exp;
+            p = e;
+        }
+    }
+
+    if( exponent != 0 )
+        value = exponent > 0 ? value * pow( 10.0, exponent ) : value / pow( 10.0, -exponent );
+
+    aValue = negative ? -value : value;
+    m_next = p;
+
+    return true;
+}
+
+
+bool LINE_SCANNER::ParseHex( unsigned long& aValue )
+{
+    skipBlanks();
+
+    const char* p = m_next;
+
+    if( p[0] == '0' && ( p[1] == 'x' || p[1] == 'X' ) )
+    {
+        char c = p[2];
+
+        if( ( c >= '0' && c <= '9' ) || ( c >= 'a' && c <= 'f' ) || ( c >= 'A' && c <= 'F' ) )
+            p += 2;
+    }
+
+    unsigned long value = 0;
+    const char*   start = p;
+
+    for( ; ; p++ )
+    {
+        char c = *p;
+
+        if( c >= '0' && c <= '9' )
+            value = ( value << 4 ) | ( c - '0' );
+        else if( c >= 'a' && c <= 'f' )
+            value = ( value << 4 ) | ( c - 'a' + 10 );
+        else if( c >= 'A' && c <= 'F' )
+            value = ( value << 4 ) | ( c - 'A' + 10 );
+        else
+            break;
+    }
+
+    if( p == start )
+        return false;
+
+    aValue = value;
+    m_next = p;
+
+    return true;
+}
+
+
+bool LINE_SCANNER::ParseChar( char& aValue )
+{
+    if( AtEnd() )
+        return false;
+
+    aValue = *m_next;
+    skipField();
+
+    return true;
+}
+
+
+bool LINE_SCANNER::ParseWord( std::string& aWord )
+{
+    if( AtEnd() )
+    {
+        aWord.clear();
+        return false;
+    }
+
+    const char* start = m_next;
+
+    skipField();
+    aWord.assign( start, m_next - start );
+
+    return true;
+}
+
+
+bool LINE_SCANNER::SkipChar( char aChar )
+{
+    if( *m_next != aChar )
+        return false;
+
+    m_next++;
+
+    return true;
+}
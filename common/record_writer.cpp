@@ -0,0 +1,652 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file record_writer.cpp
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <wchar.h>
+#include <algorithm>
+
+#include <record_writer.h>
+
+
+static const double s_scales[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+
+// Writes the digits of aValue at aBuffer, backwards from its end; returns the
+// first digit.
+static char* formatUnsigned( char* aEnd, unsigned long long aValue )
+{
+    char* p = aEnd;
+
+    do
+    {
+        *--p = '0' + (char) ( aValue % 10 );
+        aValue /= 10;
+    } while( aValue );
+
+    return p;
+}
+
+
+/**
+ * Function formatFixed
+ * formats the absolute value aValue like printf( "%.*f" ) at aBuffer, with aPrecision
+ * digits after the decimal point.
+ * @return the text length, or -1 if the value cannot be formatted without the C library:
+ * when it is too large to be scaled to an integer, or too close to a rounding
+ * boundary for the scaled value to tell which way the exact value rounds.
+ */
+static int formatFixed( char* aBuffer, double aValue, int aPrecision )
+{
+    if( aPrecision < 0 || aPrecision > 15 )
+        return -1;
+
+    double scaled = aValue * s_scales[aPrecision];
+
+    if( !( scaled < 1e15 ) )      // also true for NaN and infinity
+        return -1;
+
+    // The multiplication by the power of ten is rounded once: the scaled value is
+    // within scaled * 2^-53 of the exact one.
+    double intPart = floor( scaled );
+    double frac = scaled - intPart;
+
+    if( fabs( frac - 0.5 ) <= scaled * 4e-16 )
+        return -1;
+
+    unsigned long long value = (unsigned long long) intPart;
+
+    if( frac > 0.5 )
+        ++value;
+
+    char  digits[24];
+    char* end = digits + sizeof( digits );
+    char* first = formatUnsigned( end, value );
+
+    // pad the fraction with leading zeros
+    while( end - first <= aPrecision )
+        *--first = '0';
+
+    int   intCount = ( end - first ) - aPrecision;
+    char* p = aBuffer;
+
+    memcpy( p, first, intCount );
+    p += intCount;
+
+    if( aPrecision )
+    {
+        *p++ = '.';
+        memcpy( p, first + intCount, aPrecision );
+        p += aPrecision;
+    }
+
+    return p - aBuffer;
+}
+
+
+/**
+ * Function formatGeneral
+ * formats the absolute value aValue like printf( "%.*g" ) at aBuffer, with
+ * aPrecision significant digits.
+ * @return the text length, or -1 if the value cannot be formatted without the C
+ * library, in particular when printf() would use the exponent notation.
+ */
+static int formatGeneral( char* aBuffer, double aValue, int aPrecision )
+{
+    if( aPrecision == 0 )
+        aPrecision = 1;
+
+    if( aPrecision > 15 )
+        return -1;
+
+    if( aValue == 0.0 )
+    {
+        aBuffer[0] = '0';
+        return 1;
+    }
+
+    if( !( aValue >= 1e-4 && aValue < 1e15 ) )
+        return -1;
+
+    // printf uses the fixed notation with aPrecision - 1 - X digits after the
+    // decimal point, X being the exponent of the value rounded to aPrecision
+    // significant digits.  log10 gives the exponent of the value, which is one
+    // less than X when the rounding carries to the next power of ten.
+    int exponent = (int) floor( log10( aValue ) );
+    int len = -1;
+
+    for( int pass = 0; pass < 2; ++pass, ++exponent )
+    {
+        int decimals = aPrecision - 1 - exponent;
+
+        if( exponent < -4 || decimals < 0 )
+            return -1;
+
+        len = formatFixed( aBuffer, aValue, decimals );
+
+        if( len < 0 )
+            return -1;
+
+        // the exponent of the formatted value
+        int x;
+
+        if( aBuffer[0] != '0' )
+        {
+            x = ( len - decimals - ( decimals ? 1 : 0 ) ) - 1;
+        }
+        else
+        {
+            x = -1;
+
+            for( int ii = 2; ii < len && aBuffer[ii] == '0'; ++ii )
+                --x;
+        }
+
+        if( x == exponent )
+            break;
+
+        if( x != exponent + 1 || pass )
+            return -1;
+    }
+
+    // remove the trailing zeros of the fraction, and the decimal point if nothing
+    // is left after it
+    if( memchr( aBuffer, '.', len ) )
+    {
+        while( aBuffer[len - 1] == '0' )
+            --len;
+
+        if( aBuffer[len - 1] == '.' )
+            --len;
+    }
+
+    return len;
+}
+
+
+// A conversion specification of a format string.
+struct FORMAT_SPEC
+{
+    bool    m_Left;         // '-'
+    bool    m_Plus;         // '+'
+    bool    m_Space;        // ' '
+    bool    m_Alt;          // '#'
+    bool    m_Zero;         // '0'
+    int     m_Width;
+    int     m_Precision;    // -1 if not given
+    char    m_Length[3];    // the length modifier
+    char    m_Conversion;
+
+    // Builds the format of the specification for snprintf, with the width and
+    // precision given as numbers and the length modifier replaced by aLength.
+    std::string Format( const char* aLength ) const
+    {
+        char buf[64];
+        char* p = buf;
+
+        *p++ = '%';
+
+        if( m_Left )    *p++ = '-';
+        if( m_Plus )    *p++ = '+';
+        if( m_Space )   *p++ = ' ';
+        if( m_Alt )     *p++ = '#';
+        if( m_Zero )    *p++ = '0';
+
+        if( m_Width > 0 )
+            p += sprintf( p, "%d", m_Width );
+
+        if( m_Precision >= 0 )
+            p += sprintf( p, ".%d", m_Precision );
+
+        strcpy( p, aLength );
+        p += strlen( aLength );
+        *p++ = m_Conversion;
+        *p = 0;
+
+        return buf;
+    }
+};
+
+
+// Formats aValue with the C library, as printf( aFormat ) does.
+template <typename T>
+static void cFormat( std::string& aResult, const std::string& aFormat, T aValue )
+{
+    char buf[128];
+    int  len = snprintf( buf, sizeof( buf ), aFormat.c_str(), aValue );
+
+    if( len < 0 )
+    {
+        aResult.clear();
+    }
+    else if( len < (int) sizeof( buf ) )
+    {
+        aResult.assign( buf, len );
+    }
+    else
+    {
+        std::vector<char> big( len + 1 );
+
+        snprintf( &big[0], big.size(), aFormat.c_str(), aValue );
+        aResult.assign( &big[0], len );
+    }
+}
+
+
+RECORD_WRITER::RECORD_WRITER( FILE* aFile, size_t aBufferSize ) :
+    m_file( aFile ),
+    m_buffer( aBufferSize > 256 ? aBufferSize : 256 ),
+    m_used( 0 ),
+    m_failed( false )
+{
+}
+
+
+RECORD_WRITER::~RECORD_WRITER()
+{
+    flushBuffer();
+}
+
+
+void RECORD_WRITER::flushBuffer()
+{
+    if( m_used )
+    {
+        m_failed |= fwrite( &m_buffer[0], 1, m_used, m_file ) != m_used;
+        m_used = 0;
+    }
+}
+
+
+bool RECORD_WRITER::Flush()
+{
+    flushBuffer();
+
+    return !m_failed;
+}
+
+
+void RECORD_WRITER::Text( const char* aText )
+{
+    put( aText, strlen( aText ) );
+}
+
+
+void RECORD_WRITER::putField( const char* aText, size_t aCount, int aWidth, bool aLeft,
+                              char aPadChar )
+{
+    static const char spaces[] = "                                ";
+    static const char zeros[]  = "00000000000000000000000000000000";
+    const char* pad = aPadChar == '0' ? zeros : spaces;
+
+    size_t padCount = aWidth > (int) aCount ? aWidth - aCount : 0;
+
+    if( aLeft )
+        put( aText, aCount );
+
+    while( padCount )
+    {
+        size_t n = std::min( padCount, sizeof( spaces ) - 1 );
+
+        put( pad, n );
+        padCount -= n;
+    }
+
+    if( !aLeft )
+        put( aText, aCount );
+}
+
+
+void RECORD_WRITER::Print( const char* aFormat, ... )
+{
+    va_list args;
+
+    va_start( args, aFormat );
+    vprint( aFormat, args );
+    va_end( args );
+}
+
+
+void RECORD_WRITER::vprint( const char* aFormat, va_list aArgs )
+{
+    const char* fmt = aFormat;
+
+    while( *fmt )
+    {
+        // the text up to the next conversion
+        const char* start = fmt;
+
+        while( *fmt && *fmt != '%' )
+            ++fmt;
+
+        if( fmt > start )
+            put( start, fmt - start );
+
+        if( !*fmt )
+            break;
+
+        if( fmt[1] == '%' )
+        {
+            put( fmt, 1 );
+            fmt += 2;
+            continue;
+        }
+
+        const char* specStart = fmt++;
+
+        FORMAT_SPEC spec;
+        memset( &spec, 0, sizeof( spec ) );
+        spec.m_Precision = -1;
+
+        for( ; ; ++fmt )
+        {
+            if( *fmt == '-' )       spec.m_Left = true;
+            else if( *fmt == '+' )  spec.m_Plus = true;
+            else if( *fmt == ' ' )  spec.m_Space = true;
+            else if( *fmt == '#' )  spec.m_Alt = true;
+            else if( *fmt == '0' )  spec.m_Zero = true;
+            else break;
+        }
+
+        if( *fmt == '*' )
+        {
+            spec.m_Width = va_arg( aArgs, int );
+            ++fmt;
+
+            if( spec.m_Width < 0 )
+            {
+                spec.m_Left = true;
+                spec.m_Width = -spec.m_Width;
+            }
+        }
+        else
+        {
+            while( *fmt >= '0' && *fmt <= '9' )
+                spec.m_Width = spec.m_Width * 10 + ( *fmt++ - '0' );
+        }
+
+        if( *fmt == '.' )
+        {
+            ++fmt;
+            spec.m_Precision = 0;
+
+            if( *fmt == '*' )
+            {
+                spec.m_Precision = va_arg( aArgs, int );
+                ++fmt;
+
+                if( spec.m_Precision < 0 )
+                    spec.m_Precision = -1;
+            }
+            else
+            {
+                while( *fmt >= '0' && *fmt <= '9' )
+                    spec.m_Precision = spec.m_Precision * 10 + ( *fmt++ - '0' );
+            }
+        }
+
+        for( int ii = 0; ii < 2 && *fmt && strchr( "hlLqjzt", *fmt ); ++ii )
+        {
+            spec.m_Length[ii] = *fmt++;
+
+            if( spec.m_Length[0] != 'h' && spec.m_Length[0] != 'l' )
+                break;
+
+            if( *fmt != spec.m_Length[0] )
+                break;
+        }
+
+        spec.m_Conversion = *fmt;
+
+        if( !*fmt )
+        {
+            // incomplete specification at the end of the format: written as is
+            put( specStart, fmt - specStart );
+            break;
+        }
+
+        ++fmt;
+
+        const char* length = spec.m_Length;
+        char        buf[64];
+        std::string text;
+
+        switch( spec.m_Conversion )
+        {
+        case 'd':
+        case 'i':
+            {
+                long long value;
+
+                if( !strcmp( length, "hh" ) )       value = (signed char) va_arg( aArgs, int );
+                else if( !strcmp( length, "h" ) )   value = (short) va_arg( aArgs, int );
+                else if( !strcmp( length, "l" ) )   value = va_arg( aArgs, long );
+                else if( !strcmp( length, "ll" ) || !strcmp( length, "q" ) )
+                                                    value = va_arg( aArgs, long long );
+                else if( !strcmp( length, "z" ) )   value = (long long) va_arg( aArgs, size_t );
+                else if( !strcmp( length, "t" ) )   value = va_arg( aArgs, ptrdiff_t );
+                else if( !strcmp( length, "j" ) )   value = va_arg( aArgs, intmax_t );
+                else                                value = va_arg( aArgs, int );
+
+                if( spec.m_Precision < 0 )
+                {
+                    char* end = buf + sizeof( buf );
+                    char* p = formatUnsigned( end, value < 0 ? 0ULL - (unsigned long long) value
+                                                             : (unsigned long long) value );
+
+                    char sign = value < 0 ? '-' : spec.m_Plus ? '+' : spec.m_Space ? ' ' : 0;
+
+                    if( sign && spec.m_Zero && !spec.m_Left )
+                    {
+                        put( &sign, 1 );
+                        putField( p, end - p, spec.m_Width - 1, false, '0' );
+                    }
+                    else
+                    {
+                        if( sign )
+                            *--p = sign;
+
+                        putField( p, end - p, spec.m_Width, spec.m_Left,
+                                  spec.m_Zero && !spec.m_Left ? '0' : ' ' );
+                    }
+
+                    continue;
+                }
+
+                cFormat( text, spec.Format( "ll" ), value );
+            }
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            {
+                unsigned long long value;
+
+                if( !strcmp( length, "hh" ) )
+                    value = (unsigned char) va_arg( aArgs, unsigned );
+                else if( !strcmp( length, "h" ) )
+                    value = (unsigned short) va_arg( aArgs, unsigned );
+                else if( !strcmp( length, "l" ) )
+                    value = va_arg( aArgs, unsigned long );
+                else if( !strcmp( length, "ll" ) || !strcmp( length, "q" ) )
+                    value = va_arg( aArgs, unsigned long long );
+                else if( !strcmp( length, "j" ) )
+                    value = va_arg( aArgs, uintmax_t );
+                else if( !strcmp( length, "z" ) )
+                    value = va_arg( aArgs, size_t );
+                else if( !strcmp( length, "t" ) )
+                    value = (unsigned long long) va_arg( aArgs, ptrdiff_t );
+                else
+                    value = va_arg( aArgs, unsigned );
+
+                if( spec.m_Conversion == 'u' && spec.m_Precision < 0 )
+                {
+                    char* end = buf + sizeof( buf );
+                    char* p = formatUnsigned( end, value );
+
+                    putField( p, end - p, spec.m_Width, spec.m_Left,
+                              spec.m_Zero && !spec.m_Left ? '0' : ' ' );
+                    continue;
+                }
+
+                cFormat( text, spec.Format( "ll" ), value );
+            }
+            break;
+
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'e':
+        case 'E':
+        case 'a':
+        case 'A':
+            {
+                if( !strcmp( length, "L" ) )
+                {
+                    cFormat( text, spec.Format( "L" ), va_arg( aArgs, long double ) );
+                    break;
+                }
+
+                double value = va_arg( aArgs, double );
+                int    len = -1;
+
+                if( !spec.m_Alt )
+                {
+                    char c = spec.m_Conversion;
+                    int  precision = spec.m_Precision < 0 ? 6 : spec.m_Precision;
+
+                    // Only the value is formatted here: the sign is added below
+                    if( c == 'f' || c == 'F' )
+                        len = formatFixed( buf + 1, fabs( value ), precision );
+                    else if( c == 'g' || c == 'G' )
+                        len = formatGeneral( buf + 1, fabs( value ), precision );
+                }
+
+                if( len >= 0 )
+                {
+                    // -0.0 is negative for printf
+                    bool negative = value < 0.0 || ( value == 0.0 && 1.0 / value < 0.0 );
+                    char sign = negative ? '-' : spec.m_Plus ? '+' : spec.m_Space ? ' ' : 0;
+                    char* p = buf + 1;
+
+                    if( sign && spec.m_Zero && !spec.m_Left )
+                    {
+                        put( &sign, 1 );
+                        putField( p, len, spec.m_Width - 1, false, '0' );
+                    }
+                    else
+                    {
+                        if( sign )
+                        {
+                            *--p = sign;
+                            ++len;
+                        }
+
+                        putField( p, len, spec.m_Width, spec.m_Left,
+                                  spec.m_Zero && !spec.m_Left ? '0' : ' ' );
+                    }
+
+                    continue;
+                }
+
+                cFormat( text, spec.Format( "" ), value );
+            }
+            break;
+
+        case 's':
+            if( !strcmp( length, "l" ) )
+            {
+                cFormat( text, spec.Format( "l" ), va_arg( aArgs, const wchar_t* ) );
+            }
+            else
+            {
+                const char* value = va_arg( aArgs, const char* );
+
+                if( !value )
+                {
+                    // left to the C library, which may print "(null)"
+                    cFormat( text, spec.Format( "" ), value );
+                    break;
+                }
+
+                size_t len;
+
+                if( spec.m_Precision < 0 )
+                {
+                    len = strlen( value );
+                }
+                else
+                {
+                    const void* end = memchr( value, 0, spec.m_Precision );
+
+                    len = end ? (const char*) end - value : spec.m_Precision;
+                }
+
+                putField( value, len, spec.m_Width, spec.m_Left );
+                continue;
+            }
+            break;
+
+        case 'c':
+            if( !strcmp( length, "l" ) )
+            {
+                cFormat( text, spec.Format( "l" ), va_arg( aArgs, wint_t ) );
+            }
+            else
+            {
+                buf[0] = (char) va_arg( aArgs, int );
+                putField( buf, 1, spec.m_Width, spec.m_Left );
+                continue;
+            }
+            break;
+
+        case 'p':
+            cFormat( text, spec.Format( "" ), va_arg( aArgs, void* ) );
+            break;
+
+        case 'n':
+            // the count of written characters is not supported
+            va_arg( aArgs, void* );
+            continue;
+
+        default:
+            // unknown conversion: written as is
+            put( specStart, fmt - specStart );
+            continue;
+        }
+
+        put( text.data(), text.size() );
+    }
+}
@@ -578,6 +578,9 @@ FILE_OUTPUTFORMATTER::FILE_OUTPUTFORMATTER( const wxString& aFileName,
                             m_filename.GetData() );
         THROW_IO_ERROR( msg );
     }
+
+    // Files written here are made of many small Print()s.
+    setvbuf( m_fp, NULL, _IOFBF, BUFSIZ * 8 );
 }
 
 
@@ -0,0 +1,58 @@
+'''
+    A python script example to benchmark the built in autorouter, without pcbnew frame:
+    the tracks and zones of each board are removed, then the whole board is routed,
+    first connection by connection, then with the concurrent router, which routes the
+    connections which do not overlap at the same time in worker threads.
+
+    Usage, from the source tree root:
+        python autoroute_bench.py [grid in mils] demos/*/*.kicad_pcb
+
+    For each board the time taken and the number of connections routed by both routers
+    are printed.  Each router starts from a board loaded again from its file.
+'''
+
+import sys
+import time
+
+from pcbnew import *
+
+def clearBoard(board):
+    for track in [t for t in board.GetTracks()]:
+        board.Delete(track)
+
+    for ii in reversed(range(board.GetAreaCount())):
+        board.Delete(board.GetArea(ii))
+
+def routeBoard(filename, grid, concurrent):
+    board = LoadBoard(filename)
+    clearBoard(board)
+
+    start = time.time()
+    routed = AutorouteBoard(board, FromMils(grid), concurrent)
+    return (time.time() - start, routed)
+
+args = sys.argv[1:]
+grid = 25
+
+if len(args) and args[0].isdigit():
+    grid = int(args[0])
+    args = args[1:]
+
+if not len(args):
+    print __doc__
+    sys.exit(1)
+
+print "%-40s %10s %8s %10s %8s %8s" % ("board", "serial s", "routed",
+                                        "concur. s", "routed", "speedup")
+
+for filename in args:
+    serialTime, serialRouted = routeBoard(filename, grid, False)
+    concurrentTime, concurrentRouted = routeBoard(filename, grid, True)
+
+    speedup = 0.0
+
+    if concurrentTime > 0:
+        speedup = serialTime / concurrentTime
+
+    print "%-40s %10.2f %8d %10.2f %8d %8.2f" % (filename[-40:], serialTime, serialRouted,
+                                                 concurrentTime, concurrentRouted, speedup)
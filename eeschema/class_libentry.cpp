@@ -35,6 +35,7 @@
 #include <gr_basic.h>
 #include <class_sch_screen.h>
 #include <richio.h>
+#include <line_scanner.h>
 
 #include <general.h>
 #include <template_fieldnames.h>
@@ -48,6 +49,7 @@
 #include <lib_polyline.h>
 #include <lib_rectangle.h>
 #include <lib_text.h>
+#include <ki_mutex.h>
 
 #include <boost/foreach.hpp>
 
@@ -190,6 +192,7 @@ LIB_PART::LIB_PART( const wxString& aName, PART_LIB* aLibrary ) :
     m_unitsLocked         = false;
     m_showPinNumbers      = true;
     m_showPinNames        = true;
+    m_drawingsDeferred    = 0;
 
     // Create the default alias if the name parameter is not empty.
     if( !aName.IsEmpty() )
@@ -223,6 +226,7 @@ LIB_PART::LIB_PART( LIB_PART& aPart, PART_LIB* aLibrary ) :
     m_showPinNames        = aPart.m_showPinNames;
     m_dateModified        = aPart.m_dateModified;
     m_options             = aPart.m_options;
+    m_drawingsDeferred    = 0;
 
     BOOST_FOREACH( LIB_ITEM& oldItem, aPart.GetDrawItemList() )
     {
@@ -314,6 +318,8 @@ void LIB_PART::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDc, const wxPoint& aOffset,
                      const TRANSFORM& aTransform, bool aShowPinText, bool aDrawFields,
                      bool aOnlySelected, const std::vector<bool>* aPinsDangling )
 {
+    loadDeferredDrawings();
+
     BASE_SCREEN*   screen = aPanel ? aPanel->GetScreen() : NULL;
 
     GRSetDrawMode( aDc, aDrawMode );
@@ -439,6 +445,8 @@ void LIB_PART::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDc, const wxPoint& aOffset,
 void LIB_PART::Plot( PLOTTER* aPlotter, int aUnit, int aConvert,
                           const wxPoint& aOffset, const TRANSFORM& aTransform )
 {
+    loadDeferredDrawings();
+
     wxASSERT( aPlotter != NULL );
 
     aPlotter->SetColor( GetLayerColor( LAYER_DEVICE ) );
@@ -517,6 +525,8 @@ void LIB_PART::PlotLibFields( PLOTTER* aPlotter, int aUnit, int aConvert,
 
 void LIB_PART::RemoveDrawItem( LIB_ITEM* aItem, EDA_DRAW_PANEL* aPanel, wxDC* aDc )
 {
+    loadDeferredDrawings();
+
     wxASSERT( aItem != NULL );
 
     // none of the MANDATORY_FIELDS may be removed in RAM, but they may be
@@ -555,6 +565,8 @@ void LIB_PART::RemoveDrawItem( LIB_ITEM* aItem, EDA_DRAW_PANEL* aPanel, wxDC* aD
 
 void LIB_PART::AddDrawItem( LIB_ITEM* aItem )
 {
+    loadDeferredDrawings();
+
     wxASSERT( aItem != NULL );
 
     drawings.push_back( aItem );
@@ -564,6 +576,8 @@ void LIB_PART::AddDrawItem( LIB_ITEM* aItem )
 
 LIB_ITEM* LIB_PART::GetNextDrawItem( LIB_ITEM* aItem, KICAD_T aType )
 {
+    loadDeferredDrawings();
+
     /* Return the next draw object pointer.
      * If item is NULL return the first item of type in the list.
      */
@@ -601,6 +615,8 @@ LIB_ITEM* LIB_PART::GetNextDrawItem( LIB_ITEM* aItem, KICAD_T aType )
 
 void LIB_PART::GetPins( LIB_PINS& aList, int aUnit, int aConvert )
 {
+    loadDeferredDrawings();
+
     /* Notes:
      * when aUnit == 0: no unit filtering
      * when aConvert == 0: no convert (shape selection) filtering
@@ -707,6 +723,8 @@ bool LIB_PART::PinsConflictWith( LIB_PART& aOtherPart, bool aTestNums, bool aTes
 
 bool LIB_PART::Save( OUTPUTFORMATTER& aFormatter )
 {
+    loadDeferredDrawings();
+
     LIB_FIELD&  value = GetValueField();
 
     // First line: it s a comment (component name for readers)
@@ -840,22 +858,22 @@ bool LIB_PART::Save( OUTPUTFORMATTER& aFormatter )
 }
 
 
-bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
+bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg, bool aDeferDrawings )
 {
-    int      unused;
-    char*    p;
-    char*    componentName;
-    char*    prefix = NULL;
-    char*    line;
+    int          unused;
+    char*        line;
+    std::string  keyword;
+    std::string  componentName;
+    std::string  prefix;
+    LINE_SCANNER scanner;
 
     bool     result;
     wxString Msg;
 
     line = aLineReader.Line();
+    scanner.SetLine( line );
 
-    p = strtok( line, " \t\r\n" );
-
-    if( strcmp( p, "DEF" ) != 0 )
+    if( !scanner.ParseWord( keyword ) || keyword != "DEF" )
     {
         aErrorMsg.Printf( wxT( "DEF command expected in line %d, aborted." ),
                           aLineReader.LineNumber() );
@@ -866,27 +884,22 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
     char drawnum = 0;
     char drawname = 0;
 
-    if( ( componentName = strtok( NULL, " \t\n" ) ) == NULL  // Part name:
-        || ( prefix = strtok( NULL, " \t\n" ) ) == NULL      // Prefix name:
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // NumOfPins:
-        || sscanf( p, "%d", &unused ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // TextInside:
-        || sscanf( p, "%d", &m_pinNameOffset ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // DrawNums:
-        || sscanf( p, "%c", &drawnum ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // DrawNums:
-        || sscanf( p, "%c", &drawname ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // m_unitCount:
-        || sscanf( p, "%d", &m_unitCount ) != 1 )
+    if( !scanner.ParseWord( componentName )          // Part name:
+        || !scanner.ParseWord( prefix )             // Prefix name:
+        || !scanner.ParseInt( unused )              // NumOfPins:
+        || !scanner.ParseInt( m_pinNameOffset )     // TextInside:
+        || !scanner.ParseChar( drawnum )            // DrawNums:
+        || !scanner.ParseChar( drawname )           // DrawNums:
+        || !scanner.ParseInt( m_unitCount ) )       // m_unitCount:
     {
         aErrorMsg.Printf( wxT( "Wrong DEF format in line %d, skipped." ),
                           aLineReader.LineNumber() );
 
         while( (line = aLineReader.ReadLine()) != NULL )
         {
-            p = strtok( line, " \t\n" );
+            scanner.SetLine( line );
 
-            if( stricmp( p, "ENDDEF" ) == 0 )
+            if( scanner.ParseWord( keyword ) && stricmp( keyword.c_str(), "ENDDEF" ) == 0 )
                 break;
         }
 
@@ -905,12 +918,12 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 
     if( componentName[0] != '~' )
     {
-        m_name = FROM_UTF8( componentName );
+        m_name = FROM_UTF8( componentName.c_str() );
         value.SetText( m_name );
     }
     else
     {
-        m_name = FROM_UTF8( &componentName[1] );
+        m_name = FROM_UTF8( componentName.c_str() + 1 );
         value.SetText( m_name );
         value.SetVisible( false );
     }
@@ -920,27 +933,30 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 
     LIB_FIELD& reference = GetReferenceField();
 
-    if( strcmp( prefix, "~" ) == 0 )
+    if( prefix == "~" )
     {
         reference.Empty();
         reference.SetVisible( false );
     }
     else
     {
-        reference.SetText( FROM_UTF8( prefix ) );
+        reference.SetText( FROM_UTF8( prefix.c_str() ) );
     }
 
     // Copy optional infos
-    if( ( p = strtok( NULL, " \t\n" ) ) != NULL && *p == 'L' )
+    char option;
+
+    if( scanner.ParseChar( option ) && option == 'L' )
         m_unitsLocked = true;
 
-    if( ( p = strtok( NULL, " \t\n" ) ) != NULL  && *p == 'P' )
+    if( scanner.ParseChar( option ) && option == 'P' )
         m_options = ENTRY_POWER;
 
     // Read next lines, until "ENDDEF" is found
     while( ( line = aLineReader.ReadLine() ) != NULL )
     {
-        p = strtok( line, " \t\r\n" );
+        scanner.SetLine( line );
+        scanner.ParseWord( keyword );
 
         // This is the error flag ( if an error occurs, result = false)
         result = true;
@@ -952,16 +968,14 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
             result = LoadDateAndTime( aLineReader );
         else if( *line == 'F' )
             result = LoadField( aLineReader, Msg );
-        else if( strcmp( p, "ENDDEF" ) == 0 )   // End of component description
+        else if( keyword == "ENDDEF" )   // End of component description
             goto ok;
-        else if( strcmp( p, "DRAW" ) == 0 )
-            result = LoadDrawEntries( aLineReader, Msg );
-        else if( strncmp( p, "ALIAS", 5 ) == 0 )
-        {
-            p = strtok( NULL, "\r\n" );
-            result = LoadAliases( p, aErrorMsg );
-        }
-        else if( strncmp( p, "$FPLIST", 5 ) == 0 )
+        else if( keyword == "DRAW" )
+            result = aDeferDrawings ? deferDrawEntries( aLineReader, Msg )
+                                    : LoadDrawEntries( aLineReader, Msg );
+        else if( keyword.compare( 0, 5, "ALIAS" ) == 0 )
+            result = LoadAliases( (char*) scanner.Position(), aErrorMsg );
+        else if( keyword.compare( 0, 5, "$FPLIST", 5 ) == 0 )
             result = LoadFootprints( aLineReader, Msg );
 
         // End line or block analysis: test for an error
@@ -1072,16 +1086,77 @@ bool LIB_PART::LoadDrawEntries( LINE_READER& aLineReader, wxString& aErrorMsg )
 }
 
 
-bool LIB_PART::LoadAliases( char* aLine, wxString& aErrorMsg )
+bool LIB_PART::deferDrawEntries( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
-    char* text = strtok( aLine, " \t\r\n" );
+    char* line;
+
+    m_deferredDrawings.clear();
 
-    while( text )
+    while( true )
     {
-        m_aliases.push_back( new LIB_ALIAS( FROM_UTF8( text ), this ) );
-        text = strtok( NULL, " \t\r\n" );
+        if( !( line = aLineReader.ReadLine() ) )
+        {
+            aErrorMsg = wxT( "file ended prematurely loading component draw element" );
+            return false;
+        }
+
+        // Keep the ENDDRAW line: LoadDrawEntries() expects it.
+        m_deferredDrawings.append( line, aLineReader.Length() );
+
+        if( strncmp( line, "ENDDRAW", 7 ) == 0 )
+            break;
     }
 
+    m_drawingsDeferred = 1;
+
+    return true;
+}
+
+
+// Parts of a library can be used by several threads (see BuildNetListInfo()).
+// This lock is only taken by the first use of the draw items of a part.
+static MUTEX deferredDrawingsLock;
+
+
+void LIB_PART::loadDeferredDrawings()
+{
+    // Called by every draw item accessor, so the usual case (never deferred, or already
+    // loaded) must not wait for the lock.  m_drawingsDeferred is read and cleared with
+    // atomic operations, which are full barriers: a thread which reads 0 also sees the
+    // draw items stored before the flag was cleared.
+    if( !__sync_fetch_and_add( &m_drawingsDeferred, 0 ) )
+        return;
+
+    MUTLOCK lock( deferredDrawingsLock );
+
+    if( !m_drawingsDeferred )   // Loaded by another thread meanwhile.
+        return;
+
+    STRING_LINE_READER reader( m_deferredDrawings, m_name );
+    wxString           msg;
+
+    if( !LoadDrawEntries( reader, msg ) )
+    {
+        wxLogWarning( _( "Library '%s' component '%s' draw items load error %s." ),
+                      m_library ? GetChars( m_library->GetName() ) : wxT( "" ),
+                      GetChars( m_name ), GetChars( msg ) );
+    }
+
+    drawings.sort();
+
+    std::string().swap( m_deferredDrawings );
+    __sync_fetch_and_and( &m_drawingsDeferred, 0 );
+}
+
+
+bool LIB_PART::LoadAliases( char* aLine, wxString& aErrorMsg )
+{
+    LINE_SCANNER scanner( aLine );
+    std::string  alias;
+
+    while( scanner.ParseWord( alias ) )
+        m_aliases.push_back( new LIB_ALIAS( FROM_UTF8( alias.c_str() ), this ) );
+
     return true;
 }
 
@@ -1123,8 +1198,9 @@ bool LIB_PART::LoadField( LINE_READER& aLineReader, wxString& aErrorMsg )
 
 bool LIB_PART::LoadFootprints( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
-    char* line;
-    char* p;
+    char*        line;
+    std::string  footprint;
+    LINE_SCANNER scanner;
 
     while( true )
     {
@@ -1134,12 +1210,15 @@ bool LIB_PART::LoadFootprints( LINE_READER& aLineReader, wxString& aErrorMsg )
             return false;
         }
 
-        p = strtok( line, " \t\r\n" );
+        scanner.SetLine( line );
+
+        if( !scanner.ParseWord( footprint ) )
+            continue;
 
-        if( stricmp( p, "$ENDFPLIST" ) == 0 )
+        if( stricmp( footprint.c_str(), "$ENDFPLIST" ) == 0 )
             break;
 
-        m_FootprintList.Add( FROM_UTF8( p ) );
+        m_FootprintList.Add( FROM_UTF8( footprint.c_str() ) );
     }
 
     return true;
@@ -1148,6 +1227,8 @@ bool LIB_PART::LoadFootprints( LINE_READER& aLineReader, wxString& aErrorMsg )
 
 const EDA_RECT LIB_PART::GetBoundingBox( int aUnit, int aConvert ) const
 {
+    const_cast<LIB_PART*>( this )->loadDeferredDrawings();
+
     EDA_RECT bBox;
     bool initialized = false;
 
@@ -1180,6 +1261,8 @@ const EDA_RECT LIB_PART::GetBoundingBox( int aUnit, int aConvert ) const
 
 const EDA_RECT LIB_PART::GetBodyBoundingBox( int aUnit, int aConvert ) const
 {
+    const_cast<LIB_PART*>( this )->loadDeferredDrawings();
+
     EDA_RECT bBox;
     bool initialized = false;
 
@@ -1357,10 +1440,18 @@ bool LIB_PART::LoadDateAndTime( char* aLine )
     int   year, mon, day, hour, min, sec;
 
     year = mon = day = hour = min = sec = 0;
-    strtok( aLine, " \r\t\n" );
-    strtok( NULL, " \r\t\n" );
 
-    if( sscanf( aLine, "%d/%d/%d %d:%d:%d", &year, &mon, &day, &hour, &min, &sec ) != 6 )
+    // Skip the "Ti" keyword.
+    LINE_SCANNER scanner( aLine );
+
+    // Read "year/mon/day hour:min:sec".
+    if( !scanner.SkipFields( 1 )
+      || !scanner.ParseInt( year ) || !scanner.SkipChar( '/' )
+      || !scanner.ParseInt( mon ) || !scanner.SkipChar( '/' )
+      || !scanner.ParseInt( day )
+      || !scanner.ParseInt( hour ) || !scanner.SkipChar( ':' )
+      || !scanner.ParseInt( min ) || !scanner.SkipChar( ':' )
+      || !scanner.ParseInt( sec ) )
         return false;
 
     m_dateModified = ( sec & 63 ) + ( ( min & 63 ) << 6 ) +
@@ -1373,6 +1464,8 @@ bool LIB_PART::LoadDateAndTime( char* aLine )
 
 void LIB_PART::SetOffset( const wxPoint& aOffset )
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         item.SetOffset( aOffset );
@@ -1382,12 +1475,16 @@ void LIB_PART::SetOffset( const wxPoint& aOffset )
 
 void LIB_PART::RemoveDuplicateDrawItems()
 {
+    loadDeferredDrawings();
+
     drawings.unique();
 }
 
 
 bool LIB_PART::HasConversion() const
 {
+    const_cast<LIB_PART*>( this )->loadDeferredDrawings();
+
     for( unsigned ii = 0; ii < drawings.size(); ii++  )
     {
         const LIB_ITEM& item = drawings[ii];
@@ -1401,6 +1498,8 @@ bool LIB_PART::HasConversion() const
 
 void LIB_PART::ClearStatus()
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         item.m_Flags = 0;
@@ -1410,6 +1509,8 @@ void LIB_PART::ClearStatus()
 
 int LIB_PART::SelectItems( EDA_RECT& aRect, int aUnit, int aConvert, bool aEditPinByPin )
 {
+    loadDeferredDrawings();
+
     int itemCount = 0;
 
     BOOST_FOREACH( LIB_ITEM& item, drawings )
@@ -1441,6 +1542,8 @@ int LIB_PART::SelectItems( EDA_RECT& aRect, int aUnit, int aConvert, bool aEditP
 
 void LIB_PART::MoveSelectedItems( const wxPoint& aOffset )
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         if( !item.IsSelected() )
@@ -1456,6 +1559,8 @@ void LIB_PART::MoveSelectedItems( const wxPoint& aOffset )
 
 void LIB_PART::ClearSelectedItems()
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         item.m_Flags = 0;
@@ -1465,6 +1570,8 @@ void LIB_PART::ClearSelectedItems()
 
 void LIB_PART::DeleteSelectedItems()
 {
+    loadDeferredDrawings();
+
     LIB_ITEMS::iterator item = drawings.begin();
 
     // We *do not* remove the 2 mandatory fields: reference and value
@@ -1495,6 +1602,8 @@ void LIB_PART::DeleteSelectedItems()
 
 void LIB_PART::CopySelectedItems( const wxPoint& aOffset )
 {
+    loadDeferredDrawings();
+
     /* *do not* use iterators here, because new items
      * are added to drawings that is a  boost::ptr_vector.
      * When push_back elements in buffer,
@@ -1528,6 +1637,8 @@ void LIB_PART::CopySelectedItems( const wxPoint& aOffset )
 
 void LIB_PART::MirrorSelectedItemsH( const wxPoint& aCenter )
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         if( !item.IsSelected() )
@@ -1542,6 +1653,8 @@ void LIB_PART::MirrorSelectedItemsH( const wxPoint& aCenter )
 
 void LIB_PART::MirrorSelectedItemsV( const wxPoint& aCenter )
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         if( !item.IsSelected() )
@@ -1556,6 +1669,8 @@ void LIB_PART::MirrorSelectedItemsV( const wxPoint& aCenter )
 
 void LIB_PART::RotateSelectedItems( const wxPoint& aCenter )
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         if( !item.IsSelected() )
@@ -1573,6 +1688,8 @@ void LIB_PART::RotateSelectedItems( const wxPoint& aCenter )
 LIB_ITEM* LIB_PART::LocateDrawItem( int aUnit, int aConvert,
                                     KICAD_T aType, const wxPoint& aPoint )
 {
+    loadDeferredDrawings();
+
     BOOST_FOREACH( LIB_ITEM& item, drawings )
     {
         if( ( aUnit && item.m_Unit && ( aUnit != item.m_Unit) )
@@ -1591,6 +1708,8 @@ LIB_ITEM* LIB_PART::LocateDrawItem( int aUnit, int aConvert,
 LIB_ITEM* LIB_PART::LocateDrawItem( int aUnit, int aConvert, KICAD_T aType,
                                     const wxPoint& aPoint, const TRANSFORM& aTransform )
 {
+    loadDeferredDrawings();
+
     /* we use LocateDrawItem( int aUnit, int convert, KICAD_T type, const
      * wxPoint& pt ) to search items.
      * because this function uses DefaultTransform as orient/mirror matrix
@@ -1611,6 +1730,8 @@ LIB_ITEM* LIB_PART::LocateDrawItem( int aUnit, int aConvert, KICAD_T aType,
 
 void LIB_PART::SetUnitCount( int aCount )
 {
+    loadDeferredDrawings();
+
     if( m_unitCount == aCount )
         return;
 
@@ -1658,6 +1779,8 @@ void LIB_PART::SetUnitCount( int aCount )
 
 void LIB_PART::SetConversion( bool aSetConvert )
 {
+    loadDeferredDrawings();
+
     if( aSetConvert == HasConversion() )
         return;
 
@@ -211,6 +211,9 @@ class LIB_PART : public EDA_ITEM
     LIBRENTRYOPTIONS    m_options;          ///< Special part features such as POWER or NORMAL.)
     int                 m_unitCount;        ///< Number of units (parts) per package.
     LIB_ITEMS           drawings;           ///< How to draw this part.
+    std::string         m_deferredDrawings; ///< DRAW section not parsed yet, see Load().
+    int                 m_drawingsDeferred; ///< Not 0 until m_deferredDrawings is parsed,
+                                            ///< see loadDeferredDrawings().
     wxArrayString       m_FootprintList;    /**< List of suitable footprint names for the
                                                  part (wild card names accepted). */
     LIB_ALIASES         m_aliases;          ///< List of alias object pointers associated with the
@@ -226,6 +229,16 @@ class LIB_PART : public EDA_ITEM
 private:
     void deleteAllFields();
 
+    /**
+     * Function loadDeferredDrawings
+     * parses the DRAW section kept by Load() when the draw items were deferred.
+     * Must be called before accessing the draw items (fields excepted).
+     */
+    void loadDeferredDrawings();
+
+    /// Read the DRAW section from \a aReader and keep it unparsed in m_deferredDrawings.
+    bool deferDrawEntries( LINE_READER& aReader, wxString& aErrorMsg );
+
     // LIB_PART()  { }     // not legal
 
 public:
@@ -343,9 +356,12 @@ public:
      *
      * @param aReader A LINE_READER object to load file from.
      * @param aErrorMsg - Description of error on load failure.
+     * @param aDeferDrawings - true to only parse the draw items (except fields) when
+     *                         they are first used.  Errors in the draw items are then
+     *                         only reported as warnings.
      * @return True if the load was successful, false if there was an error.
      */
-    bool Load( LINE_READER& aReader, wxString& aErrorMsg );
+    bool Load( LINE_READER& aReader, wxString& aErrorMsg, bool aDeferDrawings = false );
     bool LoadField( LINE_READER& aReader, wxString& aErrorMsg );
     bool LoadDrawEntries( LINE_READER& aReader, wxString& aErrorMsg );
     bool LoadAliases( char* aLine, wxString& aErrorMsg );
@@ -662,7 +678,11 @@ public:
      *
      * @return LIB_ITEMS& - Reference to the draw item object list.
      */
-    LIB_ITEMS& GetDrawItemList() { return drawings; }
+    LIB_ITEMS& GetDrawItemList()
+    {
+        loadDeferredDrawings();
+        return drawings;
+    }
 
     /**
      * Set the units per part count.
@@ -28,6 +28,7 @@
  */
 
 #include <fctsys.h>
+#include <common.h>
 #include <kiface_i.h>
 #include <gr_basic.h>
 #include <macros.h>
@@ -44,6 +45,8 @@
 #include <class_library.h>
 
 #include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 
 #include <wx/tokenzr.h>
 #include <wx/regex.h>
@@ -455,7 +458,7 @@ LIB_ALIAS* PART_LIB::GetPreviousEntry( const wxString& aName )
 }
 
 
-bool PART_LIB::Load( wxString& aErrorMsg )
+bool PART_LIB::Load( wxString& aErrorMsg, bool aDeferDrawings )
 {
     FILE*          file;
     char*          line;
@@ -564,7 +567,7 @@ bool PART_LIB::Load( wxString& aErrorMsg )
             // Read one DEF/ENDDEF part entry from library:
             LIB_PART* part = new LIB_PART( wxEmptyString, this );
 
-            if( part->Load( reader, msg ) )
+            if( part->Load( reader, msg, aDeferDrawings ) )
             {
                 // Check for duplicate entry names and warn the user about
                 // the potential conflict.
@@ -620,13 +623,14 @@ void PART_LIB::LoadAliases( LIB_PART* aPart )
 bool PART_LIB::LoadHeader( LINE_READER& aLineReader )
 {
     char* line, * text, * data;
+    char* saveptr;      // Libraries are loaded by several threads: no strtok() here
 
     while( aLineReader.ReadLine() )
     {
         line = (char*) aLineReader;
 
-        text = strtok( line, " \t\r\n" );
-        data = strtok( NULL, " \t\r\n" );
+        text = strtok_r( line, " \t\r\n", &saveptr );
+        data = strtok_r( NULL, " \t\r\n", &saveptr );
 
         if( stricmp( text, "TimeStamp" ) == 0 )
             timeStamp = atol( data );
@@ -643,6 +647,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
 {
     int        lineNumber = 0;
     char       line[8000], * name, * text;
+    char*      saveptr;
     LIB_ALIAS* entry;
     FILE*      file;
     wxFileName fn = fileName;
@@ -684,7 +689,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
         }
 
         // Read one $CMP/$ENDCMP part entry from library:
-        name = strtok( line + 5, "\n\r" );
+        name = strtok_r( line + 5, "\n\r", &saveptr );
 
         wxString cmpname = FROM_UTF8( name );
 
@@ -695,7 +700,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
             if( strncmp( line, "$ENDCMP", 7 ) == 0 )
                 break;
 
-            text = strtok( line + 2, "\n\r" );
+            text = strtok_r( line + 2, "\n\r", &saveptr );
 
             if( entry )
             {
@@ -798,15 +803,14 @@ bool PART_LIB::SaveHeader( OUTPUTFORMATTER& aFormatter )
 }
 
 
-PART_LIB* PART_LIB::LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer )
+PART_LIB* PART_LIB::LoadLibrary( const wxString& aFileName, bool aDeferDrawings )
+    throw( IO_ERROR, boost::bad_pointer )
 {
     std::auto_ptr<PART_LIB> lib( new PART_LIB( LIBRARY_TYPE_EESCHEMA, aFileName ) );
 
-    wxBusyCursor ShowWait;
-
     wxString errorMsg;
 
-    if( !lib->Load( errorMsg ) )
+    if( !lib->Load( errorMsg, aDeferDrawings ) )
         THROW_IO_ERROR( errorMsg );
 
     if( USE_OLD_DOC_FILE_FORMAT( lib->versionMajor, lib->versionMinor ) )
@@ -838,6 +842,8 @@ PART_LIB* PART_LIBS::AddLibrary( const wxString& aFileName ) throw( IO_ERROR, bo
         return lib;
 #endif
 
+    wxBusyCursor ShowWait;
+
     lib = PART_LIB::LoadLibrary( aFileName );
 
     push_back( lib );
@@ -858,6 +864,8 @@ PART_LIB* PART_LIBS::AddLibrary( const wxString& aFileName, PART_LIBS::iterator&
         return lib;
 #endif
 
+    wxBusyCursor ShowWait;
+
     lib = PART_LIB::LoadLibrary( aFileName );
 
     if( aIterator >= begin() && aIterator < end() )
@@ -1102,6 +1110,44 @@ const wxString PART_LIBS::CacheName( const wxString& aFullProjectFilename )
 }
 
 
+/// A library to load by PART_LIBS::LoadAllLibraries().
+struct LIBRARY_LOAD_JOB
+{
+    wxString    m_FileName;
+    PART_LIB*   m_Library;      ///< the loaded library, owned by the job until added.
+    bool        m_Failed;
+    wxString    m_Error;
+
+    LIBRARY_LOAD_JOB() : m_Library( NULL ), m_Failed( false ) {}
+};
+
+typedef std::vector<LIBRARY_LOAD_JOB> LIBRARY_LOAD_JOBS;
+
+
+/**
+ * Function loadLibraryJobs
+ * is the worker thread function of PART_LIBS::LoadAllLibraries(): it loads the
+ * libraries of aJobs[ii], for ii = aFirst, aFirst + aStep ...
+ */
+static void loadLibraryJobs( LIBRARY_LOAD_JOBS* aJobs, unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aJobs->size(); ii += aStep )
+    {
+        LIBRARY_LOAD_JOB& job = (*aJobs)[ii];
+
+        try
+        {
+            job.m_Library = PART_LIB::LoadLibrary( job.m_FileName, true );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            job.m_Failed = true;
+            job.m_Error  = ioe.errorText;
+        }
+    }
+}
+
+
 void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::bad_pointer )
 {
     wxFileName      fn;
@@ -1123,6 +1169,8 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
 
     wxASSERT( !size() );    // expect to load into "this" empty container.
 
+    std::vector<wxString> filenames;
+
     for( unsigned i = 0; i < lib_names.GetCount();  ++i )
     {
         fn.Clear();
@@ -1149,21 +1197,67 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
             filename = fn.GetFullPath();
         }
 
-        try
-        {
-            AddLibrary( filename );
-        }
-        catch( const IO_ERROR& ioe )
+        filenames.push_back( filename );
+    }
+
+    wxBusyCursor ShowWait;
+
+    LIBRARY_LOAD_JOBS jobs( filenames.size() );
+
+    for( unsigned i = 0; i < filenames.size();  ++i )
+        jobs[i].m_FileName = filenames[i];
+
+    {
+        // Keep LOCALE_IO::C_count at 1 or greater for the duration of all worker threads,
+        // see FOOTPRINT_LIST::ReadFootprintFiles().
+        LOCALE_IO   top_most_nesting;
+
+        unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+        threadCount = std::min( threadCount, (unsigned) jobs.size() );
+
+        // Something which will not invoke a thread copy constructor
+        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+        MYTHREADS threads;
+
+        for( unsigned ii = 1; ii < threadCount; ii++ )
+            threads.push_back( new boost::thread( &loadLibraryJobs, &jobs, ii, threadCount ) );
+
+        loadLibraryJobs( &jobs, 0, std::max( 1u, threadCount ) );
+
+        for( unsigned ii = 0; ii < threads.size(); ++ii )
+            threads[ii].join();
+    }
+
+    // Add the libraries in the project order, and report the first error in that
+    // order, as if they were loaded one after another.
+    for( unsigned i = 0; i < jobs.size();  ++i )
+    {
+        LIBRARY_LOAD_JOB& job = jobs[i];
+
+        if( job.m_Failed )
         {
+            for( unsigned j = i + 1; j < jobs.size();  ++j )
+                delete jobs[j].m_Library;
+
             wxString msg = wxString::Format( _(
                     "Part library '%s' failed to load. Error:\n"
                     "%s" ),
-                    GetChars( filename ),
-                    GetChars( ioe.errorText )
+                    GetChars( job.m_FileName ),
+                    GetChars( job.m_Error )
                     );
 
             THROW_IO_ERROR( msg );
         }
+
+        // Don't add the library if it is already loaded, like AddLibrary() does.
+        if( FindLibrary( job.m_Library->GetName() ) )
+        {
+            delete job.m_Library;
+            continue;
+        }
+
+        push_back( job.m_Library );
     }
 
     // add the special cache library.
@@ -1174,7 +1268,14 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
     {
         try
         {
-            cache_lib = AddLibrary( cache_name );
+            cache_lib = FindLibrary( wxFileName( cache_name ).GetName() );
+
+            if( !cache_lib )
+            {
+                cache_lib = PART_LIB::LoadLibrary( cache_name, true );
+                push_back( cache_lib );
+            }
+
             if( cache_lib )
                 cache_lib->SetCache();
         }
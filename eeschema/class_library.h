@@ -236,6 +236,8 @@ public:
      * Function LoadAllLibraries
      * loads all of the project's libraries into this container, which should
      * be cleared before calling it.
+     * Libraries are loaded by worker threads, and the draw items of their parts
+     * are only parsed when first used.
      */
     void LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::bad_pointer );
 
@@ -385,9 +387,11 @@ public:
      * Load library from file.
      *
      * @param aErrorMsg - Error message if load fails.
+     * @param aDeferDrawings - true to parse the draw items of each part only when
+     *                         first used, see LIB_PART::Load().
      * @return True if load was successful otherwise false.
      */
-    bool Load( wxString& aErrorMsg );
+    bool Load( wxString& aErrorMsg, bool aDeferDrawings = false );
 
     bool LoadDocs( wxString& aErrorMsg );
 
@@ -645,12 +649,17 @@ public:
      * Function LoadLibrary
      * allocates and loads a part library file.
      *
+     * It does not use the GUI, so it can be called from a worker thread.
+     *
      * @param aFileName - File name of the part library to load.
+     * @param aDeferDrawings - true to parse the draw items of each part only when
+     *                         first used, see LIB_PART::Load().
      * @return PART_LIB* - the allocated and loaded PART_LIB, which is owned by
      *   the caller.
      * @throw IO_ERROR if there's any problem loading the library.
      */
-    static PART_LIB* LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer );
+    static PART_LIB* LoadLibrary( const wxString& aFileName, bool aDeferDrawings = false )
+        throw( IO_ERROR, boost::bad_pointer );
 
     /**
      * Function HasPowerParts
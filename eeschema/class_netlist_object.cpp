@@ -36,6 +36,7 @@
 #include <class_netlist_object.h>
 
 #include <wx/regex.h>
+#include <ki_mutex.h>
 
 
 /**
@@ -45,12 +46,18 @@
  */
 static wxRegEx busLabelRe( wxT( "^([^[:space:]]+)(\\[[\\d]+\\.+[\\d]+\\])$" ), wxRE_ADVANCED );
 
+/// busLabelRe keeps the last match: lock this when using it, because net list items
+/// are created by several threads.
+static MUTEX busLabelReLock;
+
 
 bool IsBusLabel( const wxString& aLabel )
 {
     wxCHECK_MSG( busLabelRe.IsValid(), false,
                  wxT( "Invalid regular expression in IsBusLabel()." ) );
 
+    MUTLOCK lock( busLabelReLock );
+
     return busLabelRe.Matches( aLabel );
 }
 
@@ -258,8 +265,15 @@ void NETLIST_OBJECT::ConvertBusToNetListItems( NETLIST_OBJECT_LIST& aNetListItem
     wxString tmp, busName, busNumber;
     long begin, end, member;
 
-    busName = busLabelRe.GetMatch( m_Label, 1 );
-    busNumber = busLabelRe.GetMatch( m_Label, 2 );
+    {
+        MUTLOCK lock( busLabelReLock );
+
+        if( !busLabelRe.Matches( m_Label ) )
+            return;
+
+        busName = busLabelRe.GetMatch( m_Label, 1 );
+        busNumber = busLabelRe.GetMatch( m_Label, 2 );
+    }
 
     /* Search for  '[' because a bus label is like "busname[nn..mm]" */
     i = busNumber.Find( '[' );
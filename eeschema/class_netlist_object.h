@@ -35,6 +35,7 @@
 #include <sch_sheet_path.h>
 #include <lib_pin.h>      // LIB_PIN::PinStringNum( m_PinNum )
 #include <sch_item_struct.h>
+#include <sch_connection_index.h>
 
 class NETLIST_OBJECT_LIST;
 class SCH_COMPONENT;
@@ -276,6 +277,16 @@ class NETLIST_OBJECT_LIST : public NETLIST_OBJECTS
     int m_lastBusNetCode;   // Used in intermediate calculation:
                             // last net code created for bus members
 
+    // Disjoint-set forests used to merge net codes (and bus net codes) in intermediate
+    // calculations: m_netCodeParent[code] is the code this net code was merged into,
+    // or the code itself. Codes outside the vector are not merged.
+    std::vector<int> m_netCodeParent;
+    std::vector<int> m_busNetCodeParent;
+
+    // Connection points and segments of the sheet currently analyzed by
+    // BuildNetListInfo(). Ids are indexes in list.
+    SCH_CONNECTION_INDEX m_sheetConnections;
+
 public:
     /**
      * Constructor.
@@ -385,10 +396,18 @@ private:
     /*
      * Propagate aNewNetCode to items having an internal netcode aOldNetCode
      * used to interconnect group of items already physically connected,
-     * when a new connection is found between aOldNetCode and aNewNetCode
+     * when a new connection is found between aOldNetCode and aNewNetCode.
+     * Items are not updated: the two codes are merged in m_netCodeParent (or
+     * m_busNetCodeParent), and item codes are updated by resolveNetCodes()
      */
     void propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
 
+    /*
+     * Set the net code and the bus net code of each item to the code of the net
+     * it was merged into by propageNetCode()
+     */
+    void resolveNetCodes();
+
     /*
      * This function merges the net codes of groups of objects already connected
      * to labels (wires, bus, pins ... ) when 2 labels are equivalents
@@ -416,16 +435,26 @@ private:
      */
     void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
 
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    /*
+     * Fill m_sheetConnections with the items of the sheet starting at index aIdxStart.
+     * The list of objects is expected sorted by sheets.
+     */
+    void buildSheetConnections( unsigned aIdxStart );
+
+    /*
+     * Search items having an end point connected to an end point of aRef,
+     * and propagate the aRef net code to them.
+     * Search is made in the items of m_sheetConnections (the sheet of aRef).
+     */
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus );
 
     /*
      * Search connections betweena junction and segments
      * Propagate the junction net code to objects connected by this junction.
      * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
+     * Search is made in the segments of m_sheetConnections (the sheet of aJonction).
      */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus );
 
     void connectBusLabels();
 
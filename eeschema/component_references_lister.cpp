@@ -38,6 +38,7 @@
 #include <schframe.h>
 #include <sch_reference_list.h>
 #include <sch_component.h>
+#include <hashtables.h>
 
 #include <boost/foreach.hpp>
 
@@ -231,6 +232,48 @@ void SCH_REFERENCE_LIST::GetRefsInUse( int aIndex, std::vector< int >& aIdList,
 }
 
 
+int SCH_REFERENCE_LIST::findUnit( const std::vector<unsigned>& aCandidates, size_t aIndex,
+                                  int aUnit )
+{
+    const SCH_REFERENCE& ref = componentFlatList[aIndex];
+    int                  found = -1;
+
+    for( unsigned ii = 0; ii < aCandidates.size(); ii++ )
+    {
+        unsigned idx = aCandidates[ii];
+        const SCH_REFERENCE& candidate = componentFlatList[idx];
+
+        if(  ( aIndex == idx )
+          || ( candidate.m_IsNew )
+          || ( candidate.m_NumRef != ref.m_NumRef )
+          || ( ref.CompareRef( candidate ) != 0 ) )
+            continue;
+
+        // Keep the lowest index, as the plain linear search in FindUnit() would.
+        if( candidate.m_Unit == aUnit && ( found < 0 || (int) idx < found ) )
+            found = (int) idx;
+    }
+
+    return found;
+}
+
+
+void SCH_REFERENCE_LIST::getRefsInUse( const std::vector<unsigned>& aPrefixItems,
+                                       std::vector< int >& aIdList, int aMinRefId )
+{
+    aIdList.clear();
+
+    for( unsigned ii = 0; ii < aPrefixItems.size(); ii++ )
+    {
+        if( componentFlatList[aPrefixItems[ii]].m_NumRef >= aMinRefId )
+            aIdList.push_back( componentFlatList[aPrefixItems[ii]].m_NumRef );
+    }
+
+    sort( aIdList.begin(), aIdList.end() );
+    aIdList.erase( unique( aIdList.begin(), aIdList.end() ), aIdList.end() );
+}
+
+
 int SCH_REFERENCE_LIST::GetLastReference( int aIndex, int aMinValue )
 {
     int lastNumber = aMinValue;
@@ -285,6 +328,66 @@ int SCH_REFERENCE_LIST::CreateFirstFreeRefId( std::vector<int>& aIdList, int aFi
 }
 
 
+/* Lookup tables used by Annotate() to avoid scanning the whole flattened list for every
+ * component.  They only hold indices into componentFlatList; every candidate found through
+ * them is checked again against the same conditions as the plain linear searches, so a
+ * stale or colliding entry can cost some time but never change the result.
+ */
+typedef std::vector<unsigned>                                           FLAT_INDEX_LIST;
+
+/// Reference prefix ("U", "IC" ...) to the items using it.
+typedef boost::unordered_map< std::string, FLAT_INDEX_LIST >            PREFIX_ITEMS_MAP;
+
+/// Reference prefix and reference number to the items which have been given that number.
+typedef boost::unordered_map< std::pair< std::string, int >, FLAT_INDEX_LIST > REF_NUMBER_ITEMS_MAP;
+
+/// Reference prefix, value and library part name to the items sharing them.
+typedef boost::unordered_map< wxString, FLAT_INDEX_LIST, WXSTRING_HASH > PART_ITEMS_MAP;
+
+/// Schematic component to its items (one per sheet path the component is used in).
+typedef boost::unordered_map< SCH_COMPONENT*, FLAT_INDEX_LIST >         COMPONENT_ITEMS_MAP;
+
+/// Schematic component to the locked unit lists which hold one of its instances.
+typedef std::vector< std::pair< SCH_REFERENCE_LIST*, unsigned > >       LOCKED_REF_LIST;
+typedef boost::unordered_map< SCH_COMPONENT*, LOCKED_REF_LIST >         LOCKED_REFS_MAP;
+
+
+static wxString partItemsKey( const SCH_REFERENCE& aItem, const wxString& aValue,
+                              const wxString& aPartName )
+{
+    // Tabs are not expected in any of these strings.  A collision would only merge two
+    // buckets, which is harmless since candidates are always compared in full.
+#ifdef KICAD_KEEPCASE
+    return aItem.GetRef() + wxT( '\t' ) + aValue + wxT( '\t' ) + aPartName;
+#else
+    // CompareValue() and CompareLibName() ignore the case: so must the key, or parts
+    // which only differ by case would never be found in the same bucket.
+    return aItem.GetRef() + wxT( '\t' ) + aValue.Lower() + wxT( '\t' ) + aPartName.Lower();
+#endif
+}
+
+
+int SCH_REFERENCE_LIST::CreateFirstFreeRefId( std::vector<int>& aIdList, int aFirstValue,
+                                              unsigned& aScanStart )
+{
+    // aIdList[0 .. aScanStart-1] is known to hold aFirstValue .. aFirstValue + aScanStart - 1
+    // without any hole, so the search for the next hole can resume from there.
+    int      expectedId = aFirstValue + aScanStart;
+    unsigned ii = aScanStart;
+
+    while( ii < aIdList.size() && aIdList[ii] == expectedId )
+    {
+        ii++;
+        expectedId++;
+    }
+
+    aIdList.insert( aIdList.begin() + ii, expectedId );
+    aScanStart = ii + 1;
+
+    return expectedId;
+}
+
+
 void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
       SCH_MULTI_UNIT_REFERENCE_MAP aLockedUnitMap )
 {
@@ -297,6 +400,35 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
     // Components with an invisible reference (power...) always are re-annotated.
     ResetHiddenReferences();
 
+    // Build the lookup tables once, instead of walking the full list for each component.
+    PREFIX_ITEMS_MAP     prefixItems;
+    REF_NUMBER_ITEMS_MAP refNumberItems;
+    PART_ITEMS_MAP       partItems;
+    COMPONENT_ITEMS_MAP  componentItems;
+    LOCKED_REFS_MAP      lockedRefs;
+
+    for( unsigned ii = 0; ii < componentFlatList.size(); ii++ )
+    {
+        SCH_REFERENCE& item = componentFlatList[ii];
+
+        prefixItems[item.m_Ref].push_back( ii );
+        refNumberItems[std::make_pair( (std::string) item.m_Ref, item.m_NumRef )].push_back( ii );
+        partItems[partItemsKey( item, item.m_Value->GetText(),
+                                item.m_RootCmp->GetPartName() )].push_back( ii );
+        componentItems[item.m_RootCmp].push_back( ii );
+    }
+
+    BOOST_FOREACH( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair, aLockedUnitMap )
+    {
+        unsigned n_refs = pair.second.GetCount();
+
+        for( unsigned thisRefI = 0; thisRefI < n_refs; ++thisRefI )
+        {
+            lockedRefs[pair.second[thisRefI].GetComp()].push_back(
+                    std::make_pair( &pair.second, thisRefI ) );
+        }
+    }
+
     /* calculate index of the first component with the same reference prefix
      * than the current component.  All components having the same reference
      * prefix will receive a reference number with consecutive values:
@@ -323,7 +455,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
     // This is the list of all Id already in use for a given reference prefix.
     // Will be refilled for each new reference prefix.
     std::vector<int>idList;
-    GetRefsInUse( first, idList, minRefId );
+    unsigned idScanStart = 0;
+    getRefsInUse( prefixItems[componentFlatList[first].m_Ref], idList, minRefId );
 #endif
     for( unsigned ii = 0; ii < componentFlatList.size(); ii++ )
     {
@@ -332,20 +465,20 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
 
         // Check whether this component is in aLockedUnitMap.
         SCH_REFERENCE_LIST* lockedList = NULL;
-        BOOST_FOREACH( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair, aLockedUnitMap )
+        LOCKED_REFS_MAP::iterator locked = lockedRefs.find( componentFlatList[ii].m_RootCmp );
+
+        if( locked != lockedRefs.end() )
         {
-            unsigned n_refs = pair.second.GetCount();
-            for( unsigned thisRefI = 0; thisRefI < n_refs; ++thisRefI )
+            for( unsigned jj = 0; jj < locked->second.size(); jj++ )
             {
-                SCH_REFERENCE &thisRef = pair.second[thisRefI];
+                SCH_REFERENCE_LIST* list = locked->second[jj].first;
 
-                if( thisRef.IsSameInstance( componentFlatList[ii] ) )
+                if( (*list)[locked->second[jj].second].IsSameInstance( componentFlatList[ii] ) )
                 {
-                    lockedList = &pair.second;
+                    lockedList = list;
                     break;
                 }
             }
-            if( lockedList != NULL ) break;
         }
 
         if(  ( componentFlatList[first].CompareRef( componentFlatList[ii] ) != 0 )
@@ -368,7 +501,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
             if( aUseSheetNum )
                 minRefId = componentFlatList[ii].m_SheetNum * aSheetIntervalId + 1;
 
-            GetRefsInUse( first, idList, minRefId );
+            idScanStart = 0;
+            getRefsInUse( prefixItems[componentFlatList[first].m_Ref], idList, minRefId );
 #endif
         }
 
@@ -380,7 +514,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
 #ifdef USE_OLD_ALGO
                 LastReferenceNumber++;
 #else
-                LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
+                LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId, idScanStart );
 #endif
                 componentFlatList[ii].m_NumRef = LastReferenceNumber;
             }
@@ -399,9 +533,11 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
 #ifdef USE_OLD_ALGO
             LastReferenceNumber++;
 #else
-            LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
+            LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId, idScanStart );
 #endif
             componentFlatList[ii].m_NumRef = LastReferenceNumber;
+            refNumberItems[std::make_pair( (std::string) componentFlatList[ii].m_Ref,
+                                           LastReferenceNumber )].push_back( ii );
 
             if( !componentFlatList[ii].IsUnitsLocked() )
                 componentFlatList[ii].m_Unit = 1;
@@ -427,13 +563,26 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
                 if( thisRef.CompareLibName( componentFlatList[ii] ) != 0 ) continue;
 
                 // Find the matching component
-                for( unsigned jj = ii + 1; jj < componentFlatList.size(); jj++ )
+                COMPONENT_ITEMS_MAP::iterator instances = componentItems.find( thisRef.GetComp() );
+
+                if( instances == componentItems.end() )
+                    continue;
+
+                const FLAT_INDEX_LIST& candidates = instances->second;
+
+                for( FLAT_INDEX_LIST::const_iterator it =
+                        std::upper_bound( candidates.begin(), candidates.end(), ii );
+                     it != candidates.end(); ++it )
                 {
+                    unsigned jj = *it;
+
                     if( ! thisRef.IsSameInstance( componentFlatList[jj] ) ) continue;
                     componentFlatList[jj].m_NumRef = componentFlatList[ii].m_NumRef;
                     componentFlatList[jj].m_Unit = thisRef.m_Unit;
                     componentFlatList[jj].m_IsNew = false;
                     componentFlatList[jj].m_Flag = 1;
+                    refNumberItems[std::make_pair( (std::string) componentFlatList[jj].m_Ref,
+                                                   componentFlatList[jj].m_NumRef )].push_back( jj );
                     break;
                 }
             }
@@ -445,19 +594,31 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
             * we search for others parts that have the same value and the same
             * reference prefix (ref without ref number)
             */
+            const FLAT_INDEX_LIST& sameNumber =
+                refNumberItems[std::make_pair( (std::string) componentFlatList[ii].m_Ref,
+                                               componentFlatList[ii].m_NumRef )];
+            const FLAT_INDEX_LIST& samePart =
+                partItems[partItemsKey( componentFlatList[ii],
+                                        componentFlatList[ii].m_Value->GetText(),
+                                        componentFlatList[ii].m_RootCmp->GetPartName() )];
+
             for( Unit = 1; Unit <= NumberOfUnits; Unit++ )
             {
                 if( componentFlatList[ii].m_Unit == Unit )
                     continue;
 
-                int found = FindUnit( ii, Unit );
+                int found = findUnit( sameNumber, ii, Unit );
 
                 if( found >= 0 )
                     continue; // this unit exists for this reference (unit already annotated)
 
                 // Search a component to annotate ( same prefix, same value, not annotated)
-                for( unsigned jj = ii + 1; jj < componentFlatList.size(); jj++ )
+                for( FLAT_INDEX_LIST::const_iterator it =
+                        std::upper_bound( samePart.begin(), samePart.end(), ii );
+                     it != samePart.end(); ++it )
                 {
+                    unsigned jj = *it;
+
                     if( componentFlatList[jj].m_Flag )    // already tested
                         continue;
 
@@ -481,6 +642,8 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId,
                         componentFlatList[jj].m_Unit   = Unit;
                         componentFlatList[jj].m_Flag   = 1;
                         componentFlatList[jj].m_IsNew  = false;
+                        refNumberItems[std::make_pair( (std::string) componentFlatList[jj].m_Ref,
+                                                       componentFlatList[jj].m_NumRef )].push_back( jj );
                         break;
                     }
                 }
@@ -24,6 +24,7 @@
 #include <component_tree_search_container.h>
 
 #include <algorithm>
+#include <iterator>
 #include <boost/foreach.hpp>
 #include <set>
 
@@ -103,6 +104,7 @@ COMPONENT_TREE_SEARCH_CONTAINER::COMPONENT_TREE_SEARCH_CONTAINER( PART_LIBS* aLi
       m_libraries_added( 0 ),
       m_components_added( 0 ),
       m_preselect_unit_number( -1 ),
+      m_last_matches_valid( false ),
       m_libs( aLibs ),
       m_filter( CMP_FILTER_NONE )
 {
@@ -195,6 +197,7 @@ void COMPONENT_TREE_SEARCH_CONTAINER::AddAliasList( const wxString& aNodeName,
         TREE_NODE* alias_node = new TREE_NODE( TREE_NODE::TYPE_ALIAS, lib_node,
                                                a, a->GetName(), display_info, search_text );
         m_nodes.push_back( alias_node );
+        indexAliasNode( alias_node );
 
         if( a->GetPart()->IsMulti() )    // Add all units as sub-nodes.
         {
@@ -213,6 +216,71 @@ void COMPONENT_TREE_SEARCH_CONTAINER::AddAliasList( const wxString& aNodeName,
 
         ++m_components_added;
     }
+
+    m_last_matches_valid = false;
+}
+
+
+// Key of the trigram starting at aPos in aText. Characters are at most 21 bits wide.
+static unsigned long long trigramKey( const wxString& aText, size_t aPos )
+{
+    return ( (unsigned long long) aText[aPos].GetValue() << 42 )
+         | ( (unsigned long long) aText[aPos + 1].GetValue() << 21 )
+         | (unsigned long long) aText[aPos + 2].GetValue();
+}
+
+
+static void getTrigrams( const wxString& aText, std::vector<unsigned long long>& aKeys )
+{
+    for( size_t ii = 0; ii + 2 < aText.length(); ++ii )
+        aKeys.push_back( trigramKey( aText, ii ) );
+}
+
+
+void COMPONENT_TREE_SEARCH_CONTAINER::indexAliasNode( TREE_NODE* aNode )
+{
+    const unsigned id = m_alias_nodes.size();
+    m_alias_nodes.push_back( aNode );
+
+    // All the texts a term is searched in, see UpdateSearchTerm().
+    std::vector<unsigned long long> keys;
+    getTrigrams( aNode->MatchName, keys );
+    getTrigrams( aNode->Parent->MatchName, keys );
+    getTrigrams( aNode->SearchText, keys );
+
+    std::sort( keys.begin(), keys.end() );
+    keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+
+    // Ids are increasing, so the id lists stay sorted.
+    BOOST_FOREACH( unsigned long long key, keys )
+        m_trigram_index[key].push_back( id );
+}
+
+
+void COMPONENT_TREE_SEARCH_CONTAINER::narrowCandidates( const wxString& aTerm,
+                                                        std::vector<unsigned>& aCandidates ) const
+{
+    std::vector<unsigned long long> keys;
+    getTrigrams( aTerm, keys );
+
+    std::vector<unsigned> narrowed;
+
+    for( size_t ii = 0; ii < keys.size() && !aCandidates.empty(); ++ii )
+    {
+        TRIGRAM_INDEX::const_iterator it = m_trigram_index.find( keys[ii] );
+
+        if( it == m_trigram_index.end() )
+        {
+            aCandidates.clear();
+            break;
+        }
+
+        narrowed.clear();
+        std::set_intersection( aCandidates.begin(), aCandidates.end(),
+                               it->second.begin(), it->second.end(),
+                               std::back_inserter( narrowed ) );
+        aCandidates.swap( narrowed );
+    }
 }
 
 
@@ -259,17 +327,44 @@ void COMPONENT_TREE_SEARCH_CONTAINER::UpdateSearchTerm( const wxString& aSearch
     unsigned starttime =  GetRunningMicroSecs();
 #endif
 
-    // We score the list by going through it several time, essentially with a complexity
-    // of O(n). For the default library of 2000+ items, this typically takes less than 5ms
-    // on an i5. Good enough, no index needed.
+    // Only candidates are scored. All the terms must be found (AND semantics), so when
+    // the search string only extends the previous one (the user is typing), the
+    // candidates are the previous matches. Then the trigram index of each term narrows
+    // down the candidates, which are checked by the scoring below.
+    std::vector<unsigned> candidates;
+
+    if( m_last_matches_valid && aSearch.StartsWith( m_last_search ) )
+    {
+        candidates = m_last_matches;
+    }
+    else
+    {
+        candidates.resize( m_alias_nodes.size() );
+
+        for( unsigned ii = 0; ii < candidates.size(); ++ii )
+            candidates[ii] = ii;
+    }
 
-    // Initial AND condition: Leaf nodes are considered to match initially.
+    // Split and lowercase the search string once, for both the narrowing and the scoring.
+    std::vector<wxString> terms;
+    wxStringTokenizer     tokenizer( aSearch );
+
+    while( tokenizer.HasMoreTokens() )
+        terms.push_back( tokenizer.GetNextToken().Lower() );
+
+    for( unsigned ii = 0; ii < terms.size() && !candidates.empty(); ++ii )
+        narrowCandidates( terms[ii], candidates );
+
+    // Initial AND condition: candidate nodes are considered to match initially.
     BOOST_FOREACH( TREE_NODE* node, m_nodes )
     {
         node->PreviousScore = node->MatchScore;
-        node->MatchScore = ( node->Type == TREE_NODE::TYPE_LIB ) ? 0 : kLowestDefaultScore;
+        node->MatchScore = 0;
     }
 
+    BOOST_FOREACH( unsigned id, candidates )
+        m_alias_nodes[id]->MatchScore = kLowestDefaultScore;
+
     // Create match scores for each node for all the terms, that come space-separated.
     // Scoring adds up values for each term according to importance of the match. If a term does
     // not match at all, the result is thrown out of the results (AND semantics).
@@ -281,16 +376,11 @@ void COMPONENT_TREE_SEARCH_CONTAINER::UpdateSearchTerm( const wxString& aSearch
     //     first so contribute more to the score.
     //
     // This is of course subject to tweaking.
-    wxStringTokenizer tokenizer( aSearch );
-
-    while ( tokenizer.HasMoreTokens() )
+    BOOST_FOREACH( const wxString& term, terms )
     {
-        const wxString term = tokenizer.GetNextToken().Lower();
-
-        BOOST_FOREACH( TREE_NODE* node, m_nodes )
+        BOOST_FOREACH( unsigned id, candidates )
         {
-            if( node->Type != TREE_NODE::TYPE_ALIAS )
-                continue;      // Only aliases are actually scored here.
+            TREE_NODE* node = m_alias_nodes[id];
 
             if( node->MatchScore == 0)
                 continue;   // Leaf node without score are out of the game.
@@ -325,6 +415,17 @@ void COMPONENT_TREE_SEARCH_CONTAINER::UpdateSearchTerm( const wxString& aSearch
         }
     }
 
+    m_last_search = aSearch;
+    m_last_matches.clear();
+
+    BOOST_FOREACH( unsigned id, candidates )
+    {
+        if( m_alias_nodes[id]->MatchScore > 0 )
+            m_last_matches.push_back( id );
+    }
+
+    m_last_matches_valid = true;
+
     // Library nodes have the maximum score seen in any of their children.
     // Alias nodes have the score of their parents.
     unsigned highest_score_seen = 0;
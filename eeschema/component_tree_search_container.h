@@ -25,6 +25,7 @@
 #define COMPONENT_TREE_SEARCH_CONTAINER_H
 
 #include <vector>
+#include <boost/unordered_map.hpp>
 #include <wx/string.h>
 
 class LIB_ALIAS;
@@ -40,6 +41,9 @@ class wxArrayString;
 //
 // The scored result list is adpated on each update on the search-term: this allows
 // to have a search-as-you-type experience.
+// Components are indexed by the trigrams of their name and search text, and a search
+// term extending the previous one only re-scores the previous results, so this scales
+// to libraries of tens of thousands of components.
 class COMPONENT_TREE_SEARCH_CONTAINER
 {
 public:
@@ -129,7 +133,27 @@ private:
     struct TREE_NODE;
     static bool scoreComparator( const TREE_NODE* a1, const TREE_NODE* a2 );
 
+    /// Alias node ids (indexes in m_alias_nodes) containing a given trigram, sorted.
+    typedef boost::unordered_map< unsigned long long, std::vector<unsigned> > TRIGRAM_INDEX;
+
+    /** Function indexAliasNode
+     * Add an alias node to m_alias_nodes and to the trigram index.
+     */
+    void indexAliasNode( TREE_NODE* aNode );
+
+    /** Function narrowCandidates
+     * Keep in aCandidates (sorted alias node ids) only the nodes which can contain aTerm,
+     * according to the trigram index. Terms shorter than a trigram do not narrow anything.
+     */
+    void narrowCandidates( const wxString& aTerm, std::vector<unsigned>& aCandidates ) const;
+
     std::vector<TREE_NODE*> m_nodes;
+    std::vector<TREE_NODE*> m_alias_nodes;  ///< Alias nodes, in the order they were added.
+    TRIGRAM_INDEX m_trigram_index;
+
+    wxString m_last_search;                 ///< Search string of the last update.
+    std::vector<unsigned> m_last_matches;   ///< Alias node ids matching m_last_search.
+    bool m_last_matches_valid;
     wxTreeCtrl* m_tree;
     int m_libraries_added;
     int m_components_added;
@@ -34,6 +34,7 @@
 #include <trigo.h>
 #include <wxstruct.h>
 #include <richio.h>
+#include <line_scanner.h>
 #include <base_units.h>
 #include <msgpanel.h>
 
@@ -124,23 +125,32 @@ bool LIB_ARC::Save( OUTPUTFORMATTER& aFormatter )
 
 bool LIB_ARC::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
-    int startx, starty, endx, endy, cnt;
-    char tmp[256] = "";
-    char* line = (char*) aLineReader;
+    int          startx, starty, endx, endy, cnt;
+    char         fill = 0;
+    int*         values[] = { &m_Pos.x, &m_Pos.y, &m_Radius, &m_t1, &m_t2, &m_Unit,
+                              &m_Convert, &m_Width };
+    int*         ends[] = { &startx, &starty, &endx, &endy };
+    LINE_SCANNER scanner( aLineReader.Line() + 2 );
+
+    for( cnt = 0; cnt < 8 && scanner.ParseInt( *values[cnt] ); cnt++ )
+        ;
 
-    cnt = sscanf( line + 2, "%d %d %d %d %d %d %d %d %255s %d %d %d %d",
-                  &m_Pos.x, &m_Pos.y, &m_Radius, &m_t1, &m_t2, &m_Unit,
-                  &m_Convert, &m_Width, tmp, &startx, &starty, &endx, &endy );
     if( cnt < 8 )
     {
         aErrorMsg.Printf( _( "Arc only had %d parameters of the required 8" ), cnt );
         return false;
     }
 
-    if( tmp[0] == 'F' )
+    if( scanner.ParseChar( fill ) )
+    {
+        for( cnt = 9; cnt < 13 && scanner.ParseInt( *ends[cnt - 9] ); cnt++ )
+            ;
+    }
+
+    if( fill == 'F' )
         m_Fill = FILLED_SHAPE;
 
-    if( tmp[0] == 'f' )
+    if( fill == 'f' )
         m_Fill = FILLED_WITH_BG_BODYCOLOR;
 
     NORMALIZE_ANGLE_POS( m_t1 );
@@ -34,6 +34,7 @@
 #include <wxstruct.h>
 #include <bezier_curves.h>
 #include <richio.h>
+#include <line_scanner.h>
 #include <base_units.h>
 #include <msgpanel.h>
 
@@ -71,12 +72,14 @@ bool LIB_BEZIER::Save( OUTPUTFORMATTER& aFormatter )
 
 bool LIB_BEZIER::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
-    char*   p;
-    int     i, ccount = 0;
-    wxPoint pt;
-    char*   line = (char*) aLineReader;
+    int          i, ccount = 0;
+    char         fill = 0;
+    wxPoint      pt;
+    int*         values[] = { &ccount, &m_Unit, &m_Convert, &m_Width };
+    LINE_SCANNER scanner( aLineReader.Line() + 2 );
 
-    i = sscanf( line + 2, "%d %d %d %d", &ccount, &m_Unit, &m_Convert, &m_Width );
+    for( i = 0; i < 4 && scanner.ParseInt( *values[i] ); i++ )
+        ;
 
     if( i !=4 )
     {
@@ -90,24 +93,15 @@ bool LIB_BEZIER::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
         return false;
     }
 
-    strtok( line + 2, " \t\n" );     // Skip field
-    strtok( NULL, " \t\n" );         // Skip field
-    strtok( NULL, " \t\n" );         // Skip field
-    strtok( NULL, " \t\n" );
-
     for( i = 0; i < ccount; i++ )
     {
-        p = strtok( NULL, " \t\n" );
-
-        if( sscanf( p, "%d", &pt.x ) != 1 )
+        if( !scanner.ParseInt( pt.x ) )
         {
             aErrorMsg.Printf( _( "Bezier point %d X position not defined" ), i );
             return false;
         }
 
-        p = strtok( NULL, " \t\n" );
-
-        if( sscanf( p, "%d", &pt.y ) != 1 )
+        if( !scanner.ParseInt( pt.y ) )
         {
             aErrorMsg.Printf( _( "Bezier point %d Y position not defined" ), i );
             return false;
@@ -118,12 +112,12 @@ bool LIB_BEZIER::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 
     m_Fill = NO_FILL;
 
-    if( ( p = strtok( NULL, " \t\n" ) ) != NULL )
+    if( scanner.ParseChar( fill ) )
     {
-        if( p[0] == 'F' )
+        if( fill == 'F' )
             m_Fill = FILLED_SHAPE;
 
-        if( p[0] == 'f' )
+        if( fill == 'f' )
             m_Fill = FILLED_WITH_BG_BODYCOLOR;
     }
 
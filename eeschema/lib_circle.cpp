@@ -35,6 +35,7 @@
 #include <trigo.h>
 #include <wxstruct.h>
 #include <richio.h>
+#include <line_scanner.h>
 #include <base_units.h>
 #include <msgpanel.h>
 
@@ -65,11 +66,13 @@ bool LIB_CIRCLE::Save( OUTPUTFORMATTER& aFormatter )
 
 bool LIB_CIRCLE::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
-    char tmp[256];
-    char* line = (char*) aLineReader;
+    int          cnt;
+    char         fill = 0;
+    int*         values[] = { &m_Pos.x, &m_Pos.y, &m_Radius, &m_Unit, &m_Convert, &m_Width };
+    LINE_SCANNER scanner( aLineReader.Line() + 2 );
 
-    int  cnt = sscanf( line + 2, "%d %d %d %d %d %d %255s", &m_Pos.x, &m_Pos.y,
-                       &m_Radius, &m_Unit, &m_Convert, &m_Width, tmp );
+    for( cnt = 0; cnt < 6 && scanner.ParseInt( *values[cnt] ); cnt++ )
+        ;
 
     if( cnt < 6 )
     {
@@ -77,10 +80,12 @@ bool LIB_CIRCLE::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
         return false;
     }
 
-    if( tmp[0] == 'F' )
+    scanner.ParseChar( fill );
+
+    if( fill == 'F' )
         m_Fill = FILLED_SHAPE;
 
-    if( tmp[0] == 'f' )
+    if( fill == 'f' )
         m_Fill = FILLED_WITH_BG_BODYCOLOR;
 
     return true;
@@ -33,6 +33,7 @@
 #include <base_struct.h>
 #include <drawtxt.h>
 #include <kicad_string.h>
+#include <line_scanner.h>
 #include <class_drawpanel.h>
 #include <plot_common.h>
 #include <trigo.h>
@@ -128,23 +129,23 @@ bool LIB_FIELD::Save( OUTPUTFORMATTER& aFormatter )
 
 bool LIB_FIELD::Load( LINE_READER& aLineReader, wxString& errorMsg )
 {
-    int     cnt;
-    char    textOrient;
-    char    textVisible;
-    char    textHJustify;
-    char    textVJustify[256];
+    int          cnt;
+    char         textOrient;
+    char         textVisible;
+    char         textHJustify;
+    std::string  textVJustify;
 
-    char*   line = (char*) aLineReader;
-    char*   limit = line + aLineReader.Length();
+    char*        line = (char*) aLineReader;
+    char*        limit = line + aLineReader.Length();
+    LINE_SCANNER scanner( line + 1 );
 
-    if( sscanf( line + 1, "%d", &m_id ) != 1 || m_id < 0 )
+    if( !scanner.ParseInt( m_id ) || m_id < 0 )
     {
         errorMsg = wxT( "invalid field header" );
         return false;
     }
 
-    // Caller did a strtok(), which inserts a nul, so next few bytes are ugly:
-    // digit(s), a nul, some whitespace, then a double quote.
+    // Skip the field number and the whitespace up to the opening double quote.
     while( line < limit && *line != '"' )
         line++;
 
@@ -158,10 +159,21 @@ bool LIB_FIELD::Load( LINE_READER& aLineReader, wxString& errorMsg )
     if( m_Text.size() == 1 && m_Text[0] == wxChar( '~' ) )
         m_Text.clear();
 
-    memset( textVJustify, 0, sizeof( textVJustify ) );
+    int*  values[] = { &m_Pos.x, &m_Pos.y, &m_Size.y };
+    char* flags[] = { &textOrient, &textVisible, &textHJustify };
 
-    cnt = sscanf( line, " %d %d %d %c %c %c %255s", &m_Pos.x, &m_Pos.y, &m_Size.y,
-                  &textOrient, &textVisible, &textHJustify, textVJustify );
+    scanner.SetLine( line );
+
+    for( cnt = 0; cnt < 3 && scanner.ParseInt( *values[cnt] ); cnt++ )
+        ;
+
+    while( cnt >= 3 && cnt < 6 && scanner.ParseChar( *flags[cnt - 3] ) )
+        cnt++;
+
+    if( cnt == 6 && scanner.ParseWord( textVJustify ) )
+        cnt++;
+
+    textVJustify.resize( 3, 0 );
 
     if( cnt < 5 )
     {
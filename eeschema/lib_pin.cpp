@@ -37,6 +37,7 @@
 #include <plot_common.h>
 #include <schframe.h>
 #include <richio.h>
+#include <line_scanner.h>
 #include <base_units.h>
 #include <msgpanel.h>
 
@@ -717,27 +718,23 @@ bool LIB_PIN::Save( OUTPUTFORMATTER& aFormatter )
     return true;
 }
 
-#include <wx/tokenzr.h>
-
 bool LIB_PIN::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
-    char pinAttrs[64];
-    char pinOrient[64];
-    char pinType[64];
-
-    *pinAttrs = 0;
+    std::string field;
+    std::string pinAttrs;
+    char        pinOrient;
+    char        pinType;
 
     // We cannot use sscanf, at least on Windows, to parse the pin description.
     // The reason is the pin name is free, and use UTF8 encoding.
     // We encourtered issues (Windows specific) to read this name for some UTF8
     // cyrillic codes
-    // So, read the pin name (and num) after conversion from UTF8, and read the others
-    // parameters (in ASCII) using sscanf
+    // So, read the pin name (and num) as raw UTF8 bytes and convert them afterwards,
+    // the others parameters are in pure ASCII.
 
     // the full line starts by "X ". The pin data starts at line + 2.
-    wxString utf8line = FROM_UTF8( aLineReader.Line() + 2 );
-	wxStringTokenizer tokenizer( utf8line, wxT(" \n\r" ) );
-    int prms_count = tokenizer.CountTokens();
+    LINE_SCANNER scanner( aLineReader.Line() + 2 );
+    int prms_count = scanner.FieldCount();
 
     if( prms_count < 11 )
     {
@@ -746,39 +743,37 @@ bool LIB_PIN::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
     }
 
     // Extract the pinName (UTF8 encoded)
-    m_name = tokenizer.GetNextToken();
-
-    wxString tmp;
+    scanner.ParseWord( field );
+    m_name = FROM_UTF8( field.c_str() );
 
     // Extract the pinName (UTF8 encoded accepted, but should be only ASCII8.)
-    tmp = tokenizer.GetNextToken();
+    scanner.ParseWord( field );
+    wxString tmp = FROM_UTF8( field.c_str() );
     SetPinNumFromString( tmp );
 
-    // Read other parameters, in pure ASCII
-    char line[1024];
-    tmp = tokenizer.GetString();
-
-    unsigned len = tmp.Length();
-
-    if( len >= sizeof( line ) )     // Should not occur.
-        len = sizeof( line) - 1;
-
-    strncpy( line, TO_UTF8( tmp ), len );
-    line[len] = 0;
+    // Read other parameters
+    if( !scanner.ParseInt( m_position.x ) || !scanner.ParseInt( m_position.y )
+      || !scanner.ParseInt( m_length ) || !scanner.ParseChar( pinOrient )
+      || !scanner.ParseInt( m_numTextSize ) || !scanner.ParseInt( m_nameTextSize )
+      || !scanner.ParseInt( m_Unit ) || !scanner.ParseInt( m_Convert )
+      || !scanner.ParseChar( pinType ) )
+    {
+        aErrorMsg.Printf( wxT( "pin parameters read issue" ) );
+        return false;
+    }
 
-    int cnt = sscanf( line, "%d %d %d %63s %d %d %d %d %63s %63s",
-                &m_position.x, &m_position.y, &m_length, pinOrient, &m_numTextSize,
-                &m_nameTextSize, &m_Unit, &m_Convert, pinType, pinAttrs );
+    if( prms_count >= 12 )
+        scanner.ParseWord( pinAttrs );
 
-    if( cnt != (prms_count - 2) )
+    if( !scanner.AtEnd() )
     {
         aErrorMsg.Printf( wxT( "pin parameters read issue" ) );
         return false;
     }
 
-    m_orientation = pinOrient[0] & 255;
+    m_orientation = pinOrient & 255;
 
-    switch( *pinType & 255 )
+    switch( pinType & 255 )
     {
     case 'I':
         m_type = PIN_INPUT;
@@ -825,13 +820,13 @@ bool LIB_PIN::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
         break;
 
     default:
-        aErrorMsg.Printf( wxT( "unknown pin type [%c]" ), *pinType & 255 );
+        aErrorMsg.Printf( wxT( "unknown pin type [%c]" ), pinType & 255 );
         return false;
     }
 
     if( prms_count >= 12 )       /* Special Symbol defined */
     {
-        for( int j = strlen( pinAttrs ); j > 0; )
+        for( int j = pinAttrs.size(); j > 0; )
         {
             switch( pinAttrs[--j] )
             {
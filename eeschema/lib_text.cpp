@@ -34,6 +34,7 @@
 #include <trigo.h>
 #include <wxstruct.h>
 #include <richio.h>
+#include <line_scanner.h>
 #include <base_units.h>
 #include <msgpanel.h>
 
@@ -98,43 +99,63 @@ bool LIB_TEXT::Save( OUTPUTFORMATTER& aFormatter )
 
 bool LIB_TEXT::Load( LINE_READER& aLineReader, wxString& errorMsg )
 {
-    int     cnt, thickness = 0;
-    char    hjustify = 'C', vjustify = 'C';
-    char    buf[256];
-    char    tmp[256];
-    char*   line = (char*) aLineReader;
-    double  angle;
-
-    buf[0] = 0;
-    tmp[0] = 0;         // For italic option, Not in old versions
-
-    cnt = sscanf( line + 2, "%lf %d %d %d %d %d %d \"%[^\"]\" %255s %d %c %c",
-                  &angle, &m_Pos.x, &m_Pos.y, &m_Size.x, &m_Attributs,
-                  &m_Unit, &m_Convert, buf, tmp, &thickness, &hjustify,
-                  &vjustify );
-
-    if( cnt >= 8 ) // if quoted loading failed, load as not quoted
+    int          cnt = 0, thickness = 0;
+    char         hjustify = 'C', vjustify = 'C';
+    std::string  text;
+    std::string  italic;    // For italic option, Not in old versions
+    bool         quoted = false;
+    double       angle = 0.0;
+    int*         values[] = { &m_Pos.x, &m_Pos.y, &m_Size.x, &m_Attributs,
+                              &m_Unit, &m_Convert };
+
+    // Draw items are loaded on first use, possibly by several threads: the fields are
+    // read by LINE_SCANNER, which does not depend on the locale, not by sscanf().
+    LINE_SCANNER scanner( aLineReader.Line() + 2 );
+
+    if( scanner.ParseDouble( angle ) )
     {
-        m_Text = FROM_UTF8( buf );
-
-        // convert two apostrophes back to double quote
-        m_Text.Replace( wxT( "''" ), wxT( "\"" ) );
+        for( cnt = 1; cnt < 7 && scanner.ParseInt( *values[cnt - 1] ); cnt++ )
+            ;
     }
-    else
+
+    if( cnt == 7 && !scanner.AtEnd() && *scanner.Position() == '"' )
     {
-        cnt = sscanf( line + 2, "%lf %d %d %d %d %d %d %255s %255s %d %c %c",
-                      &angle, &m_Pos.x, &m_Pos.y, &m_Size.x, &m_Attributs,
-                      &m_Unit, &m_Convert, buf, tmp, &thickness, &hjustify,
-                      &vjustify );
+        const char* start = scanner.Position() + 1;
+        const char* end = strchr( start, '"' );
 
-        if( cnt < 8 )
+        if( end && end > start )
         {
-            errorMsg.Printf( _( "Text only had %d parameters of the required 8" ), cnt );
-            return false;
+            text.assign( start, end - start );
+            scanner.SetLine( end + 1 );
+            quoted = true;
+            cnt++;
         }
+    }
+
+    // if quoted loading failed, load as not quoted
+    if( cnt == 7 && scanner.ParseWord( text ) )
+        cnt++;
+
+    if( cnt < 8 )
+    {
+        errorMsg.Printf( _( "Text only had %d parameters of the required 8" ), cnt );
+        return false;
+    }
+
+    if( scanner.ParseWord( italic ) && scanner.ParseInt( thickness )
+      && scanner.ParseChar( hjustify ) )
+        scanner.ParseChar( vjustify );
+
+    m_Text = FROM_UTF8( text.c_str() );
 
+    if( quoted )
+    {
+        // convert two apostrophes back to double quote
+        m_Text.Replace( wxT( "''" ), wxT( "\"" ) );
+    }
+    else
+    {
         /* Convert '~' to spaces (only if text is not quoted). */
-        m_Text = FROM_UTF8( buf );
         m_Text.Replace( wxT( "~" ), wxT( " " ) );
     }
 
@@ -142,7 +163,7 @@ bool LIB_TEXT::Load( LINE_READER& aLineReader, wxString& errorMsg )
 
     m_Size.y = m_Size.x;
 
-    if( strnicmp( tmp, "Italic", 6 ) == 0 )
+    if( strnicmp( italic.c_str(), "Italic", 6 ) == 0 )
         m_Italic = true;
 
     if( thickness > 0 )
@@ -43,6 +43,10 @@
 #include <sch_no_connect.h>
 #include <sch_text.h>
 #include <sch_sheet.h>
+
+#include <algorithm>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <algorithm>
 #include <invoke_sch_dialog.h>
 #include <boost/foreach.hpp>
@@ -159,6 +163,8 @@ void NETLIST_OBJECT_LIST::Clear()
     }
 
     clear();
+    m_netCodeParent.clear();
+    m_busNetCodeParent.clear();
 }
 
 
@@ -199,18 +205,75 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
 }
 
 
+typedef boost::ptr_vector< NETLIST_OBJECT_LIST > SHEET_ITEM_LISTS;
+
+
+/**
+ * Function collectSheetItems
+ * is the worker thread function of BuildNetListInfo(): it fills aLists[ii] with
+ * the connected items of the sheet path aSheets[ii], for ii = aFirst, aFirst + aStep ...
+ * Sheets only read their items, so a screen used by several sheet paths can be
+ * handled by several threads.
+ */
+static void collectSheetItems( const std::vector<SCH_SHEET_PATH*>* aSheets,
+                               SHEET_ITEM_LISTS* aLists, unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aSheets->size(); ii += aStep )
+    {
+        SCH_SHEET_PATH*      sheet = (*aSheets)[ii];
+        NETLIST_OBJECT_LIST& list = (*aLists)[ii];
+
+        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
+        {
+            item->GetNetListItem( list, sheet );
+        }
+    }
+}
+
+
 bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
 {
     SCH_SHEET_PATH* sheet;
 
-    // Fill list with connected items from the flattened sheet list
+    // Fill list with connected items from the flattened sheet list.
+    // Sheets are independent: each one is collected in its own list by a worker
+    // thread, and the lists are appended in the sheet list order.
+    std::vector<SCH_SHEET_PATH*> sheets;
+
     for( sheet = aSheets.GetFirst(); sheet != NULL;
          sheet = aSheets.GetNext() )
     {
-        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
-        {
-            item->GetNetListItem( *this, sheet );
-        }
+        sheets.push_back( sheet );
+    }
+
+    SHEET_ITEM_LISTS sheetItems;
+
+    for( unsigned ii = 0; ii < sheets.size(); ii++ )
+        sheetItems.push_back( new NETLIST_OBJECT_LIST() );
+
+    unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+    threadCount = std::min( threadCount, (unsigned) sheets.size() );
+
+    // Something which will not invoke a thread copy constructor
+    typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+    MYTHREADS threads;
+
+    for( unsigned ii = 1; ii < threadCount; ii++ )
+        threads.push_back( new boost::thread( &collectSheetItems, &sheets, &sheetItems,
+                                              ii, threadCount ) );
+
+    collectSheetItems( &sheets, &sheetItems, 0, std::max( 1u, threadCount ) );
+
+    for( unsigned ii = 0; ii < threads.size(); ++ii )
+        threads[ii].join();
+
+    for( unsigned ii = 0; ii < sheetItems.size(); ii++ )
+    {
+        insert( end(), sheetItems[ii].begin(), sheetItems[ii].end() );
+
+        // Items are now owned by this list.
+        sheetItems[ii].clear();
     }
 
     if( size() == 0 )
@@ -221,15 +284,17 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
 
     sheet = &(GetItem( 0 )->m_SheetPath);
     m_lastNetCode = m_lastBusNetCode = 1;
+    m_netCodeParent.clear();
+    m_busNetCodeParent.clear();
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
+    for( unsigned ii = 0; ii < size(); ii++ )
     {
         NETLIST_OBJECT* net_item = GetItem( ii );
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
+        if( ii == 0 || net_item->m_SheetPath != *sheet )   // Sheet change
         {
             sheet  = &(net_item->m_SheetPath);
-            istart = ii;
+            buildSheetConnections( ii );
         }
 
         switch( net_item->m_Type )
@@ -253,7 +318,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
+            pointToPointConnect( net_item, IS_WIRE );
             break;
 
         case NET_JUNCTION:
@@ -264,7 +329,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE );
 
             // Control of the junction, on BUS.
             if( net_item->m_BusNetCode == 0 )
@@ -273,7 +338,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS );
             break;
 
         case NET_LABEL:
@@ -286,7 +351,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE );
             break;
 
         case NET_SHEETBUSLABELMEMBER:
@@ -301,7 +366,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_BUS, istart );
+            pointToPointConnect( net_item, IS_BUS );
             break;
 
         case NET_BUSLABELMEMBER:
@@ -314,7 +379,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS );
             break;
         }
     }
@@ -324,6 +389,9 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     DumpNetTable();
 #endif
 
+    // connectBusLabels() compares bus net codes
+    resolveNetCodes();
+
     // Updating the Bus Labels Netcode connected by Bus
     connectBusLabels();
 
@@ -371,6 +439,8 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
             sheetLabelConnect( GetItem( ii ) );
     }
 
+    resolveNetCodes();
+
     // Sort objects by NetCode
     SortListbyNetcode();
 
@@ -672,49 +742,104 @@ void NETLIST_OBJECT_LIST::connectBusLabels()
 }
 
 
+// Find the root of aCode in the disjoint-set forest aParent, with path halving
+static int findNetCodeRoot( std::vector<int>& aParent, int aCode )
+{
+    while( aCode >= 0 && aCode < (int) aParent.size() && aParent[aCode] != aCode )
+    {
+        aParent[aCode] = aParent[ aParent[aCode] ];
+        aCode = aParent[aCode];
+    }
+
+    return aCode;
+}
+
+
 void NETLIST_OBJECT_LIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
 {
     if( aOldNetCode == aNewNetCode )
         return;
 
-    if( aIsBus == false )    // Propagate NetCode
+    std::vector<int>& parent = aIsBus ? m_busNetCodeParent : m_netCodeParent;
+
+    int oldRoot = findNetCodeRoot( parent, aOldNetCode );
+    int newRoot = findNetCodeRoot( parent, aNewNetCode );
+
+    if( oldRoot == newRoot )
+        return;
+
+    // Like a relabeling of all items, the merged net keeps the code of aNewNetCode
+    int maxCode = std::max( oldRoot, newRoot );
+
+    if( maxCode >= (int) parent.size() )
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
+        int ii = parent.size();
+        parent.resize( maxCode + 1 );
 
-            if( object->GetNet() == aOldNetCode )
-                object->SetNet( aNewNetCode );
-        }
+        for( ; ii <= maxCode; ii++ )
+            parent[ii] = ii;
     }
-    else               // Propagate BusNetCode
+
+    parent[oldRoot] = newRoot;
+}
+
+
+void NETLIST_OBJECT_LIST::resolveNetCodes()
+{
+    for( unsigned ii = 0; ii < size(); ii++ )
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
+        NETLIST_OBJECT* object = GetItem( ii );
 
-            if( object->m_BusNetCode == aOldNetCode )
-                object->m_BusNetCode = aNewNetCode;
-        }
+        object->SetNet( findNetCodeRoot( m_netCodeParent, object->GetNet() ) );
+        object->m_BusNetCode = findNetCodeRoot( m_busNetCodeParent, object->m_BusNetCode );
+    }
+}
+
+
+void NETLIST_OBJECT_LIST::buildSheetConnections( unsigned aIdxStart )
+{
+    m_sheetConnections.Clear();
+
+    const SCH_SHEET_PATH& sheet = GetItem( aIdxStart )->m_SheetPath;
+
+    for( unsigned i = aIdxStart; i < size(); i++ )
+    {
+        NETLIST_OBJECT* item = GetItem( i );
+
+        if( item->m_SheetPath != sheet )
+            break;
+
+        m_sheetConnections.AddPoint( item->m_Start, i );
+
+        if( item->m_End != item->m_Start )
+            m_sheetConnections.AddPoint( item->m_End, i );
+
+        if( item->m_Type == NET_SEGMENT || item->m_Type == NET_BUS )
+            m_sheetConnections.AddSegment( item->m_Start, item->m_End, i );
     }
 }
 
 
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
-                                               int start )
+void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus )
 {
     int netCode;
 
+    // Items having an end point on an end point of aRef.
+    // (an item can be found twice, this is not a problem)
+    std::vector<int> candidates;
+
+    m_sheetConnections.QueryPoints( aRef->m_Start, candidates );
+
+    if( aRef->m_End != aRef->m_Start )
+        m_sheetConnections.QueryPoints( aRef->m_End, candidates );
+
     if( aIsBus == false )    // Objects other than BUS and BUSLABELS
     {
         netCode = aRef->GetNet();
 
-        for( unsigned i = start; i < size(); i++ )
+        for( unsigned i = 0; i < candidates.size(); i++ )
         {
-            NETLIST_OBJECT* item = GetItem( i );
-
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
-                continue;
+            NETLIST_OBJECT* item = GetItem( candidates[i] );
 
             switch( item->m_Type )
             {
@@ -727,16 +852,10 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
             case NET_PINLABEL:
             case NET_JUNCTION:
             case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propageNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
+                if( item->GetNet() == 0 )
+                    item->SetNet( netCode );
+                else
+                    propageNetCode( item->GetNet(), netCode, IS_WIRE );
                 break;
 
             case NET_BUS:
@@ -753,12 +872,9 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
     {
         netCode = aRef->m_BusNetCode;
 
-        for( unsigned i = start; i < size(); i++ )
+        for( unsigned i = 0; i < candidates.size(); i++ )
         {
-            NETLIST_OBJECT* item = GetItem( i );
-
-            if( item->m_SheetPath != aRef->m_SheetPath )
-                continue;
+            NETLIST_OBJECT* item = GetItem( candidates[i] );
 
             switch( item->m_Type )
             {
@@ -779,16 +895,10 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
             case NET_HIERBUSLABELMEMBER:
             case NET_GLOBBUSLABELMEMBER:
             case NET_JUNCTION:
-                if(  aRef->m_Start == item->m_Start
-                  || aRef->m_Start == item->m_End
-                  || aRef->m_End   == item->m_Start
-                  || aRef->m_End   == item->m_End )
-                {
-                    if( item->m_BusNetCode == 0 )
-                        item->m_BusNetCode = netCode;
-                    else
-                        propageNetCode( item->m_BusNetCode, netCode, IS_BUS );
-                }
+                if( item->m_BusNetCode == 0 )
+                    item->m_BusNetCode = netCode;
+                else
+                    propageNetCode( item->m_BusNetCode, netCode, IS_BUS );
                 break;
             }
         }
@@ -796,16 +906,15 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
 }
 
 
-void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                bool aIsBus, int aIdxStart )
+void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus )
 {
-    for( unsigned i = aIdxStart; i < size(); i++ )
-    {
-        NETLIST_OBJECT* segment = GetItem( i );
+    std::vector<int> candidates;
 
-        // if different sheets, obviously no physical connection between elements.
-        if( segment->m_SheetPath != aJonction->m_SheetPath )
-            continue;
+    m_sheetConnections.QuerySegments( aJonction->m_Start, candidates );
+
+    for( unsigned i = 0; i < candidates.size(); i++ )
+    {
+        NETLIST_OBJECT* segment = GetItem( candidates[i] );
 
         if( aIsBus == IS_WIRE )
         {
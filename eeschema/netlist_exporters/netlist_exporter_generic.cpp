@@ -26,6 +26,7 @@
 #include <build_version.h>
 #include <sch_base_frame.h>
 #include <class_library.h>
+#include <richio.h>
 
 #include <schframe.h>
 #include "netlist_exporter_generic.h"
@@ -39,6 +40,7 @@ bool NETLIST_EXPORTER_GENERIC::WriteNetlist( const wxString& aOutFileName, unsig
         m_masterList->GetItem( ii )->m_Flag = 0;
 
     // output the XML format netlist.
+    // The XML text is written by wxXmlDocument, so the whole tree is built.
     wxXmlDocument   xdoc;
 
     xdoc.SetRoot( makeRoot( GNL_ALL ) );
@@ -47,37 +49,109 @@ bool NETLIST_EXPORTER_GENERIC::WriteNetlist( const wxString& aOutFileName, unsig
 }
 
 
+void XNODE_TREE_WRITER::StartNode( const wxString& aName )
+{
+    XNODE* n = new XNODE( wxXML_ELEMENT_NODE, aName );
+
+    if( m_stack.empty() )
+        m_root = n;
+    else
+        m_stack.back()->AddChild( n );
+
+    m_stack.push_back( n );
+}
+
+
+void XNODE_TREE_WRITER::AddAttribute( const wxString& aName, const wxString& aValue )
+{
+    m_stack.back()->AddAttribute( aName, aValue );
+}
+
+
+void XNODE_TREE_WRITER::AddText( const wxString& aText )
+{
+    m_stack.back()->AddChild( new XNODE( wxXML_TEXT_NODE, wxEmptyString, aText ) );
+}
+
+
+void XNODE_TREE_WRITER::EndNode()
+{
+    m_stack.pop_back();
+}
+
+
+// See XNODE::Format(): each node but the root starts on a new line, and the closing
+// parenthesis of a node follows the one of its last child.
+void SEXPR_TREE_WRITER::StartNode( const wxString& aName )
+{
+    if( m_nestLevel > 0 )
+        m_out->Print( 0, "\n" );
+
+    m_out->Print( m_nestLevel, "(%s", m_out->Quotew( aName ).c_str() );
+    ++m_nestLevel;
+}
+
+
+void SEXPR_TREE_WRITER::AddAttribute( const wxString& aName, const wxString& aValue )
+{
+    m_out->Print( 0, " (%s %s)",
+                  m_out->Quotew( aName ).c_str(),
+                  m_out->Quotew( aValue ).c_str() );
+}
+
+
+void SEXPR_TREE_WRITER::AddText( const wxString& aText )
+{
+    m_out->Print( 0, " %s", m_out->Quotew( aText ).c_str() );
+}
+
+
+void SEXPR_TREE_WRITER::EndNode()
+{
+    --m_nestLevel;
+    m_out->Print( 0, ")" );
+}
+
+
 XNODE* NETLIST_EXPORTER_GENERIC::makeRoot( int aCtl )
 {
-    XNODE*      xroot = node( wxT( "export" ) );
+    XNODE_TREE_WRITER writer;
 
-    xroot->AddAttribute( wxT( "version" ), wxT( "D" ) );
+    writeRoot( writer, aCtl );
+
+    return writer.GetRoot();
+}
+
+
+void NETLIST_EXPORTER_GENERIC::writeRoot( NETLIST_TREE_WRITER& aWriter, int aCtl )
+{
+    aWriter.StartNode( wxT( "export" ) );
+
+    aWriter.AddAttribute( wxT( "version" ), wxT( "D" ) );
 
     if( aCtl & GNL_HEADER )
         // add the "design" header
-        xroot->AddChild( makeDesignHeader() );
+        writeDesignHeader( aWriter );
 
     if( aCtl & GNL_COMPONENTS )
-        xroot->AddChild( makeComponents() );
+        writeComponents( aWriter );
 
     if( aCtl & GNL_PARTS )
-        xroot->AddChild( makeLibParts() );
+        writeLibParts( aWriter );
 
     if( aCtl & GNL_LIBRARIES )
-        // must follow makeGenericLibParts()
-        xroot->AddChild( makeLibraries() );
+        // must follow writeLibParts()
+        writeLibraries( aWriter );
 
     if( aCtl & GNL_NETS )
-        xroot->AddChild( makeListOfNets() );
+        writeListOfNetsNode( aWriter );
 
-    return xroot;
+    aWriter.EndNode();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeComponents()
+void NETLIST_EXPORTER_GENERIC::writeComponents( NETLIST_TREE_WRITER& aWriter )
 {
-    XNODE*      xcomps = node( wxT( "components" ) );
-
     wxString    timeStamp;
 
     // some strings we need many times, but don't want to construct more
@@ -106,6 +180,8 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeComponents()
     wxString    sPart       = wxT( "part" );
     wxString    sNames      = wxT( "names" );
 
+    aWriter.StartNode( wxT( "components" ) );
+
     m_ReferencesAlreadyFound.Clear();
 
     SCH_SHEET_LIST sheetList;
@@ -123,31 +199,28 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeComponents()
 
             schItem = comp;
 
-            XNODE* xcomp;  // current component being constructed
-
             // Output the component's elements in order of expected access frequency.
             // This may not always look best, but it will allow faster execution
             // under XSL processing systems which do sequential searching within
             // an element.
 
-            xcomps->AddChild( xcomp = node( sComponent ) );
-            xcomp->AddAttribute( sRef, comp->GetRef( path ) );
+            aWriter.StartNode( sComponent );
+            aWriter.AddAttribute( sRef, comp->GetRef( path ) );
 
-            xcomp->AddChild( node( sValue, comp->GetField( VALUE )->GetText() ) );
+            aWriter.Node( sValue, comp->GetField( VALUE )->GetText() );
 
             if( !comp->GetField( FOOTPRINT )->IsVoid() )
-                xcomp->AddChild( node( sFootprint, comp->GetField( FOOTPRINT )->GetText() ) );
+                aWriter.Node( sFootprint, comp->GetField( FOOTPRINT )->GetText() );
 
             if( !comp->GetField( DATASHEET )->IsVoid() )
-                xcomp->AddChild( node( sDatasheet, comp->GetField( DATASHEET )->GetText() ) );
+                aWriter.Node( sDatasheet, comp->GetField( DATASHEET )->GetText() );
 
             // Export all user defined fields within the component,
             // which start at field index MANDATORY_FIELDS.  Only output the <fields>
             // container element if there are any <field>s.
             if( comp->GetFieldCount() > MANDATORY_FIELDS )
             {
-                XNODE* xfields;
-                xcomp->AddChild( xfields = node( sFields ) );
+                aWriter.StartNode( sFields );
 
                 for( int fldNdx = MANDATORY_FIELDS; fldNdx < comp->GetFieldCount(); ++fldNdx )
                 {
@@ -156,57 +229,59 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeComponents()
                     // only output a field if non empty and not just "~"
                     if( !f->IsVoid() )
                     {
-                        XNODE*  xfield;
-                        xfields->AddChild( xfield = node( sField, f->GetText() ) );
-                        xfield->AddAttribute( sName, f->GetName() );
+                        aWriter.StartNode( sField );
+                        aWriter.AddAttribute( sName, f->GetName() );
+                        aWriter.AddText( f->GetText() );
+                        aWriter.EndNode();
                     }
                 }
+
+                aWriter.EndNode();
             }
 
-            XNODE*  xlibsource;
-            xcomp->AddChild( xlibsource = node( sLibSource ) );
+            aWriter.StartNode( sLibSource );
 
             // "logical" library name, which is in anticipation of a better search
             // algorithm for parts based on "logical_lib.part" and where logical_lib
             // is merely the library name minus path and extension.
             LIB_PART* part = m_libs->FindLibPart( comp->GetPartName() );
             if( part )
-                xlibsource->AddAttribute( sLib, part->GetLib()->GetLogicalName() );
+                aWriter.AddAttribute( sLib, part->GetLib()->GetLogicalName() );
 
-            xlibsource->AddAttribute( sPart, comp->GetPartName() );
+            aWriter.AddAttribute( sPart, comp->GetPartName() );
+            aWriter.EndNode();
 
-            XNODE* xsheetpath;
-
-            xcomp->AddChild( xsheetpath = node( sSheetPath ) );
-            xsheetpath->AddAttribute( sNames, path->PathHumanReadable() );
-            xsheetpath->AddAttribute( sTStamps, path->Path() );
+            aWriter.StartNode( sSheetPath );
+            aWriter.AddAttribute( sNames, path->PathHumanReadable() );
+            aWriter.AddAttribute( sTStamps, path->Path() );
+            aWriter.EndNode();
 
             timeStamp.Printf( sTSFmt, (unsigned long)comp->GetTimeStamp() );
-            xcomp->AddChild( node( sTStamp, timeStamp ) );
+            aWriter.Node( sTStamp, timeStamp );
+
+            aWriter.EndNode();
         }
     }
 
-    return xcomps;
+    aWriter.EndNode();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
+void NETLIST_EXPORTER_GENERIC::writeDesignHeader( NETLIST_TREE_WRITER& aWriter )
 {
     SCH_SCREEN* screen;
-    XNODE*     xdesign = node( wxT("design") );
-    XNODE*     xtitleBlock;
-    XNODE*     xsheet;
-    XNODE*     xcomment;
     wxString   sheetTxt;
     wxFileName sourceFileName;
 
+    aWriter.StartNode( wxT("design") );
+
     // the root sheet is a special sheet, call it source
-    xdesign->AddChild( node( wxT( "source" ), g_RootSheet->GetScreen()->GetFileName() ) );
+    aWriter.Node( wxT( "source" ), g_RootSheet->GetScreen()->GetFileName() );
 
-    xdesign->AddChild( node( wxT( "date" ), DateAndTime() ) );
+    aWriter.Node( wxT( "date" ), DateAndTime() );
 
     // which Eeschema tool
-    xdesign->AddChild( node( wxT( "tool" ), wxT( "Eeschema " ) + GetBuildVersion() ) );
+    aWriter.Node( wxT( "tool" ), wxT( "Eeschema " ) + GetBuildVersion() );
 
     /*
         Export the sheets information
@@ -217,74 +292,81 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeDesignHeader()
     {
         screen = sheet->LastScreen();
 
-        xdesign->AddChild( xsheet = node( wxT( "sheet" ) ) );
+        aWriter.StartNode( wxT( "sheet" ) );
 
         // get the string representation of the sheet index number.
         // Note that sheet->GetIndex() is zero index base and we need to increment the number by one to make
         // human readable
         sheetTxt.Printf( wxT( "%d" ), ( sheetList.GetIndex() + 1 ) );
-        xsheet->AddAttribute( wxT( "number" ), sheetTxt );
-        xsheet->AddAttribute( wxT( "name" ), sheet->PathHumanReadable() );
-        xsheet->AddAttribute( wxT( "tstamps" ), sheet->Path() );
+        aWriter.AddAttribute( wxT( "number" ), sheetTxt );
+        aWriter.AddAttribute( wxT( "name" ), sheet->PathHumanReadable() );
+        aWriter.AddAttribute( wxT( "tstamps" ), sheet->Path() );
 
 
         TITLE_BLOCK tb = screen->GetTitleBlock();
 
-        xsheet->AddChild( xtitleBlock = node( wxT( "title_block" ) ) );
+        aWriter.StartNode( wxT( "title_block" ) );
 
-        xtitleBlock->AddChild( node( wxT( "title" ), tb.GetTitle() ) );
-        xtitleBlock->AddChild( node( wxT( "company" ), tb.GetCompany() ) );
-        xtitleBlock->AddChild( node( wxT( "rev" ), tb.GetRevision() ) );
-        xtitleBlock->AddChild( node( wxT( "date" ), tb.GetDate() ) );
+        aWriter.Node( wxT( "title" ), tb.GetTitle() );
+        aWriter.Node( wxT( "company" ), tb.GetCompany() );
+        aWriter.Node( wxT( "rev" ), tb.GetRevision() );
+        aWriter.Node( wxT( "date" ), tb.GetDate() );
 
         // We are going to remove the fileName directories.
         sourceFileName = wxFileName( screen->GetFileName() );
-        xtitleBlock->AddChild( node( wxT( "source" ), sourceFileName.GetFullName() ) );
-
-        xtitleBlock->AddChild( xcomment = node( wxT( "comment" ) ) );
-        xcomment->AddAttribute( wxT("number"), wxT("1") );
-        xcomment->AddAttribute( wxT( "value" ), tb.GetComment1() );
-
-        xtitleBlock->AddChild( xcomment = node( wxT( "comment" ) ) );
-        xcomment->AddAttribute( wxT("number"), wxT("2") );
-        xcomment->AddAttribute( wxT( "value" ), tb.GetComment2() );
-
-        xtitleBlock->AddChild( xcomment = node( wxT( "comment" ) ) );
-        xcomment->AddAttribute( wxT("number"), wxT("3") );
-        xcomment->AddAttribute( wxT( "value" ), tb.GetComment3() );
-
-        xtitleBlock->AddChild( xcomment = node( wxT( "comment" ) ) );
-        xcomment->AddAttribute( wxT("number"), wxT("4") );
-        xcomment->AddAttribute( wxT( "value" ), tb.GetComment4() );
+        aWriter.Node( wxT( "source" ), sourceFileName.GetFullName() );
+
+        aWriter.StartNode( wxT( "comment" ) );
+        aWriter.AddAttribute( wxT("number"), wxT("1") );
+        aWriter.AddAttribute( wxT( "value" ), tb.GetComment1() );
+        aWriter.EndNode();
+
+        aWriter.StartNode( wxT( "comment" ) );
+        aWriter.AddAttribute( wxT("number"), wxT("2") );
+        aWriter.AddAttribute( wxT( "value" ), tb.GetComment2() );
+        aWriter.EndNode();
+
+        aWriter.StartNode( wxT( "comment" ) );
+        aWriter.AddAttribute( wxT("number"), wxT("3") );
+        aWriter.AddAttribute( wxT( "value" ), tb.GetComment3() );
+        aWriter.EndNode();
+
+        aWriter.StartNode( wxT( "comment" ) );
+        aWriter.AddAttribute( wxT("number"), wxT("4") );
+        aWriter.AddAttribute( wxT( "value" ), tb.GetComment4() );
+        aWriter.EndNode();
+
+        aWriter.EndNode();      // title_block
+        aWriter.EndNode();      // sheet
     }
 
-    return xdesign;
+    aWriter.EndNode();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeLibraries()
+void NETLIST_EXPORTER_GENERIC::writeLibraries( NETLIST_TREE_WRITER& aWriter )
 {
-    XNODE*  xlibs = node( wxT( "libraries" ) );     // auto_ptr
+    aWriter.StartNode( wxT( "libraries" ) );
 
     for( std::set<void*>::iterator it = m_Libraries.begin(); it!=m_Libraries.end();  ++it )
     {
         PART_LIB*    lib = (PART_LIB*) *it;
-        XNODE*      xlibrary;
 
-        xlibs->AddChild( xlibrary = node( wxT( "library" ) ) );
-        xlibrary->AddAttribute( wxT( "logical" ), lib->GetLogicalName() );
-        xlibrary->AddChild( node( wxT( "uri" ),  lib->GetFullFileName() ) );
+        aWriter.StartNode( wxT( "library" ) );
+        aWriter.AddAttribute( wxT( "logical" ), lib->GetLogicalName() );
+        aWriter.Node( wxT( "uri" ),  lib->GetFullFileName() );
 
         // @todo: add more fun stuff here
+
+        aWriter.EndNode();
     }
 
-    return xlibs;
+    aWriter.EndNode();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
+void NETLIST_EXPORTER_GENERIC::writeLibParts( NETLIST_TREE_WRITER& aWriter )
 {
-    XNODE*      xlibparts = node( wxT( "libparts" ) );   // auto_ptr
     wxString    sLibpart  = wxT( "libpart" );
     wxString    sLib      = wxT( "lib" );
     wxString    sPart     = wxT( "part" );
@@ -306,6 +388,8 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
     LIB_PINS    pinList;
     LIB_FIELDS  fieldList;
 
+    aWriter.StartNode( wxT( "libparts" ) );
+
     m_Libraries.clear();
 
     for( std::set<LIB_PART*>::iterator it = m_LibParts.begin(); it!=m_LibParts.end();  ++it )
@@ -315,61 +399,65 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
 
         m_Libraries.insert( library );  // inserts component's library if unique
 
-        XNODE* xlibpart;
-        xlibparts->AddChild( xlibpart = node( sLibpart ) );
-        xlibpart->AddAttribute( sLib, library->GetLogicalName() );
-        xlibpart->AddAttribute( sPart, lcomp->GetName()  );
+        aWriter.StartNode( sLibpart );
+        aWriter.AddAttribute( sLib, library->GetLogicalName() );
+        aWriter.AddAttribute( sPart, lcomp->GetName()  );
 
         if( lcomp->GetAliasCount() )
         {
             wxArrayString aliases = lcomp->GetAliasNames( false );
             if( aliases.GetCount() )
             {
-                XNODE* xaliases = node( sAliases );
-                xlibpart->AddChild( xaliases );
+                aWriter.StartNode( sAliases );
+
                 for( unsigned i=0;  i<aliases.GetCount();  ++i )
                 {
-                    xaliases->AddChild( node( sAlias, aliases[i] ) );
+                    aWriter.Node( sAlias, aliases[i] );
                 }
+
+                aWriter.EndNode();
             }
         }
 
         //----- show the important properties -------------------------
         if( !lcomp->GetAlias( 0 )->GetDescription().IsEmpty() )
-            xlibpart->AddChild( node( sDescr, lcomp->GetAlias( 0 )->GetDescription() ) );
+            aWriter.Node( sDescr, lcomp->GetAlias( 0 )->GetDescription() );
 
         if( !lcomp->GetAlias( 0 )->GetDocFileName().IsEmpty() )
-            xlibpart->AddChild( node( sDocs,  lcomp->GetAlias( 0 )->GetDocFileName() ) );
+            aWriter.Node( sDocs,  lcomp->GetAlias( 0 )->GetDocFileName() );
 
         // Write the footprint list
         if( lcomp->GetFootPrints().GetCount() )
         {
-            XNODE*  xfootprints;
-            xlibpart->AddChild( xfootprints = node( sFprints ) );
+            aWriter.StartNode( sFprints );
 
             for( unsigned i=0; i<lcomp->GetFootPrints().GetCount(); ++i )
             {
-                xfootprints->AddChild( node( sFp, lcomp->GetFootPrints()[i] ) );
+                aWriter.Node( sFp, lcomp->GetFootPrints()[i] );
             }
+
+            aWriter.EndNode();
         }
 
         //----- show the fields here ----------------------------------
         fieldList.clear();
         lcomp->GetFields( fieldList );
 
-        XNODE*     xfields;
-        xlibpart->AddChild( xfields = node( sFields ) );
+        aWriter.StartNode( sFields );
 
         for( unsigned i=0;  i<fieldList.size();  ++i )
         {
             if( !fieldList[i].GetText().IsEmpty() )
             {
-                XNODE*     xfield;
-                xfields->AddChild( xfield = node( sField, fieldList[i].GetText() ) );
-                xfield->AddAttribute( sName, fieldList[i].GetName(false) );
+                aWriter.StartNode( sField );
+                aWriter.AddAttribute( sName, fieldList[i].GetName(false) );
+                aWriter.AddText( fieldList[i].GetText() );
+                aWriter.EndNode();
             }
         }
 
+        aWriter.EndNode();
+
         //----- show the pins here ------------------------------------
         pinList.clear();
         lcomp->GetPins( pinList, 0, 0 );
@@ -394,30 +482,32 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeLibParts()
 
         if( pinList.size() )
         {
-            XNODE*     pins;
+            aWriter.StartNode( sPins );
 
-            xlibpart->AddChild( pins = node( sPins ) );
             for( unsigned i=0; i<pinList.size();  ++i )
             {
-                XNODE*     pin;
-
-                pins->AddChild( pin = node( sPin ) );
-                pin->AddAttribute( sPinNum, pinList[i]->GetNumberString() );
-                pin->AddAttribute( sPinName, pinList[i]->GetName() );
-                pin->AddAttribute( sPinType, pinList[i]->GetCanonicalElectricalTypeName() );
+                aWriter.StartNode( sPin );
+                aWriter.AddAttribute( sPinNum, pinList[i]->GetNumberString() );
+                aWriter.AddAttribute( sPinName, pinList[i]->GetName() );
+                aWriter.AddAttribute( sPinType, pinList[i]->GetCanonicalElectricalTypeName() );
 
                 // caution: construction work site here, drive slowly
+
+                aWriter.EndNode();
             }
+
+            aWriter.EndNode();
         }
+
+        aWriter.EndNode();      // libpart
     }
 
-    return xlibparts;
+    aWriter.EndNode();
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
+void NETLIST_EXPORTER_GENERIC::writeListOfNetsNode( NETLIST_TREE_WRITER& aWriter )
 {
-    XNODE*      xnets = node( wxT( "nets" ) );      // auto_ptr if exceptions ever get used.
     wxString    netCodeTxt;
     wxString    netName;
     wxString    ref;
@@ -430,7 +520,7 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
     wxString    sNode = wxT( "node" );
     wxString    sFmtd = wxT( "%d" );
 
-    XNODE*      xnet = 0;
+    bool        netStarted = false;
     int         netCode;
     int         lastNetCode = -1;
     int         sameNetcodeCount = 0;
@@ -443,6 +533,8 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
         </net>
     */
 
+    aWriter.StartNode( wxT( "nets" ) );
+
     m_LibParts.clear();     // must call this function before using m_LibParts.
 
     for( unsigned ii = 0; ii < m_masterList->size(); ii++ )
@@ -473,19 +565,26 @@ XNODE* NETLIST_EXPORTER_GENERIC::makeListOfNets()
 
         if( ++sameNetcodeCount == 1 )
         {
-            xnets->AddChild( xnet = node( sNet ) );
+            if( netStarted )
+                aWriter.EndNode();
+
+            aWriter.StartNode( sNet );
+            netStarted = true;
             netCodeTxt.Printf( sFmtd, netCode );
-            xnet->AddAttribute( sCode, netCodeTxt );
-            xnet->AddAttribute( sName, netName );
+            aWriter.AddAttribute( sCode, netCodeTxt );
+            aWriter.AddAttribute( sName, netName );
         }
 
-        XNODE*      xnode;
-        xnet->AddChild( xnode = node( sNode ) );
-        xnode->AddAttribute( sRef, ref );
-        xnode->AddAttribute( sPin,  nitem->GetPinNumText() );
+        aWriter.StartNode( sNode );
+        aWriter.AddAttribute( sRef, ref );
+        aWriter.AddAttribute( sPin,  nitem->GetPinNumText() );
+        aWriter.EndNode();
     }
 
-    return xnets;
+    if( netStarted )
+        aWriter.EndNode();
+
+    aWriter.EndNode();
 }
 
 
@@ -562,17 +661,6 @@ bool NETLIST_EXPORTER_GENERIC::writeListOfNets( FILE* f, NETLIST_OBJECT_LIST& aO
 }
 
 
-XNODE* NETLIST_EXPORTER_GENERIC::node( const wxString& aName, const wxString& aTextualContent /* = wxEmptyString*/ )
-{
-    XNODE* n = new XNODE( wxXML_ELEMENT_NODE, aName );
-
-    if( aTextualContent.Len() > 0 )     // excludes wxEmptyString, the parameter's default value
-        n->AddChild( new XNODE( wxXML_TEXT_NODE, wxEmptyString, aTextualContent ) );
-
-    return n;
-}
-
-
 static bool sortPinsByNumber( LIB_PIN* aPin1, LIB_PIN* aPin2 )
 {
     // return "lhs < rhs"
@@ -30,8 +30,12 @@
 
 #include <xnode.h>      // also nests: <wx/xml/xml.h>
 
+#include <vector>
+
 #define GENERIC_INTERMEDIATE_NETLIST_EXT wxT( "xml" )
 
+class OUTPUTFORMATTER;
+
 /**
  * Enum GNL
  * is a set of bit which control the totality of the tree built by makeRoot()
@@ -46,6 +50,83 @@ enum GNL_T
 };
 
 
+/**
+ * Class NETLIST_TREE_WRITER
+ * receives the document model of the generic netlist, node by node in document
+ * order, from NETLIST_EXPORTER_GENERIC.  The attributes and the text of a node
+ * are given before its children.
+ */
+class NETLIST_TREE_WRITER
+{
+public:
+    virtual ~NETLIST_TREE_WRITER() {}
+
+    virtual void StartNode( const wxString& aName ) = 0;
+    virtual void AddAttribute( const wxString& aName, const wxString& aValue ) = 0;
+    virtual void AddText( const wxString& aText ) = 0;
+    virtual void EndNode() = 0;
+
+    /**
+     * Function Node
+     * writes a node without children, with an optional textual content.
+     */
+    void Node( const wxString& aName, const wxString& aTextualContent = wxEmptyString )
+    {
+        StartNode( aName );
+
+        if( aTextualContent.Len() > 0 )     // excludes wxEmptyString
+            AddText( aTextualContent );
+
+        EndNode();
+    }
+};
+
+
+/**
+ * Class XNODE_TREE_WRITER
+ * builds an XNODE tree from the document model.
+ */
+class XNODE_TREE_WRITER : public NETLIST_TREE_WRITER
+{
+public:
+    XNODE_TREE_WRITER() : m_root( NULL ) {}
+
+    void StartNode( const wxString& aName );
+    void AddAttribute( const wxString& aName, const wxString& aValue );
+    void AddText( const wxString& aText );
+    void EndNode();
+
+    /// @return the root node of the tree, owned by the caller.
+    XNODE* GetRoot() const { return m_root; }
+
+private:
+    XNODE*              m_root;
+    std::vector<XNODE*> m_stack;     ///< the nodes not ended yet
+};
+
+
+/**
+ * Class SEXPR_TREE_WRITER
+ * writes the document model as s-expressions to an OUTPUTFORMATTER while it is
+ * built.  The output is the same as XNODE::Format() of the XNODE tree, without
+ * keeping the tree in memory.
+ */
+class SEXPR_TREE_WRITER : public NETLIST_TREE_WRITER
+{
+public:
+    SEXPR_TREE_WRITER( OUTPUTFORMATTER* aOut ) : m_out( aOut ), m_nestLevel( 0 ) {}
+
+    void StartNode( const wxString& aName );
+    void AddAttribute( const wxString& aName, const wxString& aValue );
+    void AddText( const wxString& aText );
+    void EndNode();
+
+private:
+    OUTPUTFORMATTER*    m_out;
+    int                 m_nestLevel;
+};
+
+
 /**
  * Class NETLIST_EXPORTER_GENERIC
  * generates a generic XML based netlist file. This allows using XSLT or other methods to
@@ -68,26 +149,15 @@ public:
 #define GNL_ALL     ( GNL_LIBRARIES | GNL_COMPONENTS | GNL_PARTS | GNL_HEADER | GNL_NETS )
 
 protected:
-   /**
-     * Function node
-     * is a convenience function that creates a new XNODE with an optional textual child.
-     * It also provides some insulation from a possible change in XML library.
-     *
-     * @param aName is the name to associate with a new node of type wxXML_ELEMENT_NODE.
-     * @param aTextualContent is optional, and if given is the text to include in a child
-     *   of the returned node, and has type wxXML_TEXT_NODE.
-     */
-    XNODE* node( const wxString& aName, const wxString& aTextualContent = wxEmptyString );
-
     /**
-     * Function writeGENERICListOfNets
+     * Function writeListOfNets
      * writes out nets (ranked by Netcode), and elements that are
      * connected as part of that net.
      */
     bool writeListOfNets( FILE* f, NETLIST_OBJECT_LIST& aObjectsList );
 
     /**
-     * Function makeGenericRoot
+     * Function makeRoot
      * builds the entire document tree for the generic export.  This is factored
      * out here so we can write the tree in either S-expression file format
      * or in XML if we put the tree built here into a wxXmlDocument.
@@ -97,39 +167,43 @@ protected:
     XNODE* makeRoot( int aCtl = GNL_ALL );
 
     /**
-     * Function makeComponents
-     * @return XNODE* - returns a sub-tree holding all the schematic components.
+     * Function writeRoot
+     * gives the entire document to \a aWriter.  makeRoot() uses it with an
+     * XNODE_TREE_WRITER, the s-expression netlist with a SEXPR_TREE_WRITER.
+     * @param aCtl - a bitset or-ed together from GNL_ENUM values
+     */
+    void writeRoot( NETLIST_TREE_WRITER& aWriter, int aCtl = GNL_ALL );
+
+    /**
+     * Function writeComponents
+     * writes the node holding all the schematic components.
      */
-    XNODE* makeComponents();
+    void writeComponents( NETLIST_TREE_WRITER& aWriter );
 
     /**
-     * Function makeDesignHeader
-     * fills out a project "design" header into an XML node.
-     * @return XNODE* - the design header
+     * Function writeDesignHeader
+     * writes a project "design" header node.
      */
-    XNODE* makeDesignHeader();
+    void writeDesignHeader( NETLIST_TREE_WRITER& aWriter );
 
     /**
-     * Function makeLibParts
-     * fills out an XML node with the unique library parts and returns it.
-     * @return XNODE* - the library parts nodes
+     * Function writeLibParts
+     * writes the node holding the unique library parts.
      */
-    XNODE* makeLibParts();
+    void writeLibParts( NETLIST_TREE_WRITER& aWriter );
 
     /**
-     * Function makeListOfNets
-     * fills out an XML node with a list of nets and returns it.
-     * @return XNODE* - the list of nets nodes
+     * Function writeListOfNetsNode
+     * writes the node holding the list of nets.
      */
-    XNODE* makeListOfNets();
+    void writeListOfNetsNode( NETLIST_TREE_WRITER& aWriter );
 
     /**
-     * Function makeLibraries
-     * fills out an XML node with a list of used libraries and returns it.
-     * Must have called makeGenericLibParts() before this function.
-     * @return XNODE* - the library nodes
+     * Function writeLibraries
+     * writes the node holding the list of used libraries.
+     * Must have called writeLibParts() before this function.
      */
-    XNODE* makeLibraries();
+    void writeLibraries( NETLIST_TREE_WRITER& aWriter );
 };
 
 #endif
@@ -71,7 +71,9 @@ void NETLIST_EXPORTER_KICAD::Format( OUTPUTFORMATTER* aOut, int aCtl )
     for( unsigned ii = 0; ii < m_masterList->size(); ii++ )
         m_masterList->GetItem( ii )->m_Flag = 0;
 
-    std::auto_ptr<XNODE> xroot( makeRoot( aCtl ) );
+    // Write the s-expressions while walking the schematic, rather than building
+    // the whole document tree first: the tree of a large design is huge.
+    SEXPR_TREE_WRITER writer( aOut );
 
-    xroot->Format( aOut, 0 );
+    writeRoot( writer, aCtl );
 }
@@ -33,6 +33,7 @@
 #include <gr_basic.h>
 #include <kicad_string.h>
 #include <richio.h>
+#include <line_scanner.h>
 #include <schframe.h>
 #include <plot_common.h>
 #include <msgpanel.h>
@@ -1155,13 +1156,13 @@ bool SCH_COMPONENT::Load( LINE_READER& aLine, wxString& aErrorMsg )
     // Remark: avoid using sscanf to read texts entered by user
     // which are UTF8 encoded, because sscanf does not work well on Windows
     // with some UTF8 values.
-    int         ii;
-    char        name1[256],
-                char1[256], char2[256], char3[256];
-    int         newfmt = 0;
-    char*       ptcar;
-    wxString    fieldName;
-    char*       line = aLine.Line();
+    char         name1[256];
+    int          newfmt = 0;
+    char*        ptcar;
+    wxString     fieldName;
+    char*        line = aLine.Line();
+    LINE_SCANNER scanner;
+    std::string  justifyField, styleField;
 
     m_convert = 1;
 
@@ -1262,11 +1263,20 @@ bool SCH_COMPONENT::Load( LINE_READER& aLine, wxString& aErrorMsg )
 
         if( line[0] == 'U' )
         {
-            sscanf( line + 1, "%d %d %lX", &m_unit, &m_convert, &m_TimeStamp );
+            unsigned long timeStamp;
+
+            scanner.SetLine( line + 1 );
+
+            if( scanner.ParseInt( m_unit ) && scanner.ParseInt( m_convert )
+              && scanner.ParseHex( timeStamp ) )
+                m_TimeStamp = (time_t) timeStamp;
         }
         else if( line[0] == 'P' )
         {
-            sscanf( line + 1, "%d %d", &m_Pos.x, &m_Pos.y );
+            scanner.SetLine( line + 1 );
+
+            if( scanner.ParseInt( m_Pos.x ) )
+                scanner.ParseInt( m_Pos.y );
 
             // Set fields position to a default position (that is the
             // component position.  For existing fields, the real position
@@ -1373,43 +1383,54 @@ bool SCH_COMPONENT::Load( LINE_READER& aLine, wxString& aErrorMsg )
             }
 
             GetField( fieldNdx )->SetText( fieldText );
-            memset( char3, 0, sizeof(char3) );
-            int x, y, w, attr;
 
-            if( ( ii = sscanf( ptcar, "%255s %d %d %d %X %255s %255s", char1, &x, &y, &w, &attr,
-                               char2, char3 ) ) < 4 )
+            char          orient;
+            int           x, y, w;
+            unsigned long attr = 0;
+
+            scanner.SetLine( ptcar );
+
+            if( !scanner.ParseChar( orient ) || !scanner.ParseInt( x )
+              || !scanner.ParseInt( y ) || !scanner.ParseInt( w ) )
             {
                 aErrorMsg.Printf( wxT( "Component Field error line %d, aborted" ),
                                   aLine.LineNumber() );
                 continue;
             }
 
+            // Attributes and justifications are missing in very old files.
+            bool hasAttributes = scanner.ParseHex( attr );
+            bool hasJustify = hasAttributes && scanner.ParseWord( justifyField )
+                              && scanner.ParseWord( styleField );
+
             GetField( fieldNdx )->SetTextPosition( wxPoint( x, y ) );
             GetField( fieldNdx )->SetAttributes( attr );
 
-            if( (w == 0 ) || (ii == 4) )
+            if( (w == 0 ) || !hasAttributes )
                 w = GetDefaultTextSize();
 
             GetField( fieldNdx )->SetSize( wxSize( w, w ) );
             GetField( fieldNdx )->SetOrientation( TEXT_ORIENT_HORIZ );
 
-            if( char1[0] == 'V' )
+            if( orient == 'V' )
                 GetField( fieldNdx )->SetOrientation( TEXT_ORIENT_VERT );
 
-            if( ii >= 7 )
+            if( hasJustify )
             {
-                if( *char2 == 'L' )
+                styleField.resize( 3, ' ' );
+
+                if( justifyField[0] == 'L' )
                     hjustify = GR_TEXT_HJUSTIFY_LEFT;
-                else if( *char2 == 'R' )
+                else if( justifyField[0] == 'R' )
                     hjustify = GR_TEXT_HJUSTIFY_RIGHT;
 
-                if( char3[0] == 'B' )
+                if( styleField[0] == 'B' )
                     vjustify = GR_TEXT_VJUSTIFY_BOTTOM;
-                else if( char3[0] == 'T' )
+                else if( styleField[0] == 'T' )
                     vjustify = GR_TEXT_VJUSTIFY_TOP;
 
-                GetField( fieldNdx )->SetItalic( char3[1] == 'I' );
-                GetField( fieldNdx )->SetBold( char3[2] == 'B' );
+                GetField( fieldNdx )->SetItalic( styleField[1] == 'I' );
+                GetField( fieldNdx )->SetBold( styleField[2] == 'B' );
                 GetField( fieldNdx )->SetHorizJustify( hjustify );
                 GetField( fieldNdx )->SetVertJustify( vjustify );
             }
@@ -1424,19 +1445,26 @@ bool SCH_COMPONENT::Load( LINE_READER& aLine, wxString& aErrorMsg )
         }
     }
 
-    if( sscanf( line, "%d %d %d", &m_unit, &m_Pos.x, &m_Pos.y ) != 3 )
+    scanner.SetLine( line );
+
+    if( !scanner.ParseInt( m_unit ) || !scanner.ParseInt( m_Pos.x ) || !scanner.ParseInt( m_Pos.y ) )
     {
         aErrorMsg.Printf( wxT( "Component unit & pos error at line %d, aborted" ),
                           aLine.LineNumber() );
         return false;
     }
 
-    if( !(line = aLine.ReadLine()) ||
-        sscanf( line, "%d %d %d %d",
-                &m_transform.x1,
-                &m_transform.y1,
-                &m_transform.x2,
-                &m_transform.y2 ) != 4 )
+    if( !(line = aLine.ReadLine()) )
+    {
+        aErrorMsg.Printf( wxT( "Component orient error at line %d, aborted" ),
+                          aLine.LineNumber() );
+        return false;
+    }
+
+    scanner.SetLine( line );
+
+    if( !scanner.ParseInt( m_transform.x1 ) || !scanner.ParseInt( m_transform.y1 )
+      || !scanner.ParseInt( m_transform.x2 ) || !scanner.ParseInt( m_transform.y2 ) )
     {
         aErrorMsg.Printf( wxT( "Component orient error at line %d, aborted" ),
                           aLine.LineNumber() );
@@ -0,0 +1,79 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_connection_index.cpp
+ */
+
+#include <algorithm>
+
+#include <sch_connection_index.h>
+
+
+void SCH_CONNECTION_INDEX::Clear()
+{
+    m_points.clear();
+    m_segments.clear();
+}
+
+
+void SCH_CONNECTION_INDEX::AddPoint( const wxPoint& aPosition, int aId )
+{
+    m_points[ pointKey( aPosition.x, aPosition.y ) ].push_back( aId );
+}
+
+
+void SCH_CONNECTION_INDEX::AddSegment( const wxPoint& aStart, const wxPoint& aEnd, int aId )
+{
+    int xmin = cellCoord( std::min( aStart.x, aEnd.x ) );
+    int xmax = cellCoord( std::max( aStart.x, aEnd.x ) );
+    int ymin = cellCoord( std::min( aStart.y, aEnd.y ) );
+    int ymax = cellCoord( std::max( aStart.y, aEnd.y ) );
+
+    // Schematic wires are almost always horizontal or vertical: the cells of the
+    // bounding box are the cells crossed by the segment.
+    for( int x = xmin; x <= xmax; x++ )
+    {
+        for( int y = ymin; y <= ymax; y++ )
+            m_segments[ pointKey( x, y ) ].push_back( aId );
+    }
+}
+
+
+void SCH_CONNECTION_INDEX::QueryPoints( const wxPoint& aPosition, std::vector<int>& aIds ) const
+{
+    CELLS::const_iterator it = m_points.find( pointKey( aPosition.x, aPosition.y ) );
+
+    if( it != m_points.end() )
+        aIds.insert( aIds.end(), it->second.begin(), it->second.end() );
+}
+
+
+void SCH_CONNECTION_INDEX::QuerySegments( const wxPoint& aPosition, std::vector<int>& aIds ) const
+{
+    CELLS::const_iterator it = m_segments.find( pointKey( cellCoord( aPosition.x ),
+                                                          cellCoord( aPosition.y ) ) );
+
+    if( it != m_segments.end() )
+        aIds.insert( aIds.end(), it->second.begin(), it->second.end() );
+}
@@ -0,0 +1,104 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_connection_index.h
+ */
+
+#ifndef _SCH_CONNECTION_INDEX_H_
+#define _SCH_CONNECTION_INDEX_H_
+
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <wx/gdicmn.h>
+
+
+/**
+ * Class SCH_CONNECTION_INDEX
+ * is a spatial hash of the connection points (pins, wire ends, labels ...) and of the
+ * wire and bus segments of a schematic sheet, used to find the items connected at a
+ * given position without scanning all the items of the sheet.
+ *
+ * Items are stored by an integer id chosen by the caller (usually an index in the
+ * caller's item list).  Queries return ids in insertion order.
+ */
+class SCH_CONNECTION_INDEX
+{
+public:
+    SCH_CONNECTION_INDEX() {}
+
+    /**
+     * Function Clear
+     * removes all points and segments from the index.
+     */
+    void Clear();
+
+    /**
+     * Function AddPoint
+     * adds a connection point.
+     */
+    void AddPoint( const wxPoint& aPosition, int aId );
+
+    /**
+     * Function AddSegment
+     * adds a segment, which can be connected to points anywhere on its length.
+     */
+    void AddSegment( const wxPoint& aStart, const wxPoint& aEnd, int aId );
+
+    /**
+     * Function QueryPoints
+     * appends to \a aIds the ids of the connection points at \a aPosition.
+     */
+    void QueryPoints( const wxPoint& aPosition, std::vector<int>& aIds ) const;
+
+    /**
+     * Function QuerySegments
+     * appends to \a aIds the ids of the segments which can contain \a aPosition.
+     * Segments are found from their grid cells: the caller must test the candidates
+     * (with IsPointOnSegment() for instance).
+     */
+    void QuerySegments( const wxPoint& aPosition, std::vector<int>& aIds ) const;
+
+private:
+    typedef boost::unordered_map< long long, std::vector<int> > CELLS;
+
+    /// Size of the cells of the segment grid, in internal units.
+    static const int SEGMENT_CELL_SIZE = 1000;
+
+    static long long pointKey( int aX, int aY )
+    {
+        return ( (long long) aX << 32 ) ^ (unsigned) aY;
+    }
+
+    static int cellCoord( int aCoord )
+    {
+        // Round towards minus infinity, so that negative coordinates have their own cells
+        return aCoord >= 0 ? aCoord / SEGMENT_CELL_SIZE
+                           : -( ( -aCoord - 1 ) / SEGMENT_CELL_SIZE ) - 1;
+    }
+
+    CELLS m_points;      ///< Connection points, by exact position
+    CELLS m_segments;    ///< Segments, by grid cell
+};
+
+#endif    // _SCH_CONNECTION_INDEX_H_
@@ -33,6 +33,7 @@
 #include <trigo.h>
 #include <common.h>
 #include <richio.h>
+#include <line_scanner.h>
 #include <plot_common.h>
 
 #include <sch_junction.h>
@@ -80,13 +81,9 @@ void SCH_JUNCTION::SwapData( SCH_ITEM* aItem )
 
 bool SCH_JUNCTION::Load( LINE_READER& aLine, wxString& aErrorMsg )
 {
-    char name[256];
-    char* line = (char*) aLine;
+    LINE_SCANNER scanner( aLine.Line() );
 
-    while( (*line != ' ' ) && *line )
-        line++;
-
-    if( sscanf( line, "%255s %d %d", name, &m_pos.x, &m_pos.y ) != 3 )
+    if( !scanner.SkipFields( 2 ) || !scanner.ParseInt( m_pos.x ) || !scanner.ParseInt( m_pos.y ) )
     {
         aErrorMsg.Printf( wxT( "Eeschema file connection load error at line %d, aborted" ),
                           aLine.LineNumber() );
@@ -36,6 +36,7 @@
 #include <eeschema_config.h>
 #include <general.h>
 #include <protos.h>
+#include <line_scanner.h>
 #include <sch_line.h>
 #include <class_netlist_object.h>
 
@@ -167,14 +168,11 @@ bool SCH_LINE::Save( FILE* aFile ) const
 
 bool SCH_LINE::Load( LINE_READER& aLine, wxString& aErrorMsg )
 {
-    char  Name1[256];
-    char  Name2[256];
-    char* line = (char*) aLine;
+    char         layer;
+    LINE_SCANNER scanner( aLine.Line() );
 
-    while( (*line != ' ' ) && *line )
-        line++;
-
-    if( sscanf( line, "%255s %255s", Name1, Name2 ) != 2  )
+    // "Wire Wire Line", "Wire Bus Line" or "Wire Notes Line"
+    if( !scanner.SkipFields( 1 ) || !scanner.ParseChar( layer ) || !scanner.SkipFields( 1 ) )
     {
         aErrorMsg.Printf( wxT( "Eeschema file segment error at line %d, aborted" ),
                           aLine.LineNumber() );
@@ -184,14 +182,23 @@ bool SCH_LINE::Load( LINE_READER& aLine, wxString& aErrorMsg )
 
     m_Layer = LAYER_NOTES;
 
-    if( Name1[0] == 'W' )
+    if( layer == 'W' )
         m_Layer = LAYER_WIRE;
 
-    if( Name1[0] == 'B' )
+    if( layer == 'B' )
         m_Layer = LAYER_BUS;
 
-    if( !aLine.ReadLine() || sscanf( (char*) aLine, "%d %d %d %d ",
-                                      &m_start.x, &m_start.y, &m_end.x, &m_end.y ) != 4 )
+    if( !aLine.ReadLine() )
+    {
+        aErrorMsg.Printf( wxT( "Eeschema file Segment struct error at line %d, aborted" ),
+                          aLine.LineNumber() );
+        return false;
+    }
+
+    scanner.SetLine( aLine.Line() );
+
+    if( !scanner.ParseInt( m_start.x ) || !scanner.ParseInt( m_start.y )
+      || !scanner.ParseInt( m_end.x ) || !scanner.ParseInt( m_end.y ) )
     {
         aErrorMsg.Printf( wxT( "Eeschema file Segment struct error at line %d, aborted" ),
                           aLine.LineNumber() );
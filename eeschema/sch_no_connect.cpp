@@ -33,6 +33,7 @@
 #include <class_drawpanel.h>
 #include <common.h>
 #include <plot_common.h>
+#include <line_scanner.h>
 
 #include <general.h>
 #include <sch_no_connect.h>
@@ -95,13 +96,9 @@ bool SCH_NO_CONNECT::Save( FILE* aFile ) const
 
 bool SCH_NO_CONNECT::Load( LINE_READER& aLine, wxString& aErrorMsg )
 {
-    char name[256];
-    char* line = (char*) aLine;
+    LINE_SCANNER scanner( aLine.Line() );
 
-    while( (*line != ' ' ) && *line )
-        line++;
-
-    if( sscanf( line, "%255s %d %d", name, &m_pos.x, &m_pos.y ) != 3 )
+    if( !scanner.SkipFields( 2 ) || !scanner.ParseInt( m_pos.x ) || !scanner.ParseInt( m_pos.y ) )
     {
         aErrorMsg.Printf( wxT( "Eeschema file No Connect load error at line %d" ),
                           aLine.LineNumber() );
@@ -464,6 +464,34 @@ private:
      * @return The first free (not yet used) value.
      */
     int CreateFirstFreeRefId( std::vector<int>& aIdList, int aFirstValue );
+
+    /**
+     * Function CreateFirstFreeRefId
+     * is the same search as above, but resumes from \a aScanStart instead of the beginning
+     * of \a aIdList.  All the entries before \a aScanStart must be the consecutive values
+     * starting at \a aFirstValue, which is what successive calls on the same list leave
+     * behind.  Reset \a aScanStart to 0 whenever the list is rebuilt.
+     * @param aIdList The buffer that contains the reference numbers in use, all >= aFirstValue.
+     * @param aFirstValue The first expected free value
+     * @param aScanStart The position to resume from, updated for the next call.
+     * @return The first free (not yet used) value.
+     */
+    int CreateFirstFreeRefId( std::vector<int>& aIdList, int aFirstValue, unsigned& aScanStart );
+
+    /**
+     * Function findUnit
+     * is FindUnit() restricted to the items indexed by \a aCandidates, used by Annotate()
+     * with the items sharing the reference prefix and number of \a aIndex.
+     */
+    int findUnit( const std::vector<unsigned>& aCandidates, size_t aIndex, int aUnit );
+
+    /**
+     * Function getRefsInUse
+     * is GetRefsInUse() restricted to the items indexed by \a aPrefixItems, which must be
+     * all the items using the reference prefix being annotated.
+     */
+    void getRefsInUse( const std::vector<unsigned>& aPrefixItems, std::vector< int >& aIdList,
+                       int aMinRefId );
 };
 
 #endif    // _SCH_REFERENCE_LIST_H_
@@ -53,7 +53,9 @@
 #include <sch_component.h>
 #include <sch_text.h>
 #include <lib_pin.h>
+#include <sch_connection_index.h>
 
+#include <algorithm>
 #include <boost/foreach.hpp>
 
 #define EESCHEMA_FILE_STAMP   "EESchema"
@@ -935,14 +937,81 @@ bool SCH_SCREEN::TestDanglingEnds( EDA_DRAW_PANEL* aCanvas, wxDC* aDC )
 {
     SCH_ITEM* item;
     std::vector< DANGLING_END_ITEM > endPoints;
+    std::vector< unsigned > firstEndPoint;    // index of the first end point of each item
     bool hasDanglingEnds = false;
 
     for( item = m_drawList.begin(); item; item = item->Next() )
+    {
+        firstEndPoint.push_back( endPoints.size() );
         item->GetEndPoints( endPoints );
+    }
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    firstEndPoint.push_back( endPoints.size() );
+
+    // Index the end points, and the wires and buses (stored in endPoints as a
+    // start and end pair), so each item is only tested against the end points
+    // located at its own connection points.
+    SCH_CONNECTION_INDEX index;
+
+    for( unsigned ii = 0; ii < endPoints.size(); ii++ )
     {
-        if( item->IsDanglingStateChanged( endPoints ) && ( aCanvas ) && ( aDC ) )
+        index.AddPoint( endPoints[ii].GetPosition(), ii );
+
+        if( ( endPoints[ii].GetType() == WIRE_START_END
+              || endPoints[ii].GetType() == BUS_START_END ) && ii + 1 < endPoints.size() )
+            index.AddSegment( endPoints[ii].GetPosition(), endPoints[ii + 1].GetPosition(), ii );
+    }
+
+    std::vector< int > candidates;
+    std::vector< DANGLING_END_ITEM > nearEndPoints;
+    unsigned itemIdx = 0;
+
+    for( item = m_drawList.begin(); item; item = item->Next(), itemIdx++ )
+    {
+        candidates.clear();
+
+        for( unsigned ii = firstEndPoint[itemIdx]; ii < firstEndPoint[itemIdx + 1]; ii++ )
+        {
+            const wxPoint& pos = endPoints[ii].GetPosition();
+
+            index.QueryPoints( pos, candidates );
+            index.QuerySegments( pos, candidates );
+        }
+
+        // Wires and buses must be given as complete start and end pairs.
+        for( unsigned ii = 0, count = candidates.size(); ii < count; ii++ )
+        {
+            int idx = candidates[ii];
+
+            switch( endPoints[idx].GetType() )
+            {
+            case WIRE_START_END:
+            case BUS_START_END:
+                if( idx + 1 < (int) endPoints.size() )
+                    candidates.push_back( idx + 1 );
+                break;
+
+            case WIRE_END_END:
+            case BUS_END_END:
+                if( idx > 0 )
+                    candidates.push_back( idx - 1 );
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        // Keep the original order of the end points.
+        std::sort( candidates.begin(), candidates.end() );
+        candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+        nearEndPoints.clear();
+
+        for( unsigned ii = 0; ii < candidates.size(); ii++ )
+            nearEndPoints.push_back( endPoints[ candidates[ii] ] );
+
+        if( item->IsDanglingStateChanged( nearEndPoints ) && ( aCanvas ) && ( aDC ) )
         {
             item->Draw( aCanvas, aDC, wxPoint( 0, 0 ), g_XorMode );
             item->Draw( aCanvas, aDC, wxPoint( 0, 0 ), GR_DEFAULT_DRAWMODE );
@@ -217,5 +217,7 @@ void GERBVIEW_FRAME::Block_Move( wxDC* DC )
             gerb_item->MoveAB( delta );
     }
 
+    GetGerberLayout()->InvalidateItemsIndex();
+
     m_canvas->Refresh( true );
 }
@@ -278,7 +278,7 @@ void GERBER_IMAGE::InitToolTable()
  */
 void GERBER_IMAGE::ReportMessage( const wxString aMessage )
 {
-    m_Parent->ReportMessage( aMessage );
+    m_Messages.Add( aMessage );
 }
 
 
@@ -289,7 +289,7 @@ void GERBER_IMAGE::ReportMessage( const wxString aMessage )
  */
 void GERBER_IMAGE::ClearMessageList()
 {
-    m_Parent->ClearMessageList();
+    m_Messages.Clear();
 }
 
 
@@ -323,7 +323,7 @@ void GERBER_IMAGE::StepAndRepeatItem( const GERBER_DRAW_ITEM& aItem )
             move_vector.y = scaletoIU( jj * GetLayerParams().m_StepForRepeat.y,
                                    GetLayerParams().m_StepForRepeatMetric );
             dupItem->MoveXY( move_vector );
-            m_Parent->GetGerberLayout()->m_Drawings.Append( dupItem );
+            m_Drawings.Append( dupItem );
         }
     }
 }
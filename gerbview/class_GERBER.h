@@ -154,6 +154,11 @@ public:
 
     APERTURE_MACRO_SET m_aperture_macros;                       ///< a collection of APERTURE_MACROS, sorted by name
 
+    DLIST<GERBER_DRAW_ITEM> m_Drawings;                         // Items read from the file. They are moved
+                                                                // to the GBR_LAYOUT items list by the frame
+                                                                // once the file is read
+    wxArrayString      m_Messages;                              // Messages found when reading the file
+
 private:
     int                m_hasNegativeItems;                      // true if the image is negative or has some negative items
                                                                 // Used to optimize drawing, because when there are no
@@ -204,7 +209,7 @@ public:
 
     /**
      * Function ReportMessage
-     * Add a message (a string) in message list
+     * Add a message (a string) in the message list of this image
      * for instance when reading a Gerber file
      * @param aMessage = the straing to add in list
      */
@@ -212,11 +217,21 @@ public:
 
     /**
      * Function ClearMessageList
-     * Clear the message list
+     * Clear the message list of this image
      * Call it before reading a Gerber file
      */
     void    ClearMessageList();
 
+    /**
+     * Function LoadGerberFile
+     * reads the gerber file opened in m_Current_File (RS274D, RS274X or RS274X2 format),
+     * and closes it.
+     * The items are stored in m_Drawings, and the errors in m_Messages: the frame is not
+     * used, so several files can be read at the same time, by different threads, in
+     * different images.  The C locale must be set by the caller (see LOCALE_IO).
+     */
+    void    LoadGerberFile();
+
     /**
      * Function InitToolTable
      */
@@ -236,6 +251,19 @@ public:
      */
     wxPoint ReadIJCoord( char*& Text );
 
+    /**
+     * Function coordToIU
+     * converts a coordinate value read in a X, Y, I or J command to internal units
+     * @param aValue = the value read
+     * @param aDigitCount = the number of digits of the value
+     * @param aIsFloat = true if the value is given in decimal format (in mm or inches)
+     * @param aFmtScale = the format scale (number of digits of the mantissa)
+     * @param aFmtLen = the number of digits of the coordinate format, used
+     *          when the trailing zeros are omitted
+     */
+    int     coordToIU( double aValue, int aDigitCount, bool aIsFloat,
+                       int aFmtScale, int aFmtLen ) const;
+
     // functions to read G commands or D commands:
     int     GCodeNumber( char*& Text );
     int     DCodeNumber( char*& Text );
@@ -37,6 +37,7 @@
 GBR_LAYOUT::GBR_LAYOUT()
 {
     m_printLayersMask.set();
+    m_itemsIndexValid = false;
 }
 
 
@@ -55,3 +56,98 @@ EDA_RECT GBR_LAYOUT::ComputeBoundingBox()
     SetBoundingBox( bbox );
     return bbox;
 }
+
+
+void GBR_LAYOUT::buildItemsIndex()
+{
+    m_indexedItems.clear();
+
+    for( int layer = 0; layer < GERBER_DRAWLAYERS_COUNT; ++layer )
+    {
+        m_itemsIndex[layer].RemoveAll();
+        m_unboundedItems[layer].clear();
+    }
+
+    for( GERBER_DRAW_ITEM* item = m_Drawings; item; item = item->Next() )
+    {
+        int rank = m_indexedItems.size();
+        int layer = item->GetLayer();
+
+        m_indexedItems.push_back( item );
+
+        if( layer < 0 || layer >= GERBER_DRAWLAYERS_COUNT )
+            continue;
+
+        // The actual shape of aperture macros is not known: they are always drawn
+        if( item->Shape() == GBR_SPOT_MACRO )
+        {
+            m_unboundedItems[layer].push_back( rank );
+            continue;
+        }
+
+        EDA_RECT bbox = item->GetBoundingBox();
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        m_itemsIndex[layer].Insert( mmin, mmax, rank );
+    }
+
+    m_itemsIndexValid = true;
+}
+
+
+/**
+ * Class GBR_ITEMS_COLLECTOR
+ * is the R-tree visitor used by QueryItems(): it stores the rank of found items
+ */
+struct GBR_ITEMS_COLLECTOR
+{
+    GBR_ITEMS_COLLECTOR( std::vector<int>& aRanks ) : m_ranks( aRanks ) {}
+
+    bool operator()( int aRank )
+    {
+        m_ranks.push_back( aRank );
+        return true;
+    }
+
+    std::vector<int>& m_ranks;
+};
+
+
+void GBR_LAYOUT::QueryItems( int aLayer, const EDA_RECT& aArea,
+                             std::vector<GERBER_DRAW_ITEM*>& aList )
+{
+    if( aLayer >= GERBER_DRAWLAYERS_COUNT )
+        return;
+
+    // Items appended or deleted without an explicit invalidation
+    if( m_itemsIndexValid && m_indexedItems.size() != m_Drawings.GetCount() )
+        m_itemsIndexValid = false;
+
+    if( !m_itemsIndexValid )
+        buildItemsIndex();
+
+    EDA_RECT area = aArea;
+    area.Normalize();
+
+    std::vector<int> ranks;
+    GBR_ITEMS_COLLECTOR collector( ranks );
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    for( int layer = 0; layer < GERBER_DRAWLAYERS_COUNT; ++layer )
+    {
+        if( aLayer >= 0 && layer != aLayer )
+            continue;
+
+        ranks.insert( ranks.end(), m_unboundedItems[layer].begin(),
+                      m_unboundedItems[layer].end() );
+        m_itemsIndex[layer].Search( mmin, mmax, collector );
+    }
+
+    // Keep the list order: negative items must be drawn after the items they erase
+    std::sort( ranks.begin(), ranks.end() );
+
+    for( unsigned ii = 0; ii < ranks.size(); ii++ )
+        aList.push_back( m_indexedItems[ranks[ii]] );
+}
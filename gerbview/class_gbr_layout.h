@@ -32,7 +32,9 @@
 #define CLASS_GBR_LAYOUT_H
 
 
+#include <vector>
 #include <dlist.h>
+#include <geometry/rtree.h>
 
 #include <class_colors_design_settings.h>
 #include <common.h>                         // PAGE_INFO
@@ -42,6 +44,9 @@
 
 #include <gr_basic.h>
 
+/// R-tree of the items of a graphic layer. Items are stored by their rank in m_Drawings
+typedef RTree<int, int, 2, float> GBR_ITEMS_RTREE;
+
 /**
  * Class GBR_LAYOUT
  * holds list of GERBER_DRAW_ITEM currently loaded.
@@ -53,6 +58,16 @@ private:
     TITLE_BLOCK         m_titles;
     wxPoint             m_originAxisPosition;
     std::bitset <GERBER_DRAWLAYERS_COUNT> m_printLayersMask; // When printing: the list of layers to print
+
+    // Spatial index of m_Drawings, built on demand by QueryItems()
+    bool                m_itemsIndexValid;
+    std::vector<GERBER_DRAW_ITEM*> m_indexedItems;  // m_Drawings items, in list order
+    GBR_ITEMS_RTREE     m_itemsIndex[GERBER_DRAWLAYERS_COUNT];
+    std::vector<int>    m_unboundedItems[GERBER_DRAWLAYERS_COUNT]; // rank of items with no
+                                                                   // usable bounding box
+
+    void buildItemsIndex();
+
 public:
 
     DLIST<GERBER_DRAW_ITEM> m_Drawings;     // linked list of Gerber Items to draw
@@ -96,6 +111,24 @@ public:
 
     void SetBoundingBox( const EDA_RECT& aBox ) { m_BoundingBox = aBox; }
 
+    /**
+     * Function QueryItems
+     * collects the items of a graphic layer which can be seen inside an area.
+     * The spatial index is rebuilt first if it is no longer valid.
+     * @param aLayer = the graphic layer, or -1 to search all layers
+     * @param aArea = the area, in draw (A,B) coordinates
+     * @param aList = the list to fill. Items are appended in m_Drawings order,
+     *        i.e. in draw order
+     */
+    void QueryItems( int aLayer, const EDA_RECT& aArea, std::vector<GERBER_DRAW_ITEM*>& aList );
+
+    /**
+     * Function InvalidateItemsIndex
+     * must be called after items are added, removed, moved or change their graphic layer.
+     * The spatial index used by QueryItems() will be rebuilt on the next query.
+     */
+    void InvalidateItemsIndex() { m_itemsIndexValid = false; }
+
     /**
      * Function Draw.
      * Redraw the CLASS_GBR_LAYOUT items but not cursors, axis or grid.
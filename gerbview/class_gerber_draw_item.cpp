@@ -241,11 +241,61 @@ const EDA_RECT GERBER_DRAW_ITEM::GetBoundingBox() const
     // return a rectangle which is (pos,dim) in nature.  therefore the +1
     EDA_RECT bbox( m_Start, wxSize( 1, 1 ) );
 
-    bbox.Inflate( m_Size.x / 2, m_Size.y / 2 );
+    switch( m_Shape )
+    {
+    case GBR_POLYGON:
+        bbox.Merge( m_End );
+
+        for( unsigned ii = 0; ii < m_PolyCorners.size(); ii++ )
+            bbox.Merge( m_PolyCorners[ii] );
+        break;
+
+    case GBR_CIRCLE:
+    {
+        int radius = KiROUND( GetLineLength( m_Start, m_End ) );
+        bbox.Inflate( radius );
+        bbox.Merge( m_End );
+    }
+        break;
+
+    case GBR_ARC:
+    {
+        // Use the full circle: the arc is always inside it
+        int radius = KiROUND( GetLineLength( m_ArcCentre, m_Start ) );
+        bbox = EDA_RECT( m_ArcCentre, wxSize( 1, 1 ) );
+        bbox.Inflate( radius );
+        bbox.Merge( m_Start );
+        bbox.Merge( m_End );
+    }
+        break;
+
+    case GBR_SEGMENT:
+        bbox.Merge( m_End );
+
+        // segments drawn with a rectangular aperture are drawn as polygons
+        for( unsigned ii = 0; ii < m_PolyCorners.size(); ii++ )
+            bbox.Merge( m_PolyCorners[ii] );
+        break;
+
+    default:
+        // Flashed items. Note: the shape of aperture macros can be larger than m_Size
+        break;
+    }
+
+    // The pen (or the aperture for flashed items) size.
+    // The largest dimension is used, because the item can be rotated
+    int penSize = std::max( m_Size.x, m_Size.y );
+    bbox.Inflate( penSize / 2 + 1 );
+
+    // Transform the 4 corners, because rotation and mirroring can change
+    // the corner which is the top left corner of the rectangle
+    wxPoint corner = GetABPosition( bbox.GetOrigin() );
+    EDA_RECT abBox( corner, wxSize( 0, 0 ) );
+    abBox.Merge( GetABPosition( bbox.GetEnd() ) );
+    abBox.Merge( GetABPosition( wxPoint( bbox.GetX(), bbox.GetBottom() ) ) );
+    abBox.Merge( GetABPosition( wxPoint( bbox.GetRight(), bbox.GetY() ) ) );
 
-    bbox.SetOrigin( GetABPosition( bbox.GetOrigin() ) );
-    bbox.SetEnd( GetABPosition( bbox.GetEnd() ) );
-    return bbox;
+    return abBox;
 }
 
 
@@ -210,6 +210,7 @@ void GERBER_LAYER_WIDGET::onPopupSelection( wxCommandEvent& event )
 
     case ID_SORT_GBR_LAYERS:
         g_GERBER_List.SortImagesByZOrder( myframe->GetItemsList() );
+        myframe->GetGerberLayout()->InvalidateItemsIndex();
         myframe->ReFillLayerWidget();
         myframe->syncLayerBox();
         myframe->GetCanvas()->Refresh();
@@ -224,6 +224,15 @@ void GBR_LAYOUT::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDrawMode,
 
     bool end = false;
 
+    // Items outside the clip box are not drawn. They are skipped using the spatial index.
+    // When printing, the clip box is not related to the drawing area: nothing is skipped
+    EDA_RECT cullBox = drawBox;
+
+    if( aPanel->GetScreen()->m_IsPrinting )
+        cullBox = EDA_RECT( wxPoint( INT_MIN / 2, INT_MIN / 2 ), wxSize( INT_MAX, INT_MAX ) );
+
+    std::vector<GERBER_DRAW_ITEM*> layerItems;
+
     // Draw layers from bottom to top, and active layer last
     // in non transparent modes, the last layer drawn mask mask previously drawn layer
     for( int layer = GERBER_DRAWLAYERS_COUNT-1; !end; --layer )
@@ -325,11 +334,12 @@ void GBR_LAYOUT::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDrawMode,
 
         // Now we can draw the current layer to the bitmap buffer
         // When needed, the previous bitmap is already copied to the screen buffer.
-        for( GERBER_DRAW_ITEM* item = gerbFrame->GetItemsList(); item; item = item->Next() )
-        {
-            if( item->GetLayer() != layer )
-                continue;
+        layerItems.clear();
+        QueryItems( layer, cullBox, layerItems );
 
+        for( unsigned ii = 0; ii < layerItems.size(); ii++ )
+        {
+            GERBER_DRAW_ITEM* item = layerItems[ii];
             GR_DRAWMODE drawMode = layerdrawMode;
 
             if( dcode_highlight && dcode_highlight == item->m_DCode )
@@ -190,7 +190,7 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
         return false;
     }
 
-    ClearMessageList();
+    drill_Layer->ClearMessageList();
 
     /* Read the gerber file */
     FILE * file = wxFopen( aFullFileName, wxT( "rt" ) );
@@ -208,11 +208,15 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
 
     bool success = drill_Layer->Read_EXCELLON_File( file, aFullFileName );
 
+    // Move the items read from the file to the layout
+    GetGerberLayout()->m_Drawings.Append( drill_Layer->m_Drawings );
+    GetGerberLayout()->InvalidateItemsIndex();
+
     // Display errors list
-    if( m_Messages.size() > 0 )
+    if( drill_Layer->m_Messages.size() > 0 )
     {
         HTML_MESSAGE_BOX dlg( this, _( "Files not found" ) );
-        dlg.ListSet( m_Messages );
+        dlg.ListSet( drill_Layer->m_Messages );
         dlg.ShowModal();
     }
     return success;
@@ -289,8 +293,7 @@ bool EXCELLON_IMAGE::Read_EXCELLON_File( FILE * aFile,
             {
                 wxString msg;
                 msg.Printf( wxT( "Unexpected symbol &lt;%c&gt;" ), *text );
-                if( GetParent() )
-                    GetParent()->ReportMessage( msg );
+                ReportMessage( msg );
             }
                 break;
             }   // End switch
@@ -536,18 +539,18 @@ bool EXCELLON_IMAGE::Execute_Drill_Command( char*& text )
                     return false;
                 }
                 gbritem = new GERBER_DRAW_ITEM( GetParent()->GetGerberLayout(), this );
-                GetParent()->GetGerberLayout()->m_Drawings.Append( gbritem );
+                m_Drawings.Append( gbritem );
                 if( m_SlotOn )  // Oval hole
                 {
                     fillLineGBRITEM( gbritem,
-                                    tool->m_Num_Dcode, GetParent()->getActiveLayer(),
+                                    tool->m_Num_Dcode, m_GraphicLayer,
                                     m_PreviousPos, m_CurrentPos,
                                     tool->m_Size, false );
                 }
                 else
                 {
                     fillFlashedGBRITEM( gbritem, tool->m_Shape,
-                                    tool->m_Num_Dcode, GetParent()->getActiveLayer(),
+                                    tool->m_Num_Dcode, m_GraphicLayer,
                                     m_CurrentPos,
                                     tool->m_Size, false );
                 }
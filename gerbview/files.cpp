@@ -37,6 +37,19 @@
 #include <gerbview_id.h>
 #include <class_gerbview_layer_widget.h>
 #include <wildcards_and_files_ext.h>
+#include <class_GERBER.h>
+
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+
+// Reads the gerber files of aImages[aFirst], aImages[aFirst + aStep] ...
+static void loadGerberImages( std::vector<GERBER_IMAGE*>* aImages,
+                              unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aImages->size(); ii += aStep )
+        (*aImages)[ii]->LoadGerberFile();
+}
 
 
 void GERBVIEW_FRAME::OnGbrFileHistory( wxCommandEvent& event )
@@ -173,8 +186,12 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
         m_mruPath = currentPath;
     }
 
-    // Read gerber files: each file is loaded on a new GerbView layer
+    // Read gerber files: each file is loaded on a new GerbView layer.
+    // The files are opened and given a layer one after the other, then read in
+    // parallel, each one in its own image, and the items read are given to the
+    // layout in the file order.
     int layer = getActiveLayer();
+    std::vector<GERBER_IMAGE*> images;
 
     for( unsigned ii = 0; ii < filenamesList.GetCount(); ii++ )
     {
@@ -187,8 +204,11 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
 
         setActiveLayer( layer, false );
 
-        if( Read_GERBER_File( filename.GetFullPath(), filename.GetFullPath() ) )
+        GERBER_IMAGE* gerber = openGerberFile( filename.GetFullPath() );
+
+        if( gerber )
         {
+            images.push_back( gerber );
             UpdateFileHistory( m_lastFileName );
 
             layer = getNextAvailableLayer( layer );
@@ -205,6 +225,8 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
         }
     }
 
+    readGerberImages( images );
+
     Zoom_Automatique( false );
 
     // Synchronize layers tools with actual active layer:
@@ -216,6 +238,39 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
 }
 
 
+void GERBVIEW_FRAME::readGerberImages( std::vector<GERBER_IMAGE*>& aImages )
+{
+    if( aImages.empty() )
+        return;
+
+    {
+        // The locale is set here once for all the files: LOCALE_IO is not
+        // instantiated by the worker threads
+        LOCALE_IO toggleIo;
+
+        unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+        threadCount = std::min( threadCount, (unsigned) aImages.size() );
+
+        // Something which will not invoke a thread copy constructor
+        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+        MYTHREADS threads;
+
+        for( unsigned ii = 1; ii < threadCount; ii++ )
+            threads.push_back( new boost::thread( &loadGerberImages, &aImages,
+                                                  ii, threadCount ) );
+
+        loadGerberImages( &aImages, 0, threadCount );
+
+        for( unsigned ii = 0; ii < threads.size(); ++ii )
+            threads[ii].join();
+    }
+
+    for( unsigned ii = 0; ii < aImages.size(); ii++ )
+        finishGerberFileLoad( aImages[ii] );
+}
+
+
 bool GERBVIEW_FRAME::LoadExcellonFiles( const wxString& aFullFileName )
 {
     wxString   filetypes;
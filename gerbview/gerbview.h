@@ -38,6 +38,13 @@
 */
 #define GERBER_BUFZ     4000
 
+/**
+ * size of the stdio buffer used to read gerber files.
+ * Gerber files are read line by line, and can be huge (tens of MB),
+ * so they are read by large blocks.
+ */
+#define GERBER_FILE_BUFFER_SIZE ( 1024 * 1024 )
+
 /// List of page sizes
 extern const wxChar* g_GerberPageSizeList[8];
 
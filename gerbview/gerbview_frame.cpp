@@ -214,11 +214,34 @@ bool GERBVIEW_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
 
         int layer = 0;
 
+        // Open the files one after the other, each one on its layer, and read them
+        // in parallel
+        std::vector<GERBER_IMAGE*> images;
+
         for( unsigned i=0;  i<limit;  ++i, ++layer )
         {
-            setActiveLayer( layer );
-            LoadGerberFiles( aFileSet[i] );
+            setActiveLayer( layer, false );
+
+            wxFileName filename = aFileSet[i];
+            m_mruPath = filename.GetPath();
+            m_lastFileName = filename.GetFullPath();
+
+            GERBER_IMAGE* gerber = openGerberFile( m_lastFileName );
+
+            if( gerber )
+            {
+                images.push_back( gerber );
+                UpdateFileHistory( m_lastFileName );
+            }
         }
+
+        readGerberImages( images );
+
+        // Synchronize layers tools with actual active layer:
+        ReFillLayerWidget();
+        setActiveLayer( getActiveLayer() );
+        m_LayersManager->UpdateLayerIcons();
+        syncLayerBox();
     }
 
     Zoom_Automatique( true );        // Zoom fit in frame
@@ -45,6 +45,7 @@ class DCODE_SELECTION_BOX;
 class GERBER_LAYER_WIDGET;
 class GBR_LAYER_BOX_SELECTOR;
 class GERBER_DRAW_ITEM;
+class GERBER_IMAGE;
 
 
 /**
@@ -620,6 +621,30 @@ public:
     bool                Read_GERBER_File( const wxString&   GERBER_FullFileName,
                                           const wxString&   D_Code_FullFileName );
 
+    /**
+     * Function openGerberFile
+     * prepares the image of the active layer to read a gerber file, and opens the file.
+     * The file is then read by GERBER_IMAGE::LoadGerberFile(), which can be called
+     * from a worker thread, and finishGerberFileLoad() must be called once it is read.
+     * @param aFullFileName = the gerber file name
+     * @return the image, or NULL (and an error is displayed) if the file cannot be opened.
+     */
+    GERBER_IMAGE*       openGerberFile( const wxString& aFullFileName );
+
+    /**
+     * Function finishGerberFileLoad
+     * moves the items read in \a aGerber to the layout, and displays the errors found
+     * in the file.
+     */
+    void                finishGerberFileLoad( GERBER_IMAGE* aGerber );
+
+    /**
+     * Function readGerberImages
+     * reads the gerber files opened by openGerberFile() in \a aImages, in parallel,
+     * then calls finishGerberFileLoad() for each one, in the order of \a aImages.
+     */
+    void                readGerberImages( std::vector<GERBER_IMAGE*>& aImages );
+
     /**
      * function LoadDrllFiles
      * Load a drill (EXCELLON) file or many files.
@@ -50,6 +50,7 @@ bool GERBVIEW_FRAME::Clear_DrawLayers( bool query )
     }
 
     GetGerberLayout()->m_Drawings.DeleteAll();
+    GetGerberLayout()->InvalidateItemsIndex();
 
     g_GERBER_List.ClearList();
 
@@ -89,6 +90,8 @@ void GERBVIEW_FRAME::Erase_Current_DrawLayer( bool query )
         item->DeleteStructure();
     }
 
+    GetGerberLayout()->InvalidateItemsIndex();
+
     g_GERBER_List.ClearImage( layer );
 
     GetScreen()->SetModify();
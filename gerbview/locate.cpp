@@ -48,17 +48,20 @@ GERBER_DRAW_ITEM* GERBVIEW_FRAME::Locate( const wxPoint& aPosition, int aTypeloc
         ref = GetNearestGridPosition( ref );
 
     int layer = getActiveLayer();
+    GBR_LAYOUT* layout = GetGerberLayout();
+    EDA_RECT refArea( ref, wxSize( 1, 1 ) );
+    std::vector<GERBER_DRAW_ITEM*> candidates;
 
     // Search first on active layer
-    GERBER_DRAW_ITEM* gerb_item = GetItemsList();
+    GERBER_DRAW_ITEM* gerb_item = NULL;
 
-    for( ; gerb_item; gerb_item = gerb_item->Next() )
-    {
-        if( gerb_item->GetLayer()!= layer )
-            continue;
+    layout->QueryItems( layer, refArea, candidates );
 
-        if( gerb_item->HitTest( ref ) )
+    for( unsigned ii = 0; ii < candidates.size(); ii++ )
+    {
+        if( candidates[ii]->HitTest( ref ) )
         {
+            gerb_item = candidates[ii];
             found = true;
             break;
         }
@@ -66,10 +69,14 @@ GERBER_DRAW_ITEM* GERBVIEW_FRAME::Locate( const wxPoint& aPosition, int aTypeloc
 
     if( !found ) // Search on all layers
     {
-        for( gerb_item = GetItemsList(); gerb_item; gerb_item = gerb_item->Next() )
+        candidates.clear();
+        layout->QueryItems( -1, refArea, candidates );
+
+        for( unsigned ii = 0; ii < candidates.size(); ii++ )
         {
-            if( gerb_item->HitTest( ref ) )
+            if( candidates[ii]->HitTest( ref ) )
             {
+                gerb_item = candidates[ii];
                 found = true;
                 break;
             }
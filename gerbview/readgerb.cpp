@@ -39,16 +39,26 @@
 bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
                                            const wxString& D_Code_FullFileName )
 {
-    int      G_command = 0;        // command number for G commands like G04
-    int      D_commande = 0;       // command number for D commands like D02
+    GERBER_IMAGE* gerber = openGerberFile( GERBER_FullFileName );
 
-    char     line[GERBER_BUFZ];
+    if( gerber == NULL )
+        return false;
 
-    wxString msg;
-    char*    text;
-    int layer;         // current layer used in GerbView
+    {
+        LOCALE_IO toggleIo;
+        gerber->LoadGerberFile();
+    }
+
+    finishGerberFileLoad( gerber );
 
-    layer = getActiveLayer();
+    return true;
+}
+
+
+GERBER_IMAGE* GERBVIEW_FRAME::openGerberFile( const wxString& aFullFileName )
+{
+    wxString msg;
+    int      layer = getActiveLayer();     // current layer used in GerbView
     GERBER_IMAGE* gerber = g_GERBER_List.GetGbrImage( layer );
 
     if( gerber == NULL )
@@ -57,40 +67,88 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
         g_GERBER_List.AddGbrImage( gerber, layer );
     }
 
-    ClearMessageList( );
+    gerber->ClearMessageList();
 
     /* Set the gerber scale: */
     gerber->ResetDefaultValues();
 
-    /* Read the gerber file */
-    gerber->m_Current_File = wxFopen( GERBER_FullFileName, wxT( "rt" ) );
+    /* Open the gerber file */
+    gerber->m_Current_File = wxFopen( aFullFileName, wxT( "rt" ) );
+
     if( gerber->m_Current_File == 0 )
     {
-        msg.Printf( _( "File <%s> not found" ), GetChars( GERBER_FullFileName ) );
+        msg.Printf( _( "File <%s> not found" ), GetChars( aFullFileName ) );
         DisplayError( this, msg, 10 );
-        return false;
+        return NULL;
     }
 
-    gerber->m_FileName = GERBER_FullFileName;
+    setvbuf( gerber->m_Current_File, NULL, _IOFBF, GERBER_FILE_BUFFER_SIZE );
+
+    gerber->m_FileName = aFullFileName;
+
+    wxString path = wxPathOnly( aFullFileName );
 
-    wxString path = wxPathOnly( GERBER_FullFileName );
     if( path != wxEmptyString )
         wxSetWorkingDirectory( path );
 
-    LOCALE_IO toggleIo;
+    return gerber;
+}
+
+
+void GERBVIEW_FRAME::finishGerberFileLoad( GERBER_IMAGE* aGerber )
+{
+    wxString msg;
+
+    // Move the items read from the file to the layout
+    GetGerberLayout()->m_Drawings.Append( aGerber->m_Drawings );
+
+    aGerber->m_InUse = true;
+
+    // Polygons are built in place in the item list: the spatial index must be rebuilt
+    GetGerberLayout()->InvalidateItemsIndex();
+
+    // Display errors list
+    if( aGerber->m_Messages.size() > 0 )
+    {
+        HTML_MESSAGE_BOX dlg( this, _("Errors") );
+        dlg.ListSet( aGerber->m_Messages );
+        dlg.ShowModal();
+    }
+
+    /* if the gerber file is only a RS274D file
+     * (i.e. without any aperture information), wran the user:
+     */
+    if( !aGerber->m_Has_DCode )
+    {
+        msg = _("Warning: this file has no D-Code definition\n"
+                "It is perhaps an old RS274D file\n"
+                "Therefore the size of items is undefined");
+        wxMessageBox( msg );
+    }
+}
+
+
+void GERBER_IMAGE::LoadGerberFile()
+{
+    int      G_command = 0;        // command number for G commands like G04
+    int      D_commande = 0;       // command number for D commands like D02
+
+    char     line[GERBER_BUFZ];
+
+    wxString msg;
+    char*    text;
 
     while( true )
     {
-        if( fgets( line, sizeof(line), gerber->m_Current_File ) == NULL )
+        if( fgets( line, sizeof(line), m_Current_File ) == NULL )
         {
-            if( gerber->m_FilesPtr == 0 )
+            if( m_FilesPtr == 0 )
                 break;
 
-            fclose( gerber->m_Current_File );
+            fclose( m_Current_File );
 
-            gerber->m_FilesPtr--;
-            gerber->m_Current_File =
-                gerber->m_FilesList[gerber->m_FilesPtr];
+            m_FilesPtr--;
+            m_Current_File = m_FilesList[m_FilesPtr];
 
             continue;
         }
@@ -108,57 +166,55 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
                 break;
 
             case '*':       // End command
-                gerber->m_CommandState = END_BLOCK;
+                m_CommandState = END_BLOCK;
                 text++;
                 break;
 
             case 'M':       // End file
-                gerber->m_CommandState = CMD_IDLE;
+                m_CommandState = CMD_IDLE;
                 while( *text )
                     text++;
                 break;
 
             case 'G':    /* Line type Gxx : command */
-                G_command = gerber->GCodeNumber( text );
-                gerber->Execute_G_Command( text, G_command );
+                G_command = GCodeNumber( text );
+                Execute_G_Command( text, G_command );
                 break;
 
             case 'D':       /* Line type Dxx : Tool selection (xx > 0) or
                              * command if xx = 0..9 */
-                D_commande = gerber->DCodeNumber( text );
-                gerber->Execute_DCODE_Command( text, D_commande );
+                D_commande = DCodeNumber( text );
+                Execute_DCODE_Command( text, D_commande );
                 break;
 
             case 'X':
             case 'Y':                   /* Move or draw command */
-                gerber->m_CurrentPos = gerber->ReadXYCoord( text );
+                m_CurrentPos = ReadXYCoord( text );
                 if( *text == '*' )      // command like X12550Y19250*
                 {
-                    gerber->Execute_DCODE_Command( text,
-                                                   gerber->m_Last_Pen_Command );
+                    Execute_DCODE_Command( text, m_Last_Pen_Command );
                 }
                 break;
 
             case 'I':
             case 'J':       /* Auxiliary Move command */
-                gerber->m_IJPos = gerber->ReadIJCoord( text );
+                m_IJPos = ReadIJCoord( text );
                 if( *text == '*' )      // command like X35142Y15945J504*
                 {
-                    gerber->Execute_DCODE_Command( text,
-                                                   gerber->m_Last_Pen_Command );
+                    Execute_DCODE_Command( text, m_Last_Pen_Command );
                 }
                 break;
 
             case '%':
-                if( gerber->m_CommandState != ENTER_RS274X_CMD )
+                if( m_CommandState != ENTER_RS274X_CMD )
                 {
-                    gerber->m_CommandState = ENTER_RS274X_CMD;
-                    gerber->ReadRS274XCommand( line, text );
+                    m_CommandState = ENTER_RS274X_CMD;
+                    ReadRS274XCommand( line, text );
                 }
                 else        //Error
                 {
                     ReportMessage( wxT("Expected RS274X Command")  );
-                    gerber->m_CommandState = CMD_IDLE;
+                    m_CommandState = CMD_IDLE;
                     text++;
                 }
                 break;
@@ -172,28 +228,6 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
         }
     }
 
-    fclose( gerber->m_Current_File );
-
-    gerber->m_InUse = true;
-
-    // Display errors list
-    if( m_Messages.size() > 0 )
-    {
-        HTML_MESSAGE_BOX dlg( this, _("Errors") );
-        dlg.ListSet(m_Messages);
-        dlg.ShowModal();
-    }
-
-    /* if the gerber file is only a RS274D file
-     * (i.e. without any aperture information), wran the user:
-     */
-    if( !gerber->m_Has_DCode )
-    {
-        msg = _("Warning: this file has no D-Code definition\n"
-                "It is perhaps an old RS274D file\n"
-                "Therefore the size of items is undefined");
-        wxMessageBox( msg );
-    }
-
-    return true;
+    fclose( m_Current_File );
+    m_Current_File = NULL;
 }
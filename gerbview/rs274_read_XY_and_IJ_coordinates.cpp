@@ -71,14 +71,113 @@ int scaletoIU( double aCoord, bool isMetric )
 }
 
 
+/**
+ * Function readCoordNumber
+ * reads a coordinate value ( [+-]digits[.digits] ) in a gerber command.
+ * The C library conversion functions are not used: they are slow, depend on
+ * the current locale and need a copy of the number in a separate buffer.
+ * @param aText = a reference to the text to read. On exit, it points
+ *          the first char after the number
+ * @param aDigitCount = the number of digits read (sign and decimal point are not counted)
+ * @param aIsFloat = set to true if the number has a decimal point, unchanged otherwise
+ * @return double - the value read
+ */
+static double readCoordNumber( char*& aText, int& aDigitCount, bool& aIsFloat )
+{
+    static const double pow10[] =
+    {
+        1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+    };
+
+    double  mantissa = 0.0;
+    int     decimals = 0;
+    bool    negative = false;
+    bool    decimalPoint = false;
+    bool    valid    = true;    // false after a misplaced sign or decimal point
+
+    aDigitCount = 0;
+
+    if( *aText == '-' || *aText == '+' )
+    {
+        negative = *aText == '-';
+        aText++;
+    }
+
+    while( IsNumber( *aText ) )
+    {
+        if( *aText >= '0' && *aText <= '9' )
+        {
+            aDigitCount++;
+
+            if( valid )
+            {
+                mantissa = mantissa * 10.0 + ( *aText - '0' );
+
+                if( decimalPoint )
+                    decimals++;
+            }
+        }
+        else if( *aText == '.' )
+        {
+            aIsFloat = true;
+
+            if( decimalPoint )
+                valid = false;
+
+            decimalPoint = true;
+        }
+        else    // A sign inside a number: the end of the number
+        {
+            valid = false;
+        }
+
+        aText++;
+    }
+
+    if( decimals )
+        mantissa /= decimals < (int) DIM( pow10 ) ? pow10[decimals] : pow( 10.0, decimals );
+
+    return negative ? -mantissa : mantissa;
+}
+
+
+int GERBER_IMAGE::coordToIU( double aValue, int aDigitCount, bool aIsFloat,
+                             int aFmtScale, int aFmtLen ) const
+{
+    if( aIsFloat )
+    {
+        // When X or Y values are float numbers, they are given in mm or inches
+        if( m_GerbMetric )  // units are mm
+            return KiROUND( aValue * IU_PER_MILS / 0.0254 );
+        else    // units are inches
+            return KiROUND( aValue * IU_PER_MILS * 1000 );
+    }
+
+    if( m_NoTrailingZeros )
+    {
+        // Add the missing trailing zeros
+        while( aDigitCount < aFmtLen )
+        {
+            aValue *= 10.0;
+            aDigitCount++;
+        }
+    }
+
+    double real_scale = scale_list[aFmtScale];
+
+    if( m_GerbMetric )
+        real_scale = real_scale / 25.4;
+
+    return KiROUND( aValue * real_scale );
+}
+
+
 wxPoint GERBER_IMAGE::ReadXYCoord( char*& Text )
 {
     wxPoint pos;
     int     type_coord = 0, current_coord, nbdigits;
     bool    is_float   = m_DecimalFormat;
-    char*   text;
-    char    line[256];
-
 
     if( m_Relative )
         pos.x = pos.y = 0;
@@ -88,62 +187,22 @@ wxPoint GERBER_IMAGE::ReadXYCoord( char*& Text )
     if( Text == NULL )
         return pos;
 
-    text = line;
     while( *Text )
     {
         if( (*Text == 'X') || (*Text == 'Y') )
         {
             type_coord = *Text;
             Text++;
-            text     = line;
-            nbdigits = 0;
 
-            while( IsNumber( *Text ) )
-            {
-                if( *Text == '.' )  // Force decimat format if reading a floating point number
-                    is_float = true;
-
-                // count digits only (sign and decimal point are not counted)
-                if( (*Text >= '0') && (*Text <='9') )
-                    nbdigits++;
-                *(text++) = *(Text++);
-            }
+            // is_float is forced to true if reading a floating point number
+            double value = readCoordNumber( Text, nbdigits, is_float );
 
-            *text = 0;
-
-            if( is_float )
-            {
-                // When X or Y values are float numbers, they are given in mm or inches
-                if( m_GerbMetric )  // units are mm
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS / 0.0254 );
-                else    // units are inches
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS * 1000 );
-            }
+            if( type_coord == 'X' )
+                current_coord = coordToIU( value, nbdigits, is_float,
+                                           m_FmtScale.x, m_FmtLen.x );
             else
-            {
-                int fmt_scale = (type_coord == 'X') ? m_FmtScale.x : m_FmtScale.y;
-
-                if( m_NoTrailingZeros )
-                {
-                    int min_digit =
-                        (type_coord == 'X') ? m_FmtLen.x : m_FmtLen.y;
-                    while( nbdigits < min_digit )
-                    {
-                        *(text++) = '0';
-                        nbdigits++;
-                    }
-
-                    *text = 0;
-                }
-
-                current_coord = atoi( line );
-                double real_scale = scale_list[fmt_scale];
-
-                if( m_GerbMetric )
-                    real_scale = real_scale / 25.4;
-
-                current_coord = KiROUND( current_coord * real_scale );
-            }
+                current_coord = coordToIU( value, nbdigits, is_float,
+                                           m_FmtScale.y, m_FmtLen.y );
 
             if( type_coord == 'X' )
                 pos.x = current_coord;
@@ -177,69 +236,26 @@ wxPoint GERBER_IMAGE::ReadIJCoord( char*& Text )
 
     int     type_coord = 0, current_coord, nbdigits;
     bool    is_float   = false;
-    char*   text;
-    char    line[256];
 
     if( Text == NULL )
         return pos;
 
-    text = line;
     while( *Text )
     {
         if( (*Text == 'I') || (*Text == 'J') )
         {
             type_coord = *Text;
             Text++;
-            text     = line;
-            nbdigits = 0;
-            while( IsNumber( *Text ) )
-            {
-                if( *Text == '.' )
-                    is_float = true;
-
-                // count digits only (sign and decimal point are not counted)
-                if( (*Text >= '0') && (*Text <='9') )
-                    nbdigits++;
 
-                *(text++) = *(Text++);
-            }
+            double value = readCoordNumber( Text, nbdigits, is_float );
 
-            *text = 0;
-            if( is_float )
-            {
-                // When X or Y values are float numbers, they are given in mm or inches
-                if( m_GerbMetric )  // units are mm
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS / 0.0254 );
-                else    // units are inches
-                    current_coord = KiROUND( atof( line ) * IU_PER_MILS * 1000 );
-            }
+            if( type_coord == 'I' )
+                current_coord = coordToIU( value, nbdigits, is_float,
+                                           m_FmtScale.x, m_FmtLen.x );
             else
-            {
-                int fmt_scale =
-                    (type_coord == 'I') ? m_FmtScale.x : m_FmtScale.y;
-
-                if( m_NoTrailingZeros )
-                {
-                    int min_digit =
-                        (type_coord == 'I') ? m_FmtLen.x : m_FmtLen.y;
-                    while( nbdigits < min_digit )
-                    {
-                        *(text++) = '0';
-                        nbdigits++;
-                    }
-
-                    *text = 0;
-                }
+                current_coord = coordToIU( value, nbdigits, is_float,
+                                           m_FmtScale.y, m_FmtLen.y );
 
-                current_coord = atoi( line );
-
-                double real_scale = scale_list[fmt_scale];
-
-                if( m_GerbMetric )
-                    real_scale = real_scale / 25.4;
-
-                current_coord = KiROUND( current_coord * real_scale );
-            }
             if( type_coord == 'I' )
                 pos.x = current_coord;
             else if( type_coord == 'J' )
@@ -551,9 +551,9 @@ bool GERBER_IMAGE::Execute_G_Command( char*& text, int G_command )
         break;
 
     case GC_TURN_OFF_POLY_FILL:
-        if( m_Exposure && m_Parent->GetGerberLayout()->m_Drawings )    // End of polygon
+        if( m_Exposure && m_Drawings )    // End of polygon
         {
-            GERBER_DRAW_ITEM * gbritem = m_Parent->GetGerberLayout()->m_Drawings.GetLast();
+            GERBER_DRAW_ITEM * gbritem = m_Drawings.GetLast();
             StepAndRepeatItem( *gbritem );
         }
         m_Exposure = false;
@@ -584,7 +584,8 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
     GERBER_DRAW_ITEM* gbritem;
     GBR_LAYOUT*       layout = m_Parent->GetGerberLayout();
 
-    int activeLayer = m_Parent->getActiveLayer();
+    // The items are stored in this image: this function can run in a worker thread
+    int activeLayer = m_GraphicLayer;
 
     int      dcode = 0;
     D_CODE*  tool  = NULL;
@@ -621,7 +622,7 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             {
                 m_Exposure = true;
                 gbritem    = new GERBER_DRAW_ITEM( layout, this );
-                layout->m_Drawings.Append( gbritem );
+                m_Drawings.Append( gbritem );
                 gbritem->m_Shape = GBR_POLYGON;
                 gbritem->SetLayer( activeLayer );
                 gbritem->m_Flashed = false;
@@ -631,7 +632,7 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             {
             case GERB_INTERPOL_ARC_NEG:
             case GERB_INTERPOL_ARC_POS:
-                gbritem = layout->m_Drawings.GetLast();
+                gbritem = m_Drawings.GetLast();
 
                 //               D( printf( "Add arc poly %d,%d to %d,%d fill %d interpol %d 360_enb %d\n",
                 //                          m_PreviousPos.x, m_PreviousPos.y, m_CurrentPos.x,
@@ -644,7 +645,7 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
                 break;
 
             default:
-                gbritem = layout->m_Drawings.GetLast();
+                gbritem = m_Drawings.GetLast();
 
 //                D( printf( "Add poly edge %d,%d to %d,%d fill %d\n",
 //                           m_PreviousPos.x, m_PreviousPos.y,
@@ -664,9 +665,9 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             break;
 
         case 2:     // code D2: exposure OFF (i.e. "move to")
-            if( m_Exposure && layout->m_Drawings )    // End of polygon
+            if( m_Exposure && m_Drawings )    // End of polygon
             {
-                gbritem = layout->m_Drawings.GetLast();
+                gbritem = m_Drawings.GetLast();
                 StepAndRepeatItem( *gbritem );
             }
             m_Exposure    = false;
@@ -697,7 +698,7 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             {
             case GERB_INTERPOL_LINEAR_1X:
                 gbritem = new GERBER_DRAW_ITEM( layout, this );
-                layout->m_Drawings.Append( gbritem );
+                m_Drawings.Append( gbritem );
 
 //                D( printf( "Add line %d,%d to %d,%d\n",
 //                           m_PreviousPos.x, m_PreviousPos.y,
@@ -710,13 +711,16 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             case GERB_INTERPOL_LINEAR_01X:
             case GERB_INTERPOL_LINEAR_001X:
             case GERB_INTERPOL_LINEAR_10X:
-                wxBell();
+                // Not a GUI call (wxBell) here: this can run in a worker thread
+                msg.Printf( wxT( "RS274D: DCODE Command: interpolation (type %X) not handled" ),
+                            m_Iterpolation );
+                ReportMessage( msg );
                 break;
 
             case GERB_INTERPOL_ARC_NEG:
             case GERB_INTERPOL_ARC_POS:
                 gbritem = new GERBER_DRAW_ITEM( layout, this );
-                layout->m_Drawings.Append( gbritem );
+                m_Drawings.Append( gbritem );
 
 //                D( printf( "Add arc %d,%d to %d,%d center %d, %d interpol %d 360_enb %d\n",
 //                           m_PreviousPos.x, m_PreviousPos.y, m_CurrentPos.x,
@@ -754,7 +758,7 @@ bool GERBER_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             }
 
             gbritem = new GERBER_DRAW_ITEM( layout, this );
-            layout->m_Drawings.Append( gbritem );
+            m_Drawings.Append( gbritem );
             fillFlashedGBRITEM( gbritem, aperture,
                                 dcode, activeLayer, m_CurrentPos,
                                 size, GetLayerParams().m_LayerNegative );
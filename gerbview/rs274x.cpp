@@ -601,10 +601,20 @@ bool GERBER_IMAGE::ExecuteRS274XCommand( int       command,
         strncpy( line, text, sizeof(line)-1 );
         line[sizeof(line)-1] = '\0';
 
-        strtok( line, "*%%\n\r" );
+        // No strtok() or working directory here: several files can be read at the same
+        // time.  A relative include file name is relative to the gerber file.
+        line[ strcspn( line, "*%\n\r" ) ] = 0;
         m_FilesList[m_FilesPtr] = m_Current_File;
 
-        m_Current_File = fopen( line, "rt" );
+        {
+            wxFileName includeFile( FROM_UTF8( line ) );
+
+            if( !includeFile.IsAbsolute() )
+                includeFile.MakeAbsolute( wxPathOnly( m_FileName ) );
+
+            m_Current_File = wxFopen( includeFile.GetFullPath(), wxT( "rt" ) );
+        }
+
         if( m_Current_File == 0 )
         {
             msg.Printf( wxT( "include file <%s> not found." ), line );
@@ -613,6 +623,8 @@ bool GERBER_IMAGE::ExecuteRS274XCommand( int       command,
             m_Current_File = m_FilesList[m_FilesPtr];
             break;
         }
+
+        setvbuf( m_Current_File, NULL, _IOFBF, GERBER_FILE_BUFFER_SIZE );
         m_FilesPtr++;
         break;
 
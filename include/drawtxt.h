@@ -112,6 +112,8 @@ int OverbarPositionY( int size_v );
  *                  used to draw 3D texts or for plotting, NULL for normal drawings
  *  @param aPlotter = a pointer to a PLOTTER instance, when this function is used to plot
  *                  the text. NULL to draw this text.
+ *  @param aCallbackData = the last parameter given to aCallback, e.g. the buffer which
+ *                  receives the segments
  */
 void DrawGraphicText( EDA_RECT* aClipBox,
                       wxDC * aDC,
@@ -125,8 +127,9 @@ void DrawGraphicText( EDA_RECT* aClipBox,
                       int aWidth,
                       bool aItalic,
                       bool aBold,
-                      void (*aCallback)( int x0, int y0, int xf, int yf ) = NULL,
-                      PLOTTER * aPlotter = NULL );
+                      void (*aCallback)( int x0, int y0, int xf, int yf, void* aData ) = NULL,
+                      PLOTTER * aPlotter = NULL,
+                      void* aCallbackData = NULL );
 
 
 /**
@@ -149,7 +152,9 @@ void DrawGraphicHaloText( EDA_RECT* aClipBox,
                           int aWidth,
                           bool aItalic,
                           bool aBold,
-                          void (*aCallback)( int x0, int y0, int xf, int yf ) = NULL,
-                          PLOTTER * aPlotter = NULL );
+                          void (*aCallback)( int x0, int y0, int xf, int yf,
+                                             void* aData ) = NULL,
+                          PLOTTER * aPlotter = NULL,
+                          void* aCallbackData = NULL );
 
 #endif /* __INCLUDE__DRAWTXT_H__ */
@@ -0,0 +1,152 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file line_scanner.h
+ */
+
+#ifndef LINE_SCANNER_H_
+#define LINE_SCANNER_H_
+
+#include <string>
+
+
+/**
+ * Class LINE_SCANNER
+ * reads the blank separated fields of one line of a legacy (non s-expression) schematic
+ * or library file, as read by a LINE_READER.
+ * <p>
+ * It replaces the sscanf() and strtok() calls of the legacy loaders: numbers are
+ * converted by hand, so they do not depend on the current locale and need no LOCALE_IO,
+ * the line is never modified, and there is no hidden static state, so several threads
+ * can load files at the same time.  Text fields are returned as UTF8 bytes and are left
+ * to the caller to convert, which avoids the problems sscanf has with UTF8 on Windows.
+ * <p>
+ * Blanks are spaces, tabs, carriage returns and line feeds.  The Parse functions skip
+ * leading blanks and consume one field.  They return false, leaving the field in place,
+ * if there is no field left or if the field does not start with a valid value.  As with
+ * sscanf, a number ends at the first character which cannot belong to it.
+ */
+class LINE_SCANNER
+{
+public:
+    LINE_SCANNER( const char* aLine = "" ) :
+        m_next( aLine )
+    {
+    }
+
+    /**
+     * Function SetLine
+     * restarts the scan at the beginning of \a aLine.
+     */
+    void SetLine( const char* aLine )       { m_next = aLine; }
+
+    /**
+     * Function Position
+     * @return the not yet scanned part of the line.
+     */
+    const char* Position() const            { return m_next; }
+
+    /**
+     * Function AtEnd
+     * skips blanks and returns true if nothing is left on the line.
+     */
+    bool AtEnd();
+
+    /**
+     * Function FieldCount
+     * returns the number of fields left on the line, without consuming them.
+     */
+    int FieldCount() const;
+
+    /**
+     * Function SkipFields
+     * skips \a aCount fields.
+     * @return false if there were less than \a aCount fields left.
+     */
+    bool SkipFields( int aCount = 1 );
+
+    /**
+     * Function ParseInt
+     * reads a decimal integer with an optional sign, like sscanf( "%d" ).
+     */
+    bool ParseInt( int& aValue );
+
+    /**
+     * Function ParseDouble
+     * reads a decimal floating point number, like sscanf( "%lf" ) in the C locale: an
+     * optional sign, digits with an optional '.' and an optional exponent.  Hexadecimal,
+     * inf and nan are not accepted.
+     */
+    bool ParseDouble( double& aValue );
+
+    /**
+     * Function ParseHex
+     * reads an hexadecimal integer with an optional 0x prefix, like sscanf( "%lX" ).
+     */
+    bool ParseHex( unsigned long& aValue );
+
+    /**
+     * Function ParseChar
+     * reads the first character of the next field and skips the remaining of this field.
+     */
+    bool ParseChar( char& aValue );
+
+    /**
+     * Function ParseWord
+     * reads the next field as is into \a aWord, replacing its previous contents.  The
+     * capacity of \a aWord is kept, so it can be reused from line to line.  \a aWord is
+     * cleared if there is no field left.
+     */
+    bool ParseWord( std::string& aWord );
+
+    /**
+     * Function SkipChar
+     * consumes \a aChar if it is the next character, like a literal in a sscanf format,
+     * to read fields such as "2015/03/12" with consecutive Parse calls.
+     * @return false, leaving the line unchanged, if the next character is not \a aChar.
+     */
+    bool SkipChar( char aChar );
+
+private:
+    static inline bool isBlank( char c )
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    void skipBlanks()
+    {
+        while( isBlank( *m_next ) )
+            m_next++;
+    }
+
+    void skipField()
+    {
+        while( *m_next && !isBlank( *m_next ) )
+            m_next++;
+    }
+
+    const char* m_next;         ///< The first character not yet scanned.
+};
+
+#endif  // LINE_SCANNER_H_
@@ -349,6 +349,13 @@ public:
     }
 
 protected:
+    /**
+     * Function closeOutputFile
+     * closes the plot file, at the end of EndPlot().
+     * @return false if a write to the file or its closing failed.
+     */
+    bool closeOutputFile();
+
     // These are marker subcomponents
     /**
      * Plot a circle centered on the position. Building block for markers
@@ -618,6 +625,9 @@ protected:
                                       std::vector<int> *pos_pairs );
     void fputsPostscriptString(FILE *fout, const wxString& txt);
 
+    /// Same as fputsPostscriptString, but returns the escaped string
+    std::string encodePostscriptString( const wxString& txt );
+
     /// Virtual primitive for emitting the setrgbcolor operator
     virtual void emitSetRGBColor( double r, double g, double b ) = 0;
 
@@ -691,14 +701,18 @@ protected:
     virtual void emitSetRGBColor( double r, double g, double b );
 };
 
+class wxOutputStream;
+class wxZlibOutputStream;
+
 class PDF_PLOTTER : public PSLIKE_PLOTTER
 {
 public:
-    PDF_PLOTTER() : pageStreamHandle( 0 ), workFile( NULL )
+    PDF_PLOTTER() : pageStreamHandle( 0 ), m_fileStream( NULL ), m_zlibStream( NULL )
     {
         // Avoid non initialized variables:
         pageStreamHandle = streamLengthHandle = fontResDictHandle = 0;
         pageTreeHandle = 0;
+        m_streamStart = 0;
     }
 
     virtual PlotFormat GetPlotterType() const
@@ -768,13 +782,31 @@ protected:
     void closePdfObject();
     int startPdfStream(int handle = -1);
     void closePdfStream();
+
+    /// Write to the current content stream, printf style
+    void streamPrintf( const char* aFormat, ... );
+
+    /// Write a string to the current content stream
+    void streamPuts( const char* aText );
+
+    /**
+     * Fast path for path construction, used by polygons and polylines:
+     * write "x y aOperator" followed by aSeparator to the current content stream
+     */
+    void streamPoint( const DPOINT& aPos, char aOperator, char aSeparator = '\n' );
+
+    /// Deflate the pending content stream data into the PDF file
+    void flushStream();
+
     int pageTreeHandle;		 /// Handle to the root of the page tree object
     int fontResDictHandle;	 /// Font resource dictionary
     std::vector<int> pageHandles;/// Handles to the page objects
     int pageStreamHandle;	 /// Handle of the page content object
     int streamLengthHandle;      /// Handle to the deferred stream length
-    wxString workFilename;
-    FILE* workFile;  	         /// Temporary file to costruct the stream before zipping
+    std::string m_streamBuffer;  /// Content stream data not yet deflated
+    long m_streamStart;          /// Offset of the deflated data of the current stream
+    wxOutputStream* m_fileStream;     /// outputFile, seen as a wxOutputStream
+    wxZlibOutputStream* m_zlibStream; /// Deflates the current content stream, NULL if none
     std::vector<long> xrefTable; /// The PDF xref offset table
 };
 
@@ -985,9 +1017,12 @@ protected:
     std::vector<APERTURE>::iterator
     getAperture( const wxSize& size, APERTURE::APERTURE_TYPE type );
 
-    FILE* workFile;
-    FILE* finalFile;
-    wxString m_workFilename;
+    /**
+     * The gerber body (everything after the aperture list), built in memory
+     * because the aperture list is known only at the end of the plot.
+     * EndPlot() writes it to the plot file, after the aperture list
+     */
+    std::string m_body;
 
     /**
      * Generate the table of D codes
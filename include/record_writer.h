@@ -0,0 +1,124 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file record_writer.h
+ */
+
+#ifndef RECORD_WRITER_H_
+#define RECORD_WRITER_H_
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * Class RECORD_WRITER
+ * writes the text records of the fabrication and exchange files (GenCAD, IPC-D-356,
+ * footprint position files...) to an open FILE, through a large buffer.
+ * <p>
+ * Print() takes the same format strings as fprintf(), and gives the same output.
+ * The common conversions (%d, %u, %c, %s, %g and %f with their usual flags, width and
+ * precision) are formatted here, without the C library and independently of the
+ * locale; the other ones are passed to snprintf().
+ * <p>
+ * The FILE is neither opened nor closed by this class, and the buffer is flushed
+ * when the writer is destroyed: destroy it, or call Flush(), before closing the file.
+ */
+class RECORD_WRITER
+{
+public:
+    /**
+     * Constructor
+     * @param aFile is the file to write to, opened by the caller.
+     * @param aBufferSize is the size of the output buffer.
+     */
+    RECORD_WRITER( FILE* aFile, size_t aBufferSize = 65536 );
+
+    ~RECORD_WRITER();
+
+#if defined(__GNUG__)
+    // the first argument is "this"
+#define RECORD_WRITER_PRINTF    __attribute__ ((format (printf, 2, 3)))
+#else
+#define RECORD_WRITER_PRINTF
+#endif
+
+    /**
+     * Function Print
+     * formats and writes text, like fprintf().
+     */
+    void RECORD_WRITER_PRINTF Print( const char* aFormat, ... );
+
+    /**
+     * Function Text
+     * writes aText, like fputs().
+     */
+    void Text( const char* aText );
+
+    void Text( const std::string& aText ) { put( aText.data(), aText.size() ); }
+
+    /**
+     * Function Flush
+     * writes the buffered text to the file, e.g. before something else writes
+     * to it directly.  The file itself is not flushed.
+     * @return false if a write to the file failed, since the writer was created.
+     */
+    bool Flush();
+
+private:
+    void put( const char* aText, size_t aCount )
+    {
+        if( m_buffer.size() - m_used < aCount )
+            flushBuffer();
+
+        if( aCount > m_buffer.size() )
+        {
+            // Larger than the buffer: written directly
+            m_failed |= fwrite( aText, 1, aCount, m_file ) != aCount;
+            return;
+        }
+
+        memcpy( &m_buffer[m_used], aText, aCount );
+        m_used += aCount;
+    }
+
+    /// writes the buffer to the file.
+    void flushBuffer();
+
+    /// writes aCount characters of aText in a field of aWidth characters.
+    void putField( const char* aText, size_t aCount, int aWidth, bool aLeft,
+                   char aPadChar = ' ' );
+
+    void vprint( const char* aFormat, va_list aArgs );
+
+    FILE*               m_file;
+    std::vector<char>   m_buffer;
+    size_t              m_used;
+    bool                m_failed;
+};
+
+#endif  // RECORD_WRITER_H_
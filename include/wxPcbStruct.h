@@ -92,6 +92,8 @@ class PCB_EDIT_FRAME : public PCB_BASE_EDIT_FRAME
     /**
      * Function loadFootprints
      * loads the footprints for each #COMPONENT in \a aNetlist from the list of libraries.
+     * Each footprint is read only once, and footprints from different libraries are
+     * read concurrently.
      *
      * @param aNetlist is the netlist of components to load the footprints into.
      * @param aReporter is the #REPORTER object to report to.
@@ -1599,9 +1601,18 @@ public:
     void AutoPlaceModule( MODULE* Module, int place_mode, wxDC* DC );
 
     // Autorouting:
-    int Solve( wxDC* DC, int two_sides );
+
+    /**
+     * Function Solve
+     * routes the connections of the work list built by Autoroute().
+     * @param DC = the current device context
+     * @param two_sides = the number of routing layers (1 or 2)
+     * @param aConcurrent = true to search the paths of the connections which do not
+     *                      overlap at the same time, in worker threads
+     */
+    int Solve( wxDC* DC, int two_sides, bool aConcurrent = false );
     void Reset_Noroutable( wxDC* DC );
-    void Autoroute( wxDC* DC, int mode );
+    void Autoroute( wxDC* DC, int mode, bool aConcurrent = false );
     void ReadAutoroutedTracks( wxDC* DC );
     void GlobalRoute( wxDC* DC );
 
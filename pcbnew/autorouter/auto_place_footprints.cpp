@@ -51,6 +51,13 @@
 #include <base_units.h>
 #include <protos.h>
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
 
 #define GAIN            16
 #define KEEP_OUT_MARGIN 500
@@ -100,16 +107,6 @@ int             genPlacementRoutingMatrix(  BOARD* aBrd, EDA_MSG_PANEL* messageP
 static int      getOptimalModulePlacement( PCB_EDIT_FRAME* aFrame,
                                            MODULE* aModule, wxDC* aDC );
 
-/*
- * Function compute_Ratsnest_PlaceModule
- * displays the module's ratsnest during displacement, and assess the "cost"
- * of the position.
- *
- * The cost is the longest ratsnest distance with penalty for connections
- * approaching 45 degrees.
- */
-static double   compute_Ratsnest_PlaceModule( BOARD* aBrd );
-
 /* Place a footprint on the Routing matrix.
  */
 void            genModuleOnRoutingMatrix( MODULE* Module );
@@ -118,8 +115,6 @@ void            genModuleOnRoutingMatrix( MODULE* Module );
  */
 static void     drawPlacementRoutingMatrix( BOARD* aBrd, wxDC* DC );
 
-static int      TstModuleOnBoard( BOARD* Pcb, MODULE* Module, bool TstOtherSide );
-
 static void     CreateKeepOutRectangle( int ux0, int uy0, int ux1, int uy1,
                                         int marge, int aKeepOut, LSET aLayerMask );
 
@@ -536,9 +531,8 @@ int genPlacementRoutingMatrix( BOARD* aBrd, EDA_MSG_PANEL* messagePanel )
         ii = propagate();
 
     // Initialize top layer. to the same value as the bottom layer
-    if( RoutingMatrix.m_BoardSide[TOP] )
-        memcpy( RoutingMatrix.m_BoardSide[TOP], RoutingMatrix.m_BoardSide[BOTTOM],
-                nbCells * sizeof(MATRIX_CELL) );
+    if( RoutingMatrix.m_Cells[TOP] )
+        RoutingMatrix.CopyCells( BOTTOM, TOP );
 
     return 1;
 }
@@ -613,341 +607,609 @@ inline void draw_FootprintRect(EDA_RECT * aClipBox, wxDC* aDC, EDA_RECT& fpBBox,
 #endif
 }
 
-int getOptimalModulePlacement( PCB_EDIT_FRAME* aFrame, MODULE* aModule, wxDC* aDC )
+
+/* Calculates the range of cells of the routing matrix inside aRect.
+ * Returns false if no cell is inside aRect.
+ */
+static bool getCellRange( const EDA_RECT& aRect, int& aRowMin, int& aRowMax,
+                          int& aColMin, int& aColMax )
 {
-    int     error = 1;
-    wxPoint LastPosOK;
-    double  min_cost, curr_cost, Score;
-    bool    TstOtherSide;
-    DISPLAY_OPTIONS* displ_opts = (DISPLAY_OPTIONS*)aFrame->GetDisplayOptions();
-    BOARD*  brd = aFrame->GetBoard();
+    wxPoint start   = aRect.GetOrigin();
+    wxPoint end     = aRect.GetEnd();
 
-    aModule->CalculateBoundingBox();
+    start   -= RoutingMatrix.m_BrdBox.GetOrigin();
+    end     -= RoutingMatrix.m_BrdBox.GetOrigin();
 
-    bool showRats = displ_opts->m_Show_Module_Ratsnest;
-    displ_opts->m_Show_Module_Ratsnest = false;
+    aRowMin = start.y / RoutingMatrix.m_GridRouting;
+    aRowMax = end.y / RoutingMatrix.m_GridRouting;
+    aColMin = start.x / RoutingMatrix.m_GridRouting;
+    aColMax = end.x / RoutingMatrix.m_GridRouting;
 
-    brd->m_Status_Pcb &= ~RATSNEST_ITEM_LOCAL_OK;
-    aFrame->SetMsgPanel( aModule );
+    if( start.y > aRowMin * RoutingMatrix.m_GridRouting )
+        aRowMin++;
 
-    LastPosOK = RoutingMatrix.m_BrdBox.GetOrigin();
+    if( start.x > aColMin * RoutingMatrix.m_GridRouting )
+        aColMin++;
 
-    wxPoint     mod_pos = aModule->GetPosition();
-    EDA_RECT    fpBBox  = aModule->GetFootprintRect();
+    if( aRowMin < 0 )
+        aRowMin = 0;
 
-    // Move fpBBox to have the footprint position at (0,0)
-    fpBBox.Move( -mod_pos );
-    wxPoint fpBBoxOrg = fpBBox.GetOrigin();
+    if( aRowMax >= ( RoutingMatrix.m_Nrows - 1 ) )
+        aRowMax = RoutingMatrix.m_Nrows - 1;
 
-    // Calculate the limit of the footprint position, relative
-    // to the routing matrix area
-    wxPoint xylimit = RoutingMatrix.m_BrdBox.GetEnd() - fpBBox.GetEnd();
+    if( aColMin < 0 )
+        aColMin = 0;
 
-    wxPoint initialPos = RoutingMatrix.m_BrdBox.GetOrigin() - fpBBoxOrg;
+    if( aColMax >= ( RoutingMatrix.m_Ncols - 1 ) )
+        aColMax = RoutingMatrix.m_Ncols - 1;
 
-    // Stay on grid.
-    initialPos.x    -= initialPos.x % RoutingMatrix.m_GridRouting;
-    initialPos.y    -= initialPos.y % RoutingMatrix.m_GridRouting;
+    return aRowMin <= aRowMax && aColMin <= aColMax;
+}
 
-    CurrPosition = initialPos;
 
-    // Undraw the current footprint
-    aModule->DrawOutlinesWhenMoving( aFrame->GetCanvas(), aDC, wxPoint( 0, 0 ) );
+/* Sort function used to collect the pads connected to the footprint.
+ * Sort pads by net code
+ */
+static bool sortByNetcode( const D_PAD* const & ref, const D_PAD* const & item )
+{
+    return ref->GetNetCode() < item->GetNetCode();
+}
 
-    g_Offset_Module = mod_pos - CurrPosition;
 
-    /* Examine pads, and set TstOtherSide to true if a footprint
-     * has at least 1 pad through.
-     */
-    TstOtherSide = false;
+/**
+ * Class CELL_SUMS
+ * is a summed area table of a value of the cells of one side of the routing matrix:
+ * once built, the sum of this value over any rectangle of cells is known in constant
+ * time, instead of scanning the cells of the rectangle.
+ */
+class CELL_SUMS
+{
+public:
+    CELL_SUMS() : m_Ncols( 0 ) {}
 
-    if( RoutingMatrix.m_RoutingLayersCount > 1 )
+    /**
+     * Function BuildDist
+     * builds the table of the placement cost (the Dist map) of \a aSide.
+     */
+    void BuildDist( int aSide )
     {
-        LSET    other( aModule->GetLayer() == B_Cu  ? F_Cu : B_Cu );
-
-        for( D_PAD* pad = aModule->Pads(); pad; pad = pad->Next() )
-        {
-            if( !( pad->GetLayerSet() & other ).any() )
-                continue;
+        build( aSide, true );
+    }
 
-            TstOtherSide = true;
-            break;
-        }
+    /**
+     * Function BuildBlocked
+     * builds the table of the cells of \a aSide where no footprint can be placed,
+     * i.e. the cells outside the board or occupied by a footprint.
+     */
+    void BuildBlocked( int aSide )
+    {
+        build( aSide, false );
     }
 
-    // Draw the initial bounding box position
-    EDA_COLOR_T color = BROWN;
-    fpBBox.SetOrigin( fpBBoxOrg + CurrPosition );
-    draw_FootprintRect(aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, color);
+    /**
+     * Function Sum
+     * @return the sum of the table values from row aRowMin to aRowMax and from
+     * column aColMin to aColMax, limits included.
+     */
+    long long Sum( int aRowMin, int aRowMax, int aColMin, int aColMax ) const
+    {
+        int w = m_Ncols + 1;
 
-    min_cost = -1.0;
-    aFrame->SetStatusText( wxT( "Score ??, pos ??" ) );
+        return m_Sums[( aRowMax + 1 ) * w + aColMax + 1] - m_Sums[aRowMin * w + aColMax + 1]
+             - m_Sums[( aRowMax + 1 ) * w + aColMin] + m_Sums[aRowMin * w + aColMin];
+    }
 
-    for( ; CurrPosition.x < xylimit.x; CurrPosition.x += RoutingMatrix.m_GridRouting )
+private:
+    void build( int aSide, bool aDist )
     {
-        wxYield();
+        int nrows = RoutingMatrix.m_Nrows;
+        int w = RoutingMatrix.m_Ncols + 1;
 
-        if( aFrame->GetCanvas()->GetAbortRequest() )
+        m_Ncols = RoutingMatrix.m_Ncols;
+        m_Sums.assign( ( nrows + 1 ) * w, 0 );
+
+        for( int row = 0; row < nrows; row++ )
         {
-            if( IsOK( aFrame, _( "OK to abort?" ) ) )
+            long long rowSum = 0;
+
+            for( int col = 0; col < m_Ncols; col++ )
             {
-                displ_opts->m_Show_Module_Ratsnest = showRats;
-                return ESC;
+                if( aDist )
+                {
+                    rowSum += RoutingMatrix.GetDist( row, col, aSide );
+                }
+                else
+                {
+                    unsigned int data = RoutingMatrix.GetCell( row, col, aSide );
+
+                    if( ( data & CELL_is_ZONE ) == 0 || ( data & CELL_is_MODULE ) )
+                        rowSum++;
+                }
+
+                m_Sums[( row + 1 ) * w + col + 1] = m_Sums[row * w + col + 1] + rowSum;
             }
-            else
-                aFrame->GetCanvas()->SetAbortRequest( false );
         }
+    }
 
-        CurrPosition.y = initialPos.y;
+    int                     m_Ncols;
+    std::vector<long long>  m_Sums;     // (m_Nrows + 1) x (m_Ncols + 1) partial sums
+};
 
-        for( ; CurrPosition.y < xylimit.y; CurrPosition.y += RoutingMatrix.m_GridRouting )
-        {
-            // Erase traces.
-            draw_FootprintRect( aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, color );
 
-            fpBBox.SetOrigin( fpBBoxOrg + CurrPosition );
-            g_Offset_Module = mod_pos - CurrPosition;
-            int keepOutCost = TstModuleOnBoard( brd, aModule, TstOtherSide );
+/**
+ * Class PLACEMENT_COST
+ * calculates the score of each candidate position of a footprint, on a grid of
+ * positions: the keep out cost of the cells below the footprint, and the cost of its
+ * ratsnest.
+ * <p>
+ * The routing matrix, the other footprints and the pads do not change while a
+ * footprint is placed, so everything which does not depend on the position is
+ * calculated once by the constructor: the summed area tables of the matrix, and the
+ * candidate links between the footprint pads and the pads of others footprints.
+ * The positions of a column share the X distance of each link, which is calculated
+ * once per column.  Columns are independent and are evaluated by several threads.
+ */
+class PLACEMENT_COST
+{
+public:
+    PLACEMENT_COST( BOARD* aBrd, MODULE* aModule, bool aTstOtherSide,
+                    const wxPoint& aInitialPos, const wxPoint& aLimit );
 
-            // Draw at new place
-            color = keepOutCost >= 0 ? BROWN : RED;
-            draw_FootprintRect( aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, color );
+    int GetColCount() const { return m_PosCols; }
+    int GetRowCount() const { return m_PosRows; }
 
-            if( keepOutCost >= 0 )    // i.e. if the module can be put here
-            {
-                error = 0;
-                aFrame->build_ratsnest_module( aModule );
-                curr_cost   = compute_Ratsnest_PlaceModule( brd );
-                Score       = curr_cost + keepOutCost;
+    wxPoint GetPosition( int aCol, int aRow ) const
+    {
+        return wxPoint( m_InitialPos.x + aCol * RoutingMatrix.m_GridRouting,
+                        m_InitialPos.y + aRow * RoutingMatrix.m_GridRouting );
+    }
 
-                if( (min_cost >= Score ) || (min_cost < 0 ) )
-                {
-                    LastPosOK   = CurrPosition;
-                    min_cost    = Score;
-                    wxString msg;
-                    msg.Printf( wxT( "Score %g, pos %s, %s" ),
-                                min_cost,
-                                GetChars( ::CoordinateToString( LastPosOK.x ) ),
-                                GetChars( ::CoordinateToString( LastPosOK.y ) ) );
-                    aFrame->SetStatusText( msg );
-                }
-            }
-        }
+    /**
+     * Function EvaluateColumn
+     * calculates the score of all positions of column \a aCol.
+     * Can be called from several threads, for different columns.
+     * @param aDx is a buffer for the X distances of the links.
+     */
+    void EvaluateColumn( int aCol, std::vector<int>& aDx );
+
+    /**
+     * Function GetScore
+     * @return false if the footprint cannot be placed at this position,
+     * and true if it can, aScore being then set to the score of the position.
+     */
+    bool GetScore( int aCol, int aRow, double& aScore ) const
+    {
+        int ii = aCol * m_PosRows + aRow;
+
+        aScore = m_Scores[ii];
+        return m_Valid[ii];
     }
 
-    // erasing the last traces
-    GRRect( aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, 0, BROWN );
+private:
+    /* A possible ratsnest, between a pad of the footprint and a pad of the same net
+     * of another footprint.
+     */
+    struct LINK
+    {
+        wxPoint m_Start;    // footprint pad position, relative to the footprint position
+        wxPoint m_End;      // other pad position
+        bool    m_Counted;  // false if the other footprint is outside the board
+    };
+
+    int keepOutCost( const wxPoint& aPosition ) const;
+    double ratsnestCost( const wxPoint& aPosition, const std::vector<int>& aDx ) const;
+
+    int                 m_Side;
+    bool                m_TstOtherSide;
+    int                 m_Margin;
+    EDA_RECT            m_FpBBox;       // footprint rect, for the footprint at (0,0)
+    wxPoint             m_InitialPos;
+    int                 m_PosCols;
+    int                 m_PosRows;
+
+    CELL_SUMS           m_Dist;
+    CELL_SUMS           m_Blocked;
+    CELL_SUMS           m_OtherSideBlocked;
+
+    bool                m_HasRatsnest;
+    std::vector<LINK>   m_Links;
+    std::vector<int>    m_NetStarts;    // first link of each net, and m_Links.size()
+
+    std::vector<double> m_Scores;
+    std::vector<char>   m_Valid;
+};
 
-    displ_opts->m_Show_Module_Ratsnest = showRats;
 
-    // Regeneration of the modified variable.
-    CurrPosition = LastPosOK;
+PLACEMENT_COST::PLACEMENT_COST( BOARD* aBrd, MODULE* aModule, bool aTstOtherSide,
+                                const wxPoint& aInitialPos, const wxPoint& aLimit )
+{
+    wxPoint mod_pos = aModule->GetPosition();
 
-    brd->m_Status_Pcb &= ~( RATSNEST_ITEM_LOCAL_OK | LISTE_PAD_OK );
+    m_Side = aModule->GetLayer() == B_Cu ? BOTTOM : TOP;
+    m_TstOtherSide = aTstOtherSide;
+    m_Margin = ( RoutingMatrix.m_GridRouting * aModule->GetPadCount() ) / GAIN;
+    m_FpBBox = aModule->GetFootprintRect();
+    m_FpBBox.Move( -mod_pos );
+    m_InitialPos = aInitialPos;
 
-    MinCout = min_cost;
-    return error;
-}
+    m_PosCols = 0;
 
+    for( int x = aInitialPos.x; x < aLimit.x; x += RoutingMatrix.m_GridRouting )
+        m_PosCols++;
 
-/* Test if the rectangular area (ux, ux .. y0, y1):
- * - is a free zone (except OCCUPED_By_MODULE returns)
- * - is on the working surface of the board (otherwise returns OUT_OF_BOARD)
- *
- * Returns OUT_OF_BOARD, or OCCUPED_By_MODULE or FREE_CELL if OK
- */
-int TstRectangle( BOARD* Pcb, const EDA_RECT& aRect, int side )
-{
-    EDA_RECT rect = aRect;
+    m_PosRows = 0;
 
-    rect.Inflate( RoutingMatrix.m_GridRouting / 2 );
+    for( int y = aInitialPos.y; y < aLimit.y; y += RoutingMatrix.m_GridRouting )
+        m_PosRows++;
 
-    wxPoint start   = rect.GetOrigin();
-    wxPoint end     = rect.GetEnd();
+    m_Scores.resize( m_PosCols * m_PosRows );
+    m_Valid.resize( m_PosCols * m_PosRows );
 
-    start   -= RoutingMatrix.m_BrdBox.GetOrigin();
-    end     -= RoutingMatrix.m_BrdBox.GetOrigin();
+    m_Dist.BuildDist( m_Side );
+    m_Blocked.BuildBlocked( m_Side );
 
-    int row_min = start.y / RoutingMatrix.m_GridRouting;
-    int row_max = end.y / RoutingMatrix.m_GridRouting;
-    int col_min = start.x / RoutingMatrix.m_GridRouting;
-    int col_max = end.x / RoutingMatrix.m_GridRouting;
+    if( m_TstOtherSide )
+        m_OtherSideBlocked.BuildBlocked( m_Side == TOP ? BOTTOM : TOP );
 
-    if( start.y > row_min * RoutingMatrix.m_GridRouting )
-        row_min++;
+    // Collect the links the way build_ratsnest_module() collects the pads, so the
+    // nearest pad found for each net is the same one, also when distances are equal.
+    if( ( aBrd->m_Status_Pcb & LISTE_PAD_OK ) == 0 )
+    {
+        aBrd->m_Status_Pcb = 0;
+        aBrd->BuildListOfNets();
+    }
 
-    if( start.x > col_min * RoutingMatrix.m_GridRouting )
-        col_min++;
+    std::vector<D_PAD*> modulePads;
+    std::vector<D_PAD*> otherPads;
 
-    if( row_min < 0 )
-        row_min = 0;
+    for( D_PAD* pad = aModule->Pads(); pad; pad = pad->Next() )
+    {
+        if( pad->GetNetCode() != NETINFO_LIST::UNCONNECTED )
+            modulePads.push_back( pad );
+    }
 
-    if( row_max >= ( RoutingMatrix.m_Nrows - 1 ) )
-        row_max = RoutingMatrix.m_Nrows - 1;
+    // Without connected pad, there is no local ratsnest and its cost is -1.
+    m_HasRatsnest = !modulePads.empty();
 
-    if( col_min < 0 )
-        col_min = 0;
+    if( !m_HasRatsnest )
+        return;
 
-    if( col_max >= ( RoutingMatrix.m_Ncols - 1 ) )
-        col_max = RoutingMatrix.m_Ncols - 1;
+    std::sort( modulePads.begin(), modulePads.end(), sortByNetcode );
+
+    for( unsigned ii = 0; ii < modulePads.size(); ii++ )
+    {
+        NETINFO_ITEM* net = modulePads[ii]->GetNet();
+
+        if( net == NULL )       // Should not occur
+            continue;
+
+        for( unsigned jj = 0; jj < net->m_PadInNetList.size(); jj++ )
+        {
+            if( net->m_PadInNetList[jj]->GetParent() != aModule )
+                otherPads.push_back( net->m_PadInNetList[jj] );
+        }
+    }
+
+    std::sort( otherPads.begin(), otherPads.end(), sortByNetcode );
+
+    // A pad appears once for each footprint pad of its net, keep the first one.
+    std::vector<D_PAD*> uniquePads;
+    std::set<D_PAD*>    seen;
+
+    for( unsigned ii = 0; ii < otherPads.size(); ii++ )
+    {
+        if( seen.insert( otherPads[ii] ).second )
+            uniquePads.push_back( otherPads[ii] );
+    }
+
+    unsigned first = 0;     // first pad of the current net in uniquePads
 
-    for( int row = row_min; row <= row_max; row++ )
+    for( unsigned ii = 0; ii < modulePads.size(); )
     {
-        for( int col = col_min; col <= col_max; col++ )
+        int      netcode = modulePads[ii]->GetNetCode();
+        unsigned end = ii;
+
+        while( end < modulePads.size() && modulePads[end]->GetNetCode() == netcode )
+            end++;
+
+        while( first < uniquePads.size() && uniquePads[first]->GetNetCode() < netcode )
+            first++;
+
+        m_NetStarts.push_back( m_Links.size() );
+
+        for( ; ii < end; ii++ )
         {
-            unsigned int data = RoutingMatrix.GetCell( row, col, side );
+            for( unsigned jj = first; jj < uniquePads.size(); jj++ )
+            {
+                D_PAD* other = uniquePads[jj];
 
-            if( ( data & CELL_is_ZONE ) == 0 )
-                return OUT_OF_BOARD;
+                if( other->GetNetCode() > netcode )
+                    break;
 
-            if( (data & CELL_is_MODULE) )
-                return OCCUPED_By_MODULE;
+                LINK link;
+                link.m_Start   = modulePads[ii]->GetPosition() - mod_pos;
+                link.m_End     = other->GetPosition();
+                link.m_Counted = RoutingMatrix.m_BrdBox.Contains( other->GetParent()->GetPosition() );
+                m_Links.push_back( link );
+            }
         }
     }
 
-    return FREE_CELL;
+    m_NetStarts.push_back( m_Links.size() );
 }
 
 
-/* Calculates and returns the clearance area of the rectangular surface
- * aRect):
- * (Sum of cells in terms of distance)
+/* Returns the keep out cost of the footprint at aPosition, or OCCUPED_By_MODULE if
+ * it cannot be placed there (out of the board, or over another footprint).
  */
-unsigned int CalculateKeepOutArea( const EDA_RECT& aRect, int side )
+int PLACEMENT_COST::keepOutCost( const wxPoint& aPosition ) const
 {
-    wxPoint start   = aRect.GetOrigin();
-    wxPoint end     = aRect.GetEnd();
+    int      row_min, row_max, col_min, col_max;
+    EDA_RECT rect = m_FpBBox;
 
-    start   -= RoutingMatrix.m_BrdBox.GetOrigin();
-    end     -= RoutingMatrix.m_BrdBox.GetOrigin();
+    rect.Move( aPosition );
 
-    int row_min = start.y / RoutingMatrix.m_GridRouting;
-    int row_max = end.y / RoutingMatrix.m_GridRouting;
-    int col_min = start.x / RoutingMatrix.m_GridRouting;
-    int col_max = end.x / RoutingMatrix.m_GridRouting;
+    EDA_RECT area = rect;
+    area.Inflate( RoutingMatrix.m_GridRouting / 2 );
 
-    if( start.y > row_min * RoutingMatrix.m_GridRouting )
-        row_min++;
+    if( getCellRange( area, row_min, row_max, col_min, col_max ) )
+    {
+        if( m_Blocked.Sum( row_min, row_max, col_min, col_max ) )
+            return OCCUPED_By_MODULE;
 
-    if( start.x > col_min * RoutingMatrix.m_GridRouting )
-        col_min++;
+        if( m_TstOtherSide && m_OtherSideBlocked.Sum( row_min, row_max, col_min, col_max ) )
+            return OCCUPED_By_MODULE;
+    }
 
-    if( row_min < 0 )
-        row_min = 0;
+    rect.Inflate( m_Margin );
 
-    if( row_max >= ( RoutingMatrix.m_Nrows - 1 ) )
-        row_max = RoutingMatrix.m_Nrows - 1;
+    if( !getCellRange( rect, row_min, row_max, col_min, col_max ) )
+        return 0;
 
-    if( col_min < 0 )
-        col_min = 0;
+    return (int) (unsigned) m_Dist.Sum( row_min, row_max, col_min, col_max );
+}
 
-    if( col_max >= ( RoutingMatrix.m_Ncols - 1 ) )
-        col_max = RoutingMatrix.m_Ncols - 1;
 
-    unsigned int keepOutCost = 0;
+/* Returns the ratsnest cost of the footprint at aPosition: the sum, for each net, of
+ * the cost of the shortest link, which is its length with a penalty for connections
+ * approaching 45 degrees.
+ */
+double PLACEMENT_COST::ratsnestCost( const wxPoint& aPosition, const std::vector<int>& aDx ) const
+{
+    if( !m_HasRatsnest )
+        return -1;
+
+    double cost = 0;
 
-    for( int row = row_min; row <= row_max; row++ )
+    for( unsigned net = 0; net + 1 < m_NetStarts.size(); net++ )
     {
-        for( int col = col_min; col <= col_max; col++ )
+        int best = -1;
+        int bestDist = INT_MAX;
+
+        for( int ii = m_NetStarts[net]; ii < m_NetStarts[net + 1]; ii++ )
         {
-            // RoutingMatrix.GetDist returns the "cost" of the cell
-            // at position (row, col)
-            // in autoplace this is the cost of the cell, if it is
-            // inside aRect
-            keepOutCost += RoutingMatrix.GetDist( row, col, side );
+            int dist = aDx[ii] + abs( m_Links[ii].m_End.y - m_Links[ii].m_Start.y - aPosition.y );
+
+            if( dist < bestDist )
+            {
+                bestDist = dist;
+                best = ii;
+            }
         }
+
+        if( best < 0 || !m_Links[best].m_Counted )
+            continue;
+
+        int dx = aDx[best];
+        int dy = abs( m_Links[best].m_End.y - m_Links[best].m_Start.y - aPosition.y );
+
+        // the penalty is max for 45 degrees ratsnests, and 0 for horizontal
+        // or vertical ratsnests.
+        if( dx < dy )
+            std::swap( dx, dy );
+
+        cost += hypot( dx, dy * 2.0 );
     }
 
-    return keepOutCost;
+    return cost;
 }
 
 
-/* Test if the module can be placed on the board.
- * Returns the value TstRectangle().
- * Module is known by its bounding box
- */
-int TstModuleOnBoard( BOARD* Pcb, MODULE* aModule, bool TstOtherSide )
+void PLACEMENT_COST::EvaluateColumn( int aCol, std::vector<int>& aDx )
 {
-    int side = TOP;
-    int otherside = BOTTOM;
+    int x = GetPosition( aCol, 0 ).x;
+
+    aDx.resize( m_Links.size() );
+
+    for( unsigned ii = 0; ii < m_Links.size(); ii++ )
+        aDx[ii] = abs( m_Links[ii].m_End.x - m_Links[ii].m_Start.x - x );
 
-    if( aModule->GetLayer() == B_Cu )
+    for( int row = 0; row < m_PosRows; row++ )
     {
-        side = BOTTOM; otherside = TOP;
+        wxPoint pos = GetPosition( aCol, row );
+        int     ii = aCol * m_PosRows + row;
+        int     keepOut = keepOutCost( pos );
+
+        m_Valid[ii] = keepOut >= 0;
+
+        if( m_Valid[ii] )
+            m_Scores[ii] = ratsnestCost( pos, aDx ) + keepOut;
     }
+}
+
+
+/**
+ * Function evaluateColumns
+ * is the worker thread function of getOptimalModulePlacement(): it evaluates the
+ * columns aFirst, aFirst + aStep ... below aEnd.
+ */
+static void evaluateColumns( PLACEMENT_COST* aCost, int aFirst, int aEnd, int aStep )
+{
+    std::vector<int> dx;
 
-    EDA_RECT    fpBBox = aModule->GetFootprintRect();
-    fpBBox.Move( -g_Offset_Module );
+    for( int col = aFirst; col < aEnd; col += aStep )
+        aCost->EvaluateColumn( col, dx );
+}
 
-    int         diag = TstRectangle( Pcb, fpBBox, side );
 
-    if( diag != FREE_CELL )
-        return diag;
+int getOptimalModulePlacement( PCB_EDIT_FRAME* aFrame, MODULE* aModule, wxDC* aDC )
+{
+    int     error = 1;
+    wxPoint LastPosOK;
+    double  min_cost, Score;
+    bool    TstOtherSide;
+    DISPLAY_OPTIONS* displ_opts = (DISPLAY_OPTIONS*)aFrame->GetDisplayOptions();
+    BOARD*  brd = aFrame->GetBoard();
 
-    if( TstOtherSide )
+    aModule->CalculateBoundingBox();
+
+    bool showRats = displ_opts->m_Show_Module_Ratsnest;
+    displ_opts->m_Show_Module_Ratsnest = false;
+
+    brd->m_Status_Pcb &= ~RATSNEST_ITEM_LOCAL_OK;
+    aFrame->SetMsgPanel( aModule );
+
+    LastPosOK = RoutingMatrix.m_BrdBox.GetOrigin();
+
+    wxPoint     mod_pos = aModule->GetPosition();
+    EDA_RECT    fpBBox  = aModule->GetFootprintRect();
+
+    // Move fpBBox to have the footprint position at (0,0)
+    fpBBox.Move( -mod_pos );
+    wxPoint fpBBoxOrg = fpBBox.GetOrigin();
+
+    // Calculate the limit of the footprint position, relative
+    // to the routing matrix area
+    wxPoint xylimit = RoutingMatrix.m_BrdBox.GetEnd() - fpBBox.GetEnd();
+
+    wxPoint initialPos = RoutingMatrix.m_BrdBox.GetOrigin() - fpBBoxOrg;
+
+    // Stay on grid.
+    initialPos.x    -= initialPos.x % RoutingMatrix.m_GridRouting;
+    initialPos.y    -= initialPos.y % RoutingMatrix.m_GridRouting;
+
+    CurrPosition = initialPos;
+
+    // Undraw the current footprint
+    aModule->DrawOutlinesWhenMoving( aFrame->GetCanvas(), aDC, wxPoint( 0, 0 ) );
+
+    g_Offset_Module = mod_pos - CurrPosition;
+
+    /* Examine pads, and set TstOtherSide to true if a footprint
+     * has at least 1 pad through.
+     */
+    TstOtherSide = false;
+
+    if( RoutingMatrix.m_RoutingLayersCount > 1 )
     {
-        diag = TstRectangle( Pcb, fpBBox, otherside );
+        LSET    other( aModule->GetLayer() == B_Cu  ? F_Cu : B_Cu );
+
+        for( D_PAD* pad = aModule->Pads(); pad; pad = pad->Next() )
+        {
+            if( !( pad->GetLayerSet() & other ).any() )
+                continue;
 
-        if( diag != FREE_CELL )
-            return diag;
+            TstOtherSide = true;
+            break;
+        }
     }
 
-    int marge = ( RoutingMatrix.m_GridRouting * aModule->GetPadCount() ) / GAIN;
+    // Draw the initial bounding box position
+    fpBBox.SetOrigin( fpBBoxOrg + CurrPosition );
+    draw_FootprintRect(aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, BROWN);
 
-    fpBBox.Inflate( marge );
-    return CalculateKeepOutArea( fpBBox, side );
-}
+    min_cost = -1.0;
+    aFrame->SetStatusText( wxT( "Score ??, pos ??" ) );
 
+    PLACEMENT_COST cost( brd, aModule, TstOtherSide, initialPos, xylimit );
 
-double compute_Ratsnest_PlaceModule( BOARD* aBrd )
-{
-    double  curr_cost;
-    wxPoint start;      // start point of a ratsnest
-    wxPoint end;        // end point of a ratsnest
-    int     dx, dy;
+    unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
 
-    if( ( aBrd->m_Status_Pcb & RATSNEST_ITEM_LOCAL_OK ) == 0 )
-        return -1;
+    // Columns are evaluated by groups, to keep the user interface alive.
+    int groupSize = threadCount * 4;
 
-    curr_cost = 0;
+    // Something which will not invoke a thread copy constructor
+    typedef boost::ptr_vector< boost::thread >  MYTHREADS;
 
-    for( unsigned ii = 0; ii < aBrd->m_LocalRatsnest.size(); ii++ )
+    for( int col0 = 0; col0 < cost.GetColCount(); col0 += groupSize )
     {
-        RATSNEST_ITEM* pt_local_rats_nest = &aBrd->m_LocalRatsnest[ii];
+        wxYield();
 
-        if( ( pt_local_rats_nest->m_Status & LOCAL_RATSNEST_ITEM ) )
-            continue; // Skip ratsnest between 2 pads of the current module
+        if( aFrame->GetCanvas()->GetAbortRequest() )
+        {
+            if( IsOK( aFrame, _( "OK to abort?" ) ) )
+            {
+                displ_opts->m_Show_Module_Ratsnest = showRats;
+                return ESC;
+            }
+            else
+                aFrame->GetCanvas()->SetAbortRequest( false );
+        }
 
-        // Skip modules not inside the board area
-        MODULE* module = pt_local_rats_nest->m_PadEnd->GetParent();
+        int colEnd = std::min( col0 + groupSize, cost.GetColCount() );
+        int count  = std::min( (int) threadCount, colEnd - col0 );
 
-        if( !RoutingMatrix.m_BrdBox.Contains( module->GetPosition() ) )
-            continue;
+        MYTHREADS threads;
 
-        start   = pt_local_rats_nest->m_PadStart->GetPosition() - g_Offset_Module;
-        end     = pt_local_rats_nest->m_PadEnd->GetPosition();
+        for( int ii = 1; ii < count; ii++ )
+            threads.push_back( new boost::thread( &evaluateColumns, &cost, col0 + ii,
+                                                  colEnd, count ) );
 
-        // Cost of the ratsnest.
-        dx  = end.x - start.x;
-        dy  = end.y - start.y;
+        evaluateColumns( &cost, col0, colEnd, count );
 
-        dx  = abs( dx );
-        dy  = abs( dy );
+        for( unsigned ii = 0; ii < threads.size(); ii++ )
+            threads[ii].join();
 
-        // ttry to have always dx >= dy to calculate the cost of the rastsnet
-        if( dx < dy )
-            std::swap( dx, dy );
+        // Keep the best position, in the order the positions were examined one by one.
+        bool found = false;
+
+        for( int col = col0; col < colEnd; col++ )
+        {
+            for( int row = 0; row < cost.GetRowCount(); row++ )
+            {
+                if( !cost.GetScore( col, row, Score ) )
+                    continue;
+
+                error = 0;
+
+                if( (min_cost >= Score ) || (min_cost < 0 ) )
+                {
+                    LastPosOK   = cost.GetPosition( col, row );
+                    min_cost    = Score;
+                    found       = true;
+                }
+            }
+        }
 
-        // Cost of the connection = lenght + penalty due to the slope
-        // dx is the biggest lenght relative to the X or Y axis
-        // the penalty is max for 45 degrees ratsnests,
-        // and 0 for horizontal or vertical ratsnests.
-        // For Horizontal and Vertical ratsnests, dy = 0;
-        double conn_cost = hypot( dx, dy * 2.0 );
-        curr_cost += conn_cost;    // Total cost = sum of costs of each connection
+        if( found )
+        {
+            // Move the drawn bounding box to the best position.
+            draw_FootprintRect( aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, BROWN );
+            fpBBox.SetOrigin( fpBBoxOrg + LastPosOK );
+            draw_FootprintRect( aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, BROWN );
+
+            wxString msg;
+            msg.Printf( wxT( "Score %g, pos %s, %s" ),
+                        min_cost,
+                        GetChars( ::CoordinateToString( LastPosOK.x ) ),
+                        GetChars( ::CoordinateToString( LastPosOK.y ) ) );
+            aFrame->SetStatusText( msg );
+        }
     }
 
-    return curr_cost;
+    // erasing the last traces
+    GRRect( aFrame->GetCanvas()->GetClipBox(), aDC, fpBBox, 0, BROWN );
+
+    displ_opts->m_Show_Module_Ratsnest = showRats;
+
+    // Regeneration of the modified variable.
+    CurrPosition = LastPosOK;
+    g_Offset_Module = mod_pos - CurrPosition;
+
+    brd->m_Status_Pcb &= ~( RATSNEST_ITEM_LOCAL_OK | LISTE_PAD_OK );
+
+    MinCout = min_cost;
+    return error;
 }
 
 
@@ -37,6 +37,7 @@
 #include <msgpanel.h>
 
 #include <pcbnew.h>
+#include <protos.h>
 #include <cell.h>
 #include <zones.h>
 
@@ -51,7 +52,7 @@
 MATRIX_ROUTING_HEAD RoutingMatrix;     // routing matrix (grid) to route 2-sided boards
 
 /* init board, route traces*/
-void PCB_EDIT_FRAME::Autoroute( wxDC* DC, int mode )
+void PCB_EDIT_FRAME::Autoroute( wxDC* DC, int mode, bool aConcurrent )
 {
     int      start, stop;
     MODULE*  Module = NULL;
@@ -190,10 +191,10 @@ void PCB_EDIT_FRAME::Autoroute( wxDC* DC, int mode )
 
     // DisplayRoutingMatrix( m_canvas, DC );
 
-    Solve( DC, RoutingMatrix.m_RoutingLayersCount );
+    Solve( DC, RoutingMatrix.m_RoutingLayersCount, aConcurrent );
 
     /* Free memory. */
-    FreeQueue();
+    RoutingQueue.Free();
     InitWork();             /* Free memory for the list of router connections. */
     RoutingMatrix.UnInitRoutingMatrix();
     stop = time( NULL ) - start;
@@ -202,6 +203,51 @@ void PCB_EDIT_FRAME::Autoroute( wxDC* DC, int mode )
 }
 
 
+int AutorouteAllConnections( BOARD* aPcb, int aGridSize, bool aConcurrent )
+{
+    if( aPcb->GetCopperLayerCount() > 1 )
+    {
+        g_Route_Layer_TOP    = F_Cu;
+        g_Route_Layer_BOTTOM = B_Cu;
+    }
+    else
+    {
+        g_Route_Layer_TOP = g_Route_Layer_BOTTOM = B_Cu;
+    }
+
+    if( ( aPcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK ) == 0 && !BuildFullRatsnest( aPcb ) )
+        return 0;
+
+    for( unsigned ii = 0; ii < aPcb->GetRatsnestsCount(); ii++ )
+        aPcb->m_FullRatsnest[ii].m_Status |= CH_ROUTE_REQ;
+
+    RoutingMatrix.m_GridRouting = std::max( aGridSize, (int) ( 5*IU_PER_MILS ) );
+    RoutingMatrix.ComputeMatrixSize( aPcb );
+
+    RoutingMatrix.m_RoutingLayersCount = 1;
+
+    if( g_Route_Layer_TOP != g_Route_Layer_BOTTOM )
+        RoutingMatrix.m_RoutingLayersCount = 2;
+
+    if( RoutingMatrix.InitRoutingMatrix() < 0 )
+    {
+        RoutingMatrix.UnInitRoutingMatrix();
+        return -1;
+    }
+
+    PlaceCells( aPcb, -1, FORCE_PADS );
+    RoutingMatrix.m_RouteCount = Build_Work( aPcb );
+
+    int routed = AutorouteWorkList( aPcb, RoutingMatrix.m_RoutingLayersCount, aConcurrent );
+
+    RoutingQueue.Free();
+    InitWork();
+    RoutingMatrix.UnInitRoutingMatrix();
+
+    return routed;
+}
+
+
 /* Clear the flag CH_NOROUTABLE which is set to 1 by Solve(),
  * when a track was not routed.
  * (If this flag is 1 the corresponding track it is not rerouted)
@@ -33,6 +33,8 @@
 #define AUTOROUT_H
 
 
+#include <vector>
+
 #include <base_struct.h>
 #include <layers_id_colors_and_visibility.h>
 
@@ -65,18 +67,29 @@ enum AUTOPLACEROUTE_OPTIONS
 
 #define FORCE_PADS 1  /* Force placement of pads for any Netcode */
 
-/* search statistics */
-extern int OpenNodes;   /* total number of nodes opened */
-extern int ClosNodes;   /* total number of nodes closed */
-extern int MoveNodes;   /* total number of nodes moved */
-extern int MaxNodes;    /* maximum number of nodes opened at one time */
-
-
 /* Structures useful to the generation of board as bitmap. */
 typedef char MATRIX_CELL;
 typedef int  DIST_CELL;
 typedef char DIR_CELL;
 
+/* One cell of the routing matrix.  The cell state, the distance and the direction
+ * used by the maze search are stored together, so each cell visited by the search
+ * is read from a single place in memory instead of three separate arrays.
+ *
+ * The cell state is already a set of bit flags, and the direction needs 4 bits, but
+ * packing them with the distance in bit fields would not make a cell smaller than
+ * 8 bytes unless the distance is narrowed to 20 bits.  This is not enough: each step
+ * of a route adds up to a few hundred to the distance (see CalcDist()), and the auto
+ * placer accumulates its keep out costs in the distances.  So the cell keeps a full
+ * int distance, and 2 bytes of padding.
+ */
+struct ROUTING_CELL
+{
+    DIST_CELL   m_Dist;         // distance to the source of the current route
+    MATRIX_CELL m_Cell;         // obstacles and traces (CELL_is_xx flags)
+    DIR_CELL    m_Dir;          // direction back to the source (FROM_xx)
+};
+
 
 /**
  * class MATRIX_ROUTING_HEAD
@@ -85,11 +98,8 @@ typedef char DIR_CELL;
 class MATRIX_ROUTING_HEAD
 {
 public:
-    MATRIX_CELL* m_BoardSide[MAX_ROUTING_LAYERS_COUNT]; // the image map of 2 board sides
-    DIST_CELL*   m_DistSide[MAX_ROUTING_LAYERS_COUNT];  // the image map of 2 board sides:
-                                                        // distance to cells
-    DIR_CELL*    m_DirSide[MAX_ROUTING_LAYERS_COUNT];   // the image map of 2 board sides:
-                                                        // pointers back to source
+    ROUTING_CELL* m_Cells[MAX_ROUTING_LAYERS_COUNT];    // the image map of 2 board sides:
+                                                        // cells, distances and directions
     bool         m_InitMatrixDone;
     int          m_RoutingLayersCount;          // Number of layers for autorouting (0 or 1)
     int          m_GridRouting;                 // Size of grid for autoplace/autoroute
@@ -146,16 +156,42 @@ public:
     void SetCellOperation( int aLogicOp );
 
     // functions to read/write one cell ( point on grid routing matrix:
-    MATRIX_CELL GetCell( int aRow, int aCol, int aSide);
+    MATRIX_CELL GetCell( int aRow, int aCol, int aSide )
+    {
+        return m_Cells[aSide][aRow * m_Ncols + aCol].m_Cell;
+    }
+
     void SetCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
     void OrCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
     void XorCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
     void AndCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
     void AddCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell);
-    DIST_CELL GetDist( int aRow, int aCol, int aSide );
-    void SetDist( int aRow, int aCol, int aSide, DIST_CELL );
-    int GetDir( int aRow, int aCol, int aSide );
-    void SetDir( int aRow, int aCol, int aSide, int aDir);
+
+    DIST_CELL GetDist( int aRow, int aCol, int aSide )
+    {
+        return m_Cells[aSide][aRow * m_Ncols + aCol].m_Dist;
+    }
+
+    void SetDist( int aRow, int aCol, int aSide, DIST_CELL aDist )
+    {
+        m_Cells[aSide][aRow * m_Ncols + aCol].m_Dist = aDist;
+    }
+
+    int GetDir( int aRow, int aCol, int aSide )
+    {
+        return (int) m_Cells[aSide][aRow * m_Ncols + aCol].m_Dir;
+    }
+
+    void SetDir( int aRow, int aCol, int aSide, int aDir )
+    {
+        m_Cells[aSide][aRow * m_Ncols + aCol].m_Dir = (DIR_CELL) aDir;
+    }
+
+    // set the direction of all the cells of aSide to aDir
+    void SetAllDirs( int aSide, int aDir );
+
+    // copy the cell states (not the distances and directions) of aFromSide to aToSide
+    void CopyCells( int aFromSide, int aToSide );
 
     // calculate distance (with penalty) of a trace through a cell
     int CalcDist(int x,int y,int z ,int side );
@@ -215,11 +251,74 @@ void TraceFilledRectangle( int ux0, int uy0, int ux1, int uy1,
                            int color, int op_logic );
 
 /* QUEUE.CPP */
-void FreeQueue();
-void InitQueue();
-void GetQueue( int *, int *, int *, int *, int * );
-bool  SetQueue( int, int, int, int, int, int, int );
-void ReSetQueue( int, int, int, int, int, int, int );
+
+/**
+ * class ROUTING_QUEUE
+ * is the search queue of the maze router: the open nodes of a search, best one first.
+ * Each search uses its own queue, so several searches can run at the same time.
+ */
+class ROUTING_QUEUE
+{
+public:
+    // search statistics
+    int         m_OpenNodes;        // total number of nodes opened
+    int         m_ClosNodes;        // total number of nodes closed
+    int         m_MoveNodes;        // total number of nodes moved
+    int         m_MaxNodes;         // maximum number of nodes opened at one time
+
+    ROUTING_QUEUE();
+
+    // empty the queue, for a search on a grid of aNrows x aNcols cells
+    void Init( int aNrows, int aNcols );
+
+    // free the memory used by the queue
+    void Free();
+
+    // get the best node, or ILLEGAL values if the queue is empty
+    void Get( int* r, int* c, int* s, int* d, int* a );
+
+    // add a node; return false if memory allocation failed
+    bool Set( int r, int c, int side, int d, int a, int r2, int c2 );
+
+    // update the distance of a node, which may have been already closed
+    void ReSet( int r, int c, int side, int d, int a, int r2, int c2 );
+
+private:
+    struct NODE
+    {
+        int             Row;        // current row
+        int             Col;        // current column
+        int             Side;       // 0=top, 1=bottom
+        int             Dist;       // path distance to this cell so far
+        int             ApxDist;    // approximate distance to target from here
+        bool            Goal;       // true if this is the target cell
+        int             Key;        // index of the cell in m_heapIndex
+        unsigned long   Order;      // insertion order, to break ties
+    };
+
+    std::vector<NODE>   m_heap;         // open nodes, m_heap[0] is the best one
+    std::vector<int>    m_heapIndex;    // cell -> index in m_heap, or -1
+    int                 m_ncols;        // columns of the searched grid
+    int                 m_qlen;         // current queue length
+    unsigned long       m_insertCount;
+
+    int cellKey( int r, int c, int side ) const
+    {
+        return ( r * m_ncols + c ) * MAX_ROUTING_LAYERS_COUNT + side;
+    }
+
+    void placeNode( unsigned aIndex, const NODE& aNode )
+    {
+        m_heap[aIndex] = aNode;
+        m_heapIndex[aNode.Key] = aIndex;
+    }
+
+    static bool isBefore( const NODE& a, const NODE& b );
+    void siftUp( unsigned aIndex );
+    void siftDown( unsigned aIndex );
+};
+
+extern ROUTING_QUEUE RoutingQueue;      // search queue of the serial router
 
 /* WORK.CPP */
 void InitWork();
@@ -232,5 +331,34 @@ void SortWork(); /* order the work items; shortest first */
 int Build_Work( BOARD * Pcb );
 void PlaceCells( BOARD * Pcb, int net_code, int flag = 0 );
 
+/* SOLVE.CPP */
+
+/**
+ * Function AutorouteWorkList
+ * routes the connections of the work list (see Build_Work()) on the routing matrix,
+ * without user interface: the new tracks are added to \a aPcb, with no undo.
+ * @param aPcb = the board to route
+ * @param aLayersCount = the number of routing layers (1 or 2)
+ * @param aConcurrent = true to route the connections which do not overlap at the same
+ *                      time, in worker threads, false to route them one by one
+ * @return the number of connections routed
+ */
+int AutorouteWorkList( BOARD* aPcb, int aLayersCount, bool aConcurrent );
+
+/* AUTOROUT.CPP */
+
+/**
+ * Function AutorouteAllConnections
+ * routes all the connections of the ratsnest of \a aPcb, like the "Automatically Route
+ * All Footprints" command does, but without frame: the routing layers are the front
+ * and back copper layers, and the existing tracks are not used to find the connections
+ * already made.  It is meant for tests and benchmarks made on boards without tracks.
+ * @param aPcb = the board to route
+ * @param aGridSize = the routing grid, at least 5 mils
+ * @param aConcurrent = true to use the concurrent router (see AutorouteWorkList())
+ * @return the number of connections routed, or -1 if there is not enough memory
+ */
+int AutorouteAllConnections( BOARD* aPcb, int aGridSize, bool aConcurrent );
+
 
 #endif  // AUTOROUT_H
@@ -147,6 +147,10 @@ void PCB_EDIT_FRAME::OnPlaceOrRouteFootprints( wxCommandEvent& event )
         Autoroute( &dc, ROUTE_ALL );
         break;
 
+    case ID_POPUP_PCB_AUTOROUTE_ALL_MODULES_CONCURRENT:
+        Autoroute( &dc, ROUTE_ALL, true );
+        break;
+
     case ID_POPUP_PCB_AUTOROUTE_MODULE:
         Autoroute( &dc, ROUTE_MODULE );
         break;
@@ -30,6 +30,13 @@
 
 /**
  * @file queue.cpp
+ *
+ * The search queue of the maze router: an indexed binary heap of the open nodes, ordered
+ * by path distance + approximate distance to the target, so the search is an A* search.
+ * Each open node can be found from its cell (row, column, side), which ReSet()
+ * needs to move a node when a shorter path to it is found.
+ * A search uses its own queue, so searches made at the same time in different threads
+ * (see Solve()) each use a ROUTING_QUEUE, the serial router uses RoutingQueue.
  */
 
 #include <fctsys.h>
@@ -39,71 +46,140 @@
 #include <autorout.h>
 #include <cell.h>
 
+#include <new>
 
-struct PcbQueue /* search queue structure */
-{
-    struct PcbQueue* Next;
-    int              Row;       /* current row                  */
-    int              Col;       /* current column               */
-    int              Side;      /* 0=top, 1=bottom              */
-    int              Dist;      /* path distance to this cell so far        */
-    int              ApxDist;   /* approximate distance to target from here */
-};
 
-static long             qlen = 0;   /* current queue length */
-static struct PcbQueue* Head = NULL;
-static struct PcbQueue* Tail = NULL;
-static struct PcbQueue* Save = NULL;    /* hold empty queue structs */
+ROUTING_QUEUE RoutingQueue;     // search queue of the serial router
 
 
-/* Free the memory used for storing all the queue */
-void FreeQueue()
+ROUTING_QUEUE::ROUTING_QUEUE() :
+    m_OpenNodes( 0 ), m_ClosNodes( 0 ), m_MoveNodes( 0 ), m_MaxNodes( 0 ),
+    m_ncols( 0 ), m_qlen( 0 ), m_insertCount( 0 )
+{
+}
+
+
+/* Return true if a must be explored before b.
+ * As in the previous sorted list, the lowest total distance comes first, the target cell
+ * comes first among equal distances, then the most recently queued node.
+ */
+inline bool ROUTING_QUEUE::isBefore( const NODE& a, const NODE& b )
 {
-    struct PcbQueue* p;
+    int da = a.Dist + a.ApxDist;
+    int db = b.Dist + b.ApxDist;
 
-    InitQueue();
+    if( da != db )
+        return da < db;
 
-    while( (p = Save) != NULL )
+    if( a.Goal != b.Goal )
+        return a.Goal;
+
+    return a.Order > b.Order;
+}
+
+
+void ROUTING_QUEUE::siftUp( unsigned aIndex )
+{
+    NODE node = m_heap[aIndex];
+
+    while( aIndex > 0 )
     {
-        Save = p->Next;
-        delete p;
+        unsigned parent = ( aIndex - 1 ) / 2;
+
+        if( !isBefore( node, m_heap[parent] ) )
+            break;
+
+        placeNode( aIndex, m_heap[parent] );
+        aIndex = parent;
     }
+
+    placeNode( aIndex, node );
 }
 
 
-/* initialize the search queue */
-void InitQueue()
+void ROUTING_QUEUE::siftDown( unsigned aIndex )
 {
-    struct PcbQueue* p;
+    NODE     node = m_heap[aIndex];
+    unsigned count = m_heap.size();
 
-    while( (p = Head) != NULL )
+    for( ; ; )
     {
-        Head    = p->Next;
-        p->Next = Save; Save = p;
+        unsigned child = 2 * aIndex + 1;
+
+        if( child >= count )
+            break;
+
+        if( child + 1 < count && isBefore( m_heap[child + 1], m_heap[child] ) )
+            child++;
+
+        if( !isBefore( m_heap[child], node ) )
+            break;
+
+        placeNode( aIndex, m_heap[child] );
+        aIndex = child;
     }
 
-    Tail = NULL;
-    OpenNodes = ClosNodes = MoveNodes = MaxNodes = qlen = 0;
+    placeNode( aIndex, node );
 }
 
 
-/* get search queue item from list */
-void GetQueue( int* r, int* c, int* s, int* d, int* a )
+/* Free the memory used for storing all the queue */
+void ROUTING_QUEUE::Free()
+{
+    std::vector<NODE>().swap( m_heap );
+    std::vector<int>().swap( m_heapIndex );
+
+    m_ncols = 0;
+    m_OpenNodes = m_ClosNodes = m_MoveNodes = m_MaxNodes = m_qlen = 0;
+}
+
+
+/* initialize the search queue */
+void ROUTING_QUEUE::Init( int aNrows, int aNcols )
 {
-    struct PcbQueue* p;
+    // Only the nodes still queued have an index to clear.
+    for( unsigned ii = 0; ii < m_heap.size(); ii++ )
+        m_heapIndex[m_heap[ii].Key] = -1;
+
+    m_heap.clear();
+    m_insertCount = 0;
+    m_ncols = aNcols;
+
+    // All the cells are now out of the queue, a larger index is enough for a new grid.
+    unsigned cellCount = ( aNrows + 1 ) * ( aNcols + 1 ) * MAX_ROUTING_LAYERS_COUNT;
+
+    if( m_heapIndex.size() < cellCount )
+        m_heapIndex.resize( cellCount, -1 );
 
-    if( (p = Head) != NULL )  /* return first item in list */
+    m_OpenNodes = m_ClosNodes = m_MoveNodes = m_MaxNodes = m_qlen = 0;
+}
+
+
+/* get search queue item from list */
+void ROUTING_QUEUE::Get( int* r, int* c, int* s, int* d, int* a )
+{
+    if( !m_heap.empty() )  /* return first item in list */
     {
-        *r = p->Row; *c = p->Col;
-        *s = p->Side;
-        *d = p->Dist; *a = p->ApxDist;
+        const NODE& p = m_heap[0];
+
+        *r = p.Row; *c = p.Col;
+        *s = p.Side;
+        *d = p.Dist; *a = p.ApxDist;
 
-        if( (Head = p->Next) == NULL )
-            Tail = NULL;
+        m_heapIndex[p.Key] = -1;
+
+        if( m_heap.size() > 1 )
+        {
+            placeNode( 0, m_heap.back() );
+            m_heap.pop_back();
+            siftDown( 0 );
+        }
+        else
+        {
+            m_heap.pop_back();
+        }
 
-        /* put node on free list */
-        p->Next = Save; Save = p;
-        ClosNodes++; qlen--;
+        m_ClosNodes++; m_qlen--;
     }
     else /* empty list */
     {
@@ -117,104 +193,63 @@ void GetQueue( int* r, int* c, int* s, int* d, int* a )
  *      1 - OK
  *      0 - Failed to allocate memory.
  */
-bool SetQueue( int r, int c, int side, int d, int a, int r2, int c2 )
+bool ROUTING_QUEUE::Set( int r, int c, int side, int d, int a, int r2, int c2 )
 {
-    struct PcbQueue* p, * q, * t;
-    int i, j;
-
-    j = 0;                      // gcc warning fix
-
-    if( (p = Save) != NULL )    /* try free list first */
+    NODE p;
+
+    p.Row     = r;
+    p.Col     = c;
+    p.Side    = side;
+    p.Dist    = d;
+    p.ApxDist = a;
+    p.Goal    = ( r == r2 && c == c2 );
+    p.Key     = cellKey( r, c, side );
+    p.Order   = m_insertCount++;
+
+    try
     {
-        Save = p->Next;
+        m_heap.push_back( p );
     }
-    else if( ( p = (PcbQueue*) operator new( sizeof( PcbQueue ), std::nothrow ) ) == NULL )
+    catch( const std::bad_alloc& )
     {
         return 0;
     }
 
-    p->Row  = r;
-    p->Col  = c;
-    p->Side = side;
-    i = (p->Dist = d) + (p->ApxDist = a);
-    p->Next = NULL;
-
-    if( (q = Head) != NULL ) /* insert in proper position in list */
-    {
-        if( q->Dist + q->ApxDist > i ) /* insert at head */
-        {
-            p->Next = q; Head = p;
-        }
-        else   /* search for proper position */
-        {
-            for( t = q, q = q->Next; q && i > ( j = q->Dist + q->ApxDist ); t = q, q = q->Next )
-                ;
-
-            if( q && i == j && q->Row == r2 && q->Col == c2 )
-            {
-                /* insert after q, which is a goal node */
-                if( ( p->Next = q->Next ) == NULL )
-                    Tail = p;
-
-                q->Next = p;
-            }
-            else  /* insert in front of q */
-            {
-                if( ( p->Next = q ) == NULL )
-                    Tail = p;
-
-                t->Next = p;
-            }
-        }
-    }
-    else /* empty search list */
-    {
-        Head = Tail = p;
-    }
+    siftUp( m_heap.size() - 1 );
 
-    OpenNodes++;
+    m_OpenNodes++;
 
-    if( ++qlen > MaxNodes )
-        MaxNodes = qlen;
+    if( ++m_qlen > m_MaxNodes )
+        m_MaxNodes = m_qlen;
 
     return 1;
 }
 
 
 /* reposition node in list */
-void ReSetQueue( int r, int c, int s, int d, int a, int r2, int c2 )
+void ROUTING_QUEUE::ReSet( int r, int c, int s, int d, int a, int r2, int c2 )
 {
-    struct PcbQueue* p, * q;
+    int index = m_heapIndex[cellKey( r, c, s )];
 
-    /* first, see if it is already in the list */
-    for( q = NULL, p = Head; p; q = p, p = p->Next )
+    if( index < 0 )     /* not found, it has already been closed once */
     {
-        if( p->Row == r && p->Col == c && p->Side == s )
-        {
-            /* old one to remove */
-            if( q )
-            {
-                if( ( q->Next = p->Next ) == NULL )
-                    Tail = q;
-            }
-            else if( ( Head = p->Next ) == NULL )
-            {
-                Tail = NULL;
-            }
-
-            p->Next = Save;
-            Save = p;
-            OpenNodes--;
-            MoveNodes++;
-            qlen--;
-            break;
-        }
+        m_ClosNodes--;  /* we will close it again, but just count once */
+
+        bool res = Set( r, c, s, d, a, r2, c2 );
+        (void) res;
+        return;
     }
 
-    if( !p )            /* not found, it has already been closed once */
-        ClosNodes--;    /* we will close it again, but just count once */
+    /* it is still open: update its distance and move it to its new position */
+    NODE& p = m_heap[index];
+
+    p.Dist    = d;
+    p.ApxDist = a;
+    p.Order   = m_insertCount++;
+    m_MoveNodes++;
+
+    int key = p.Key;
 
-    /* if it was there, it's gone now; insert it at the proper position */
-    bool res = SetQueue( r, c, s, d, a, r2, c2 );
-    (void) res;
+    siftUp( index );
+    siftDown( m_heapIndex[key] );
 }
@@ -47,9 +47,7 @@
 
 MATRIX_ROUTING_HEAD::MATRIX_ROUTING_HEAD()
 {
-    m_BoardSide[0] = m_BoardSide[1] = NULL;
-    m_DistSide[0] = m_DistSide[1] = NULL;
-    m_DirSide[0] = m_DirSide[1] = NULL;
+    m_Cells[0] = m_Cells[1] = NULL;
     m_opWriteCell        = NULL;
     m_InitMatrixDone     = false;
     m_Nrows              = 0;
@@ -113,36 +111,18 @@ int MATRIX_ROUTING_HEAD::InitRoutingMatrix()
     int side = BOTTOM;
     for( int jj = 0; jj < m_RoutingLayersCount; jj++ )  // m_RoutingLayersCount = 1 or 2
     {
-        m_BoardSide[side] = NULL;
-        m_DistSide[side]  = NULL;
-        m_DirSide[side]   = NULL;
+        // allocate matrix, distances and directions & initialize everything to empty
+        m_Cells[side] = (ROUTING_CELL*) operator new( ii * sizeof(ROUTING_CELL), std::nothrow );
 
-        // allocate matrix & initialize everything to empty
-        m_BoardSide[side] = (MATRIX_CELL*) operator new( ii * sizeof(MATRIX_CELL) );
-        memset( m_BoardSide[side], 0, ii * sizeof(MATRIX_CELL) );
-
-        if( m_BoardSide[side] == NULL )
+        if( m_Cells[side] == NULL )
             return -1;
 
-        // allocate Distances
-        m_DistSide[side] = (DIST_CELL*) operator new( ii * sizeof(DIST_CELL) );
-        memset( m_DistSide[side], 0, ii * sizeof(DIST_CELL) );
-
-        if( m_DistSide[side] == NULL )
-            return -1;
-
-        // allocate Dir (chars)
-        m_DirSide[side] = (char*) operator new( ii );
-        memset( m_DirSide[side], 0, ii );
-
-        if( m_DirSide[side] == NULL )
-            return -1;
+        memset( m_Cells[side], 0, ii * sizeof(ROUTING_CELL) );
 
         side = TOP;
     }
 
-    m_MemSize = m_RouteCount * ii * ( sizeof(MATRIX_CELL)
-                + sizeof(DIST_CELL) + sizeof(char) );
+    m_MemSize = m_RouteCount * ii * sizeof(ROUTING_CELL);
 
     return m_MemSize;
 }
@@ -156,25 +136,11 @@ void MATRIX_ROUTING_HEAD::UnInitRoutingMatrix()
 
     for( ii = 0; ii < MAX_ROUTING_LAYERS_COUNT; ii++ )
     {
-        // de-allocate Dir matrix
-        if( m_DirSide[ii] )
-        {
-            delete m_DirSide[ii];
-            m_DirSide[ii] = NULL;
-        }
-
-        // de-allocate Distances matrix
-        if( m_DistSide[ii] )
+        // de-allocate cells, distances and directions matrix
+        if( m_Cells[ii] )
         {
-            delete m_DistSide[ii];
-            m_DistSide[ii] = NULL;
-        }
-
-        // de-allocate cells matrix
-        if( m_BoardSide[ii] )
-        {
-            delete m_BoardSide[ii];
-            m_BoardSide[ii] = NULL;
+            operator delete( m_Cells[ii] );
+            m_Cells[ii] = NULL;
         }
     }
 
@@ -444,25 +410,11 @@ void MATRIX_ROUTING_HEAD::SetCellOperation( int aLogicOp )
 }
 
 
-/* return the value stored in a cell
- */
-MATRIX_CELL MATRIX_ROUTING_HEAD::GetCell( int aRow, int aCol, int aSide )
-{
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    return p[aRow * m_Ncols + aCol];
-}
-
-
 /* basic cell operation : WRITE operation
  */
 void MATRIX_ROUTING_HEAD::SetCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
 {
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] = x;
+    m_Cells[aSide][aRow * m_Ncols + aCol].m_Cell = x;
 }
 
 
@@ -470,10 +422,7 @@ void MATRIX_ROUTING_HEAD::SetCell( int aRow, int aCol, int aSide, MATRIX_CELL x
  */
 void MATRIX_ROUTING_HEAD::OrCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
 {
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] |= x;
+    m_Cells[aSide][aRow * m_Ncols + aCol].m_Cell |= x;
 }
 
 
@@ -481,10 +430,7 @@ void MATRIX_ROUTING_HEAD::OrCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
  */
 void MATRIX_ROUTING_HEAD::XorCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
 {
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] ^= x;
+    m_Cells[aSide][aRow * m_Ncols + aCol].m_Cell ^= x;
 }
 
 
@@ -492,10 +438,7 @@ void MATRIX_ROUTING_HEAD::XorCell( int aRow, int aCol, int aSide, MATRIX_CELL x
  */
 void MATRIX_ROUTING_HEAD::AndCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
 {
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] &= x;
+    m_Cells[aSide][aRow * m_Ncols + aCol].m_Cell &= x;
 }
 
 
@@ -503,48 +446,24 @@ void MATRIX_ROUTING_HEAD::AndCell( int aRow, int aCol, int aSide, MATRIX_CELL x
  */
 void MATRIX_ROUTING_HEAD::AddCell( int aRow, int aCol, int aSide, MATRIX_CELL x )
 {
-    MATRIX_CELL* p;
-
-    p = RoutingMatrix.m_BoardSide[aSide];
-    p[aRow * m_Ncols + aCol] += x;
-}
-
-
-// fetch distance cell
-DIST_CELL MATRIX_ROUTING_HEAD::GetDist( int aRow, int aCol, int aSide ) // fetch distance cell
-{
-    DIST_CELL* p;
-
-    p = RoutingMatrix.m_DistSide[aSide];
-    return p[aRow * m_Ncols + aCol];
-}
-
-
-// store distance cell
-void MATRIX_ROUTING_HEAD::SetDist( int aRow, int aCol, int aSide, DIST_CELL x )
-{
-    DIST_CELL* p;
-
-    p = RoutingMatrix.m_DistSide[aSide];
-    p[aRow * m_Ncols + aCol] = x;
+    m_Cells[aSide][aRow * m_Ncols + aCol].m_Cell += x;
 }
 
 
-// fetch direction cell
-int MATRIX_ROUTING_HEAD::GetDir( int aRow, int aCol, int aSide )
+void MATRIX_ROUTING_HEAD::SetAllDirs( int aSide, int aDir )
 {
-    DIR_CELL* p;
+    ROUTING_CELL* p = m_Cells[aSide];
 
-    p = RoutingMatrix.m_DirSide[aSide];
-    return (int) (p[aRow * m_Ncols + aCol]);
+    for( int ii = m_Nrows * m_Ncols; ii > 0; ii--, p++ )
+        p->m_Dir = (DIR_CELL) aDir;
 }
 
 
-// store direction cell
-void MATRIX_ROUTING_HEAD::SetDir( int aRow, int aCol, int aSide, int x )
+void MATRIX_ROUTING_HEAD::CopyCells( int aFromSide, int aToSide )
 {
-    DIR_CELL* p;
+    ROUTING_CELL* src = m_Cells[aFromSide];
+    ROUTING_CELL* dst = m_Cells[aToSide];
 
-    p = RoutingMatrix.m_DirSide[aSide];
-    p[aRow * m_Ncols + aCol] = (char) x;
+    for( int ii = m_Nrows * m_Ncols; ii > 0; ii--, src++, dst++ )
+        dst->m_Cell = src->m_Cell;
 }
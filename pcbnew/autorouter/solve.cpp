@@ -48,8 +48,14 @@
 #include <autorout.h>
 #include <cell.h>
 
+#include <algorithm>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 
-static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
+
+static int Autoroute_One_Track( BOARD*          aPcb,
+                                PCB_EDIT_FRAME* pcbframe,
                                 wxDC*           DC,
                                 int             two_sides,
                                 int             row_source,
@@ -58,7 +64,8 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
                                 int             col_target,
                                 RATSNEST_ITEM*  pt_rat );
 
-static int Retrace( PCB_EDIT_FRAME* pcbframe,
+static int Retrace( BOARD*          aPcb,
+                    PCB_EDIT_FRAME* pcbframe,
                     wxDC*           DC,
                     int,
                     int,
@@ -74,7 +81,7 @@ static void OrCell_Trace( BOARD* pcb,
                           int    orient,
                           int    current_net_code );
 
-static void AddNewTrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC );
+static void AddNewTrace( BOARD* aPcb, PCB_EDIT_FRAME* pcbframe, wxDC* DC );
 
 
 static int            segm_oX, segm_oY;
@@ -85,10 +92,6 @@ static int            s_Clearance;  // Clearance value used in autorouter
 
 static PICKED_ITEMS_LIST s_ItemsListPicker;
 
-int OpenNodes;       // total number of nodes opened
-int ClosNodes;       // total number of nodes closed
-int MoveNodes;       // total number of nodes moved
-int MaxNodes;        // maximum number of nodes opened at one time
 
 #define NOSUCCESS       0
 #define STOP_FROM_ESC   -1
@@ -230,23 +233,19 @@ static struct block blocking[8] =
   } };
 
 // mask for hole-related blocking effects
-static struct
-{
-    long trace;
-    int  present;
-} selfok2[8] =
+static const long selfok2[8] =
 {
-    { HOLE_NORTHWEST, 0 },
-    { HOLE_NORTH,     0 },
-    { HOLE_NORTHEAST, 0 },
-    { HOLE_WEST,      0 },
-    { HOLE_EAST,      0 },
-    { HOLE_SOUTHWEST, 0 },
-    { HOLE_SOUTH,     0 },
-    { HOLE_SOUTHEAST, 0 }
+    HOLE_NORTHWEST,
+    HOLE_NORTH,
+    HOLE_NORTHEAST,
+    HOLE_WEST,
+    HOLE_EAST,
+    HOLE_SOUTHWEST,
+    HOLE_SOUTH,
+    HOLE_SOUTHEAST
 };
 
-static long newmask[8] =
+static const long newmask[8] =
 {
     // patterns to mask out in neighbor cells
     0,
@@ -260,281 +259,304 @@ static long newmask[8] =
 };
 
 
-/* Route all traces
- * :
- *  1 if OK
- * -1 if escape (stop being routed) request
- * -2 if default memory allocation
+/* Concurrent routing.
+ * Connections whose neighbourhoods do not overlap are searched at the same time, each
+ * by a worker thread in its own copy of a window of the routing matrix, then the paths
+ * found are turned into tracks one after the other, in the order of the work list, by
+ * the current thread.  A path is committed only if the cells it uses did not change
+ * since its window was copied, otherwise it is dropped and the connection routed again
+ * on the whole matrix, like a connection which could not be routed inside its window.
+ */
+#define WINDOW_MARGIN       10      // min cells around a connection in its search window
+#define JOBS_PER_THREAD     4       // max connections searched by a thread in a batch
+
+
+/* A rectangle of the routing matrix, copied for a search made by a worker thread.
+ * It has the cell accessors of MATRIX_ROUTING_HEAD, with coordinates relative to its
+ * origin, so findPath() can search in either of them.
  */
-int PCB_EDIT_FRAME::Solve( wxDC* DC, int aLayersCount )
+class ROUTING_WINDOW
 {
-    int           current_net_code;
-    int           row_source, col_source, row_target, col_target;
-    int           success, nbsucces = 0, nbunsucces = 0;
-    NETINFO_ITEM* net;
-    bool          stop = false;
-    wxString      msg;
-    int           routedCount = 0;      // routed ratsnest count
-    bool          two_sides = aLayersCount == 2;
+public:
+    int     m_Row0, m_Col0;         // position of the window in RoutingMatrix
+    int     m_Nrows, m_Ncols;       // window size
 
-    m_canvas->SetAbortRequest( false );
+    ROUTING_WINDOW() :
+        m_Row0( 0 ), m_Col0( 0 ), m_Nrows( 0 ), m_Ncols( 0 )
+    {
+    }
 
-    s_Clearance = GetBoard()->GetDesignSettings().GetDefault()->GetClearance();
+    // copy the cells of a rectangle of RoutingMatrix, with no distance and no direction
+    void Copy( int aRow0, int aCol0, int aNrows, int aNcols );
 
-    // Prepare the undo command info
-    s_ItemsListPicker.ClearListAndDeleteItems();  // Should not be necessary, but...
+    void Free()
+    {
+        for( int side = 0; side < MAX_ROUTING_LAYERS_COUNT; side++ )
+            std::vector<ROUTING_CELL>().swap( m_Cells[side] );
+    }
 
-    // go until no more work to do
-    GetWork( &row_source, &col_source, &current_net_code,
-             &row_target, &col_target, &pt_cur_ch ); // First net to route.
+    MATRIX_CELL GetCell( int aRow, int aCol, int aSide ) const
+    {
+        return m_Cells[aSide][aRow * m_Ncols + aCol].m_Cell;
+    }
 
-    for( ; row_source != ILLEGAL; GetWork( &row_source, &col_source,
-                                           &current_net_code, &row_target,
-                                           &col_target,
-                                           &pt_cur_ch ) )
+    DIST_CELL GetDist( int aRow, int aCol, int aSide ) const
     {
-        // Test to stop routing ( escape key pressed )
-        wxYield();
+        return m_Cells[aSide][aRow * m_Ncols + aCol].m_Dist;
+    }
 
-        if( m_canvas->GetAbortRequest() )
-        {
-            if( IsOK( this, _( "Abort routing?" ) ) )
-            {
-                success = STOP_FROM_ESC;
-                stop    = true;
-                break;
-            }
-            else
-            {
-                m_canvas->SetAbortRequest( false );
-            }
-        }
+    void SetDist( int aRow, int aCol, int aSide, DIST_CELL aDist )
+    {
+        m_Cells[aSide][aRow * m_Ncols + aCol].m_Dist = aDist;
+    }
 
-        EraseMsgBox();
+    int GetDir( int aRow, int aCol, int aSide ) const
+    {
+        return (int) m_Cells[aSide][aRow * m_Ncols + aCol].m_Dir;
+    }
 
-        routedCount++;
-        net = GetBoard()->FindNet( current_net_code );
+    void SetDir( int aRow, int aCol, int aSide, int aDir )
+    {
+        m_Cells[aSide][aRow * m_Ncols + aCol].m_Dir = (DIR_CELL) aDir;
+    }
 
-        if( net )
-        {
-            msg.Printf( wxT( "[%8.8s]" ), GetChars( net->GetNetname() ) );
-            AppendMsgPanel( wxT( "Net route" ), msg, BROWN );
-            msg.Printf( wxT( "%d / %d" ), routedCount, RoutingMatrix.m_RouteCount );
-            AppendMsgPanel( wxT( "Activity" ), msg, BROWN );
-        }
+    // distances do not depend on the cells: RoutingMatrix is only read
+    int CalcDist( int x, int y, int z, int side )
+    {
+        return RoutingMatrix.CalcDist( x, y, z, side );
+    }
 
-        segm_oX = GetBoard()->GetBoundingBox().GetX() + (RoutingMatrix.m_GridRouting * col_source);
-        segm_oY = GetBoard()->GetBoundingBox().GetY() + (RoutingMatrix.m_GridRouting * row_source);
-        segm_fX = GetBoard()->GetBoundingBox().GetX() + (RoutingMatrix.m_GridRouting * col_target);
-        segm_fY = GetBoard()->GetBoundingBox().GetY() + (RoutingMatrix.m_GridRouting * row_target);
+    int GetApxDist( int r1, int c1, int r2, int c2 )
+    {
+        return RoutingMatrix.GetApxDist( r1, c1, r2, c2 );
+    }
 
-        // Draw segment.
-        GRLine( m_canvas->GetClipBox(), DC,
-                segm_oX, segm_oY, segm_fX, segm_fY,
-                0, WHITE );
-        pt_cur_ch->m_PadStart->Draw( m_canvas, DC, GR_OR | GR_HIGHLIGHT );
-        pt_cur_ch->m_PadEnd->Draw( m_canvas, DC, GR_OR | GR_HIGHLIGHT );
+private:
+    std::vector<ROUTING_CELL> m_Cells[MAX_ROUTING_LAYERS_COUNT];
+};
 
-        success = Autoroute_One_Track( this, DC,
-                                       two_sides, row_source, col_source,
-                                       row_target, col_target, pt_cur_ch );
 
-        switch( success )
-        {
-        case NOSUCCESS:
-            pt_cur_ch->m_Status |= CH_UNROUTABLE;
-            nbunsucces++;
-            break;
+void ROUTING_WINDOW::Copy( int aRow0, int aCol0, int aNrows, int aNcols )
+{
+    m_Row0  = aRow0;
+    m_Col0  = aCol0;
+    m_Nrows = aNrows;
+    m_Ncols = aNcols;
 
-        case STOP_FROM_ESC:
-            stop = true;
-            break;
+    for( int side = 0; side < MAX_ROUTING_LAYERS_COUNT; side++ )
+    {
+        m_Cells[side].clear();
 
-        case ERR_MEMORY:
-            stop = true;
-            break;
+        if( RoutingMatrix.m_Cells[side] == NULL )
+            continue;
 
-        default:
-            nbsucces++;
-            break;
+        m_Cells[side].resize( aNrows * aNcols );
+
+        for( int row = 0; row < aNrows; row++ )
+        {
+            const ROUTING_CELL* src = RoutingMatrix.m_Cells[side]
+                                      + ( aRow0 + row ) * RoutingMatrix.m_Ncols + aCol0;
+            ROUTING_CELL*       dst = &m_Cells[side][row * aNcols];
+
+            for( int col = 0; col < aNcols; col++ )
+            {
+                dst[col].m_Cell = src[col].m_Cell;
+                dst[col].m_Dist = 0;
+                dst[col].m_Dir  = FROM_NOWHERE;
+            }
         }
+    }
+}
 
-        msg.Printf( wxT( "%d" ), nbsucces );
-        AppendMsgPanel( wxT( "OK" ), msg, GREEN );
-        msg.Printf( wxT( "%d" ), nbunsucces );
-        AppendMsgPanel( wxT( "Fail" ), msg, RED );
-        msg.Printf( wxT( "  %d" ), GetBoard()->GetUnconnectedNetCount() );
-        AppendMsgPanel( wxT( "Not Connected" ), msg, CYAN );
 
-        // Delete routing from display.
-        pt_cur_ch->m_PadStart->Draw( m_canvas, DC, GR_AND );
-        pt_cur_ch->m_PadEnd->Draw( m_canvas, DC, GR_AND );
+// a cell of a path found by a worker thread, in RoutingMatrix coordinates
+struct ROUTE_STEP
+{
+    int m_Row, m_Col, m_Side;
+    int m_Dir;                      // direction back to the source
+};
 
-        if( stop )
-            break;
-    }
 
-    SaveCopyInUndoList( s_ItemsListPicker, UR_UNSPECIFIED );
-    s_ItemsListPicker.ClearItemsList(); // s_ItemsListPicker is no more owner of picked items
+// a connection of the work list routed concurrently
+struct ROUTE_JOB
+{
+    int                     m_RowSource, m_ColSource;
+    int                     m_RowTarget, m_ColTarget;
+    int                     m_NetCode;
+    RATSNEST_ITEM*          m_Ratsnest;
+
+    EDA_RECT                m_Area;         // search window, in cells
+    int                     m_Result;       // result of the search in m_Window
+    int                     m_TargetSide;   // side where the search reached the target
+    ROUTING_WINDOW          m_Window;
+    std::vector<ROUTE_STEP> m_Path;         // path cells, from the target
+};
 
-    return SUCCESS;
+
+/* Set the current connection: its ratsnest and the board coordinates of its ends,
+ * used to draw it and to create the tracks.
+ */
+static void setCurrentConnection( BOARD* aPcb, int row_source, int col_source,
+                                  int row_target, int col_target, RATSNEST_ITEM* aRatsnest )
+{
+    segm_oX = aPcb->GetBoundingBox().GetX() + (RoutingMatrix.m_GridRouting * col_source);
+    segm_oY = aPcb->GetBoundingBox().GetY() + (RoutingMatrix.m_GridRouting * row_source);
+    segm_fX = aPcb->GetBoundingBox().GetX() + (RoutingMatrix.m_GridRouting * col_target);
+    segm_fY = aPcb->GetBoundingBox().GetY() + (RoutingMatrix.m_GridRouting * row_target);
+    pt_cur_ch = aRatsnest;
 }
 
 
-/* Route a trace on the BOARD.
- * Parameters:
- * 1 side / 2 sides (0 / 1)
- * Coord source (row, col)
- * Coord destination (row, col)
- * Net_code
- * Pointer to the ratsnest reference
- *
- * Returns:
- * SUCCESS if routed
- * TRIVIAL_SUCCESS if pads are connected by overlay (no track needed)
- * If failure NOSUCCESS
- * Escape STOP_FROM_ESC if demand
- * ERR_MEMORY if memory allocation failed.
+/* Test if a connection can be routed: its pads must be on the routing layers, and each
+ * must contain its grid point.
+ * Returns NOSUCCESS if it cannot, TRIVIAL_SUCCESS if the pads overlap on the same grid
+ * point (no track needed), SUCCESS if a path must be searched.
  */
-static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
-                                wxDC*           DC,
-                                int             two_sides,
-                                int             row_source,
-                                int             col_source,
-                                int             row_target,
-                                int             col_target,
-                                RATSNEST_ITEM*  pt_rat )
+static int checkEndPoints( BOARD* aPcb,
+                           int row_source, int col_source,
+                           int row_target, int col_target,
+                           RATSNEST_ITEM* pt_rat )
 {
-    int          r, c, side, d, apx_dist, nr, nc;
-    int          result, skip;
-    int          i;
-    long         curcell, newcell, buddy, lastopen, lastclos, lastmove;
-    int          newdist, olddir, _self;
-    int          current_net_code;
-    int          marge;
-    LSET         padLayerMaskStart;    // Mask layers belonging to the starting pad.
-    LSET         padLayerMaskEnd;      // Mask layers belonging to the ending pad.
+    LSET    routeLayerMask = LSET( g_Route_Layer_TOP ) | LSET( g_Route_Layer_BOTTOM );
+    LSET    padLayerMaskStart = pt_rat->m_PadStart->GetLayerSet();
+    LSET    padLayerMaskEnd = pt_rat->m_PadEnd->GetLayerSet();
 
-    LSET         topLayerMask( g_Route_Layer_TOP );
+    /* First Test if routing possible ie if the pads are accessible
+     * on the routing layers.
+     */
+    if( ( routeLayerMask & padLayerMaskStart ) == 0 )
+        return NOSUCCESS;
 
-    LSET         bottomLayerMask( g_Route_Layer_BOTTOM );
+    if( ( routeLayerMask & padLayerMaskEnd ) == 0 )
+        return NOSUCCESS;
 
-    LSET         routeLayerMask;       // Mask two layers for routing.
+    /* Then test if routing possible ie if the pads are accessible
+     * On the routing grid (1 grid point must be in the pad)
+     */
+    int cX = ( RoutingMatrix.m_GridRouting * col_source ) + aPcb->GetBoundingBox().GetX();
+    int cY = ( RoutingMatrix.m_GridRouting * row_source ) + aPcb->GetBoundingBox().GetY();
+    int dx = pt_rat->m_PadStart->GetSize().x / 2;
+    int dy = pt_rat->m_PadStart->GetSize().y / 2;
+    int px = pt_rat->m_PadStart->GetPosition().x;
+    int py = pt_rat->m_PadStart->GetPosition().y;
 
-    LSET         tab_mask[2];           // Enables the calculation of the mask layer being
-                                        // tested. (side = TOP or BOTTOM)
-    int          start_mask_layer = 0;
-    wxString     msg;
+    if( ( ( int( pt_rat->m_PadStart->GetOrientation() ) / 900 ) & 1 ) != 0 )
+        std::swap( dx, dy );
 
-    // @todo this could be a bottle neck
-    LSET all_cu = LSET::AllCuMask( pcbframe->GetBoard()->GetCopperLayerCount() );
+    if( ( abs( cX - px ) > dx ) || ( abs( cY - py ) > dy ) )
+        return NOSUCCESS;
 
-    wxBusyCursor dummy_cursor;      // Set an hourglass cursor while routing a
-                                    // track
+    cX = ( RoutingMatrix.m_GridRouting * col_target ) + aPcb->GetBoundingBox().GetX();
+    cY = ( RoutingMatrix.m_GridRouting * row_target ) + aPcb->GetBoundingBox().GetY();
+    dx = pt_rat->m_PadEnd->GetSize().x / 2;
+    dy = pt_rat->m_PadEnd->GetSize().y / 2;
+    px = pt_rat->m_PadEnd->GetPosition().x;
+    py = pt_rat->m_PadEnd->GetPosition().y;
 
-    result = NOSUCCESS;
+    if( ( ( int( pt_rat->m_PadEnd->GetOrientation() ) / 900) & 1 ) != 0 )
+        std::swap( dx, dy );
 
-    marge = s_Clearance + ( pcbframe->GetDesignSettings().GetCurrentTrackWidth() / 2 );
+    if( ( abs( cX - px ) > dx ) || ( abs( cY - py ) > dy ) )
+        return NOSUCCESS;
 
-    // clear direction flags
-    i = RoutingMatrix.m_Nrows * RoutingMatrix.m_Ncols * sizeof(DIR_CELL);
+    // Test the trivial case: direct connection overlay pads.
+    LSET all_cu = LSET::AllCuMask( aPcb->GetCopperLayerCount() );
 
-    if( two_sides )
-        memset( RoutingMatrix.m_DirSide[TOP], FROM_NOWHERE, i );
-    memset( RoutingMatrix.m_DirSide[BOTTOM], FROM_NOWHERE, i );
+    if( row_source == row_target  && col_source == col_target &&
+            ( padLayerMaskEnd & padLayerMaskStart & all_cu ).any() )
+        return TRIVIAL_SUCCESS;
 
-    lastopen = lastclos = lastmove = 0;
+    return SUCCESS;
+}
 
-    // Set tab_masque[side] for final test of routing.
-    if( two_sides )
-        tab_mask[TOP] = topLayerMask;
-    tab_mask[BOTTOM] = bottomLayerMask;
 
-    // Set active layers mask.
-    routeLayerMask = topLayerMask | bottomLayerMask;
+/* Mark the cells of the 2 pads of pt_rat as CURRENT_PAD, so a search can go thru them,
+ * except the cells also used by other pads, which stay obstacles.
+ */
+static void markConnectionPads( BOARD* aPcb, RATSNEST_ITEM* pt_rat, int marge )
+{
+    PlacePad( pt_rat->m_PadStart, CURRENT_PAD, marge, WRITE_OR_CELL );
+    PlacePad( pt_rat->m_PadEnd, CURRENT_PAD, marge, WRITE_OR_CELL );
 
-    pt_cur_ch = pt_rat;
+    // Regenerates the remaining barriers (which may encroach on the
+    // placement bits precedent).  Only the pads near the 2 pads of the connection
+    // can have a cell marked as CURRENT_PAD.
+    EDA_RECT startArea = pt_rat->m_PadStart->GetBoundingBox();
+    EDA_RECT endArea = pt_rat->m_PadEnd->GetBoundingBox();
 
-    current_net_code  = pt_rat->GetNet();
-    padLayerMaskStart = pt_cur_ch->m_PadStart->GetLayerSet();
+    startArea.Inflate( marge + RoutingMatrix.m_GridRouting );
+    endArea.Inflate( marge + RoutingMatrix.m_GridRouting );
 
-    padLayerMaskEnd = pt_cur_ch->m_PadEnd->GetLayerSet();
+    for( unsigned ii = 0; ii < aPcb->GetPadCount(); ii++ )
+    {
+        D_PAD* ptr = aPcb->GetPad( ii );
 
+        if( ( pt_rat->m_PadStart == ptr ) || ( pt_rat->m_PadEnd == ptr ) )
+            continue;
 
-    /* First Test if routing possible ie if the pads are accessible
-     * on the routing layers.
-     */
-    if( ( routeLayerMask & padLayerMaskStart ) == 0 )
-        goto end_of_route;
+        EDA_RECT area = ptr->GetBoundingBox();
 
-    if( ( routeLayerMask & padLayerMaskEnd ) == 0 )
-        goto end_of_route;
+        area.Inflate( marge + RoutingMatrix.m_GridRouting );
 
-    /* Then test if routing possible ie if the pads are accessible
-     * On the routing grid (1 grid point must be in the pad)
-     */
-    {
-        int cX = ( RoutingMatrix.m_GridRouting * col_source )
-                 + pcbframe->GetBoard()->GetBoundingBox().GetX();
-        int cY = ( RoutingMatrix.m_GridRouting * row_source )
-                 + pcbframe->GetBoard()->GetBoundingBox().GetY();
-        int dx = pt_cur_ch->m_PadStart->GetSize().x / 2;
-        int dy = pt_cur_ch->m_PadStart->GetSize().y / 2;
-        int px = pt_cur_ch->m_PadStart->GetPosition().x;
-        int py = pt_cur_ch->m_PadStart->GetPosition().y;
-
-        if( ( ( int( pt_cur_ch->m_PadStart->GetOrientation() ) / 900 ) & 1 ) != 0 )
-            std::swap( dx, dy );
-
-        if( ( abs( cX - px ) > dx ) || ( abs( cY - py ) > dy ) )
-            goto end_of_route;
-
-        cX = ( RoutingMatrix.m_GridRouting * col_target )
-             + pcbframe->GetBoard()->GetBoundingBox().GetX();
-        cY = ( RoutingMatrix.m_GridRouting * row_target )
-             + pcbframe->GetBoard()->GetBoundingBox().GetY();
-        dx = pt_cur_ch->m_PadEnd->GetSize().x / 2;
-        dy = pt_cur_ch->m_PadEnd->GetSize().y / 2;
-        px = pt_cur_ch->m_PadEnd->GetPosition().x;
-        py = pt_cur_ch->m_PadEnd->GetPosition().y;
-
-        if( ( ( int( pt_cur_ch->m_PadEnd->GetOrientation() ) / 900) & 1 ) != 0 )
-            std::swap( dx, dy );
-
-        if( ( abs( cX - px ) > dx ) || ( abs( cY - py ) > dy ) )
-            goto end_of_route;
+        if( area.Intersects( startArea ) || area.Intersects( endArea ) )
+            PlacePad( ptr, ~CURRENT_PAD, marge, WRITE_AND_CELL );
     }
+}
 
-    // Test the trivial case: direct connection overlay pads.
-    if( row_source == row_target  && col_source == col_target &&
-            ( padLayerMaskEnd & padLayerMaskStart & all_cu ).any() )
-    {
-        result = TRIVIAL_SUCCESS;
-        goto end_of_route;
-    }
 
-    // Placing the bit to remove obstacles on 2 pads to a link.
-    pcbframe->SetStatusText( wxT( "Gen Cells" ) );
+static void unmarkConnectionPads( RATSNEST_ITEM* pt_rat, int marge )
+{
+    PlacePad( pt_rat->m_PadStart, ~CURRENT_PAD, marge, WRITE_AND_CELL );
+    PlacePad( pt_rat->m_PadEnd, ~CURRENT_PAD, marge, WRITE_AND_CELL );
+}
 
-    PlacePad( pt_cur_ch->m_PadStart, CURRENT_PAD, marge, WRITE_OR_CELL );
-    PlacePad( pt_cur_ch->m_PadEnd, CURRENT_PAD, marge, WRITE_OR_CELL );
 
-    // Regenerates the remaining barriers (which may encroach on the
-    // placement bits precedent)
-    i = pcbframe->GetBoard()->GetPadCount();
+/* Search the best path from the source cell to the target cell of aGrid, which is
+ * RoutingMatrix or a ROUTING_WINDOW, whose cells of the connection pads are marked as
+ * CURRENT_PAD and whose directions are cleared.
+ * pcbframe is used to report the search activity and to test the abort request, it is
+ * NULL for the searches made by worker threads.
+ * Returns:
+ * SUCCESS if a path was found, the directions of aGrid lead from the target, on side
+ *   *aTargetSide, back to the source
+ * NOSUCCESS if there is no path
+ * STOP_FROM_ESC if routing was aborted
+ * ERR_MEMORY if memory allocation failed.
+ */
+template <class GRID>
+static int findPath( GRID&           aGrid,
+                     ROUTING_QUEUE&  aQueue,
+                     int             two_sides,
+                     int             row_source,
+                     int             col_source,
+                     int             row_target,
+                     int             col_target,
+                     LSET            padLayerMaskStart,
+                     LSET            padLayerMaskEnd,
+                     PCB_EDIT_FRAME* pcbframe,
+                     int*            aTargetSide )
+{
+    int          r, c, side, d, apx_dist, nr, nc;
+    int          skip;
+    int          i;
+    long         curcell, newcell, buddy, lastopen, lastclos, lastmove;
+    int          newdist, olddir, _self;
+    bool         selfok[8];
+    LSET         topLayerMask( g_Route_Layer_TOP );
+    LSET         bottomLayerMask( g_Route_Layer_BOTTOM );
+    LSET         tab_mask[2];           // Enables the calculation of the mask layer being
+                                        // tested. (side = TOP or BOTTOM)
+    wxString     msg;
 
-    for( unsigned ii = 0; ii < pcbframe->GetBoard()->GetPadCount(); ii++ )
-    {
-        D_PAD* ptr = pcbframe->GetBoard()->GetPad( ii );
+    lastopen = lastclos = lastmove = 0;
 
-        if( ( pt_cur_ch->m_PadStart != ptr ) && ( pt_cur_ch->m_PadEnd != ptr ) )
-        {
-            PlacePad( ptr, ~CURRENT_PAD, marge, WRITE_AND_CELL );
-        }
-    }
+    // Set tab_masque[side] for final test of routing.
+    if( two_sides )
+        tab_mask[TOP] = topLayerMask;
+    tab_mask[BOTTOM] = bottomLayerMask;
 
-    InitQueue(); // initialize the search queue
-    apx_dist = RoutingMatrix.GetApxDist( row_source, col_source, row_target, col_target );
+    aQueue.Init( aGrid.m_Nrows, aGrid.m_Ncols ); // initialize the search queue
+    apx_dist = aGrid.GetApxDist( row_source, col_source, row_target, col_target );
 
     // Initialize first search.
     if( two_sides )   // Preferred orientation.
@@ -543,10 +565,8 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
         {
             if( ( padLayerMaskStart & topLayerMask ).any() )
             {
-                start_mask_layer = 2;
-
-                if( SetQueue( row_source, col_source, TOP, 0, apx_dist,
-                              row_target, col_target ) == 0 )
+                if( aQueue.Set( row_source, col_source, TOP, 0, apx_dist,
+                                row_target, col_target ) == 0 )
                 {
                     return ERR_MEMORY;
                 }
@@ -554,10 +574,8 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
 
             if( ( padLayerMaskStart & bottomLayerMask ).any() )
             {
-                start_mask_layer |= 1;
-
-                if( SetQueue( row_source, col_source, BOTTOM, 0, apx_dist,
-                              row_target, col_target ) == 0 )
+                if( aQueue.Set( row_source, col_source, BOTTOM, 0, apx_dist,
+                                row_target, col_target ) == 0 )
                 {
                     return ERR_MEMORY;
                 }
@@ -567,10 +585,8 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
         {
             if( ( padLayerMaskStart & bottomLayerMask ).any() )
             {
-                start_mask_layer = 1;
-
-                if( SetQueue( row_source, col_source, BOTTOM, 0, apx_dist,
-                              row_target, col_target ) == 0 )
+                if( aQueue.Set( row_source, col_source, BOTTOM, 0, apx_dist,
+                                row_target, col_target ) == 0 )
                 {
                     return ERR_MEMORY;
                 }
@@ -578,10 +594,8 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
 
             if( ( padLayerMaskStart & topLayerMask ).any() )
             {
-                start_mask_layer |= 2;
-
-                if( SetQueue( row_source, col_source, TOP, 0, apx_dist,
-                              row_target, col_target ) == 0 )
+                if( aQueue.Set( row_source, col_source, TOP, 0, apx_dist,
+                                row_target, col_target ) == 0 )
                 {
                     return ERR_MEMORY;
                 }
@@ -590,245 +604,920 @@ static int Autoroute_One_Track( PCB_EDIT_FRAME* pcbframe,
     }
     else if( ( padLayerMaskStart & bottomLayerMask ).any() )
     {
-        start_mask_layer = 1;
-
-        if( SetQueue( row_source, col_source, BOTTOM, 0, apx_dist, row_target, col_target ) == 0 )
+        if( aQueue.Set( row_source, col_source, BOTTOM, 0, apx_dist,
+                        row_target, col_target ) == 0 )
         {
             return ERR_MEMORY;
         }
     }
 
     // search until success or we exhaust all possibilities
-    GetQueue( &r, &c, &side, &d, &apx_dist );
+    aQueue.Get( &r, &c, &side, &d, &apx_dist );
+
+    for( ; r != ILLEGAL; aQueue.Get( &r, &c, &side, &d, &apx_dist ) )
+    {
+        curcell = aGrid.GetCell( r, c, side );
+
+        if( curcell & CURRENT_PAD )
+            curcell &= ~HOLE;
+
+        if( (r == row_target) && (c == col_target)  // success if layer OK
+           && (tab_mask[side] & padLayerMaskEnd).any() )
+        {
+            *aTargetSide = side;
+            return SUCCESS;     // Routing complete.
+        }
+
+        if( pcbframe )
+        {
+            if( pcbframe->GetCanvas()->GetAbortRequest() )
+                return STOP_FROM_ESC;
+
+            // report every COUNT new nodes or so
+            #define COUNT 20000
+
+            if( ( aQueue.m_OpenNodes - lastopen > COUNT )
+               || ( aQueue.m_ClosNodes - lastclos > COUNT )
+               || ( aQueue.m_MoveNodes - lastmove > COUNT ) )
+            {
+                lastopen = aQueue.m_OpenNodes;
+                lastclos = aQueue.m_ClosNodes;
+                lastmove = aQueue.m_MoveNodes;
+                msg.Printf( wxT( "Activity: Open %d   Closed %d   Moved %d" ),
+                            aQueue.m_OpenNodes, aQueue.m_ClosNodes, aQueue.m_MoveNodes );
+                pcbframe->SetStatusText( msg );
+            }
+        }
+
+        _self = 0;
+
+        if( curcell & HOLE )
+        {
+            _self = 5;
+
+            // set 'present' bits
+            for( i = 0; i < 8; i++ )
+                selfok[i] = ( curcell & selfok2[i] ) != 0;
+        }
+
+        for( i = 0; i < 8; i++ ) // consider neighbors
+        {
+            nr = r + delta[i][0];
+            nc = c + delta[i][1];
+
+            // off the edge?
+            if( nr < 0 || nr >= aGrid.m_Nrows ||
+                nc < 0 || nc >= aGrid.m_Ncols )
+                continue;  // off the edge
+
+            if( _self == 5 && selfok[i] )
+                continue;
+
+            newcell = aGrid.GetCell( nr, nc, side );
+
+            if( newcell & CURRENT_PAD )
+                newcell &= ~HOLE;
+
+            // check for non-target hole
+            if( newcell & HOLE )
+            {
+                if( nr != row_target || nc != col_target )
+                    continue;
+            }
+            // check for traces
+            else if( newcell & HOLE & ~(newmask[i]) )
+            {
+                continue;
+            }
+
+            // check blocking on corner neighbors
+            if( delta[i][0] && delta[i][1] )
+            {
+                // check first buddy
+                buddy = aGrid.GetCell( r + blocking[i].r1, c + blocking[i].c1, side );
+
+                if( buddy & CURRENT_PAD )
+                    buddy &= ~HOLE;
+
+                if( buddy & HOLE )
+                    continue;
+
+//              if (buddy & (blocking[i].b1)) continue;
+                // check second buddy
+                buddy = aGrid.GetCell( r + blocking[i].r2, c + blocking[i].c2, side );
+
+                if( buddy & CURRENT_PAD )
+                    buddy &= ~HOLE;
+
+                if( buddy & HOLE )
+                    continue;
+
+//              if (buddy & (blocking[i].b2)) continue;
+            }
+
+            olddir  = aGrid.GetDir( r, c, side );
+            newdist = d + aGrid.CalcDist( ndir[i], olddir,
+                                    ( olddir == FROM_OTHERSIDE ) ?
+                                    aGrid.GetDir( r, c, 1 - side ) : 0, side );
+
+            // if (a) not visited yet, or (b) we have
+            // found a better path, add it to queue
+            if( !aGrid.GetDir( nr, nc, side ) )
+            {
+                aGrid.SetDir( nr, nc, side, ndir[i] );
+                aGrid.SetDist( nr, nc, side, newdist );
+
+                if( aQueue.Set( nr, nc, side, newdist,
+                                aGrid.GetApxDist( nr, nc, row_target, col_target ),
+                                row_target, col_target ) == 0 )
+                {
+                    return ERR_MEMORY;
+                }
+            }
+            else if( newdist < aGrid.GetDist( nr, nc, side ) )
+            {
+                aGrid.SetDir( nr, nc, side, ndir[i] );
+                aGrid.SetDist( nr, nc, side, newdist );
+                aQueue.ReSet( nr, nc, side, newdist,
+                              aGrid.GetApxDist( nr, nc, row_target, col_target ),
+                              row_target, col_target );
+            }
+        }
+
+        //* Test the other layer. *
+        if( two_sides )
+        {
+            olddir = aGrid.GetDir( r, c, side );
+
+            if( olddir == FROM_OTHERSIDE )
+                continue;   // useless move, so don't bother
+
+            if( curcell )   // can't drill via if anything here
+                continue;
+
+            // check for holes or traces on other side
+            if( ( newcell = aGrid.GetCell( r, c, 1 - side ) ) != 0 )
+                continue;
+
+            // check for nearby holes or traces on both sides
+            for( skip = 0, i = 0; i < 8; i++ )
+            {
+                nr = r + delta[i][0]; nc = c + delta[i][1];
+
+                if( nr < 0 || nr >= aGrid.m_Nrows ||
+                    nc < 0 || nc >= aGrid.m_Ncols )
+                    continue;  // off the edge !!
+
+                if( aGrid.GetCell( nr, nc, side ) /* & blocking2[i] */ )
+                {
+                    skip = 1; // can't drill via here
+                    break;
+                }
+
+                if( aGrid.GetCell( nr, nc, 1 - side ) /* & blocking2[i] */ )
+                {
+                    skip = 1; // can't drill via here
+                    break;
+                }
+            }
+
+            if( skip )      // neighboring hole or trace?
+                continue;   // yes, can't drill via here
+
+            newdist = d + aGrid.CalcDist( FROM_OTHERSIDE, olddir, 0, side );
+
+            /*  if (a) not visited yet,
+             *  or (b) we have found a better path,
+             *  add it to queue */
+            if( !aGrid.GetDir( r, c, 1 - side ) )
+            {
+                aGrid.SetDir( r, c, 1 - side, FROM_OTHERSIDE );
+                aGrid.SetDist( r, c, 1 - side, newdist );
+
+                if( aQueue.Set( r, c, 1 - side, newdist, apx_dist, row_target, col_target ) == 0 )
+                {
+                    return ERR_MEMORY;
+                }
+            }
+            else if( newdist < aGrid.GetDist( r, c, 1 - side ) )
+            {
+                aGrid.SetDir( r, c, 1 - side, FROM_OTHERSIDE );
+                aGrid.SetDist( r, c, 1 - side, newdist );
+                aQueue.ReSet( r, c,
+                              1 - side,
+                              newdist,
+                              apx_dist,
+                              row_target,
+                              col_target );
+            }
+        }     // Finished attempt to route on other layer.
+    }
+
+    return NOSUCCESS;
+}
+
+
+/* Move (aRow, aCol, aSide) to the cell we came from, given its direction aDir.
+ * Returns false if aDir is not a direction.
+ */
+static bool stepBack( int aDir, int& aRow, int& aCol, int& aSide )
+{
+    switch( aDir )
+    {
+    case FROM_NORTH:
+        aRow++;
+        break;
+
+    case FROM_EAST:
+        aCol++;
+        break;
+
+    case FROM_SOUTH:
+        aRow--;
+        break;
+
+    case FROM_WEST:
+        aCol--;
+        break;
+
+    case FROM_NORTHEAST:
+        aRow++;
+        aCol++;
+        break;
+
+    case FROM_SOUTHEAST:
+        aRow--;
+        aCol++;
+        break;
+
+    case FROM_SOUTHWEST:
+        aRow--;
+        aCol--;
+        break;
+
+    case FROM_NORTHWEST:
+        aRow++;
+        aCol--;
+        break;
+
+    case FROM_OTHERSIDE:
+        aSide = 1 - aSide;
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+
+/* Store in aJob.m_Path the cells of the path found in its window, walking back from
+ * the target like Retrace() does.
+ * Returns false if the directions do not lead to the source.
+ */
+static bool getPath( ROUTE_JOB& aJob )
+{
+    ROUTING_WINDOW& window = aJob.m_Window;
+    int             r = aJob.m_RowTarget - window.m_Row0;
+    int             c = aJob.m_ColTarget - window.m_Col0;
+    int             s = aJob.m_TargetSide;
+    int             row_source = aJob.m_RowSource - window.m_Row0;
+    int             col_source = aJob.m_ColSource - window.m_Col0;
+    unsigned        maxLength = window.m_Nrows * window.m_Ncols * MAX_ROUTING_LAYERS_COUNT;
+
+    aJob.m_Path.clear();
+
+    do
+    {
+        ROUTE_STEP step;
+
+        step.m_Row  = r + window.m_Row0;
+        step.m_Col  = c + window.m_Col0;
+        step.m_Side = s;
+        step.m_Dir  = window.GetDir( r, c, s );
+
+        if( !stepBack( step.m_Dir, r, c, s ) || aJob.m_Path.size() >= maxLength )
+            return false;
+
+        aJob.m_Path.push_back( step );
+    } while( !( ( r == row_source ) && ( c == col_source ) ) );
+
+    return true;
+}
+
+
+/* Return true if a cell read to find the path of aJob, a path cell or one of its
+ * neighbours, has changed in RoutingMatrix since the window of aJob was copied.
+ */
+static bool hasConflict( const ROUTE_JOB& aJob )
+{
+    const ROUTING_WINDOW& window = aJob.m_Window;
+
+    for( unsigned ii = 0; ii <= aJob.m_Path.size(); ii++ )
+    {
+        // the source cell, which is not in m_Path, is tested last
+        int row = ii < aJob.m_Path.size() ? aJob.m_Path[ii].m_Row : aJob.m_RowSource;
+        int col = ii < aJob.m_Path.size() ? aJob.m_Path[ii].m_Col : aJob.m_ColSource;
+
+        for( int r = row - 1; r <= row + 1; r++ )
+        {
+            for( int c = col - 1; c <= col + 1; c++ )
+            {
+                if( r < window.m_Row0 || r >= window.m_Row0 + window.m_Nrows ||
+                    c < window.m_Col0 || c >= window.m_Col0 + window.m_Ncols )
+                    continue;
+
+                for( int side = 0; side < MAX_ROUTING_LAYERS_COUNT; side++ )
+                {
+                    if( RoutingMatrix.m_Cells[side] == NULL )
+                        continue;
+
+                    // CURRENT_PAD was set in the copy only
+                    MATRIX_CELL copied = window.GetCell( r - window.m_Row0,
+                                                         c - window.m_Col0, side );
+
+                    if( RoutingMatrix.GetCell( r, c, side ) != ( copied & ~CURRENT_PAD ) )
+                        return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/* Worker thread: search the paths of aJobs[aFirst], aJobs[aFirst + aStep] ... */
+static void searchJobs( std::vector<ROUTE_JOB*>* aJobs, int two_sides,
+                        unsigned aFirst, unsigned aStep )
+{
+    ROUTING_QUEUE queue;
+
+    for( unsigned ii = aFirst; ii < aJobs->size(); ii += aStep )
+    {
+        ROUTE_JOB&      job = *(*aJobs)[ii];
+        ROUTING_WINDOW& window = job.m_Window;
+
+        job.m_Result = findPath( window, queue, two_sides,
+                                 job.m_RowSource - window.m_Row0,
+                                 job.m_ColSource - window.m_Col0,
+                                 job.m_RowTarget - window.m_Row0,
+                                 job.m_ColTarget - window.m_Col0,
+                                 job.m_Ratsnest->m_PadStart->GetLayerSet(),
+                                 job.m_Ratsnest->m_PadEnd->GetLayerSet(),
+                                 NULL, &job.m_TargetSide );
+
+        if( job.m_Result == SUCCESS && !getPath( job ) )
+            job.m_Result = NOSUCCESS;
+    }
+}
+
+
+/* Route a connection on the whole routing matrix.
+ * Returns the result of Autoroute_One_Track(), the connection is flagged CH_UNROUTABLE
+ * if it cannot be routed.
+ */
+static int routeConnection( BOARD* aPcb, PCB_EDIT_FRAME* aFrame, wxDC* DC, int two_sides,
+                            const ROUTE_JOB& aJob )
+{
+    setCurrentConnection( aPcb, aJob.m_RowSource, aJob.m_ColSource,
+                          aJob.m_RowTarget, aJob.m_ColTarget, aJob.m_Ratsnest );
+
+    int result = Autoroute_One_Track( aPcb, aFrame, DC, two_sides,
+                                      aJob.m_RowSource, aJob.m_ColSource,
+                                      aJob.m_RowTarget, aJob.m_ColTarget, aJob.m_Ratsnest );
+
+    if( result == NOSUCCESS )
+        aJob.m_Ratsnest->m_Status |= CH_UNROUTABLE;
+
+    return result;
+}
+
+
+/* Route all the connections of the work list, concurrently (see above).
+ * aFrame, which reports the progress and can abort routing, can be NULL.
+ * Returns SUCCESS, STOP_FROM_ESC or ERR_MEMORY.
+ */
+static int routeConcurrently( BOARD* aPcb, PCB_EDIT_FRAME* aFrame, wxDC* DC, int two_sides,
+                              int* aRouted, int* aFailed )
+{
+    std::vector<ROUTE_JOB> jobs;
+    ROUTE_JOB              job;
+
+    // The work list, in its order: shortest connections first.
+    GetWork( &job.m_RowSource, &job.m_ColSource, &job.m_NetCode,
+             &job.m_RowTarget, &job.m_ColTarget, &job.m_Ratsnest );
+
+    for( ; job.m_RowSource != ILLEGAL; GetWork( &job.m_RowSource, &job.m_ColSource,
+                                                &job.m_NetCode, &job.m_RowTarget,
+                                                &job.m_ColTarget, &job.m_Ratsnest ) )
+    {
+        jobs.push_back( job );
+    }
+
+    BOARD_DESIGN_SETTINGS& settings = aPcb->GetDesignSettings();
+    int marge = s_Clearance + ( settings.GetCurrentTrackWidth() / 2 );
+
+    // Tracks and vias created from a path change the cells up to this distance from it
+    int spill = ( s_Clearance + std::max( settings.GetCurrentTrackWidth(),
+                                          settings.GetCurrentViaSize() ) / 2 )
+                / RoutingMatrix.m_GridRouting + 2;
+
+    unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+    unsigned maxBatch = threadCount * JOBS_PER_THREAD;
+
+    std::vector<ROUTE_JOB*> pending;
+    wxString                msg;
+
+    for( unsigned ii = 0; ii < jobs.size(); ii++ )
+        pending.push_back( &jobs[ii] );
+
+    while( pending.size() )
+    {
+        if( aFrame )
+        {
+            // Test to stop routing ( escape key pressed )
+            wxYield();
+
+            if( aFrame->GetCanvas()->GetAbortRequest() )
+            {
+                if( IsOK( aFrame, _( "Abort routing?" ) ) )
+                    return STOP_FROM_ESC;
+
+                aFrame->GetCanvas()->SetAbortRequest( false );
+            }
+
+            aFrame->EraseMsgBox();
+            msg.Printf( wxT( "%d / %d" ), (int) ( jobs.size() - pending.size() ),
+                        (int) jobs.size() );
+            aFrame->AppendMsgPanel( wxT( "Activity" ), msg, BROWN );
+            msg.Printf( wxT( "%d" ), *aRouted );
+            aFrame->AppendMsgPanel( wxT( "OK" ), msg, GREEN );
+            msg.Printf( wxT( "%d" ), *aFailed );
+            aFrame->AppendMsgPanel( wxT( "Fail" ), msg, RED );
+        }
+
+        // Choose the batch of connections searched at the same time: the first pending
+        // connections whose window, and the cells their tracks can change, do not overlap
+        // the ones of a connection before them.
+        std::vector<ROUTE_JOB*> batch;
+        std::vector<ROUTE_JOB*> later;
+        std::vector<EDA_RECT>   used;
+
+        for( unsigned ii = 0; ii < pending.size(); ii++ )
+        {
+            ROUTE_JOB* current = pending[ii];
+
+            if( batch.size() >= maxBatch )
+            {
+                later.push_back( current );
+                continue;
+            }
+
+            int result = checkEndPoints( aPcb, current->m_RowSource, current->m_ColSource,
+                                         current->m_RowTarget, current->m_ColTarget,
+                                         current->m_Ratsnest );
+
+            if( result == NOSUCCESS )
+            {
+                current->m_Ratsnest->m_Status |= CH_UNROUTABLE;
+                (*aFailed)++;
+                continue;
+            }
+
+            if( result == TRIVIAL_SUCCESS )
+            {
+                (*aRouted)++;
+                continue;
+            }
+
+            int rowMin = std::min( current->m_RowSource, current->m_RowTarget );
+            int rowMax = std::max( current->m_RowSource, current->m_RowTarget );
+            int colMin = std::min( current->m_ColSource, current->m_ColTarget );
+            int colMax = std::max( current->m_ColSource, current->m_ColTarget );
+            int margin = std::max( WINDOW_MARGIN, ( rowMax - rowMin + colMax - colMin ) / 4 );
+
+            rowMin = std::max( 0, rowMin - margin );
+            colMin = std::max( 0, colMin - margin );
+            rowMax = std::min( RoutingMatrix.m_Nrows - 1, rowMax + margin );
+            colMax = std::min( RoutingMatrix.m_Ncols - 1, colMax + margin );
+
+            current->m_Area = EDA_RECT( wxPoint( colMin, rowMin ),
+                                        wxSize( colMax - colMin + 1, rowMax - rowMin + 1 ) );
+
+            // The tracks also go to the pad centers
+            EDA_RECT guard = current->m_Area;
+            D_PAD*   pads[2] = { current->m_Ratsnest->m_PadStart,
+                                 current->m_Ratsnest->m_PadEnd };
+
+            for( int jj = 0; jj < 2; jj++ )
+            {
+                EDA_RECT padArea = pads[jj]->GetBoundingBox();
+                wxPoint  origin = padArea.GetOrigin() - RoutingMatrix.GetBrdCoordOrigin();
+
+                guard.Merge( EDA_RECT( wxPoint( origin.x / RoutingMatrix.m_GridRouting,
+                                                origin.y / RoutingMatrix.m_GridRouting ),
+                                       wxSize( padArea.GetWidth() / RoutingMatrix.m_GridRouting + 1,
+                                               padArea.GetHeight() / RoutingMatrix.m_GridRouting + 1 ) ) );
+            }
+
+            guard.Inflate( spill );
+
+            bool overlap = false;
+
+            for( unsigned jj = 0; jj < used.size() && !overlap; jj++ )
+                overlap = used[jj].Intersects( guard );
+
+            // A connection overlapping a connection left for a next batch is left too,
+            // so overlapping connections are routed in the work list order.
+            used.push_back( guard );
+
+            if( overlap )
+                later.push_back( current );
+            else
+                batch.push_back( current );
+        }
+
+        pending.swap( later );
+
+        if( batch.empty() )
+            continue;
+
+        if( batch.size() == 1 )
+        {
+            // Nothing to do at the same time: use the whole matrix.
+            int result = routeConnection( aPcb, aFrame, DC, two_sides, *batch[0] );
+
+            if( result == STOP_FROM_ESC || result == ERR_MEMORY )
+                return result;
+
+            if( result == NOSUCCESS )
+                (*aFailed)++;
+            else
+                (*aRouted)++;
+
+            continue;
+        }
+
+        // The routing matrix is not thread safe: copy the windows first.
+        for( unsigned ii = 0; ii < batch.size(); ii++ )
+        {
+            ROUTE_JOB* current = batch[ii];
+
+            markConnectionPads( aPcb, current->m_Ratsnest, marge );
+            current->m_Window.Copy( current->m_Area.GetY(), current->m_Area.GetX(),
+                                    current->m_Area.GetHeight(), current->m_Area.GetWidth() );
+            unmarkConnectionPads( current->m_Ratsnest, marge );
+        }
+
+        unsigned batchThreads = std::min( threadCount, (unsigned) batch.size() );
+
+        // Something which will not invoke a thread copy constructor
+        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+        MYTHREADS threads;
+
+        for( unsigned ii = 1; ii < batchThreads; ii++ )
+            threads.push_back( new boost::thread( &searchJobs, &batch, two_sides,
+                                                  ii, batchThreads ) );
+
+        searchJobs( &batch, two_sides, 0, batchThreads );
+
+        for( unsigned ii = 0; ii < threads.size(); ++ii )
+            threads[ii].join();
+
+        // Create the tracks in the work list order.  A connection not routed inside its
+        // window, or whose path is no longer free, is routed again on the whole matrix.
+        std::vector<ROUTE_JOB*> retry;
+        bool                    noMemory = false;
+
+        for( unsigned ii = 0; ii < batch.size(); ii++ )
+        {
+            ROUTE_JOB* current = batch[ii];
+
+            if( current->m_Result == ERR_MEMORY )
+                noMemory = true;
+            else if( current->m_Result != SUCCESS || hasConflict( *current ) )
+                retry.push_back( current );
+            else
+            {
+                for( unsigned jj = 0; jj < current->m_Path.size(); jj++ )
+                {
+                    const ROUTE_STEP& step = current->m_Path[jj];
+
+                    RoutingMatrix.SetDir( step.m_Row, step.m_Col, step.m_Side, step.m_Dir );
+                }
+
+                setCurrentConnection( aPcb, current->m_RowSource, current->m_ColSource,
+                                      current->m_RowTarget, current->m_ColTarget,
+                                      current->m_Ratsnest );
+
+                if( Retrace( aPcb, aFrame, DC, current->m_RowSource, current->m_ColSource,
+                             current->m_RowTarget, current->m_ColTarget,
+                             current->m_TargetSide, current->m_NetCode ) )
+                {
+                    (*aRouted)++;
+                }
+                else
+                {
+                    current->m_Ratsnest->m_Status |= CH_UNROUTABLE;
+                    (*aFailed)++;
+                }
+            }
+
+            current->m_Window.Free();
+            std::vector<ROUTE_STEP>().swap( current->m_Path );
+        }
+
+        if( noMemory )
+            return ERR_MEMORY;
+
+        for( unsigned ii = 0; ii < retry.size(); ii++ )
+        {
+            int result = routeConnection( aPcb, aFrame, DC, two_sides, *retry[ii] );
+
+            if( result == STOP_FROM_ESC || result == ERR_MEMORY )
+                return result;
+
+            if( result == NOSUCCESS )
+                (*aFailed)++;
+            else
+                (*aRouted)++;
+        }
+    }
+
+    return SUCCESS;
+}
+
+
+/* Route all traces
+ * :
+ *  1 if OK
+ * -1 if escape (stop being routed) request
+ * -2 if default memory allocation
+ */
+int PCB_EDIT_FRAME::Solve( wxDC* DC, int aLayersCount, bool aConcurrent )
+{
+    int           current_net_code;
+    int           row_source, col_source, row_target, col_target;
+    int           success, nbsucces = 0, nbunsucces = 0;
+    NETINFO_ITEM* net;
+    bool          stop = false;
+    wxString      msg;
+    int           routedCount = 0;      // routed ratsnest count
+    bool          two_sides = aLayersCount == 2;
+    wxBusyCursor  dummy_cursor;         // Set an hourglass cursor while routing
+
+    m_canvas->SetAbortRequest( false );
+
+    s_Clearance = GetBoard()->GetDesignSettings().GetDefault()->GetClearance();
+
+    // Prepare the undo command info
+    s_ItemsListPicker.ClearListAndDeleteItems();  // Should not be necessary, but...
+
+    if( aConcurrent )
+    {
+        routeConcurrently( GetBoard(), this, DC, two_sides, &nbsucces, &nbunsucces );
+
+        msg.Printf( wxT( "%d" ), nbsucces );
+        AppendMsgPanel( wxT( "OK" ), msg, GREEN );
+        msg.Printf( wxT( "%d" ), nbunsucces );
+        AppendMsgPanel( wxT( "Fail" ), msg, RED );
+        msg.Printf( wxT( "  %d" ), GetBoard()->GetUnconnectedNetCount() );
+        AppendMsgPanel( wxT( "Not Connected" ), msg, CYAN );
+
+        SaveCopyInUndoList( s_ItemsListPicker, UR_UNSPECIFIED );
+        s_ItemsListPicker.ClearItemsList(); // s_ItemsListPicker is no more owner of picked items
+
+        return SUCCESS;
+    }
+
+    // go until no more work to do
+    GetWork( &row_source, &col_source, &current_net_code,
+             &row_target, &col_target, &pt_cur_ch ); // First net to route.
 
-    for( ; r != ILLEGAL; GetQueue( &r, &c, &side, &d, &apx_dist ) )
+    for( ; row_source != ILLEGAL; GetWork( &row_source, &col_source,
+                                           &current_net_code, &row_target,
+                                           &col_target,
+                                           &pt_cur_ch ) )
     {
-        curcell = RoutingMatrix.GetCell( r, c, side );
-
-        if( curcell & CURRENT_PAD )
-            curcell &= ~HOLE;
+        // Test to stop routing ( escape key pressed )
+        wxYield();
 
-        if( (r == row_target) && (c == col_target)  // success if layer OK
-           && (tab_mask[side] & padLayerMaskEnd).any() )
+        if( m_canvas->GetAbortRequest() )
         {
-            // Remove link.
-            GRSetDrawMode( DC, GR_XOR );
-            GRLine( pcbframe->GetCanvas()->GetClipBox(),
-                    DC,
-                    segm_oX,
-                    segm_oY,
-                    segm_fX,
-                    segm_fY,
-                    0,
-                    WHITE );
-
-            // Generate trace.
-            if( Retrace( pcbframe, DC, row_source, col_source,
-                         row_target, col_target, side, current_net_code ) )
+            if( IsOK( this, _( "Abort routing?" ) ) )
             {
-                result = SUCCESS;   // Success : Route OK
+                success = STOP_FROM_ESC;
+                stop    = true;
+                break;
+            }
+            else
+            {
+                m_canvas->SetAbortRequest( false );
             }
-
-            break;                  // Routing complete.
         }
 
-        if( pcbframe->GetCanvas()->GetAbortRequest() )
-        {
-            result = STOP_FROM_ESC;
-            break;
-        }
+        EraseMsgBox();
 
-        // report every COUNT new nodes or so
-        #define COUNT 20000
+        routedCount++;
+        net = GetBoard()->FindNet( current_net_code );
 
-        if( ( OpenNodes - lastopen > COUNT )
-           || ( ClosNodes - lastclos > COUNT )
-           || ( MoveNodes - lastmove > COUNT ) )
+        if( net )
         {
-            lastopen = OpenNodes;
-            lastclos = ClosNodes;
-            lastmove = MoveNodes;
-            msg.Printf( wxT( "Activity: Open %d   Closed %d   Moved %d" ),
-                        OpenNodes, ClosNodes, MoveNodes );
-            pcbframe->SetStatusText( msg );
+            msg.Printf( wxT( "[%8.8s]" ), GetChars( net->GetNetname() ) );
+            AppendMsgPanel( wxT( "Net route" ), msg, BROWN );
+            msg.Printf( wxT( "%d / %d" ), routedCount, RoutingMatrix.m_RouteCount );
+            AppendMsgPanel( wxT( "Activity" ), msg, BROWN );
         }
 
-        _self = 0;
-
-        if( curcell & HOLE )
-        {
-            _self = 5;
+        setCurrentConnection( GetBoard(), row_source, col_source,
+                              row_target, col_target, pt_cur_ch );
 
-            // set 'present' bits
-            for( i = 0; i < 8; i++ )
-            {
-                selfok2[i].present = 0;
+        // Draw segment.
+        GRLine( m_canvas->GetClipBox(), DC,
+                segm_oX, segm_oY, segm_fX, segm_fY,
+                0, WHITE );
+        pt_cur_ch->m_PadStart->Draw( m_canvas, DC, GR_OR | GR_HIGHLIGHT );
+        pt_cur_ch->m_PadEnd->Draw( m_canvas, DC, GR_OR | GR_HIGHLIGHT );
 
-                if( curcell & selfok2[i].trace )
-                    selfok2[i].present = 1;
-            }
-        }
+        success = Autoroute_One_Track( GetBoard(), this, DC,
+                                       two_sides, row_source, col_source,
+                                       row_target, col_target, pt_cur_ch );
 
-        for( i = 0; i < 8; i++ ) // consider neighbors
+        switch( success )
         {
-            nr = r + delta[i][0];
-            nc = c + delta[i][1];
+        case NOSUCCESS:
+            pt_cur_ch->m_Status |= CH_UNROUTABLE;
+            nbunsucces++;
+            break;
 
-            // off the edge?
-            if( nr < 0 || nr >= RoutingMatrix.m_Nrows ||
-                nc < 0 || nc >= RoutingMatrix.m_Ncols )
-                continue;  // off the edge
+        case STOP_FROM_ESC:
+            stop = true;
+            break;
 
-            if( _self == 5 && selfok2[i].present )
-                continue;
+        case ERR_MEMORY:
+            stop = true;
+            break;
 
-            newcell = RoutingMatrix.GetCell( nr, nc, side );
+        default:
+            nbsucces++;
+            break;
+        }
 
-            if( newcell & CURRENT_PAD )
-                newcell &= ~HOLE;
+        msg.Printf( wxT( "%d" ), nbsucces );
+        AppendMsgPanel( wxT( "OK" ), msg, GREEN );
+        msg.Printf( wxT( "%d" ), nbunsucces );
+        AppendMsgPanel( wxT( "Fail" ), msg, RED );
+        msg.Printf( wxT( "  %d" ), GetBoard()->GetUnconnectedNetCount() );
+        AppendMsgPanel( wxT( "Not Connected" ), msg, CYAN );
 
-            // check for non-target hole
-            if( newcell & HOLE )
-            {
-                if( nr != row_target || nc != col_target )
-                    continue;
-            }
-            // check for traces
-            else if( newcell & HOLE & ~(newmask[i]) )
-            {
-                continue;
-            }
+        // Delete routing from display.
+        pt_cur_ch->m_PadStart->Draw( m_canvas, DC, GR_AND );
+        pt_cur_ch->m_PadEnd->Draw( m_canvas, DC, GR_AND );
 
-            // check blocking on corner neighbors
-            if( delta[i][0] && delta[i][1] )
-            {
-                // check first buddy
-                buddy = RoutingMatrix.GetCell( r + blocking[i].r1, c + blocking[i].c1, side );
+        if( stop )
+            break;
+    }
 
-                if( buddy & CURRENT_PAD )
-                    buddy &= ~HOLE;
+    SaveCopyInUndoList( s_ItemsListPicker, UR_UNSPECIFIED );
+    s_ItemsListPicker.ClearItemsList(); // s_ItemsListPicker is no more owner of picked items
 
-                if( buddy & HOLE )
-                    continue;
+    return SUCCESS;
+}
 
-//              if (buddy & (blocking[i].b1)) continue;
-                // check second buddy
-                buddy = RoutingMatrix.GetCell( r + blocking[i].r2, c + blocking[i].c2, side );
 
-                if( buddy & CURRENT_PAD )
-                    buddy &= ~HOLE;
+int AutorouteWorkList( BOARD* aPcb, int aLayersCount, bool aConcurrent )
+{
+    int  routed = 0, failed = 0;
+    int  two_sides = aLayersCount == 2;
 
-                if( buddy & HOLE )
-                    continue;
+    s_Clearance = aPcb->GetDesignSettings().GetDefault()->GetClearance();
+    s_ItemsListPicker.ClearListAndDeleteItems();
 
-//              if (buddy & (blocking[i].b2)) continue;
-            }
+    if( aConcurrent )
+    {
+        routeConcurrently( aPcb, NULL, NULL, two_sides, &routed, &failed );
+    }
+    else
+    {
+        ROUTE_JOB job;
 
-            olddir  = RoutingMatrix.GetDir( r, c, side );
-            newdist = d + RoutingMatrix.CalcDist( ndir[i], olddir,
-                                    ( olddir == FROM_OTHERSIDE ) ?
-                                    RoutingMatrix.GetDir( r, c, 1 - side ) : 0, side );
+        GetWork( &job.m_RowSource, &job.m_ColSource, &job.m_NetCode,
+                 &job.m_RowTarget, &job.m_ColTarget, &job.m_Ratsnest );
 
-            // if (a) not visited yet, or (b) we have
-            // found a better path, add it to queue
-            if( !RoutingMatrix.GetDir( nr, nc, side ) )
-            {
-                RoutingMatrix.SetDir( nr, nc, side, ndir[i] );
-                RoutingMatrix.SetDist( nr, nc, side, newdist );
+        for( ; job.m_RowSource != ILLEGAL; GetWork( &job.m_RowSource, &job.m_ColSource,
+                                                    &job.m_NetCode, &job.m_RowTarget,
+                                                    &job.m_ColTarget, &job.m_Ratsnest ) )
+        {
+            int result = routeConnection( aPcb, NULL, NULL, two_sides, job );
 
-                if( SetQueue( nr, nc, side, newdist,
-                              RoutingMatrix.GetApxDist( nr, nc, row_target, col_target ),
-                              row_target, col_target ) == 0 )
-                {
-                    return ERR_MEMORY;
-                }
-            }
-            else if( newdist < RoutingMatrix.GetDist( nr, nc, side ) )
-            {
-                RoutingMatrix.SetDir( nr, nc, side, ndir[i] );
-                RoutingMatrix.SetDist( nr, nc, side, newdist );
-                ReSetQueue( nr, nc, side, newdist,
-                            RoutingMatrix.GetApxDist( nr, nc, row_target, col_target ),
-                            row_target, col_target );
-            }
+            if( result == ERR_MEMORY )
+                break;
+
+            if( result == NOSUCCESS )
+                failed++;
+            else
+                routed++;
         }
+    }
 
-        //* Test the other layer. *
-        if( two_sides )
-        {
-            olddir = RoutingMatrix.GetDir( r, c, side );
+    // The new tracks are owned by aPcb, there is no undo list to give them to.
+    s_ItemsListPicker.ClearItemsList();
 
-            if( olddir == FROM_OTHERSIDE )
-                continue;   // useless move, so don't bother
+    return routed;
+}
 
-            if( curcell )   // can't drill via if anything here
-                continue;
 
-            // check for holes or traces on other side
-            if( ( newcell = RoutingMatrix.GetCell( r, c, 1 - side ) ) != 0 )
-                continue;
+/* Route a trace on the BOARD.
+ * Parameters:
+ * 1 side / 2 sides (0 / 1)
+ * Coord source (row, col)
+ * Coord destination (row, col)
+ * Net_code
+ * Pointer to the ratsnest reference
+ * pcbframe, used to display the routing, can be NULL
+ *
+ * Returns:
+ * SUCCESS if routed
+ * TRIVIAL_SUCCESS if pads are connected by overlay (no track needed)
+ * If failure NOSUCCESS
+ * Escape STOP_FROM_ESC if demand
+ * ERR_MEMORY if memory allocation failed.
+ */
+static int Autoroute_One_Track( BOARD*          aPcb,
+                                PCB_EDIT_FRAME* pcbframe,
+                                wxDC*           DC,
+                                int             two_sides,
+                                int             row_source,
+                                int             col_source,
+                                int             row_target,
+                                int             col_target,
+                                RATSNEST_ITEM*  pt_rat )
+{
+    int          result, side;
+    int          marge;
+    wxString     msg;
 
-            // check for nearby holes or traces on both sides
-            for( skip = 0, i = 0; i < 8; i++ )
-            {
-                nr = r + delta[i][0]; nc = c + delta[i][1];
+    marge = s_Clearance + ( aPcb->GetDesignSettings().GetCurrentTrackWidth() / 2 );
 
-                if( nr < 0 || nr >= RoutingMatrix.m_Nrows ||
-                    nc < 0 || nc >= RoutingMatrix.m_Ncols )
-                    continue;  // off the edge !!
+    pt_cur_ch = pt_rat;
 
-                if( RoutingMatrix.GetCell( nr, nc, side ) /* & blocking2[i] */ )
-                {
-                    skip = 1; // can't drill via here
-                    break;
-                }
+    result = checkEndPoints( aPcb, row_source, col_source, row_target, col_target, pt_rat );
 
-                if( RoutingMatrix.GetCell( nr, nc, 1 - side ) /* & blocking2[i] */ )
-                {
-                    skip = 1; // can't drill via here
-                    break;
-                }
-            }
+    if( result != SUCCESS )
+        return result;
 
-            if( skip )      // neighboring hole or trace?
-                continue;   // yes, can't drill via here
+    // Placing the bit to remove obstacles on 2 pads to a link.
+    if( pcbframe )
+        pcbframe->SetStatusText( wxT( "Gen Cells" ) );
 
-            newdist = d + RoutingMatrix.CalcDist( FROM_OTHERSIDE, olddir, 0, side );
+    markConnectionPads( aPcb, pt_rat, marge );
 
-            /*  if (a) not visited yet,
-             *  or (b) we have found a better path,
-             *  add it to queue */
-            if( !RoutingMatrix.GetDir( r, c, 1 - side ) )
-            {
-                RoutingMatrix.SetDir( r, c, 1 - side, FROM_OTHERSIDE );
-                RoutingMatrix.SetDist( r, c, 1 - side, newdist );
+    // clear direction flags
+    if( two_sides )
+        RoutingMatrix.SetAllDirs( TOP, FROM_NOWHERE );
+    RoutingMatrix.SetAllDirs( BOTTOM, FROM_NOWHERE );
 
-                if( SetQueue( r, c, 1 - side, newdist, apx_dist, row_target, col_target ) == 0 )
-                {
-                    return ERR_MEMORY;
-                }
-            }
-            else if( newdist < RoutingMatrix.GetDist( r, c, 1 - side ) )
-            {
-                RoutingMatrix.SetDir( r, c, 1 - side, FROM_OTHERSIDE );
-                RoutingMatrix.SetDist( r, c, 1 - side, newdist );
-                ReSetQueue( r, c,
-                            1 - side,
-                            newdist,
-                            apx_dist,
-                            row_target,
-                            col_target );
-            }
-        }     // Finished attempt to route on other layer.
+    result = findPath( RoutingMatrix, RoutingQueue, two_sides,
+                       row_source, col_source, row_target, col_target,
+                       pt_rat->m_PadStart->GetLayerSet(), pt_rat->m_PadEnd->GetLayerSet(),
+                       pcbframe, &side );
+
+    if( result == SUCCESS )
+    {
+        if( pcbframe )
+        {
+            // Remove link.
+            GRSetDrawMode( DC, GR_XOR );
+            GRLine( pcbframe->GetCanvas()->GetClipBox(),
+                    DC,
+                    segm_oX,
+                    segm_oY,
+                    segm_fX,
+                    segm_fY,
+                    0,
+                    WHITE );
+        }
+
+        // Generate trace.
+        if( !Retrace( aPcb, pcbframe, DC, row_source, col_source,
+                      row_target, col_target, side, pt_rat->GetNet() ) )
+        {
+            result = NOSUCCESS;
+        }
     }
 
-end_of_route:
-    PlacePad( pt_cur_ch->m_PadStart, ~CURRENT_PAD, marge, WRITE_AND_CELL );
-    PlacePad( pt_cur_ch->m_PadEnd, ~CURRENT_PAD, marge, WRITE_AND_CELL );
+    unmarkConnectionPads( pt_rat, marge );
 
-    msg.Printf( wxT( "Activity: Open %d   Closed %d   Moved %d"),
-                OpenNodes, ClosNodes, MoveNodes );
-    pcbframe->SetStatusText( msg );
+    if( pcbframe )
+    {
+        msg.Printf( wxT( "Activity: Open %d   Closed %d   Moved %d"),
+                    RoutingQueue.m_OpenNodes, RoutingQueue.m_ClosNodes,
+                    RoutingQueue.m_MoveNodes );
+        pcbframe->SetStatusText( msg );
+    }
 
     return result;
 }
@@ -951,7 +1640,7 @@ static long bit[8][9] =
  * 0 if error
  * > 0 if Ok
  */
-static int Retrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC,
+static int Retrace( BOARD* aPcb, PCB_EDIT_FRAME* pcbframe, wxDC* DC,
                     int row_source, int col_source,
                     int row_target, int col_target, int target_side,
                     int current_net_code )
@@ -975,49 +1664,8 @@ static int Retrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC,
         r2 = r1; c2 = c1; s2 = s1;
         x  = RoutingMatrix.GetDir( r1, c1, s1 );
 
-        switch( x )
+        if( !stepBack( x, r2, c2, s2 ) )
         {
-        case FROM_NORTH:
-            r2++;
-            break;
-
-        case FROM_EAST:
-            c2++;
-            break;
-
-        case FROM_SOUTH:
-            r2--;
-            break;
-
-        case FROM_WEST:
-            c2--;
-            break;
-
-        case FROM_NORTHEAST:
-            r2++;
-            c2++;
-            break;
-
-        case FROM_SOUTHEAST:
-            r2--;
-            c2++;
-            break;
-
-        case FROM_SOUTHWEST:
-            r2--;
-            c2--;
-            break;
-
-        case FROM_NORTHWEST:
-            r2++;
-            c2--;
-            break;
-
-        case FROM_OTHERSIDE:
-            s2 = 1 - s2;
-            break;
-
-        default:
             wxMessageBox( wxT( "Retrace: internal error: no way back" ) );
             return 0;
         }
@@ -1070,7 +1718,7 @@ static int Retrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC,
                 return 0;
             }
 
-            OrCell_Trace( pcbframe->GetBoard(), r1, c1, s1, p_dir, current_net_code );
+            OrCell_Trace( aPcb, r1, c1, s1, p_dir, current_net_code );
         }
         else
         {
@@ -1085,10 +1733,10 @@ static int Retrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC,
                     || x == FROM_OTHERSIDE )
                && ( ( b = bit[y - 1][x - 1] ) != 0 ) )
             {
-                OrCell_Trace( pcbframe->GetBoard(), r1, c1, s1, b, current_net_code );
+                OrCell_Trace( aPcb, r1, c1, s1, b, current_net_code );
 
                 if( b & HOLE )
-                    OrCell_Trace( pcbframe->GetBoard(), r2, c2, s2, HOLE, current_net_code );
+                    OrCell_Trace( aPcb, r2, c2, s2, HOLE, current_net_code );
             }
             else
             {
@@ -1141,7 +1789,7 @@ static int Retrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC,
                 return 0;
             }
 
-            OrCell_Trace( pcbframe->GetBoard(), r2, c2, s2, p_dir, current_net_code );
+            OrCell_Trace( aPcb, r2, c2, s2, p_dir, current_net_code );
         }
 
         // move to next cell
@@ -1153,7 +1801,7 @@ static int Retrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC,
         s1 = s2;
     } while( !( ( r2 == row_source ) && ( c2 == col_source ) ) );
 
-    AddNewTrace( pcbframe, DC );
+    AddNewTrace( aPcb, pcbframe, DC );
     return 1;
 }
 
@@ -1270,18 +1918,16 @@ static void OrCell_Trace( BOARD* pcb, int col, int row,
  * connected
  * Center on pads even if they are off grid.
  */
-static void AddNewTrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC )
+static void AddNewTrace( BOARD* aPcb, PCB_EDIT_FRAME* pcbframe, wxDC* DC )
 {
     if( g_FirstTrackSegment == NULL )
         return;
 
     int dx0, dy0, dx1, dy1;
     int marge, via_marge;
-    EDA_DRAW_PANEL* panel = pcbframe->GetCanvas();
-    PCB_SCREEN* screen = pcbframe->GetScreen();
 
-    marge = s_Clearance + ( pcbframe->GetDesignSettings().GetCurrentTrackWidth() / 2 );
-    via_marge = s_Clearance + ( pcbframe->GetDesignSettings().GetCurrentViaSize() / 2 );
+    marge = s_Clearance + ( aPcb->GetDesignSettings().GetCurrentTrackWidth() / 2 );
+    via_marge = s_Clearance + ( aPcb->GetDesignSettings().GetCurrentViaSize() / 2 );
 
     dx1 = g_CurrentTrackSegment->GetEnd().x - g_CurrentTrackSegment->GetStart().x;
     dy1 = g_CurrentTrackSegment->GetEnd().y - g_CurrentTrackSegment->GetStart().y;
@@ -1305,13 +1951,13 @@ static void AddNewTrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC )
         g_CurrentTrackList.PushBack( newTrack );
     }
 
-    g_FirstTrackSegment->start = pcbframe->GetBoard()->GetPad( g_FirstTrackSegment,
+    g_FirstTrackSegment->start = aPcb->GetPad( g_FirstTrackSegment,
             ENDPOINT_START );
 
     if( g_FirstTrackSegment->start )
         g_FirstTrackSegment->SetState( BEGIN_ONPAD, true );
 
-    g_CurrentTrackSegment->end = pcbframe->GetBoard()->GetPad( g_CurrentTrackSegment,
+    g_CurrentTrackSegment->end = aPcb->GetPad( g_CurrentTrackSegment,
             ENDPOINT_END );
 
     if( g_CurrentTrackSegment->end )
@@ -1331,18 +1977,21 @@ static void AddNewTrace( PCB_EDIT_FRAME* pcbframe, wxDC* DC )
 
     // Put entire new current segment list in BOARD
     TRACK* track;
-    TRACK* insertBeforeMe = g_CurrentTrackSegment->GetBestInsertPoint( pcbframe->GetBoard() );
+    TRACK* insertBeforeMe = g_CurrentTrackSegment->GetBestInsertPoint( aPcb );
 
     while( ( track = g_CurrentTrackList.PopFront() ) != NULL )
     {
         ITEM_PICKER picker( track, UR_NEW );
         s_ItemsListPicker.PushItem( picker );
-        pcbframe->GetBoard()->m_Track.Insert( track, insertBeforeMe );
+        aPcb->m_Track.Insert( track, insertBeforeMe );
     }
 
-    DrawTraces( panel, DC, firstTrack, newCount, GR_OR );
+    if( pcbframe )
+    {
+        DrawTraces( pcbframe->GetCanvas(), DC, firstTrack, newCount, GR_OR );
 
-    pcbframe->TestNetConnection( DC, netcode );
+        pcbframe->TestNetConnection( DC, netcode );
 
-    screen->SetModify();
+        pcbframe->GetScreen()->SetModify();
+    }
 }
@@ -790,6 +790,10 @@ void PCB_BASE_FRAME::OnModify()
     GetScreen()->SetModify();
     GetScreen()->SetSave();
 
+    // Edit commands and undo/redo can change module references
+    // without MODULE::SetReference()
+    GetBoard()->InvalidateModuleIndex();
+
     if( IsGalCanvasActive() )
     {
         UpdateStatusBar();
@@ -48,18 +48,26 @@
 #include <convert_basic_shapes_to_polygon.h>
 
 // These variables are parameters used in addTextSegmToPoly.
-// But addTextSegmToPoly is a call-back function,
-// so we cannot send them as arguments.
-static int s_textWidth;
-static int s_textCircle2SegmentCount;
-static SHAPE_POLY_SET* s_cornerBuffer;
+// addTextSegmToPoly is a call-back function, which receives them through
+// the callback data of DrawGraphicText (they cannot be static: the board layers
+// can be converted by several threads at once).
+struct TSEGM_2_POLY_PRMS
+{
+    int             m_textWidth;
+    int             m_textCircle2SegmentCount;
+    SHAPE_POLY_SET* m_cornerBuffer;
+};
 
 // This is a call back function, used by DrawGraphicText to draw the 3D text shape:
-static void addTextSegmToPoly( int x0, int y0, int xf, int yf )
+// aData is a TSEGM_2_POLY_PRMS
+static void addTextSegmToPoly( int x0, int y0, int xf, int yf, void* aData )
 {
-    TransformRoundedEndsSegmentToPolygon( *s_cornerBuffer,
+    TSEGM_2_POLY_PRMS* prms = (TSEGM_2_POLY_PRMS*) aData;
+
+    TransformRoundedEndsSegmentToPolygon( *prms->m_cornerBuffer,
                                            wxPoint( x0, y0), wxPoint( xf, yf ),
-                                           s_textCircle2SegmentCount, s_textWidth );
+                                           prms->m_textCircle2SegmentCount,
+                                           prms->m_textWidth );
 }
 
 
@@ -248,18 +256,20 @@ void MODULE::TransformGraphicShapesWithClearanceToPolygonSet(
     if( Value().GetLayer() == aLayer && Value().IsVisible() )
         texts.push_back( &Value() );
 
-    s_cornerBuffer = &aCornerBuffer;
+    TSEGM_2_POLY_PRMS prms;
+
+    prms.m_cornerBuffer = &aCornerBuffer;
 
     // To allow optimization of circles approximated by segments,
     // aCircleToSegmentsCountForTexts, when not 0, is used.
     // if 0 (default value) the aCircleToSegmentsCount is used
-    s_textCircle2SegmentCount = aCircleToSegmentsCountForTexts ?
-                                aCircleToSegmentsCountForTexts : aCircleToSegmentsCount;
+    prms.m_textCircle2SegmentCount = aCircleToSegmentsCountForTexts ?
+                                     aCircleToSegmentsCountForTexts : aCircleToSegmentsCount;
 
     for( unsigned ii = 0; ii < texts.size(); ii++ )
     {
         TEXTE_MODULE *textmod = texts[ii];
-        s_textWidth  = textmod->GetThickness() + ( 2 * aInflateValue );
+        prms.m_textWidth = textmod->GetThickness() + ( 2 * aInflateValue );
         wxSize size = textmod->GetSize();
 
         if( textmod->IsMirrored() )
@@ -269,7 +279,7 @@ void MODULE::TransformGraphicShapesWithClearanceToPolygonSet(
                          textmod->GetShownText(), textmod->GetDrawRotation(), size,
                          textmod->GetHorizJustify(), textmod->GetVertJustify(),
                          textmod->GetThickness(), textmod->IsItalic(),
-                         true, addTextSegmToPoly );
+                         true, addTextSegmToPoly, NULL, &prms );
     }
 
 }
@@ -374,9 +384,11 @@ void TEXTE_PCB::TransformShapeWithClearanceToPolygonSet(
     if( IsMirrored() )
         size.x = -size.x;
 
-    s_cornerBuffer = &aCornerBuffer;
-    s_textWidth  = GetThickness() + ( 2 * aClearanceValue );
-    s_textCircle2SegmentCount = aCircleToSegmentsCount;
+    TSEGM_2_POLY_PRMS prms;
+
+    prms.m_cornerBuffer = &aCornerBuffer;
+    prms.m_textWidth = GetThickness() + ( 2 * aClearanceValue );
+    prms.m_textCircle2SegmentCount = aCircleToSegmentsCount;
     EDA_COLOR_T color = BLACK;  // not actually used, but needed by DrawGraphicText
 
     if( IsMultilineAllowed() )
@@ -394,7 +406,7 @@ void TEXTE_PCB::TransformShapeWithClearanceToPolygonSet(
                              txt, GetOrientation(), size,
                              GetHorizJustify(), GetVertJustify(),
                              GetThickness(), IsItalic(),
-                             true, addTextSegmToPoly );
+                             true, addTextSegmToPoly, NULL, &prms );
         }
     }
     else
@@ -403,7 +415,7 @@ void TEXTE_PCB::TransformShapeWithClearanceToPolygonSet(
                          GetShownText(), GetOrientation(), size,
                          GetHorizJustify(), GetVertJustify(),
                          GetThickness(), IsItalic(),
-                         true, addTextSegmToPoly );
+                         true, addTextSegmToPoly, NULL, &prms );
     }
 }
 
@@ -79,6 +79,10 @@ BOARD::BOARD() :
     m_nodeCount     = 0;                    // Number of connected pads.
     m_unconnectedNetCount   = 0;            // Number of unconnected nets.
 
+    m_moduleIndexCount = 0;
+    m_moduleIndexValid = false;
+    m_moduleIndexHasDuplicates = false;
+
     m_CurrentZoneContour = NULL;            // This ZONE_CONTAINER handle the
                                             // zone contour currently in progress
 
@@ -716,6 +720,7 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, int aControl )
             m_Modules.PushFront( (MODULE*) aBoardItem );
 
         aBoardItem->SetParent( this );
+        addToModuleIndex( (MODULE*) aBoardItem, !( aControl & ADD_APPEND ) );
 
         // Because the list of pads has changed, reset the status
         // This indicate the list of pad and nets must be recalculated before use
@@ -788,6 +793,7 @@ BOARD_ITEM* BOARD::Remove( BOARD_ITEM* aBoardItem )
 
     case PCB_MODULE_T:
         m_Modules.Remove( (MODULE*) aBoardItem );
+        removeFromModuleIndex( (MODULE*) aBoardItem );
         break;
 
     case PCB_TRACE_T:
@@ -1264,38 +1270,172 @@ NETINFO_ITEM* BOARD::FindNet( const wxString& aNetname ) const
 }
 
 
-MODULE* BOARD::FindModuleByReference( const wxString& aReference ) const
+/**
+ * Function addModuleKey
+ * adds a key of a module to a module index.
+ * @param aFirst = true to replace a module already using this key
+ * @return false if the key was already used by an other module
+ */
+template <class MAP>
+static bool addModuleKey( MAP& aMap, const wxString& aKey, MODULE* aModule, bool aFirst )
+{
+    std::pair<typename MAP::iterator, bool> result =
+        aMap.insert( std::make_pair( aKey, aModule ) );
+
+    if( result.second )
+        return true;
+
+    if( aFirst )
+        result.first->second = aModule;
+
+    return false;
+}
+
+
+/**
+ * Function removeModuleKey
+ * removes a key of a module from a module index.
+ * @return false if the key is not used by \a aModule
+ */
+template <class MAP>
+static bool removeModuleKey( MAP& aMap, const wxString& aKey, MODULE* aModule )
+{
+    typename MAP::iterator it = aMap.find( aKey );
+
+    if( it == aMap.end() || it->second != aModule )
+        return false;
+
+    aMap.erase( it );
+    return true;
+}
+
+
+void BOARD::buildModuleIndex() const
 {
-    struct FINDER : public INSPECTOR
+    m_modulesByReference.clear();
+    m_modulesByPath.clear();
+    m_moduleIndexHasDuplicates = false;
+
+    // Like a linear search, the first module of the list is found for duplicate keys.
+    // Modules without path are not stored in m_modulesByPath (they are searched linearly)
+    for( MODULE* module = m_Modules; module; module = module->Next() )
     {
-        MODULE* found;
+        if( !addModuleKey( m_modulesByReference, module->GetReference(), module, false ) )
+            m_moduleIndexHasDuplicates = true;
 
-        FINDER() : found( 0 )  {}
+        if( !module->GetPath().IsEmpty() &&
+            !addModuleKey( m_modulesByPath, module->GetPath().Lower(), module, false ) )
+            m_moduleIndexHasDuplicates = true;
+    }
 
-        // implement interface INSPECTOR
-        SEARCH_RESULT Inspect( EDA_ITEM* item, const void* data )
-        {
-            MODULE*         module = (MODULE*) item;
-            const wxString& ref    = *(const wxString*) data;
+    m_moduleIndexCount = m_Modules.GetCount();
+    m_moduleIndexValid = true;
+}
 
-            if( ref == module->GetReference() )
-            {
-                found = module;
-                return SEARCH_QUIT;
-            }
 
-            return SEARCH_CONTINUE;
-        }
-    } inspector;
+void BOARD::addToModuleIndex( MODULE* aModule, bool aFirst )
+{
+    if( !m_moduleIndexValid )
+        return;
 
-    // search only for MODULES
-    static const KICAD_T scanTypes[] = { PCB_MODULE_T, EOT };
+    // m_Modules was modified without using Add() or Remove()
+    if( m_moduleIndexCount + 1 != m_Modules.GetCount() )
+    {
+        m_moduleIndexValid = false;
+        return;
+    }
 
-    // visit this BOARD with the above inspector
-    BOARD* nonconstMe = (BOARD*) this;
-    nonconstMe->Visit( &inspector, &aReference, scanTypes );
+    m_moduleIndexCount++;
 
-    return inspector.found;
+    if( !addModuleKey( m_modulesByReference, aModule->GetReference(), aModule, aFirst ) )
+        m_moduleIndexHasDuplicates = true;
+
+    if( !aModule->GetPath().IsEmpty() &&
+        !addModuleKey( m_modulesByPath, aModule->GetPath().Lower(), aModule, aFirst ) )
+        m_moduleIndexHasDuplicates = true;
+}
+
+
+void BOARD::removeFromModuleIndex( MODULE* aModule )
+{
+    if( !m_moduleIndexValid )
+        return;
+
+    // When a key is shared, the module which now owns this key is not known
+    if( m_moduleIndexHasDuplicates || m_moduleIndexCount != m_Modules.GetCount() + 1 )
+    {
+        m_moduleIndexValid = false;
+        return;
+    }
+
+    m_moduleIndexCount--;
+
+    if( !removeModuleKey( m_modulesByReference, aModule->GetReference(), aModule ) )
+        m_moduleIndexValid = false;
+
+    if( !aModule->GetPath().IsEmpty() &&
+        !removeModuleKey( m_modulesByPath, aModule->GetPath().Lower(), aModule ) )
+        m_moduleIndexValid = false;
+}
+
+
+void BOARD::OnModuleKeyChanged( MODULE* aModule, const wxString& aOldReference,
+                                const wxString& aOldPath )
+{
+    if( !m_moduleIndexValid )
+        return;
+
+    if( m_moduleIndexHasDuplicates )
+    {
+        m_moduleIndexValid = false;
+        return;
+    }
+
+    // Modules which are not (yet) in m_Modules are not in the indexes
+    if( !removeModuleKey( m_modulesByReference, aOldReference, aModule ) )
+        return;
+
+    if( !aOldPath.IsEmpty() )
+        removeModuleKey( m_modulesByPath, aOldPath.Lower(), aModule );
+
+    // The position of aModule in list is not known: when the new key is already used,
+    // the module to find first is not known
+    if( !addModuleKey( m_modulesByReference, aModule->GetReference(), aModule, false ) )
+        m_moduleIndexValid = false;
+
+    if( !aModule->GetPath().IsEmpty() &&
+        !addModuleKey( m_modulesByPath, aModule->GetPath().Lower(), aModule, false ) )
+        m_moduleIndexValid = false;
+}
+
+
+MODULE* BOARD::FindModuleByReference( const wxString& aReference ) const
+{
+    if( !m_moduleIndexValid || m_moduleIndexCount != m_Modules.GetCount() )
+        buildModuleIndex();
+
+    MODULES_MAP::const_iterator it = m_modulesByReference.find( aReference );
+
+    if( it != m_modulesByReference.end() && it->second->GetReference() == aReference )
+        return it->second;
+
+    // The reference text can be modified without MODULE::SetReference() (undo/redo,
+    // footprint properties dialog, scripting): the index can miss a module, or hold
+    // an old reference.  So a miss is checked by the linear search, and the indexes
+    // are rebuilt when they are found stale.
+    for( MODULE* module = m_Modules; module; module = module->Next() )
+    {
+        if( aReference == module->GetReference() )
+        {
+            buildModuleIndex();
+            return module;
+        }
+    }
+
+    if( it != m_modulesByReference.end() )
+        buildModuleIndex();
+
+    return NULL;
 }
 
 
@@ -1303,11 +1443,31 @@ MODULE* BOARD::FindModule( const wxString& aRefOrTimeStamp, bool aSearchByTimeSt
 {
     if( aSearchByTimeStamp )
     {
-        for( MODULE* module = m_Modules;  module;  module = module->Next() )
+        if( aRefOrTimeStamp.IsEmpty() )
         {
-            if( aRefOrTimeStamp.CmpNoCase( module->GetPath() ) == 0 )
-                return module;
+            for( MODULE* module = m_Modules;  module;  module = module->Next() )
+            {
+                if( module->GetPath().IsEmpty() )
+                    return module;
+            }
+
+            return NULL;
         }
+
+        if( !m_moduleIndexValid || m_moduleIndexCount != m_Modules.GetCount() )
+            buildModuleIndex();
+
+        wxString key = aRefOrTimeStamp.Lower();
+        MODULES_MAP::const_iterator it = m_modulesByPath.find( key );
+
+        if( it != m_modulesByPath.end() && it->second->GetPath().Lower() != key )
+        {
+            buildModuleIndex();
+            it = m_modulesByPath.find( key );
+        }
+
+        if( it != m_modulesByPath.end() )
+            return it->second;
     }
     else
     {
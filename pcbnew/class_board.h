@@ -205,6 +205,37 @@ private:
     /// Number of unconnected nets in the current rats nest.
     int                     m_unconnectedNetCount;
 
+    typedef boost::unordered_map<wxString, MODULE*, WXSTRING_HASH> MODULES_MAP;
+
+    /// Hash indexes of m_Modules by reference and by path (time stamp), used by
+    /// FindModuleByReference() and FindModule(). They are built on demand, and updated
+    /// by Add(), Remove() and MODULE::SetReference()/SetPath() while valid.
+    mutable MODULES_MAP     m_modulesByReference;
+    mutable MODULES_MAP     m_modulesByPath;        ///< keys are lower case paths
+    mutable unsigned        m_moduleIndexCount;     ///< modules count when the indexes were built
+    mutable bool            m_moduleIndexValid;
+    mutable bool            m_moduleIndexHasDuplicates; ///< a key is used by more than one module
+
+    /**
+     * Function buildModuleIndex
+     * (re)builds m_modulesByReference and m_modulesByPath from m_Modules.
+     */
+    void buildModuleIndex() const;
+
+    /**
+     * Function addToModuleIndex
+     * adds \a aModule to the module indexes, if they are valid.
+     * @param aFirst = true if \a aModule is the first module of m_Modules,
+     *                 false if it is the last one
+     */
+    void addToModuleIndex( MODULE* aModule, bool aFirst );
+
+    /**
+     * Function removeFromModuleIndex
+     * removes \a aModule from the module indexes, if they are valid.
+     */
+    void removeFromModuleIndex( MODULE* aModule );
+
     /**
      * Function chainMarkedSegments
      * is used by MarkTrace() to set the BUSY flag of connected segments of the trace
@@ -931,6 +962,26 @@ public:
      */
     MODULE* FindModule( const wxString& aRefOrTimeStamp, bool aSearchByTimeStamp = false ) const;
 
+    /**
+     * Function OnModuleKeyChanged
+     * must be called when the reference or the path of a module of this board
+     * has changed, to keep the indexes used by FindModule() in sync.
+     * MODULE::SetReference() and MODULE::SetPath() call it.
+     * @param aModule = the modified module
+     * @param aOldReference = the reference of \a aModule before the change
+     * @param aOldPath = the path of \a aModule before the change
+     */
+    void OnModuleKeyChanged( MODULE* aModule, const wxString& aOldReference,
+                             const wxString& aOldPath );
+
+    /**
+     * Function InvalidateModuleIndex
+     * forces a rebuild of the indexes used by FindModule() on next search.
+     * Must be called when modules are renamed or m_Modules is modified without
+     * using Add(), Remove(), MODULE::SetReference() or MODULE::SetPath().
+     */
+    void InvalidateModuleIndex() { m_moduleIndexValid = false; }
+
     /**
      * Function ReplaceNetlist
      * updates the #BOARD according to \a aNetlist.
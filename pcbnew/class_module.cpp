@@ -1236,6 +1236,32 @@ wxString MODULE::GetNextPadName( bool aFillSequenceGaps ) const
 }
 
 
+void MODULE::SetReference( const wxString& aReference )
+{
+    wxString oldReference = m_Reference->GetText();
+
+    m_Reference->SetText( aReference );
+
+    BOARD* board = GetBoard();
+
+    if( board && oldReference != aReference )
+        board->OnModuleKeyChanged( this, oldReference, m_Path );
+}
+
+
+void MODULE::SetPath( const wxString& aPath )
+{
+    wxString oldPath = m_Path;
+
+    m_Path = aPath;
+
+    BOARD* board = GetBoard();
+
+    if( board && oldPath != aPath )
+        board->OnModuleKeyChanged( this, GetReference(), oldPath );
+}
+
+
 wxString MODULE::GetReferencePrefix() const
 {
     wxString prefix = GetReference();
@@ -173,7 +173,7 @@ public:
     void SetKeywords( const wxString& aKeywords ) { m_KeyWord = aKeywords; }
 
     const wxString& GetPath() const { return m_Path; }
-    void SetPath( const wxString& aPath ) { m_Path = aPath; }
+    void SetPath( const wxString& aPath );
 
     int GetLocalSolderMaskMargin() const { return m_LocalSolderMaskMargin; }
     void SetLocalSolderMaskMargin( int aMargin ) { m_LocalSolderMaskMargin = aMargin; }
@@ -407,10 +407,7 @@ public:
      * @param aReference A reference to a wxString object containing the reference designator
      *                   text.
      */
-    void SetReference( const wxString& aReference )
-    {
-        m_Reference->SetText( aReference );
-    }
+    void SetReference( const wxString& aReference );
 
     /**
      * Function GetReference prefix
@@ -95,7 +95,12 @@ DIALOG_GENDRILL_BASE::DIALOG_GENDRILL_BASE( wxWindow* parent, wxWindowID id, con
 	m_Check_Merge_PTH_NPTH = new wxCheckBox( sbOptSizer->GetStaticBox(), wxID_ANY, _("Merge PTH and NPTH holes into one file"), wxDefaultPosition, wxDefaultSize, 0 );
 	m_Check_Merge_PTH_NPTH->SetToolTip( _("Not recommanded.\nUse it only for board houses which ask for merged PTH and NPTH into onlu one file") );
 	
-	sbOptSizer->Add( m_Check_Merge_PTH_NPTH, 0, wxALL, 5 );
+	sbOptSizer->Add( m_Check_Merge_PTH_NPTH, 0, wxTOP|wxRIGHT|wxLEFT, 5 );
+	
+	m_Check_Optimize_Order = new wxCheckBox( sbOptSizer->GetStaticBox(), wxID_ANY, _("Optimize drilling order"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_Check_Optimize_Order->SetToolTip( _("Drill the holes of each tool in an order which shortens the travel of the drill,\ninstead of sorting them by position.") );
+	
+	sbOptSizer->Add( m_Check_Optimize_Order, 0, wxALL, 5 );
 	
 	
 	bMiddleBoxSizer->Add( sbOptSizer, 0, wxEXPAND|wxRIGHT|wxLEFT, 5 );
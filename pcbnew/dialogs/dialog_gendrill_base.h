@@ -49,6 +49,7 @@ class DIALOG_GENDRILL_BASE : public DIALOG_SHIM
 		wxCheckBox* m_Check_Mirror;
 		wxCheckBox* m_Check_Minimal;
 		wxCheckBox* m_Check_Merge_PTH_NPTH;
+		wxCheckBox* m_Check_Optimize_Order;
 		wxRadioBox* m_Choice_Drill_Offset;
 		wxStaticBoxSizer* m_DefaultViasDrillSizer;
 		wxStaticText* m_ViaDrillValue;
@@ -36,6 +36,7 @@
 #include <trigo.h>
 #include <build_version.h>
 #include <macros.h>
+#include <record_writer.h>
 
 #include <pcbnew.h>
 
@@ -281,7 +282,7 @@ static const wxString intern_new_d356_netname( const wxString &aNetname,
 
 /* Write all the accumuled data to the file in D356 format */
 static void write_D356_records( std::vector <D356_RECORD> &aRecords,
-                                FILE *fout )
+                                RECORD_WRITER& fout )
 {
     // Sanified and shorted network names and set of short names
     std::map<wxString, wxString> d356_net_map;
@@ -317,34 +318,34 @@ static void write_D356_records( std::vector <D356_RECORD> &aRecords,
         }
 
         // Operation code, signal and component
-        fprintf( fout, "%03d%-14.14s   %-6.6s%c%-4.4s%c",
-                 rktype, TO_UTF8(d356_net),
-                 TO_UTF8(rk.refdes),
-                 rk.pin.empty()?' ':'-',
-                 TO_UTF8(rk.pin),
-                 rk.midpoint?'M':' ' );
+        fout.Print( "%03d%-14.14s   %-6.6s%c%-4.4s%c",
+                    rktype, TO_UTF8(d356_net),
+                    TO_UTF8(rk.refdes),
+                    rk.pin.empty()?' ':'-',
+                    TO_UTF8(rk.pin),
+                    rk.midpoint?'M':' ' );
 
         // Hole definition
         if( rk.hole )
         {
-            fprintf( fout, "D%04d%c",
-                     iu_to_d356( rk.drill, 9999 ),
-                     rk.mechanical ? 'U':'P' );
+            fout.Print( "D%04d%c",
+                        iu_to_d356( rk.drill, 9999 ),
+                        rk.mechanical ? 'U':'P' );
         }
         else
-            fprintf( fout, "      " );
+            fout.Text( "      " );
 
         // Test point access
-        fprintf( fout, "A%02dX%+07dY%+07dX%04dY%04dR%03d",
-                rk.access,
-                iu_to_d356( rk.x_location, 999999 ),
-                iu_to_d356( rk.y_location, 999999 ),
-                iu_to_d356( rk.x_size, 9999 ),
-                iu_to_d356( rk.y_size, 9999 ),
-                rk.rotation );
+        fout.Print( "A%02dX%+07dY%+07dX%04dY%04dR%03d",
+                   rk.access,
+                   iu_to_d356( rk.x_location, 999999 ),
+                   iu_to_d356( rk.y_location, 999999 ),
+                   iu_to_d356( rk.x_size, 9999 ),
+                   iu_to_d356( rk.y_size, 9999 ),
+                   rk.rotation );
 
         // Soldermask
-        fprintf( fout, "S%d\n", rk.soldermask );
+        fout.Print( "S%d\n", rk.soldermask );
     }
 }
 
@@ -384,13 +385,17 @@ void PCB_EDIT_FRAME::GenD356File( wxCommandEvent& aEvent )
 
     build_pad_testpoints( pcb, d356_records );
 
-    // Code 00 AFAIK is ASCII, CUST 0 is decimils/degrees
-    // CUST 1 would be metric but gerbtool simply ignores it!
-    fprintf( file, "P  CODE 00\n" );
-    fprintf( file, "P  UNITS CUST 0\n" );
-    fprintf( file, "P  DIM   N\n" );
-    write_D356_records( d356_records, file );
-    fprintf( file, "999\n" );
+    {
+        RECORD_WRITER out( file );
+
+        // Code 00 AFAIK is ASCII, CUST 0 is decimils/degrees
+        // CUST 1 would be metric but gerbtool simply ignores it!
+        out.Text( "P  CODE 00\n" );
+        out.Text( "P  UNITS CUST 0\n" );
+        out.Text( "P  DIM   N\n" );
+        write_D356_records( d356_records, out );
+        out.Text( "999\n" );
+    }
 
     fclose( file );
 }
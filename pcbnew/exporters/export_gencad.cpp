@@ -38,6 +38,7 @@
 #include <trigo.h>
 #include <build_version.h>
 #include <macros.h>
+#include <record_writer.h>
 
 #include <pcbnew.h>
 
@@ -47,17 +48,17 @@
 #include <class_edge_mod.h>
 
 
-static bool CreateHeaderInfoData( FILE* aFile, PCB_EDIT_FRAME* frame );
-static void CreateArtworksSection( FILE* aFile );
-static void CreateTracksInfoData( FILE* aFile, BOARD* aPcb );
-static void CreateBoardSection( FILE* aFile, BOARD* aPcb );
-static void CreateComponentsSection( FILE* aFile, BOARD* aPcb );
-static void CreateDevicesSection( FILE* aFile, BOARD* aPcb );
-static void CreateRoutesSection( FILE* aFile, BOARD* aPcb );
-static void CreateSignalsSection( FILE* aFile, BOARD* aPcb );
-static void CreateShapesSection( FILE* aFile, BOARD* aPcb );
-static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb );
-static void FootprintWriteShape( FILE* File, MODULE* module );
+static bool CreateHeaderInfoData( RECORD_WRITER& aFile, PCB_EDIT_FRAME* frame );
+static void CreateArtworksSection( RECORD_WRITER& aFile );
+static void CreateTracksInfoData( RECORD_WRITER& aFile, BOARD* aPcb );
+static void CreateBoardSection( RECORD_WRITER& aFile, BOARD* aPcb );
+static void CreateComponentsSection( RECORD_WRITER& aFile, BOARD* aPcb );
+static void CreateDevicesSection( RECORD_WRITER& aFile, BOARD* aPcb );
+static void CreateRoutesSection( RECORD_WRITER& aFile, BOARD* aPcb );
+static void CreateSignalsSection( RECORD_WRITER& aFile, BOARD* aPcb );
+static void CreateShapesSection( RECORD_WRITER& aFile, BOARD* aPcb );
+static void CreatePadsShapesSection( RECORD_WRITER& aFile, BOARD* aPcb );
+static void FootprintWriteShape( RECORD_WRITER& File, MODULE* module );
 
 // layer names for Gencad export
 
@@ -300,27 +301,31 @@ void PCB_EDIT_FRAME::ExportToGenCAD( wxCommandEvent& aEvent )
         }
     }
 
-    /* Gencad has some mandatory and some optional sections: some importer
-     *  need the padstack section (which is optional) anyway. Also the
-     *  order of the section *is* important */
+    {
+        RECORD_WRITER out( file );
+
+        /* Gencad has some mandatory and some optional sections: some importer
+         *  need the padstack section (which is optional) anyway. Also the
+         *  order of the section *is* important */
 
-    CreateHeaderInfoData( file, this );     // Gencad header
-    CreateBoardSection( file, pcb );        // Board perimeter
+        CreateHeaderInfoData( out, this );     // Gencad header
+        CreateBoardSection( out, pcb );        // Board perimeter
 
-    CreatePadsShapesSection( file, pcb );   // Pads and padstacks
-    CreateArtworksSection( file );          // Empty but mandatory
+        CreatePadsShapesSection( out, pcb );   // Pads and padstacks
+        CreateArtworksSection( out );          // Empty but mandatory
 
-    /* Gencad splits a component info in shape, component and device.
-     *  We don't do any sharing (it would be difficult since each module is
-     *  customizable after placement) */
-    CreateShapesSection( file, pcb );
-    CreateComponentsSection( file, pcb );
-    CreateDevicesSection( file, pcb );
+        /* Gencad splits a component info in shape, component and device.
+         *  We don't do any sharing (it would be difficult since each module is
+         *  customizable after placement) */
+        CreateShapesSection( out, pcb );
+        CreateComponentsSection( out, pcb );
+        CreateDevicesSection( out, pcb );
 
-    // In a similar way the netlist is split in net, track and route
-    CreateSignalsSection( file, pcb );
-    CreateTracksInfoData( file, pcb );
-    CreateRoutesSection( file, pcb );
+        // In a similar way the netlist is split in net, track and route
+        CreateSignalsSection( out, pcb );
+        CreateTracksInfoData( out, pcb );
+        CreateRoutesSection( out, pcb );
+    }
 
     fclose( file );
     SetLocaleTo_Default();  // revert to the current locale
@@ -367,17 +372,17 @@ static int ViaSort( const void* aRefptr, const void* aObjptr )
 
 
 // The ARTWORKS section is empty but (officially) mandatory
-static void CreateArtworksSection( FILE* aFile )
+static void CreateArtworksSection( RECORD_WRITER& aFile )
 {
     /* The artworks section is empty */
-    fputs( "$ARTWORKS\n", aFile );
-    fputs( "$ENDARTWORKS\n\n", aFile );
+    aFile.Text( "$ARTWORKS\n" );
+    aFile.Text( "$ENDARTWORKS\n\n" );
 }
 
 
 // Emit PADS and PADSTACKS. They are sorted and emitted uniquely.
 // Via name is synthesized from their attributes, pads are numbered
-static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
+static void CreatePadsShapesSection( RECORD_WRITER& aFile, BOARD* aPcb )
 {
     std::vector<D_PAD*> pads;
     std::vector<D_PAD*> padstacks;
@@ -390,7 +395,7 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
     LSET    master_layermask = aPcb->GetDesignSettings().GetEnabledLayers();
     int     cu_count = aPcb->GetCopperLayerCount();
 
-    fputs( "$PADS\n", aFile );
+    aFile.Text( "$PADS\n" );
 
     // Enumerate and sort the pads
     if( aPcb->GetPadCount() > 0 )
@@ -421,11 +426,11 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
 
         old_via = via;
         viastacks.push_back( via );
-        fprintf( aFile, "PAD V%d.%d.%s ROUND %g\nCIRCLE 0 0 %g\n",
-                via->GetWidth(), via->GetDrillValue(),
-                fmt_mask( via->GetLayerSet() ).c_str(),
-                via->GetDrillValue() / SCALE_FACTOR,
-                via->GetWidth() / (SCALE_FACTOR * 2) );
+        aFile.Print( "PAD V%d.%d.%s ROUND %g\nCIRCLE 0 0 %g\n",
+                    via->GetWidth(), via->GetDrillValue(),
+                    fmt_mask( via->GetLayerSet() ).c_str(),
+                    via->GetDrillValue() / SCALE_FACTOR,
+                    via->GetWidth() / (SCALE_FACTOR * 2) );
     }
 
     // Emit component pads
@@ -446,7 +451,7 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
         pad_name_number++;
         pad->SetSubRatsnest( pad_name_number );
 
-        fprintf( aFile, "PAD P%d", pad->GetSubRatsnest() );
+        aFile.Print( "PAD P%d", pad->GetSubRatsnest() );
 
         padstacks.push_back( pad ); // Will have its own padstack later
         int dx = pad->GetSize().x / 2;
@@ -456,110 +461,110 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
         {
         default:
         case PAD_SHAPE_CIRCLE:
-            fprintf( aFile, " ROUND %g\n",
-                     pad->GetDrillSize().x / SCALE_FACTOR );
+            aFile.Print( " ROUND %g\n",
+                         pad->GetDrillSize().x / SCALE_FACTOR );
             /* Circle is center, radius */
-            fprintf( aFile, "CIRCLE %g %g %g\n",
-                    pad->GetOffset().x / SCALE_FACTOR,
-                    -pad->GetOffset().y / SCALE_FACTOR,
-                    pad->GetSize().x / (SCALE_FACTOR * 2) );
+            aFile.Print( "CIRCLE %g %g %g\n",
+                        pad->GetOffset().x / SCALE_FACTOR,
+                        -pad->GetOffset().y / SCALE_FACTOR,
+                        pad->GetSize().x / (SCALE_FACTOR * 2) );
             break;
 
         case PAD_SHAPE_RECT:
-            fprintf( aFile, " RECTANGULAR %g\n",
-                     pad->GetDrillSize().x / SCALE_FACTOR );
+            aFile.Print( " RECTANGULAR %g\n",
+                         pad->GetDrillSize().x / SCALE_FACTOR );
 
             // Rectangle is begin, size *not* begin, end!
-            fprintf( aFile, "RECTANGLE %g %g %g %g\n",
-                    (-dx + pad->GetOffset().x ) / SCALE_FACTOR,
-                    (-dy - pad->GetOffset().y ) / SCALE_FACTOR,
-                    dx / (SCALE_FACTOR / 2), dy / (SCALE_FACTOR / 2) );
+            aFile.Print( "RECTANGLE %g %g %g %g\n",
+                        (-dx + pad->GetOffset().x ) / SCALE_FACTOR,
+                        (-dy - pad->GetOffset().y ) / SCALE_FACTOR,
+                        dx / (SCALE_FACTOR / 2), dy / (SCALE_FACTOR / 2) );
             break;
 
         case PAD_SHAPE_OVAL:     // Create outline by 2 lines and 2 arcs
             {
                 // OrCAD Layout call them OVAL or OBLONG - GenCAD call them FINGERs
-                fprintf( aFile, " FINGER %g\n",
-                         pad->GetDrillSize().x / SCALE_FACTOR );
+                aFile.Print( " FINGER %g\n",
+                             pad->GetDrillSize().x / SCALE_FACTOR );
                 int dr = dx - dy;
 
                 if( dr >= 0 )       // Horizontal oval
                 {
                     int radius = dy;
-                    fprintf( aFile, "LINE %g %g %g %g\n",
-                             (-dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - radius) / SCALE_FACTOR,
-                             (dr + pad->GetOffset().x ) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - radius) / SCALE_FACTOR );
+                    aFile.Print( "LINE %g %g %g %g\n",
+                                 (-dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - radius) / SCALE_FACTOR,
+                                 (dr + pad->GetOffset().x ) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - radius) / SCALE_FACTOR );
 
                     // GenCAD arcs are (start, end, center)
-                    fprintf( aFile, "ARC %g %g %g %g %g %g\n",
-                             (dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - radius) / SCALE_FACTOR,
-                             (dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + radius) / SCALE_FACTOR,
-                             (dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             -pad->GetOffset().y / SCALE_FACTOR );
-
-                    fprintf( aFile, "LINE %g %g %g %g\n",
-                             (dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + radius) / SCALE_FACTOR,
-                             (-dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + radius) / SCALE_FACTOR );
-                    fprintf( aFile, "ARC %g %g %g %g %g %g\n",
-                             (-dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + radius) / SCALE_FACTOR,
-                             (-dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - radius) / SCALE_FACTOR,
-                             (-dr + pad->GetOffset().x) / SCALE_FACTOR,
-                             -pad->GetOffset().y / SCALE_FACTOR );
+                    aFile.Print( "ARC %g %g %g %g %g %g\n",
+                                 (dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - radius) / SCALE_FACTOR,
+                                 (dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + radius) / SCALE_FACTOR,
+                                 (dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 -pad->GetOffset().y / SCALE_FACTOR );
+
+                    aFile.Print( "LINE %g %g %g %g\n",
+                                 (dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + radius) / SCALE_FACTOR,
+                                 (-dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + radius) / SCALE_FACTOR );
+                    aFile.Print( "ARC %g %g %g %g %g %g\n",
+                                 (-dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + radius) / SCALE_FACTOR,
+                                 (-dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - radius) / SCALE_FACTOR,
+                                 (-dr + pad->GetOffset().x) / SCALE_FACTOR,
+                                 -pad->GetOffset().y / SCALE_FACTOR );
                 }
                 else        // Vertical oval
                 {
                     dr = -dr;
                     int radius = dx;
-                    fprintf( aFile, "LINE %g %g %g %g\n",
-                             (-radius + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - dr) / SCALE_FACTOR,
-                             (-radius + pad->GetOffset().x ) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + dr) / SCALE_FACTOR );
-                    fprintf( aFile, "ARC %g %g %g %g %g %g\n",
-                             (-radius + pad->GetOffset().x ) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + dr) / SCALE_FACTOR,
-                             (radius + pad->GetOffset().x ) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + dr) / SCALE_FACTOR,
-                             pad->GetOffset().x / SCALE_FACTOR,
-                             (-pad->GetOffset().y + dr) / SCALE_FACTOR );
-
-                    fprintf( aFile, "LINE %g %g %g %g\n",
-                             (radius + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y + dr) / SCALE_FACTOR,
-                             (radius + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - dr) / SCALE_FACTOR );
-                    fprintf( aFile, "ARC %g %g %g %g %g %g\n",
-                             (radius + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - dr) / SCALE_FACTOR,
-                             (-radius + pad->GetOffset().x) / SCALE_FACTOR,
-                             (-pad->GetOffset().y - dr) / SCALE_FACTOR,
-                             pad->GetOffset().x / SCALE_FACTOR,
-                             (-pad->GetOffset().y - dr) / SCALE_FACTOR );
+                    aFile.Print( "LINE %g %g %g %g\n",
+                                 (-radius + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - dr) / SCALE_FACTOR,
+                                 (-radius + pad->GetOffset().x ) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + dr) / SCALE_FACTOR );
+                    aFile.Print( "ARC %g %g %g %g %g %g\n",
+                                 (-radius + pad->GetOffset().x ) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + dr) / SCALE_FACTOR,
+                                 (radius + pad->GetOffset().x ) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + dr) / SCALE_FACTOR,
+                                 pad->GetOffset().x / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + dr) / SCALE_FACTOR );
+
+                    aFile.Print( "LINE %g %g %g %g\n",
+                                 (radius + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y + dr) / SCALE_FACTOR,
+                                 (radius + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - dr) / SCALE_FACTOR );
+                    aFile.Print( "ARC %g %g %g %g %g %g\n",
+                                 (radius + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - dr) / SCALE_FACTOR,
+                                 (-radius + pad->GetOffset().x) / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - dr) / SCALE_FACTOR,
+                                 pad->GetOffset().x / SCALE_FACTOR,
+                                 (-pad->GetOffset().y - dr) / SCALE_FACTOR );
                 }
             }
             break;
 
         case PAD_SHAPE_TRAPEZOID:
-            fprintf( aFile, " POLYGON %g\n",
-                     pad->GetDrillSize().x / SCALE_FACTOR );
+            aFile.Print( " POLYGON %g\n",
+                         pad->GetDrillSize().x / SCALE_FACTOR );
 
             // XXX TO BE IMPLEMENTED! and I don't know if it could be actually imported by something
             break;
         }
     }
 
-    fputs( "\n$ENDPADS\n\n", aFile );
+    aFile.Text( "\n$ENDPADS\n\n" );
 
     // Now emit the padstacks definitions, using the combined layer masks
-    fputs( "$PADSTACKS\n", aFile );
+    aFile.Text( "$PADSTACKS\n" );
 
     // Via padstacks
     for( unsigned i = 0; i < viastacks.size(); i++ )
@@ -568,20 +573,20 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
 
         LSET mask = via->GetLayerSet() & master_layermask;
 
-        fprintf( aFile, "PADSTACK VIA%d.%d.%s %g\n",
-                 via->GetWidth(), via->GetDrillValue(),
-                 fmt_mask( mask ).c_str(),
-                 via->GetDrillValue() / SCALE_FACTOR );
+        aFile.Print( "PADSTACK VIA%d.%d.%s %g\n",
+                     via->GetWidth(), via->GetDrillValue(),
+                     fmt_mask( mask ).c_str(),
+                     via->GetDrillValue() / SCALE_FACTOR );
 
         for( LSEQ seq = mask.Seq( gc_seq, DIM( gc_seq ) );  seq;  ++seq )
         {
             LAYER_ID layer = *seq;
 
-            fprintf( aFile, "PAD V%d.%d.%s %s 0 0\n",
-                    via->GetWidth(), via->GetDrillValue(),
-                    fmt_mask( mask ).c_str(),
-                    GenCADLayerName( cu_count, layer ).c_str()
-                    );
+            aFile.Print( "PAD V%d.%d.%s %s 0 0\n",
+                        via->GetWidth(), via->GetDrillValue(),
+                        fmt_mask( mask ).c_str(),
+                        GenCADLayerName( cu_count, layer ).c_str()
+                        );
         }
     }
 
@@ -595,7 +600,7 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
         D_PAD* pad = padstacks[i];
 
         // Straight padstack
-        fprintf( aFile, "PADSTACK PAD%u %g\n", i, pad->GetDrillSize().x / SCALE_FACTOR );
+        aFile.Print( "PADSTACK PAD%u %g\n", i, pad->GetDrillSize().x / SCALE_FACTOR );
 
         LSET pad_set = pad->GetLayerSet() & master_layermask;
 
@@ -604,22 +609,22 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
         {
             LAYER_ID layer = *seq;
 
-            fprintf( aFile, "PAD P%u %s 0 0\n", i, GenCADLayerName( cu_count, layer ).c_str() );
+            aFile.Print( "PAD P%u %s 0 0\n", i, GenCADLayerName( cu_count, layer ).c_str() );
         }
 
         // Flipped padstack
-        fprintf( aFile, "PADSTACK PAD%uF %g\n", i, pad->GetDrillSize().x / SCALE_FACTOR );
+        aFile.Print( "PADSTACK PAD%uF %g\n", i, pad->GetDrillSize().x / SCALE_FACTOR );
 
         // the normal LAYER_ID sequence is inverted from gc_seq[]
         for( LSEQ seq = pad_set.Seq();  seq;  ++seq )
         {
             LAYER_ID layer = *seq;
 
-            fprintf( aFile, "PAD P%u %s 0 0\n", i, GenCADLayerNameFlipped( cu_count, layer ).c_str() );
+            aFile.Print( "PAD P%u %s 0 0\n", i, GenCADLayerNameFlipped( cu_count, layer ).c_str() );
         }
     }
 
-    fputs( "$ENDPADSTACKS\n\n", aFile );
+    aFile.Text( "$ENDPADSTACKS\n\n" );
 }
 
 
@@ -627,7 +632,7 @@ static void CreatePadsShapesSection( FILE* aFile, BOARD* aPcb )
  * Since module shape is customizable after the placement we cannot share them;
  * instead we opt for the one-module-one-shape-one-component-one-device approach
  */
-static void CreateShapesSection( FILE* aFile, BOARD* aPcb )
+static void CreateShapesSection( RECORD_WRITER& aFile, BOARD* aPcb )
 {
     MODULE*     module;
     D_PAD*      pad;
@@ -635,7 +640,7 @@ static void CreateShapesSection( FILE* aFile, BOARD* aPcb )
     wxString    pinname;
     const char* mirror = "0";
 
-    fputs( "$SHAPES\n", aFile );
+    aFile.Text( "$SHAPES\n" );
 
     const LSET all_cu = LSET::AllCuMask();
 
@@ -670,17 +675,17 @@ static void CreateShapesSection( FILE* aFile, BOARD* aPcb )
             NORMALIZE_ANGLE_POS( orient );
 
             // Bottom side modules use the flipped padstack
-            fprintf( aFile, (module->GetFlag()) ?
-                     "PIN %s PAD%dF %g %g %s %g %s\n" :
-                     "PIN %s PAD%d %g %g %s %g %s\n",
-                     TO_UTF8( pinname ), pad->GetSubRatsnest(),
-                     pad->GetPos0().x / SCALE_FACTOR,
-                     -pad->GetPos0().y / SCALE_FACTOR,
-                     layer, orient / 10.0, mirror );
+            aFile.Print( (module->GetFlag()) ?
+                         "PIN %s PAD%dF %g %g %s %g %s\n" :
+                         "PIN %s PAD%d %g %g %s %g %s\n",
+                         TO_UTF8( pinname ), pad->GetSubRatsnest(),
+                         pad->GetPos0().x / SCALE_FACTOR,
+                         -pad->GetPos0().y / SCALE_FACTOR,
+                         layer, orient / 10.0, mirror );
         }
     }
 
-    fputs( "$ENDSHAPES\n\n", aFile );
+    aFile.Text( "$ENDSHAPES\n\n" );
 }
 
 
@@ -689,9 +694,9 @@ static void CreateShapesSection( FILE* aFile, BOARD* aPcb )
  * flipped, silk layers need to be handled correctly and so on. Also it seems
  * that *noone* follows the specs...
  */
-static void CreateComponentsSection( FILE* aFile, BOARD* aPcb )
+static void CreateComponentsSection( RECORD_WRITER& aFile, BOARD* aPcb )
 {
-    fputs( "$COMPONENTS\n", aFile );
+    aFile.Text( "$COMPONENTS\n" );
 
     int cu_count = aPcb->GetCopperLayerCount();
 
@@ -713,21 +718,21 @@ static void CreateComponentsSection( FILE* aFile, BOARD* aPcb )
             flip   = "0";
         }
 
-        fprintf( aFile, "\nCOMPONENT %s\n",
-                 TO_UTF8( module->GetReference() ) );
-        fprintf( aFile, "DEVICE %s_%s\n",
-                 TO_UTF8( module->GetReference() ),
-                 TO_UTF8( module->GetValue() ) );
-        fprintf( aFile, "PLACE %g %g\n",
-                 MapXTo( module->GetPosition().x ),
-                 MapYTo( module->GetPosition().y ) );
-        fprintf( aFile, "LAYER %s\n",
-                 (module->GetFlag()) ? "BOTTOM" : "TOP" );
-        fprintf( aFile, "ROTATION %g\n",
-                 orient / 10.0 );
-        fprintf( aFile, "SHAPE %s %s %s\n",
-                 TO_UTF8( module->GetReference() ),
-                 mirror, flip );
+        aFile.Print( "\nCOMPONENT %s\n",
+                     TO_UTF8( module->GetReference() ) );
+        aFile.Print( "DEVICE %s_%s\n",
+                     TO_UTF8( module->GetReference() ),
+                     TO_UTF8( module->GetValue() ) );
+        aFile.Print( "PLACE %g %g\n",
+                     MapXTo( module->GetPosition().x ),
+                     MapYTo( module->GetPosition().y ) );
+        aFile.Print( "LAYER %s\n",
+                     (module->GetFlag()) ? "BOTTOM" : "TOP" );
+        aFile.Print( "ROTATION %g\n",
+                     orient / 10.0 );
+        aFile.Print( "SHAPE %s %s %s\n",
+                     TO_UTF8( module->GetReference() ),
+                     mirror, flip );
 
         // Text on silk layer: RefDes and value (are they actually useful?)
         TEXTE_MODULE *textmod = &module->Reference();
@@ -737,36 +742,36 @@ static void CreateComponentsSection( FILE* aFile, BOARD* aPcb )
             double      orient = textmod->GetOrientation();
             std::string layer  = GenCADLayerName( cu_count, module->GetFlag() ? B_SilkS : F_SilkS );
 
-            fprintf( aFile, "TEXT %g %g %g %g %s %s \"%s\"",
-                     textmod->GetPos0().x / SCALE_FACTOR,
-                    -textmod->GetPos0().y / SCALE_FACTOR,
-                     textmod->GetSize().x / SCALE_FACTOR,
-                     orient / 10.0,
-                     mirror,
-                     layer.c_str(),
-                     TO_UTF8( textmod->GetText() ) );
+            aFile.Print( "TEXT %g %g %g %g %s %s \"%s\"",
+                         textmod->GetPos0().x / SCALE_FACTOR,
+                        -textmod->GetPos0().y / SCALE_FACTOR,
+                         textmod->GetSize().x / SCALE_FACTOR,
+                         orient / 10.0,
+                         mirror,
+                         layer.c_str(),
+                         TO_UTF8( textmod->GetText() ) );
 
             // Please note, the width is approx
-            fprintf( aFile, " 0 0 %g %g\n",
-                     ( textmod->GetSize().x * textmod->GetLength() ) / SCALE_FACTOR,
-                     textmod->GetSize().y / SCALE_FACTOR );
+            aFile.Print( " 0 0 %g %g\n",
+                         ( textmod->GetSize().x * textmod->GetLength() ) / SCALE_FACTOR,
+                         textmod->GetSize().y / SCALE_FACTOR );
 
             textmod = &module->Value(); // Dirty trick for the second iteration
         }
 
         // The SHEET is a 'generic description' for referencing the component
-        fprintf( aFile, "SHEET \"RefDes: %s, Value: %s\"\n",
-                 TO_UTF8( module->GetReference() ),
-                 TO_UTF8( module->GetValue() ) );
+        aFile.Print( "SHEET \"RefDes: %s, Value: %s\"\n",
+                     TO_UTF8( module->GetReference() ),
+                     TO_UTF8( module->GetValue() ) );
     }
 
-    fputs( "$ENDCOMPONENTS\n\n", aFile );
+    aFile.Text( "$ENDCOMPONENTS\n\n" );
 }
 
 
 /* Emit the netlist (which is actually the thing for which GenCAD is used these
  * days!); tracks are handled later */
-static void CreateSignalsSection( FILE* aFile, BOARD* aPcb )
+static void CreateSignalsSection( RECORD_WRITER& aFile, BOARD* aPcb )
 {
     wxString      msg;
     NETINFO_ITEM* net;
@@ -774,7 +779,7 @@ static void CreateSignalsSection( FILE* aFile, BOARD* aPcb )
     MODULE*       module;
     int           NbNoConn = 1;
 
-    fputs( "$SIGNALS\n", aFile );
+    aFile.Text( "$SIGNALS\n" );
 
     for( unsigned ii = 0; ii < aPcb->GetNetCount(); ii++ )
     {
@@ -790,8 +795,8 @@ static void CreateSignalsSection( FILE* aFile, BOARD* aPcb )
 
         msg = wxT( "SIGNAL " ) + net->GetNetname();
 
-        fputs( TO_UTF8( msg ), aFile );
-        fputs( "\n", aFile );
+        aFile.Text( TO_UTF8( msg ) );
+        aFile.Text( "\n" );
 
         for( module = aPcb->m_Modules; module; module = module->Next() )
         {
@@ -807,48 +812,48 @@ static void CreateSignalsSection( FILE* aFile, BOARD* aPcb )
                             GetChars( module->GetReference() ),
                             GetChars( padname ) );
 
-                fputs( TO_UTF8( msg ), aFile );
-                fputs( "\n", aFile );
+                aFile.Text( TO_UTF8( msg ) );
+                aFile.Text( "\n" );
             }
         }
     }
 
-    fputs( "$ENDSIGNALS\n\n", aFile );
+    aFile.Text( "$ENDSIGNALS\n\n" );
 }
 
 
 // Creates the header section
-static bool CreateHeaderInfoData( FILE* aFile, PCB_EDIT_FRAME* aFrame )
+static bool CreateHeaderInfoData( RECORD_WRITER& aFile, PCB_EDIT_FRAME* aFrame )
 {
     wxString    msg;
     BOARD *board = aFrame->GetBoard();
 
-    fputs( "$HEADER\n", aFile );
-    fputs( "GENCAD 1.4\n", aFile );
+    aFile.Text( "$HEADER\n" );
+    aFile.Text( "GENCAD 1.4\n" );
 
     // Please note: GenCAD syntax requires quoted strings if they can contain spaces
     msg.Printf( wxT( "USER \"%s %s\"\n" ),
                GetChars( Pgm().App().GetAppName() ),
                GetChars( GetBuildVersion() ) );
-    fputs( TO_UTF8( msg ), aFile );
+    aFile.Text( TO_UTF8( msg ) );
 
     msg = wxT( "DRAWING \"" ) + board->GetFileName() + wxT( "\"\n" );
-    fputs( TO_UTF8( msg ), aFile );
+    aFile.Text( TO_UTF8( msg ) );
 
     const TITLE_BLOCK&  tb = aFrame->GetTitleBlock();
 
     msg = wxT( "REVISION \"" ) + tb.GetRevision() + wxT( " " ) + tb.GetDate() + wxT( "\"\n" );
 
-    fputs( TO_UTF8( msg ), aFile );
-    fputs( "UNITS INCH\n", aFile );
+    aFile.Text( TO_UTF8( msg ) );
+    aFile.Text( "UNITS INCH\n" );
 
     msg.Printf( wxT( "ORIGIN %g %g\n" ),
                 MapXTo( aFrame->GetAuxOrigin().x ),
                 MapYTo( aFrame->GetAuxOrigin().y ) );
-    fputs( TO_UTF8( msg ), aFile );
+    aFile.Text( TO_UTF8( msg ) );
 
-    fputs( "INTERTRACK 0\n", aFile );
-    fputs( "$ENDHEADER\n\n", aFile );
+    aFile.Text( "INTERTRACK 0\n" );
+    aFile.Text( "$ENDHEADER\n\n" );
 
     return true;
 }
@@ -888,7 +893,7 @@ static int TrackListSortByNetcode( const void* refptr, const void* objptr )
  *  $ENROUTE
  *  Track segments must be sorted by nets
  */
-static void CreateRoutesSection( FILE* aFile, BOARD* aPcb )
+static void CreateRoutesSection( RECORD_WRITER& aFile, BOARD* aPcb )
 {
     TRACK*  track, ** tracklist;
     int     vianum = 1;
@@ -927,7 +932,7 @@ static void CreateRoutesSection( FILE* aFile, BOARD* aPcb )
 
     qsort( tracklist, nbitems, sizeof(TRACK*), TrackListSortByNetcode );
 
-    fputs( "$ROUTES\n", aFile );
+    aFile.Text( "$ROUTES\n" );
 
     old_netcode = -1; old_width = -1; old_layer = -1;
 
@@ -946,13 +951,13 @@ static void CreateRoutesSection( FILE* aFile, BOARD* aPcb )
             else
                 netname = wxT( "_noname_" );
 
-            fprintf( aFile, "ROUTE %s\n", TO_UTF8( netname ) );
+            aFile.Print( "ROUTE %s\n", TO_UTF8( netname ) );
         }
 
         if( old_width != track->GetWidth() )
         {
             old_width = track->GetWidth();
-            fprintf( aFile, "TRACK TRACK%d\n", track->GetWidth() );
+            aFile.Print( "TRACK TRACK%d\n", track->GetWidth() );
         }
 
         if( (track->Type() == PCB_TRACE_T) || (track->Type() == PCB_ZONE_T) )
@@ -960,14 +965,14 @@ static void CreateRoutesSection( FILE* aFile, BOARD* aPcb )
             if( old_layer != track->GetLayer() )
             {
                 old_layer = track->GetLayer();
-                fprintf( aFile, "LAYER %s\n",
-                        GenCADLayerName( cu_count, track->GetLayer() ).c_str()
-                        );
+                aFile.Print( "LAYER %s\n",
+                            GenCADLayerName( cu_count, track->GetLayer() ).c_str()
+                            );
             }
 
-            fprintf( aFile, "LINE %g %g %g %g\n",
-                    MapXTo( track->GetStart().x ), MapYTo( track->GetStart().y ),
-                    MapXTo( track->GetEnd().x ), MapYTo( track->GetEnd().y ) );
+            aFile.Print( "LINE %g %g %g %g\n",
+                        MapXTo( track->GetStart().x ), MapYTo( track->GetStart().y ),
+                        MapXTo( track->GetEnd().x ), MapYTo( track->GetEnd().y ) );
         }
 
         if( track->Type() == PCB_VIA_T )
@@ -976,15 +981,15 @@ static void CreateRoutesSection( FILE* aFile, BOARD* aPcb )
 
             LSET vset = via->GetLayerSet() & master_layermask;
 
-            fprintf( aFile, "VIA VIA%d.%d.%s %g %g ALL %g via%d\n",
-                     via->GetWidth(), via->GetDrillValue(),
-                     fmt_mask( vset ).c_str(),
-                     MapXTo( via->GetStart().x ), MapYTo( via->GetStart().y ),
-                     via->GetDrillValue() / SCALE_FACTOR, vianum++ );
+            aFile.Print( "VIA VIA%d.%d.%s %g %g ALL %g via%d\n",
+                         via->GetWidth(), via->GetDrillValue(),
+                         fmt_mask( vset ).c_str(),
+                         MapXTo( via->GetStart().x ), MapYTo( via->GetStart().y ),
+                         via->GetDrillValue() / SCALE_FACTOR, vianum++ );
         }
     }
 
-    fputs( "$ENDROUTES\n\n", aFile );
+    aFile.Text( "$ENDROUTES\n\n" );
 
     delete tracklist;
 }
@@ -994,17 +999,17 @@ static void CreateRoutesSection( FILE* aFile, BOARD* aPcb )
  * This is a list of footprints properties
  *  ( Shapes are in section $SHAPE )
  */
-static void CreateDevicesSection( FILE* aFile, BOARD* aPcb )
+static void CreateDevicesSection( RECORD_WRITER& aFile, BOARD* aPcb )
 {
     MODULE* module;
 
-    fputs( "$DEVICES\n", aFile );
+    aFile.Text( "$DEVICES\n" );
 
     for( module = aPcb->m_Modules; module; module = module->Next() )
     {
-        fprintf( aFile, "DEVICE \"%s\"\n", TO_UTF8( module->GetReference() ) );
-        fprintf( aFile, "PART \"%s\"\n", TO_UTF8( module->GetValue() ) );
-        fprintf( aFile, "PACKAGE \"%s\"\n", module->GetFPID().Format().c_str() );
+        aFile.Print( "DEVICE \"%s\"\n", TO_UTF8( module->GetReference() ) );
+        aFile.Print( "PART \"%s\"\n", TO_UTF8( module->GetValue() ) );
+        aFile.Print( "PACKAGE \"%s\"\n", module->GetFPID().Format().c_str() );
 
         // The TYPE attribute is almost freeform
         const char* ty = "TH";
@@ -1015,19 +1020,19 @@ static void CreateDevicesSection( FILE* aFile, BOARD* aPcb )
         if( module->GetAttributes() & MOD_VIRTUAL )
             ty = "VIRTUAL";
 
-        fprintf( aFile, "TYPE %s\n", ty );
+        aFile.Print( "TYPE %s\n", ty );
     }
 
-    fputs( "$ENDDEVICES\n\n", aFile );
+    aFile.Text( "$ENDDEVICES\n\n" );
 }
 
 
 /* Creates the section $BOARD.
  *  We output here only the board perimeter
  */
-static void CreateBoardSection( FILE* aFile, BOARD* aPcb )
+static void CreateBoardSection( RECORD_WRITER& aFile, BOARD* aPcb )
 {
-    fputs( "$BOARD\n", aFile );
+    aFile.Text( "$BOARD\n" );
 
     // Extract the board edges
     for( EDA_ITEM* drawing = aPcb->m_Drawings; drawing != 0;
@@ -1039,14 +1044,14 @@ static void CreateBoardSection( FILE* aFile, BOARD* aPcb )
             if( drawseg->GetLayer() == Edge_Cuts )
             {
                 // XXX GenCAD supports arc boundaries but I've seen nothing that reads them
-                fprintf( aFile, "LINE %g %g %g %g\n",
-                         MapXTo( drawseg->GetStart().x ), MapYTo( drawseg->GetStart().y ),
-                         MapXTo( drawseg->GetEnd().x ), MapYTo( drawseg->GetEnd().y ) );
+                aFile.Print( "LINE %g %g %g %g\n",
+                             MapXTo( drawseg->GetStart().x ), MapYTo( drawseg->GetStart().y ),
+                             MapXTo( drawseg->GetEnd().x ), MapYTo( drawseg->GetEnd().y ) );
             }
         }
     }
 
-    fputs( "$ENDBOARD\n\n", aFile );
+    aFile.Text( "$ENDBOARD\n\n" );
 }
 
 
@@ -1060,7 +1065,7 @@ static void CreateBoardSection( FILE* aFile, BOARD* aPcb )
  *  Each tool name is build like this: "TRACK" + track width.
  *  For instance for a width = 120 : name = "TRACK120".
  */
-static void CreateTracksInfoData( FILE* aFile, BOARD* aPcb )
+static void CreateTracksInfoData( RECORD_WRITER& aFile, BOARD* aPcb )
 {
     TRACK* track;
     int    last_width = -1;
@@ -1107,15 +1112,15 @@ static void CreateTracksInfoData( FILE* aFile, BOARD* aPcb )
     }
 
     // Write data
-    fputs( "$TRACKS\n", aFile );
+    aFile.Text( "$TRACKS\n" );
 
     for( ii = 0; ii < trackinfo.size(); ii++ )
     {
-        fprintf( aFile, "TRACK TRACK%d %g\n", trackinfo[ii],
-                 trackinfo[ii] / SCALE_FACTOR );
+        aFile.Print( "TRACK TRACK%d %g\n", trackinfo[ii],
+                     trackinfo[ii] / SCALE_FACTOR );
     }
 
-    fputs( "$ENDTRACKS\n\n", aFile );
+    aFile.Text( "$ENDTRACKS\n\n" );
 }
 
 
@@ -1124,7 +1129,7 @@ static void CreateTracksInfoData( FILE* aFile, BOARD* aPcb )
  * It's almost guaranteed that the silk layer will be imported wrong but
  * the shape also contains the pads!
  */
-static void FootprintWriteShape( FILE* aFile, MODULE* module )
+static void FootprintWriteShape( RECORD_WRITER& aFile, MODULE* module )
 {
     EDGE_MODULE* PtEdge;
     EDA_ITEM*    PtStruct;
@@ -1137,21 +1142,21 @@ static void FootprintWriteShape( FILE* aFile, MODULE* module )
         Yaxis_sign = 1;
 
     /* creates header: */
-    fprintf( aFile, "\nSHAPE %s\n", TO_UTF8( module->GetReference() ) );
+    aFile.Print( "\nSHAPE %s\n", TO_UTF8( module->GetReference() ) );
 
     if( module->GetAttributes() & MOD_VIRTUAL )
     {
-        fprintf( aFile, "INSERT SMD\n" );
+        aFile.Text( "INSERT SMD\n" );
     }
     else
     {
         if( module->GetAttributes() & MOD_CMS )
         {
-            fprintf( aFile, "INSERT SMD\n" );
+            aFile.Text( "INSERT SMD\n" );
         }
         else
         {
-            fprintf( aFile, "INSERT TH\n" );
+            aFile.Text( "INSERT TH\n" );
         }
     }
 
@@ -1160,15 +1165,15 @@ static void FootprintWriteShape( FILE* aFile, MODULE* module )
 
     if( module->m_Attributs != MOD_DEFAULT )
     {
-        fprintf( aFile, "ATTRIBUTE" );
+        aFile.Text( "ATTRIBUTE" );
 
         if( module->m_Attributs & MOD_CMS )
-            fprintf( aFile, " PAD_SMD" );
+            aFile.Text( " PAD_SMD" );
 
         if( module->m_Attributs & MOD_VIRTUAL )
-            fprintf( aFile, " VIRTUAL" );
+            aFile.Text( " VIRTUAL" );
 
-        fprintf( aFile, "\n" );
+        aFile.Text( "\n" );
     }
 #endif
 
@@ -1193,21 +1198,21 @@ static void FootprintWriteShape( FILE* aFile, MODULE* module )
                 switch( PtEdge->GetShape() )
                 {
                 case S_SEGMENT:
-                    fprintf( aFile, "LINE %g %g %g %g\n",
-                             (PtEdge->m_Start0.x) / SCALE_FACTOR,
-                             (Yaxis_sign * PtEdge->m_Start0.y) / SCALE_FACTOR,
-                             (PtEdge->m_End0.x) / SCALE_FACTOR,
-                             (Yaxis_sign * PtEdge->m_End0.y ) / SCALE_FACTOR );
+                    aFile.Print( "LINE %g %g %g %g\n",
+                                 (PtEdge->m_Start0.x) / SCALE_FACTOR,
+                                 (Yaxis_sign * PtEdge->m_Start0.y) / SCALE_FACTOR,
+                                 (PtEdge->m_End0.x) / SCALE_FACTOR,
+                                 (Yaxis_sign * PtEdge->m_End0.y ) / SCALE_FACTOR );
                     break;
 
                 case S_CIRCLE:
                 {
                     int radius = KiROUND( GetLineLength( PtEdge->m_End0,
                                                          PtEdge->m_Start0 ) );
-                    fprintf( aFile, "CIRCLE %g %g %g\n",
-                             PtEdge->m_Start0.x / SCALE_FACTOR,
-                             Yaxis_sign * PtEdge->m_Start0.y / SCALE_FACTOR,
-                             radius / SCALE_FACTOR );
+                    aFile.Print( "CIRCLE %g %g %g\n",
+                                 PtEdge->m_Start0.x / SCALE_FACTOR,
+                                 Yaxis_sign * PtEdge->m_Start0.y / SCALE_FACTOR,
+                                 radius / SCALE_FACTOR );
                     break;
                 }
 
@@ -1222,23 +1227,23 @@ static void FootprintWriteShape( FILE* aFile, MODULE* module )
                     if( Yaxis_sign == -1 )
                     {
                         // Flipping Y flips the arc direction too
-                        fprintf( aFile, "ARC %g %g %g %g %g %g\n",
-                                 (arcendx) / SCALE_FACTOR,
-                                 (Yaxis_sign * arcendy) / SCALE_FACTOR,
-                                 (PtEdge->m_End0.x) / SCALE_FACTOR,
-                                 (Yaxis_sign * PtEdge->GetEnd0().y) / SCALE_FACTOR,
-                                 (PtEdge->GetStart0().x) / SCALE_FACTOR,
-                                 (Yaxis_sign * PtEdge->GetStart0().y) / SCALE_FACTOR );
+                        aFile.Print( "ARC %g %g %g %g %g %g\n",
+                                     (arcendx) / SCALE_FACTOR,
+                                     (Yaxis_sign * arcendy) / SCALE_FACTOR,
+                                     (PtEdge->m_End0.x) / SCALE_FACTOR,
+                                     (Yaxis_sign * PtEdge->GetEnd0().y) / SCALE_FACTOR,
+                                     (PtEdge->GetStart0().x) / SCALE_FACTOR,
+                                     (Yaxis_sign * PtEdge->GetStart0().y) / SCALE_FACTOR );
                     }
                     else
                     {
-                        fprintf( aFile, "ARC %g %g %g %g %g %g\n",
-                                 (PtEdge->GetEnd0().x) / SCALE_FACTOR,
-                                 (Yaxis_sign * PtEdge->GetEnd0().y) / SCALE_FACTOR,
-                                 (arcendx) / SCALE_FACTOR,
-                                 (Yaxis_sign * arcendy) / SCALE_FACTOR,
-                                 (PtEdge->GetStart0().x) / SCALE_FACTOR,
-                                 (Yaxis_sign * PtEdge->GetStart0().y) / SCALE_FACTOR );
+                        aFile.Print( "ARC %g %g %g %g %g %g\n",
+                                     (PtEdge->GetEnd0().x) / SCALE_FACTOR,
+                                     (Yaxis_sign * PtEdge->GetEnd0().y) / SCALE_FACTOR,
+                                     (arcendx) / SCALE_FACTOR,
+                                     (Yaxis_sign * arcendy) / SCALE_FACTOR,
+                                     (PtEdge->GetStart0().x) / SCALE_FACTOR,
+                                     (Yaxis_sign * PtEdge->GetStart0().y) / SCALE_FACTOR );
                     }
                     break;
                 }
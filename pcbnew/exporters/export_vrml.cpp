@@ -50,9 +50,14 @@
 #include "../3d-viewer/modelparsers.h"
 
 #include <vector>
+#include <map>
+#include <algorithm>
 #include <cmath>
 #include <vrml_layer.h>
 
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
 // minimum width (mm) of a VRML line
 #define MIN_VRML_LINEWIDTH 0.12
 
@@ -128,11 +133,22 @@ enum VRML_COLOR_INDEX
 };
 
 
+// names of the shared Appearance nodes, by VRML_COLOR_INDEX
+static const char* appearance_names[VRML_COLOR_LAST] =
+{
+    "PCB_APPEARANCE",
+    "TRACK_APPEARANCE",
+    "SILK_APPEARANCE",
+    "TIN_APPEARANCE"
+};
+
+
 class MODEL_VRML
 {
 private:
     double      layer_z[LAYER_ID_COUNT];
     VRML_COLOR  colors[VRML_COLOR_LAST];
+    bool        colorDefined[VRML_COLOR_LAST];  // true once the Appearance node is written
 
     int         iMaxSeg;                    // max. sides to a small circle
     double      arcMinLen, arcMaxLen;       // min and max lengths of an arc chord
@@ -162,11 +178,18 @@ public:
     LAYER_NUM s_text_layer;
     int s_text_width;
 
+    // DEF number of the Inline node of each 3D model file already written,
+    // by full file name; the next footprints using the file USE that node
+    std::map<wxString, int> inlineIds;
+
     MODEL_VRML()
     {
         for( unsigned i = 0; i < DIM( layer_z );  ++i )
             layer_z[i] = 0;
 
+        for( unsigned i = 0; i < DIM( colorDefined );  ++i )
+            colorDefined[i] = false;
+
         holes.GetArcParams( iMaxSeg, arcMinLen, arcMaxLen );
 
         // this default only makes sense if the output is in mm
@@ -197,6 +220,20 @@ public:
         return colors[aIndex];
     }
 
+    /**
+     * Function DefineColor
+     * returns true the first time it is called for \a aIndex, when the Appearance
+     * node of this color must be written in full; it is then referred to by USE.
+     */
+    bool DefineColor( VRML_COLOR_INDEX aIndex )
+    {
+        if( colorDefined[aIndex] )
+            return false;
+
+        colorDefined[aIndex] = true;
+        return true;
+    }
+
     void SetOffset( double aXoff, double aYoff )
     {
         tx = aXoff;
@@ -300,7 +337,8 @@ static bool GetLayer( MODEL_VRML& aModel, LAYER_NUM layer, VRML_LAYER** vlayer )
 }
 
 
-static void write_triangle_bag( std::ofstream& output_file, VRML_COLOR& color,
+static void write_triangle_bag( std::ofstream& output_file, MODEL_VRML& aModel,
+                                VRML_COLOR_INDEX colorIdx,
                                 VRML_LAYER* layer, bool plane, bool top,
                                 double top_z, double bottom_z, int aPrecision )
 {
@@ -313,11 +351,7 @@ static void write_triangle_bag( std::ofstream& output_file, VRML_COLOR& color,
         "    Group {\n",
         "      children [\n",
         "        Shape {\n",
-        "          appearance Appearance {\n",
-        "            material Material {\n",
-        0,                                      // Material marker
-        "            }\n",
-        "          }\n",
+        0,                                      // Appearance marker
         "          geometry IndexedFaceSet {\n",
         "            solid TRUE\n",
         "            coord Coordinate {\n",
@@ -337,6 +371,7 @@ static void write_triangle_bag( std::ofstream& output_file, VRML_COLOR& color,
         0    // End marker
     };
 
+    VRML_COLOR& color = aModel.GetColor( colorIdx );
     int marker_found = 0, lineno = 0;
 
     while( marker_found < 4 )
@@ -349,7 +384,20 @@ static void write_triangle_bag( std::ofstream& output_file, VRML_COLOR& color,
 
             switch( marker_found )
             {
-            case 1:    // Material marker
+            case 1:    // Appearance marker
+                // the appearance of a color is written once, then shared by
+                // the next shapes of the same color
+                if( !aModel.DefineColor( colorIdx ) )
+                {
+                    output_file << "          appearance USE ";
+                    output_file << appearance_names[colorIdx] << "\n";
+                    break;
+                }
+
+                output_file << "          appearance DEF " << appearance_names[colorIdx];
+                output_file << " Appearance {\n";
+                output_file << "            material Material {\n";
+
                 output_file << "              diffuseColor " << std::setprecision(3);
                 output_file << color.diffuse_red << " ";
                 output_file << color.diffuse_grn << " ";
@@ -368,6 +416,8 @@ static void write_triangle_bag( std::ofstream& output_file, VRML_COLOR& color,
                 output_file << "              ambientIntensity " << color.ambient << "\n";
                 output_file << "              transparency " << color.transp << "\n";
                 output_file << "              shininess " << color.shiny << "\n";
+                output_file << "            }\n";
+                output_file << "          }\n";
                 break;
 
             case 2:
@@ -400,61 +450,121 @@ static void write_triangle_bag( std::ofstream& output_file, VRML_COLOR& color,
 }
 
 
+// a layer to tesselate, and the holes to cut from it
+struct LAYER_TESS_JOB
+{
+    VRML_LAYER* m_Layer;
+    VRML_LAYER* m_Holes;
+    bool        m_HolesOnly;
+
+    LAYER_TESS_JOB( VRML_LAYER* aLayer, VRML_LAYER* aHoles, bool aHolesOnly = false ) :
+        m_Layer( aLayer ), m_Holes( aHoles ), m_HolesOnly( aHolesOnly )
+    {
+    }
+};
+
+
+// tesselate the jobs aFirst, aFirst + aStep, ...; each layer has its own
+// GLU tesselator, so the layers are tesselated independently by several threads
+static void tesselateLayers( std::vector<LAYER_TESS_JOB>* aJobs, unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aJobs->size(); ii += aStep )
+    {
+        LAYER_TESS_JOB& job = (*aJobs)[ii];
+        job.m_Layer->Tesselate( job.m_Holes, job.m_HolesOnly );
+    }
+}
+
+
 static void write_layers( MODEL_VRML& aModel, std::ofstream& output_file, BOARD* aPcb )
 {
+    std::vector<LAYER_TESS_JOB> jobs;
+
+    // VRML_LAYER::Tesselate() renumbers the vertices of the holes it is given, and the
+    // layer is written with this numbering: each layer but the board gets its own copy.
+    boost::ptr_vector<VRML_LAYER> holes;
+
+    jobs.push_back( LAYER_TESS_JOB( &aModel.board, &aModel.holes ) );
+
+    if( !aModel.plainPCB )
+    {
+        VRML_LAYER* layers[] =
+        {
+            &aModel.top_copper, &aModel.top_tin, &aModel.bot_copper, &aModel.bot_tin,
+            &aModel.top_silk, &aModel.bot_silk
+        };
+
+        for( unsigned ii = 0; ii < DIM( layers ); ++ii )
+        {
+            holes.push_back( new VRML_LAYER );
+            holes.back().CopyContours( aModel.holes );
+            jobs.push_back( LAYER_TESS_JOB( layers[ii], &holes.back() ) );
+        }
+
+        jobs.push_back( LAYER_TESS_JOB( &aModel.plated_holes, NULL, true ) );
+    }
+
+    unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+    threadCount = std::min( threadCount, (unsigned) jobs.size() );
+
+    // Something which will not invoke a thread copy constructor
+    typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+    MYTHREADS threads;
+
+    for( unsigned ii = 1; ii < threadCount; ii++ )
+        threads.push_back( new boost::thread( &tesselateLayers, &jobs, ii, threadCount ) );
+
+    tesselateLayers( &jobs, 0, threadCount );
+
+    for( unsigned ii = 0; ii < threads.size(); ++ii )
+        threads[ii].join();
+
     // VRML_LAYER board;
-    aModel.board.Tesselate( &aModel.holes );
     double brdz = aModel.board_thickness / 2.0
                   - ( Millimeter2iu( ART_OFFSET / 2.0 ) ) * aModel.scale;
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_PCB ),
+    write_triangle_bag( output_file, aModel, VRML_COLOR_PCB,
                         &aModel.board, false, false, brdz, -brdz, aModel.precision );
 
     if( aModel.plainPCB )
         return;
 
     // VRML_LAYER top_copper;
-    aModel.top_copper.Tesselate( &aModel.holes );
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_TRACK ),
+    write_triangle_bag( output_file, aModel, VRML_COLOR_TRACK,
                         &aModel.top_copper, true, true,
                         aModel.GetLayerZ( F_Cu ), 0, aModel.precision );
 
     // VRML_LAYER top_tin;
-    aModel.top_tin.Tesselate( &aModel.holes );
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_TIN ),
+    write_triangle_bag( output_file, aModel, VRML_COLOR_TIN,
                         &aModel.top_tin, true, true,
                         aModel.GetLayerZ( F_Cu ) + Millimeter2iu( ART_OFFSET / 2.0 ) * aModel.scale,
                         0, aModel.precision );
 
     // VRML_LAYER bot_copper;
-    aModel.bot_copper.Tesselate( &aModel.holes );
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_TRACK ),
+    write_triangle_bag( output_file, aModel, VRML_COLOR_TRACK,
                         &aModel.bot_copper, true, false,
                         aModel.GetLayerZ( B_Cu ), 0, aModel.precision );
 
     // VRML_LAYER bot_tin;
-    aModel.bot_tin.Tesselate( &aModel.holes );
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_TIN ),
+    write_triangle_bag( output_file, aModel, VRML_COLOR_TIN,
                         &aModel.bot_tin, true, false,
                         aModel.GetLayerZ( B_Cu )
                         - Millimeter2iu( ART_OFFSET / 2.0 ) * aModel.scale,
                         0, aModel.precision );
 
     // VRML_LAYER PTH;
-    aModel.plated_holes.Tesselate( NULL, true );
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_TIN ),
+    write_triangle_bag( output_file, aModel, VRML_COLOR_TIN,
                         &aModel.plated_holes, false, false,
                         aModel.GetLayerZ( F_Cu ) + Millimeter2iu( ART_OFFSET / 2.0 ) * aModel.scale,
                         aModel.GetLayerZ( B_Cu ) - Millimeter2iu( ART_OFFSET / 2.0 ) * aModel.scale,
                         aModel.precision );
 
     // VRML_LAYER top_silk;
-    aModel.top_silk.Tesselate( &aModel.holes );
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_SILK ), &aModel.top_silk,
+    write_triangle_bag( output_file, aModel, VRML_COLOR_SILK, &aModel.top_silk,
                         true, true, aModel.GetLayerZ( F_SilkS ), 0, aModel.precision );
 
     // VRML_LAYER bot_silk;
-    aModel.bot_silk.Tesselate( &aModel.holes );
-    write_triangle_bag( output_file, aModel.GetColor( VRML_COLOR_SILK ), &aModel.bot_silk,
+    write_triangle_bag( output_file, aModel, VRML_COLOR_SILK, &aModel.bot_silk,
                         true, false, aModel.GetLayerZ( B_SilkS ), 0, aModel.precision );
 }
 
@@ -616,7 +726,7 @@ static void export_vrml_drawsegment( MODEL_VRML& aModel, DRAWSEGMENT* drawseg )
 
 /* C++ doesn't have closures and neither continuation forms... this is
  * for coupling the vrml_text_callback with the common parameters */
-static void vrml_text_callback( int x0, int y0, int xf, int yf )
+static void vrml_text_callback( int x0, int y0, int xf, int yf, void* aData )
 {
     LAYER_NUM s_text_layer = model_vrml->s_text_layer;
     int s_text_width = model_vrml->s_text_width;
@@ -1206,10 +1316,17 @@ static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb, MODULE* aModule
         wxFileName modelFileName = vrmlm->GetShape3DFullFilename();
         wxFileName destFileName( a3D_Subdir, modelFileName.GetName(), modelFileName.GetExt() );
 
+        // A model already written by a previous footprint is neither checked nor
+        // copied again, and its Inline node is shared
+        std::map<wxString, int>::const_iterator inlined =
+            aModel.inlineIds.find( modelFileName.GetFullPath() );
+
+        bool known = inlined != aModel.inlineIds.end();
+
         // Only copy VRML files.
-        if( modelFileName.FileExists() && modelFileName.GetExt() == wxT( "wrl" ) )
+        if( known || ( modelFileName.FileExists() && modelFileName.GetExt() == wxT( "wrl" ) ) )
         {
-            if( aExport3DFiles )
+            if( aExport3DFiles && !known )
             {
                 wxDateTime srcModTime = modelFileName.GetModificationTime();
                 wxDateTime destModTime = srcModTime;
@@ -1295,7 +1412,20 @@ static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb, MODULE* aModule
             aOutputFile << ( vrmlm->m_MatScale.x * aVRMLModelsToBiu ) << " ";
             aOutputFile << ( vrmlm->m_MatScale.y * aVRMLModelsToBiu ) << " ";
             aOutputFile << ( vrmlm->m_MatScale.z * aVRMLModelsToBiu ) << "\n";
-            aOutputFile << "  children [\n    Inline {\n      url \"";
+            aOutputFile << "  children [\n";
+
+            if( known )
+            {
+                aOutputFile << "    USE MODEL_" << inlined->second << " ]\n";
+                aOutputFile << "  }\n";
+                continue;
+            }
+
+            int inlineId = aModel.inlineIds.size();
+
+            aModel.inlineIds[ modelFileName.GetFullPath() ] = inlineId;
+
+            aOutputFile << "    DEF MODEL_" << inlineId << " Inline {\n      url \"";
 
             if( aUseRelativePaths )
             {
@@ -39,6 +39,7 @@
 #include <build_version.h>
 #include <macros.h>
 #include <reporter.h>
+#include <record_writer.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -344,7 +345,7 @@ static const char unit_text_mm[] = "## Unit = mm, Angle = deg.\n";
 
 static wxPoint File_Place_Offset;  // Offset coordinates for generated file.
 
-static void WriteDrawSegmentPcb( DRAWSEGMENT* PtDrawSegment, FILE* rptfile,
+static void WriteDrawSegmentPcb( DRAWSEGMENT* PtDrawSegment, RECORD_WRITER& rptfile,
                                  double aConvUnit );
 
 
@@ -397,7 +398,6 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
                                                  bool aForceSmdItems, int aSide )
 {
     MODULE*     module;
-    char        line[1024];
 
     File_Place_Offset = GetAuxOrigin();
 
@@ -489,29 +489,28 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
     // Switch the locale to standard C (needed to print floating point numbers)
     LOCALE_IO   toggle;
 
+    RECORD_WRITER out( file );
+
     // Write file header
-    sprintf( line, "### Module positions - created on %s ###\n", TO_UTF8( DateAndTime() ) );
-    fputs( line, file );
+    out.Print( "### Module positions - created on %s ###\n", TO_UTF8( DateAndTime() ) );
 
     wxString Title = Pgm().App().GetAppName() + wxT( " " ) + GetBuildVersion();
-    sprintf( line, "### Printed by Pcbnew version %s\n", TO_UTF8( Title ) );
-    fputs( line, file );
+    out.Print( "### Printed by Pcbnew version %s\n", TO_UTF8( Title ) );
 
-    fputs( unit_text, file );
+    out.Text( unit_text );
 
-    fputs( "## Side : ", file );
+    out.Text( "## Side : " );
 
     if( aSide == 0 )
-        fputs( TO_UTF8( backSideName ), file );
+        out.Text( TO_UTF8( backSideName ) );
     else if( aSide == 1 )
-        fputs( TO_UTF8( frontSideName ), file );
+        out.Text( TO_UTF8( frontSideName ) );
     else
-        fputs( "All", file );
+        out.Text( "All" );
 
-    fputs( "\n", file );
+    out.Text( "\n" );
 
-    fputs( "# Ref    Val                  Package         PosX       PosY        Rot     Side\n",
-           file );
+    out.Text( "# Ref    Val                  Package         PosX       PosY        Rot     Side\n" );
 
     for( int ii = 0; ii < moduleCount; ii++ )
     {
@@ -521,37 +520,35 @@ int PCB_EDIT_FRAME::DoGenFootprintsPositionFile( const wxString& aFullFileName,
         const wxString& val = list[ii].m_Value;
         const wxString& pkg = list[ii].m_Module->GetFPID().GetFootprintName();
 
-        sprintf( line, "%-8.8s %-16.16s %-16.16s",
-                 TO_UTF8( ref ), TO_UTF8( val ), TO_UTF8( pkg ) );
+        out.Print( "%-8.8s %-16.16s %-16.16s",
+                   TO_UTF8( ref ), TO_UTF8( val ), TO_UTF8( pkg ) );
 
         module_pos  = list[ii].m_Module->GetPosition();
         module_pos -= File_Place_Offset;
 
-        char* text = line + strlen( line );
         /* Keep the coordinates in the first quadrant, like the gerbers
          * (i.e. change sign to y) */
-        sprintf( text, " %9.4f  %9.4f  %8.1f    ",
-                 module_pos.x * conv_unit,
-                 -module_pos.y * conv_unit,
-                 list[ii].m_Module->GetOrientation() / 10.0 );
+        out.Print( " %9.4f  %9.4f  %8.1f    ",
+                   module_pos.x * conv_unit,
+                   -module_pos.y * conv_unit,
+                   list[ii].m_Module->GetOrientation() / 10.0 );
 
         LAYER_NUM layer = list[ii].m_Module->GetLayer();
 
-        fputs( line, file );
-
         wxASSERT( layer==F_Cu || layer==B_Cu );
 
         if( layer == F_Cu )
-            fputs( TO_UTF8( frontSideName ), file );
+            out.Text( TO_UTF8( frontSideName ) );
         else if( layer == B_Cu )
-            fputs( TO_UTF8( backSideName ), file );
+            out.Text( TO_UTF8( backSideName ) );
 
-        fputs( "\n", file );
+        out.Text( "\n" );
     }
 
     // Write EOF
-    fputs( "## End\n", file );
+    out.Text( "## End\n" );
 
+    out.Flush();
     fclose( file );
     return moduleCount;
 }
@@ -593,7 +590,6 @@ void PCB_EDIT_FRAME::GenFootprintsReport( wxCommandEvent& event )
 bool PCB_EDIT_FRAME::DoGenFootprintsReport( const wxString& aFullFilename, bool aUnitsMM )
 {
     D_PAD*   pad;
-    char     line[1024];
     wxString msg;
     FILE*    rptfile;
     wxPoint  module_pos;
@@ -611,35 +607,32 @@ bool PCB_EDIT_FRAME::DoGenFootprintsReport( const wxString& aFullFilename, bool
 
     LOCALE_IO   toggle;
 
+    RECORD_WRITER out( rptfile );
+
     // Generate header file comments.)
-    sprintf( line, "## Module report - date %s\n", TO_UTF8( DateAndTime() ) );
-    fputs( line, rptfile );
+    out.Print( "## Module report - date %s\n", TO_UTF8( DateAndTime() ) );
 
     wxString Title = Pgm().App().GetAppName() + wxT( " " ) + GetBuildVersion();
-    sprintf( line, "## Created by Pcbnew version %s\n", TO_UTF8( Title ) );
-    fputs( line, rptfile );
-    fputs( unit_text, rptfile );
+    out.Print( "## Created by Pcbnew version %s\n", TO_UTF8( Title ) );
+    out.Text( unit_text );
 
-    fputs( "##\n", rptfile );
-    fputs( "\n$BeginDESCRIPTION\n", rptfile );
+    out.Text( "##\n" );
+    out.Text( "\n$BeginDESCRIPTION\n" );
 
     EDA_RECT bbbox = GetBoard()->ComputeBoundingBox();
 
-    fputs( "\n$BOARD\n", rptfile );
-    fputs( "unit INCH\n", rptfile );
+    out.Text( "\n$BOARD\n" );
+    out.Text( "unit INCH\n" );
 
-    sprintf( line, "upper_left_corner %9.6f %9.6f\n",
-             bbbox.GetX() * conv_unit,
-             bbbox.GetY() * conv_unit );
+    out.Print( "upper_left_corner %9.6f %9.6f\n",
+               bbbox.GetX() * conv_unit,
+               bbbox.GetY() * conv_unit );
 
-    fputs( line, rptfile );
+    out.Print( "lower_right_corner %9.6f %9.6f\n",
+               bbbox.GetRight()  * conv_unit,
+               bbbox.GetBottom() * conv_unit );
 
-    sprintf( line, "lower_right_corner %9.6f %9.6f\n",
-             bbbox.GetRight()  * conv_unit,
-             bbbox.GetBottom() * conv_unit );
-    fputs( line, rptfile );
-
-    fputs( "$EndBOARD\n\n", rptfile );
+    out.Text( "$EndBOARD\n\n" );
 
     try
     {
@@ -651,16 +644,12 @@ bool PCB_EDIT_FRAME::DoGenFootprintsReport( const wxString& aFullFilename, bool
 
         for( MODULE* Module = GetBoard()->m_Modules;  Module;  Module = Module->Next() )
         {
-            sprintf( line, "$MODULE %s\n", EscapedUTF8( Module->GetReference() ).c_str() );
-            fputs( line, rptfile );
+            out.Print( "$MODULE %s\n", EscapedUTF8( Module->GetReference() ).c_str() );
 
-            sprintf( line, "reference %s\n", EscapedUTF8( Module->GetReference() ).c_str() );
-            fputs( line, rptfile );
-            sprintf( line, "value %s\n", EscapedUTF8( Module->GetValue() ).c_str() );
-            fputs( line, rptfile );
-            sprintf( line, "footprint %s\n",
-                     EscapedUTF8( FROM_UTF8( Module->GetFPID().Format().c_str() ) ).c_str() );
-            fputs( line, rptfile );
+            out.Print( "reference %s\n", EscapedUTF8( Module->GetReference() ).c_str() );
+            out.Print( "value %s\n", EscapedUTF8( Module->GetValue() ).c_str() );
+            out.Print( "footprint %s\n",
+                       EscapedUTF8( FROM_UTF8( Module->GetFPID().Format().c_str() ) ).c_str() );
 
             msg = wxT( "attribut" );
 
@@ -674,59 +663,52 @@ bool PCB_EDIT_FRAME::DoGenFootprintsReport( const wxString& aFullFilename, bool
                 msg += wxT( " none" );
 
             msg += wxT( "\n" );
-            fputs( TO_UTF8( msg ), rptfile );
+            out.Text( TO_UTF8( msg ) );
 
             module_pos    = Module->GetPosition();
             module_pos.x -= File_Place_Offset.x;
             module_pos.y -= File_Place_Offset.y;
 
-            sprintf( line, "position %9.6f %9.6f\n",
-                     module_pos.x * conv_unit,
-                     module_pos.y * conv_unit );
-            fputs( line, rptfile );
+            out.Print( "position %9.6f %9.6f\n",
+                       module_pos.x * conv_unit,
+                       module_pos.y * conv_unit );
 
-            sprintf( line, "orientation  %.2f\n", Module->GetOrientation() / 10.0 );
+            out.Print( "orientation  %.2f\n", Module->GetOrientation() / 10.0 );
 
             if( Module->GetLayer() == F_Cu )
-                strcat( line, "layer component\n" );
+                out.Text( "layer component\n" );
             else if( Module->GetLayer() == B_Cu )
-                strcat( line, "layer copper\n" );
+                out.Text( "layer copper\n" );
             else
-                strcat( line, "layer other\n" );
-
-            fputs( line, rptfile );
+                out.Text( "layer other\n" );
 
+            // The legacy plugin writes directly to rptfile
+            out.Flush();
             legacy->SaveModule3D( Module );
 
             for( pad = Module->Pads(); pad != NULL; pad = pad->Next() )
             {
-                fprintf( rptfile, "$PAD \"%s\"\n", TO_UTF8( pad->GetPadName() ) );
-                sprintf( line, "position %9.6f %9.6f\n",
-                         pad->GetPos0().x * conv_unit,
-                         pad->GetPos0().y * conv_unit );
-                fputs( line, rptfile );
+                out.Print( "$PAD \"%s\"\n", TO_UTF8( pad->GetPadName() ) );
+                out.Print( "position %9.6f %9.6f\n",
+                           pad->GetPos0().x * conv_unit,
+                           pad->GetPos0().y * conv_unit );
 
-                sprintf( line, "size %9.6f %9.6f\n",
-                         pad->GetSize().x * conv_unit,
-                         pad->GetSize().y * conv_unit );
-                fputs( line, rptfile );
+                out.Print( "size %9.6f %9.6f\n",
+                           pad->GetSize().x * conv_unit,
+                           pad->GetSize().y * conv_unit );
 
-                sprintf( line, "drill %9.6f\n", pad->GetDrillSize().x * conv_unit );
-                fputs( line, rptfile );
+                out.Print( "drill %9.6f\n", pad->GetDrillSize().x * conv_unit );
 
-                sprintf( line, "shape_offset %9.6f %9.6f\n",
-                         pad->GetOffset().x * conv_unit,
-                         pad->GetOffset().y * conv_unit );
-                fputs( line, rptfile );
+                out.Print( "shape_offset %9.6f %9.6f\n",
+                           pad->GetOffset().x * conv_unit,
+                           pad->GetOffset().y * conv_unit );
 
-                sprintf( line, "orientation  %.2f\n",
-                         (pad->GetOrientation() - Module->GetOrientation()) / 10.0 );
-                fputs( line, rptfile );
+                out.Print( "orientation  %.2f\n",
+                           (pad->GetOrientation() - Module->GetOrientation()) / 10.0 );
 
                 static const char* shape_name[6] = { "???", "Circ", "Rect", "Oval", "Trap", "Spec" };
 
-                sprintf( line, "Shape  %s\n", shape_name[pad->GetShape()] );
-                fputs( line, rptfile );
+                out.Print( "Shape  %s\n", shape_name[pad->GetShape()] );
 
                 int layer = 0;
 
@@ -738,12 +720,11 @@ bool PCB_EDIT_FRAME::DoGenFootprintsReport( const wxString& aFullFilename, bool
 
                 static const char* layer_name[4] = { "none", "back", "front", "both" };
 
-                sprintf( line, "Layer  %s\n", layer_name[layer] );
-                fputs( line, rptfile );
-                fprintf( rptfile, "$EndPAD\n" );
+                out.Print( "Layer  %s\n", layer_name[layer] );
+                out.Text( "$EndPAD\n" );
             }
 
-            fprintf( rptfile, "$EndMODULE  %s\n\n", TO_UTF8 (Module->GetReference() ) );
+            out.Print( "$EndMODULE  %s\n\n", TO_UTF8 (Module->GetReference() ) );
         }
     }
     catch( const IO_ERROR& ioe )
@@ -762,11 +743,12 @@ bool PCB_EDIT_FRAME::DoGenFootprintsReport( const wxString& aFullFilename, bool
         if( ( (DRAWSEGMENT*) PtStruct )->GetLayer() != Edge_Cuts )
             continue;
 
-        WriteDrawSegmentPcb( (DRAWSEGMENT*) PtStruct, rptfile, conv_unit );
+        WriteDrawSegmentPcb( (DRAWSEGMENT*) PtStruct, out, conv_unit );
     }
 
     // Generate EOF.
-    fputs( "$EndDESCRIPTION\n", rptfile );
+    out.Text( "$EndDESCRIPTION\n" );
+    out.Flush();
     fclose( rptfile );
 
     return true;
@@ -779,11 +761,10 @@ bool PCB_EDIT_FRAME::DoGenFootprintsReport( const wxString& aFullFilename, bool
  * Circle
  * Arc
  */
-void WriteDrawSegmentPcb( DRAWSEGMENT* PtDrawSegment, FILE* rptfile, double aConvUnit )
+void WriteDrawSegmentPcb( DRAWSEGMENT* PtDrawSegment, RECORD_WRITER& rptfile, double aConvUnit )
 {
     double ux0, uy0, dx, dy;
     double radius, width;
-    char   line[1024];
 
     ux0 = PtDrawSegment->GetStart().x * aConvUnit;
     uy0 = PtDrawSegment->GetStart().y * aConvUnit;
@@ -797,11 +778,11 @@ void WriteDrawSegmentPcb( DRAWSEGMENT* PtDrawSegment, FILE* rptfile, double aCon
     {
     case S_CIRCLE:
         radius = Distance( ux0, uy0, dx, dy );
-        fprintf( rptfile, "$CIRCLE \n" );
-        fprintf( rptfile, "centre %.6lf %.6lf\n", ux0, uy0 );
-        fprintf( rptfile, "radius %.6lf\n", radius );
-        fprintf( rptfile, "width %.6lf\n", width );
-        fprintf( rptfile, "$EndCIRCLE \n" );
+        rptfile.Text( "$CIRCLE \n" );
+        rptfile.Print( "centre %.6lf %.6lf\n", ux0, uy0 );
+        rptfile.Print( "radius %.6lf\n", radius );
+        rptfile.Print( "width %.6lf\n", width );
+        rptfile.Text( "$EndCIRCLE \n" );
         break;
 
     case S_ARC:
@@ -815,24 +796,23 @@ void WriteDrawSegmentPcb( DRAWSEGMENT* PtDrawSegment, FILE* rptfile, double aCon
                          PtDrawSegment->GetStart().y,
                          PtDrawSegment->GetAngle() );
 
-            fprintf( rptfile, "$ARC \n" );
-            fprintf( rptfile, "centre %.6lf %.6lf\n", ux0, uy0 );
-            fprintf( rptfile, "start %.6lf %.6lf\n",
-                     endx * aConvUnit, endy * aConvUnit );
-            fprintf( rptfile, "end %.6lf %.6lf\n", dx, dy );
-            fprintf( rptfile, "width %.6lf\n", width );
-            fprintf( rptfile, "$EndARC \n" );
+            rptfile.Text( "$ARC \n" );
+            rptfile.Print( "centre %.6lf %.6lf\n", ux0, uy0 );
+            rptfile.Print( "start %.6lf %.6lf\n",
+                           endx * aConvUnit, endy * aConvUnit );
+            rptfile.Print( "end %.6lf %.6lf\n", dx, dy );
+            rptfile.Print( "width %.6lf\n", width );
+            rptfile.Text( "$EndARC \n" );
         }
         break;
 
     default:
-        sprintf( line, "$LINE \n" );
-        fputs( line, rptfile );
+        rptfile.Text( "$LINE \n" );
 
-        fprintf( rptfile, "start %.6lf %.6lf\n", ux0, uy0 );
-        fprintf( rptfile, "end %.6lf %.6lf\n", dx, dy );
-        fprintf( rptfile, "width %.6lf\n", width );
-        fprintf( rptfile, "$EndLINE \n" );
+        rptfile.Print( "start %.6lf %.6lf\n", ux0, uy0 );
+        rptfile.Print( "end %.6lf %.6lf\n", dx, dy );
+        rptfile.Print( "width %.6lf\n", width );
+        rptfile.Text( "$EndLINE \n" );
         break;
     }
 }
@@ -37,6 +37,12 @@
 #include <fctsys.h>
 
 #include <vector>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 
 #include <plot_common.h>
 #include <trigo.h>
@@ -72,6 +78,7 @@ EXCELLON_WRITER::EXCELLON_WRITER( BOARD* aPcb )
     m_unitsDecimal    = true;
     m_mirror = false;
     m_merge_PTH_NPTH = false;
+    m_optimizeHoleOrder = false;
     m_minimalHeader = false;
     m_ShortHeader = false;
     m_mapFileFmt = PLOT_FORMAT_PDF;
@@ -79,6 +86,23 @@ EXCELLON_WRITER::EXCELLON_WRITER( BOARD* aPcb )
 }
 
 
+typedef boost::ptr_vector<EXCELLON_WRITER> EXCELLON_WRITERS;
+
+// Builds the hole lists of aWriters[aFirst], aWriters[aFirst + aStep] ..., one
+// writer per layer pair of aHoleSets.  The last one is the NPTH list if aLastIsNPTH.
+static void buildHolesLists( EXCELLON_WRITERS* aWriters,
+                             const std::vector<LAYER_PAIR>* aHoleSets, bool aLastIsNPTH,
+                             unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aWriters->size(); ii += aStep )
+    {
+        bool npth = aLastIsNPTH && ii == aWriters->size() - 1;
+
+        (*aWriters)[ii].BuildHolesList( (*aHoleSets)[ii], npth );
+    }
+}
+
+
 void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                                             bool aGenDrill, bool aGenMap,
                                             REPORTER * aReporter )
@@ -92,18 +116,44 @@ void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
     if( !m_merge_PTH_NPTH )
         hole_sets.push_back( LAYER_PAIR( F_Cu, B_Cu ) );
 
-    for( std::vector<LAYER_PAIR>::const_iterator it = hole_sets.begin();
-            it != hole_sets.end();  ++it )
+    // Each layer pair has its own copy of this writer, and its hole list is built
+    // by a worker thread: the hole lists only read the board, and they are the
+    // longest part of the job when the hole order is optimized.
+    // The files are written afterwards by this thread, because the plotters and
+    // the board bounding box calculation are not safe to use concurrently.
+    EXCELLON_WRITERS writers;
+
+    for( unsigned ii = 0; ii < hole_sets.size(); ++ii )
+        writers.push_back( new EXCELLON_WRITER( *this ) );
+
+    unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+    threadCount = std::min( threadCount, (unsigned) writers.size() );
+
+    // Something which will not invoke a thread copy constructor
+    typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+    MYTHREADS threads;
+
+    for( unsigned ii = 1; ii < threadCount; ii++ )
+        threads.push_back( new boost::thread( &buildHolesLists, &writers, &hole_sets,
+                                              !m_merge_PTH_NPTH, ii, threadCount ) );
+
+    buildHolesLists( &writers, &hole_sets, !m_merge_PTH_NPTH, 0, threadCount );
+
+    for( unsigned ii = 0; ii < threads.size(); ++ii )
+        threads[ii].join();
+
+    for( unsigned ii = 0; ii < hole_sets.size(); ++ii )
     {
-        LAYER_PAIR  pair = *it;
+        LAYER_PAIR  pair = hole_sets[ii];
         // For separate drill files, the last layer pair is the NPTH dril file.
-        bool doing_npth = m_merge_PTH_NPTH ? false : ( it == hole_sets.end() - 1 );
+        bool doing_npth = m_merge_PTH_NPTH ? false : ( ii == hole_sets.size() - 1 );
 
-        BuildHolesList( pair, doing_npth );
+        EXCELLON_WRITER& writer = writers[ii];
 
         // The file is created if it has holes, or if it is the non plated drill file
         // to be sure the NPTH file is up to date in separate files mode.
-        if( GetHolesCount() > 0 || doing_npth )
+        if( writer.GetHolesCount() > 0 || doing_npth )
         {
             fn = drillFileName( pair, doing_npth );
             fn.SetPath( aPlotDirectory );
@@ -133,7 +183,7 @@ void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                     }
                 }
 
-                CreateDrillFile( file );
+                writer.CreateDrillFile( file );
             }
 
             if( aGenMap )
@@ -142,7 +192,7 @@ void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                 wxString fullfilename = fn.GetFullPath() + wxT( "-drl_map" );
                 fullfilename << wxT(".") << GetDefaultPlotExtension( m_mapFileFmt );
 
-                bool success = GenDrillMapFile( fullfilename, m_mapFileFmt );
+                bool success = writer.GenDrillMapFile( fullfilename, m_mapFileFmt );
 
                 if( ! success )
                 {
@@ -569,6 +619,337 @@ static bool CmpHoleSettings( const HOLE_INFO& a, const HOLE_INFO& b )
 }
 
 
+static bool IsRoundHole( const HOLE_INFO& aHole )
+{
+    return aHole.m_Hole_Shape == 0;
+}
+
+
+static double holeDistance( const wxPoint& a, const wxPoint& b )
+{
+    return hypot( double( a.x ) - b.x, double( a.y ) - b.y );
+}
+
+
+/* Helper class for the hole order optimization: a grid of square cells over a set
+ * of hole positions, to find the holes nearest to a position by looking only at
+ * the cells around it.  Holes can be removed from the grid once drilled.
+ */
+class HOLE_GRID
+{
+public:
+    HOLE_GRID( const std::vector<wxPoint>& aPoints ) :
+        m_points( aPoints )
+    {
+        int xmin = INT_MAX, ymin = INT_MAX;
+        int xmax = INT_MIN, ymax = INT_MIN;
+
+        for( unsigned ii = 0; ii < aPoints.size(); ++ii )
+        {
+            xmin = std::min( xmin, aPoints[ii].x );
+            ymin = std::min( ymin, aPoints[ii].y );
+            xmax = std::max( xmax, aPoints[ii].x );
+            ymax = std::max( ymax, aPoints[ii].y );
+        }
+
+        m_xmin = xmin;
+        m_ymin = ymin;
+
+        // About one hole per cell, and no more cells than holes along an axis
+        // when the holes are aligned
+        double w = double( xmax ) - xmin;
+        double h = double( ymax ) - ymin;
+        double n = std::max( (double) aPoints.size(), 1.0 );
+
+        m_cellSize = std::max( sqrt( w * h / n ), std::max( w, h ) / n );
+        m_cellSize = std::max( m_cellSize, 1.0 );
+
+        m_cols = int( w / m_cellSize ) + 1;
+        m_rows = int( h / m_cellSize ) + 1;
+        m_cells.resize( m_cols * m_rows );
+
+        for( unsigned ii = 0; ii < aPoints.size(); ++ii )
+            m_cells[ cellRow( aPoints[ii].y ) * m_cols + cellCol( aPoints[ii].x ) ].push_back( ii );
+    }
+
+    /**
+     * Function Nearest
+     * fills aResult with the indexes of the (at most) aCount holes nearest to aPos,
+     * nearest first, excluding the hole aExclude.
+     */
+    void Nearest( const wxPoint& aPos, unsigned aCount, int aExclude,
+                  std::vector<int>& aResult ) const
+    {
+        std::vector< std::pair<double, int> > best;
+        int cx = cellCol( aPos.x );
+        int cy = cellRow( aPos.y );
+        int maxRing = std::max( m_cols, m_rows );
+
+        for( int ring = 0; ring <= maxRing; ++ring )
+        {
+            // The holes of the next rings are at least ( ring - 1 ) cells away
+            if( best.size() == aCount && ring > 1 )
+            {
+                double bound = ( ring - 1 ) * m_cellSize;
+
+                if( best.back().first <= bound * bound )
+                    break;
+            }
+
+            for( int y = cy - ring; y <= cy + ring; ++y )
+            {
+                if( y < 0 || y >= m_rows )
+                    continue;
+
+                // the whole row on the top and bottom sides, the ends elsewhere
+                int step = ( y == cy - ring || y == cy + ring ) ? 1 : std::max( 2 * ring, 1 );
+
+                for( int x = cx - ring; x <= cx + ring; x += step )
+                {
+                    if( x < 0 || x >= m_cols )
+                        continue;
+
+                    const std::vector<int>& cell = m_cells[y * m_cols + x];
+
+                    for( unsigned ii = 0; ii < cell.size(); ++ii )
+                    {
+                        if( cell[ii] == aExclude )
+                            continue;
+
+                        double dx = double( m_points[cell[ii]].x ) - aPos.x;
+                        double dy = double( m_points[cell[ii]].y ) - aPos.y;
+                        std::pair<double, int> cand( dx * dx + dy * dy, cell[ii] );
+
+                        if( best.size() == aCount && !( cand < best.back() ) )
+                            continue;
+
+                        if( best.size() == aCount )
+                            best.pop_back();
+
+                        best.insert( std::upper_bound( best.begin(), best.end(), cand ), cand );
+                    }
+                }
+            }
+        }
+
+        aResult.clear();
+
+        for( unsigned ii = 0; ii < best.size(); ++ii )
+            aResult.push_back( best[ii].second );
+    }
+
+    void Remove( int aIndex )
+    {
+        std::vector<int>& cell = m_cells[ cellRow( m_points[aIndex].y ) * m_cols
+                                          + cellCol( m_points[aIndex].x ) ];
+
+        std::vector<int>::iterator it = std::find( cell.begin(), cell.end(), aIndex );
+
+        if( it != cell.end() )
+        {
+            *it = cell.back();
+            cell.pop_back();
+        }
+    }
+
+private:
+    int cellCol( int aX ) const
+    {
+        int col = int( ( double( aX ) - m_xmin ) / m_cellSize );
+        return std::min( std::max( col, 0 ), m_cols - 1 );
+    }
+
+    int cellRow( int aY ) const
+    {
+        int row = int( ( double( aY ) - m_ymin ) / m_cellSize );
+        return std::min( std::max( row, 0 ), m_rows - 1 );
+    }
+
+    const std::vector<wxPoint>&     m_points;
+    double                          m_xmin;
+    double                          m_ymin;
+    double                          m_cellSize;
+    int                             m_cols;
+    int                             m_rows;
+    std::vector< std::vector<int> > m_cells;
+};
+
+
+/* Reorders aHoles[aFirst ... aLast - 1] to shorten the path which starts at aPosition
+ * and goes through all of them, and sets aPosition to the last hole of the path.
+ * The path is built by going to the nearest remaining hole, then improved by 2-opt
+ * moves (reversing the part of the path between two holes when it shortens the
+ * path), only tried between holes which are near neighbours.
+ */
+static void optimizeHolePath( std::vector<HOLE_INFO>& aHoles, unsigned aFirst, unsigned aLast,
+                              wxPoint& aPosition )
+{
+    if( aLast <= aFirst )
+        return;
+
+    unsigned count = aLast - aFirst;
+    std::vector<wxPoint> points( count );
+
+    for( unsigned ii = 0; ii < count; ++ii )
+        points[ii] = aHoles[aFirst + ii].m_Hole_Pos;
+
+    HOLE_GRID grid( points );
+
+    // The candidates for 2-opt moves, nearest first
+    const unsigned neighbourCount = std::min( 8u, count - 1 );
+    std::vector<int> neighbours( count * neighbourCount );
+    std::vector<int> found;
+
+    for( unsigned ii = 0; ii < count; ++ii )
+    {
+        grid.Nearest( points[ii], neighbourCount, ii, found );
+        std::copy( found.begin(), found.end(), neighbours.begin() + ii * neighbourCount );
+    }
+
+    // Nearest neighbour path
+    std::vector<int> path;
+    path.reserve( count );
+
+    wxPoint position = aPosition;
+
+    for( unsigned ii = 0; ii < count; ++ii )
+    {
+        grid.Nearest( position, 1, -1, found );
+        grid.Remove( found[0] );
+        path.push_back( found[0] );
+        position = points[found[0]];
+    }
+
+    // 2-opt moves.  The first hole, the nearest to aPosition, stays the first one.
+    std::vector<unsigned> rank( count );     // the index in path of each hole
+
+    for( unsigned ii = 0; ii < count; ++ii )
+        rank[path[ii]] = ii;
+
+    bool improved = true;
+
+    for( int pass = 0; pass < 20 && improved; ++pass )
+    {
+        improved = false;
+
+        for( unsigned i = 0; i + 1 < count; ++i )
+        {
+            // Try to replace the segment a-b by a segment from a to a near hole c
+            int     a = path[i];
+            int     b = path[i + 1];
+            double  dab = holeDistance( points[a], points[b] );
+
+            for( unsigned k = 0; k < neighbourCount; ++k )
+            {
+                int     c = neighbours[a * neighbourCount + k];
+                double  dac = holeDistance( points[a], points[c] );
+
+                if( dac >= dab )    // no gain, with this neighbour and the farther ones
+                    break;
+
+                unsigned j = rank[c];
+                unsigned first, last;
+                double   delta;
+
+                if( j > i + 1 )
+                {
+                    // a-b ... c-d becomes a-c ... b-d
+                    delta = dac - dab;
+                    first = i + 1;
+                    last = j;
+
+                    if( j + 1 < count )
+                    {
+                        int d = path[j + 1];
+                        delta += holeDistance( points[b], points[d] )
+                                 - holeDistance( points[c], points[d] );
+                    }
+                }
+                else if( j < i )
+                {
+                    // c-e ... a-b becomes c-a ... e-b
+                    int e = path[j + 1];
+                    delta = dac + holeDistance( points[e], points[b] )
+                            - holeDistance( points[c], points[e] ) - dab;
+                    first = j + 1;
+                    last = i;
+                }
+                else
+                {
+                    continue;
+                }
+
+                // Ignore gains smaller than 1 internal unit, which could be rounding errors
+                if( delta < -1.0 )
+                {
+                    std::reverse( path.begin() + first, path.begin() + last + 1 );
+
+                    for( unsigned ii = first; ii <= last; ++ii )
+                        rank[path[ii]] = ii;
+
+                    improved = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Keep the initial order if it is not longer (this can happen for a few holes)
+    double initialLength = 0.0;
+    double pathLength = 0.0;
+
+    for( unsigned ii = 0; ii < count; ++ii )
+    {
+        initialLength += holeDistance( ii ? points[ii - 1] : aPosition, points[ii] );
+        pathLength += holeDistance( ii ? points[path[ii - 1]] : aPosition, points[path[ii]] );
+    }
+
+    if( pathLength >= initialLength )
+    {
+        aPosition = points.back();
+        return;
+    }
+
+    std::vector<HOLE_INFO> sorted( count );
+
+    for( unsigned ii = 0; ii < count; ++ii )
+        sorted[ii] = aHoles[aFirst + path[ii]];
+
+    std::copy( sorted.begin(), sorted.end(), aHoles.begin() + aFirst );
+
+    aPosition = points[path.back()];
+}
+
+
+void EXCELLON_WRITER::optimizeHoleOrder()
+{
+    // CreateDrillFile() drills the round holes of all tools, then the oblong holes:
+    // they are 2 separate paths, both starting at the drill coordinates origin.
+    wxPoint roundPosition = m_offset;
+    wxPoint ovalPosition = m_offset;
+
+    std::vector<HOLE_INFO>::iterator begin = m_holeListBuffer.begin();
+    unsigned first = 0;
+
+    while( first < m_holeListBuffer.size() )
+    {
+        unsigned last = first + 1;
+
+        while( last < m_holeListBuffer.size() &&
+               m_holeListBuffer[last].m_Tool_Reference == m_holeListBuffer[first].m_Tool_Reference )
+            ++last;
+
+        unsigned firstOval = std::stable_partition( begin + first, begin + last, IsRoundHole )
+                             - begin;
+
+        optimizeHolePath( m_holeListBuffer, first, firstOval, roundPosition );
+        optimizeHolePath( m_holeListBuffer, firstOval, last, ovalPosition );
+
+        first = last;
+    }
+}
+
+
 void EXCELLON_WRITER::BuildHolesList( LAYER_PAIR aLayerPair,
                                       bool aGenerateNPTH_list )
 {
@@ -684,6 +1065,9 @@ void EXCELLON_WRITER::BuildHolesList( LAYER_PAIR aLayerPair,
         if( m_holeListBuffer[ii].m_Hole_Shape )
             m_toolListBuffer.back().m_OvalCount++;
     }
+
+    if( m_optimizeHoleOrder )
+        optimizeHoleOrder();
 }
 
 
@@ -148,6 +148,8 @@ private:
     bool                     m_mirror;
     wxPoint                  m_offset;                  // Drill offset coordinates
     bool                     m_merge_PTH_NPTH;          // True to generate only one drill file
+    bool                     m_optimizeHoleOrder;       // True to sort the holes of each tool
+                                                        // to shorten the drill travel
     std::vector<HOLE_INFO>   m_holeListBuffer;          // Buffer containing holes
     std::vector<DRILL_TOOL>  m_toolListBuffer;          // Buffer containing tools
 
@@ -215,10 +217,20 @@ public:
         m_merge_PTH_NPTH = aMerge_PTH_NPTH;
     }
 
+    /**
+     * Function SetHoleOrderOptimization
+     * @param aOptimize = true to drill the holes of each tool in an order which
+     * shortens the travel of the drill between holes, false (default) to drill them
+     * sorted by position.
+     */
+    void SetHoleOrderOptimization( bool aOptimize ) { m_optimizeHoleOrder = aOptimize; }
+
     /**
      * Function BuildHolesList
      * Create the list of holes and tools for a given board
      * The list is sorted by increasing drill size.
+     * The holes of a tool are sorted by position, or in a drill travel minimizing
+     * order if SetHoleOrderOptimization( true ) was called.
      * Only holes included within aLayerPair are listed.
      * If aLayerPair identifies with [F_Cu, B_Cu], then
      * pad holes are always included also.
@@ -237,6 +249,8 @@ public:
      * Function CreateDrillandMapFilesSet
      * Creates the full set of Excellon drill file for the board
      * filenames are computed from the board name, and layers id
+     * The hole lists of the layer pairs are built concurrently, then the files
+     * are written.
      * @param aPlotDirectory = the output folder
      * @param aGenDrill = true to generate the EXCELLON drill file
      * @param aGenMap = true to generate a drill map file
@@ -347,6 +361,14 @@ private:
      */
     bool PlotDrillMarks( PLOTTER* aPlotter );
 
+    /**
+     * Function optimizeHoleOrder
+     * reorders the holes of each tool in m_holeListBuffer (built and sorted by
+     * BuildHolesList()) to shorten the drill travel: a nearest neighbour path
+     * improved by 2-opt moves.
+     */
+    void optimizeHoleOrder();
+
     /// Get unique layer pairs by examining the micro and blind_buried vias.
     std::vector<LAYER_PAIR> getUniqueLayerPairs() const;
 
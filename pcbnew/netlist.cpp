@@ -28,6 +28,8 @@
  */
 
 #include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <fctsys.h>
 #include <pgm_base.h>
 #include <class_drawpanel.h>
@@ -192,20 +194,93 @@ MODULE* PCB_EDIT_FRAME::ListAndSelectModuleName()
 
 #define ALLOW_PARTIAL_FPID      1
 
+/**
+ * Struct FOOTPRINT_LOAD_JOB
+ * is a footprint to load from the footprint library table by loadFootprints(),
+ * and the result of this load.
+ */
+struct FOOTPRINT_LOAD_JOB
+{
+    FPID        m_FPID;
+    MODULE*     m_Module;       ///< the loaded footprint, NULL if not found
+    bool        m_Failed;       ///< true if the load has thrown m_Error
+    IO_ERROR    m_Error;
+
+    FOOTPRINT_LOAD_JOB( const FPID& aFPID ) :
+        m_FPID( aFPID ), m_Module( NULL ), m_Failed( false )
+    {
+    }
+};
+
+typedef std::vector<FOOTPRINT_LOAD_JOB>         FOOTPRINT_LOAD_JOBS;
+typedef std::vector< std::vector<unsigned> >    FOOTPRINT_LOAD_GROUPS;
+
+
+static void loadFootprintJob( FP_LIB_TABLE* aTable, FOOTPRINT_LOAD_JOB& aJob )
+{
+    try
+    {
+        // Same as PCB_BASE_FRAME::loadFootprint(), which cannot be used from a worker thread
+        aJob.m_Module = aTable->FootprintLoadWithOptionalNickname( aJob.m_FPID );
+
+        if( aJob.m_Module )
+            aJob.m_Module->ClearAllNets();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        aJob.m_Failed = true;
+        aJob.m_Error  = ioe;
+    }
+    catch( const std::exception& se )
+    {
+        aJob.m_Failed = true;
+        aJob.m_Error.errorText = FROM_UTF8( se.what() );
+    }
+}
+
+
+/**
+ * Function loadFootprintGroups
+ * is the worker thread function of loadFootprints(): it loads the footprints of
+ * the groups aFirst, aFirst + aStep, aFirst + 2 * aStep ...
+ * A group holds the footprints of one library: a library (and its PLUGIN) is used
+ * by only one thread.
+ */
+static void loadFootprintGroups( FP_LIB_TABLE* aTable, FOOTPRINT_LOAD_JOBS* aJobs,
+                                 const FOOTPRINT_LOAD_GROUPS* aGroups,
+                                 unsigned aFirst, unsigned aStep )
+{
+    for( unsigned ii = aFirst; ii < aGroups->size(); ii += aStep )
+    {
+        const std::vector<unsigned>& group = (*aGroups)[ii];
+
+        for( unsigned jj = 0; jj < group.size(); jj++ )
+            loadFootprintJob( aTable, (*aJobs)[ group[jj] ] );
+    }
+}
+
+
 void PCB_EDIT_FRAME::loadFootprints( NETLIST& aNetlist, REPORTER* aReporter )
     throw( IO_ERROR, PARSE_ERROR )
 {
     wxString   msg;
-    FPID       lastFPID;
     COMPONENT* component;
-    MODULE*    module = 0;
     MODULE*    fpOnBoard;
 
-    if( aNetlist.IsEmpty() || Prj().PcbFootprintLibs()->IsEmpty() )
+    FP_LIB_TABLE* fptbl = Prj().PcbFootprintLibs();
+
+    if( aNetlist.IsEmpty() || fptbl->IsEmpty() )
         return;
 
     aNetlist.SortByFPID();
 
+    // First pass: find the components which need a footprint from the libraries,
+    // and the list of different footprints to load.
+    std::vector<COMPONENT*>         toLoad;         // components needing a footprint
+    std::vector<unsigned>           toLoadJob;      // the job loading the footprint of toLoad[ii]
+    FOOTPRINT_LOAD_JOBS             jobs;
+    std::map<std::string, unsigned> jobsByFPID;
+
     for( unsigned ii = 0; ii < aNetlist.GetCount(); ii++ )
     {
         component = aNetlist.GetComponent( ii );
@@ -257,63 +332,161 @@ void PCB_EDIT_FRAME::loadFootprints( NETLIST& aNetlist, REPORTER* aReporter )
 
         bool loadFootprint = (fpOnBoard == NULL) || footprintMisMatch;
 
-        if( loadFootprint && (component->GetFPID() != lastFPID) )
-        {
-            module = NULL;
+        if( !loadFootprint )
+            continue;
 
 #if ALLOW_PARTIAL_FPID
-            // The FPID is ok as long as there is a footprint portion coming
-            // the library if it's needed.  Nickname can be blank.
-            if( !component->GetFPID().GetFootprintName().size() )
+        // The FPID is ok as long as there is a footprint portion coming
+        // the library if it's needed.  Nickname can be blank.
+        if( !component->GetFPID().GetFootprintName().size() )
 #else
-            if( !component->GetFPID().IsValid() )
+        if( !component->GetFPID().IsValid() )
 #endif
+        {
+            if( aReporter )
             {
-                if( aReporter )
-                {
-                    msg.Printf( _( "Component '%s' footprint ID '%s' is not "
-                                   "valid.\n" ),
-                                GetChars( component->GetReference() ),
-                                GetChars( component->GetFPID().Format() ) );
-                    aReporter->Report( msg, REPORTER::RPT_ERROR );
-                }
-
-                continue;
+                msg.Printf( _( "Component '%s' footprint ID '%s' is not "
+                               "valid.\n" ),
+                            GetChars( component->GetReference() ),
+                            GetChars( component->GetFPID().Format() ) );
+                aReporter->Report( msg, REPORTER::RPT_ERROR );
             }
 
-            // loadFootprint() can find a footprint with an empty nickname in fpid.
-            module = PCB_BASE_FRAME::loadFootprint( component->GetFPID() );
+            continue;
+        }
+
+        // Each footprint is loaded only once, and duplicated for other components
+        std::string key = component->GetFPID().Format();
+        std::map<std::string, unsigned>::iterator it = jobsByFPID.find( key );
+
+        if( it == jobsByFPID.end() )
+        {
+            it = jobsByFPID.insert( std::make_pair( key, (unsigned) jobs.size() ) ).first;
+            jobs.push_back( FOOTPRINT_LOAD_JOB( component->GetFPID() ) );
+        }
+
+        toLoad.push_back( component );
+        toLoadJob.push_back( it->second );
+    }
+
+    // Second pass: load the footprints.
+    // Footprints of a given library are loaded by the same thread, because the library
+    // PLUGIN (and its cache) is not thread safe. Footprints without nickname are searched
+    // in all libraries: they are loaded by the current thread, before other footprints.
+    FOOTPRINT_LOAD_GROUPS           groups;
+    std::map<wxString, unsigned>    groupsByNickname;
 
-            if( module )
+    for( unsigned ii = 0; ii < jobs.size(); ii++ )
+    {
+        wxString nickname = FROM_UTF8( jobs[ii].m_FPID.GetLibNickname().c_str() );
+
+        if( nickname.IsEmpty() )
+        {
+            loadFootprintJob( fptbl, jobs[ii] );
+            continue;
+        }
+
+        std::map<wxString, unsigned>::iterator it = groupsByNickname.find( nickname );
+
+        if( it == groupsByNickname.end() )
+        {
+            // FindRow() creates the library PLUGIN, this is not thread safe.
+            // It also throws an IO_ERROR for unknown nicknames, like a serial load
+            try
             {
-                lastFPID = component->GetFPID();
+                fptbl->FindRow( nickname );
             }
-            else
+            catch( ... )
             {
-                if( aReporter )
-                {
-                    wxString msg;
-                    msg.Printf( _( "Component '%s' footprint '%s' was not found in "
-                                   "any libraries in the footprint library table.\n" ),
-                                GetChars( component->GetReference() ),
-                                GetChars( component->GetFPID().GetFootprintName() ) );
-                    aReporter->Report( msg, REPORTER::RPT_ERROR );
-                }
-
-                continue;
+                for( unsigned jj = 0; jj < jobs.size(); jj++ )
+                    delete jobs[jj].m_Module;
+
+                throw;
             }
+
+            it = groupsByNickname.insert( std::make_pair( nickname,
+                                                          (unsigned) groups.size() ) ).first;
+            groups.push_back( std::vector<unsigned>() );
         }
-        else
+
+        groups[it->second].push_back( ii );
+    }
+
+    if( groups.size() )
+    {
+        // Keep LOCALE_IO::C_count at 1 or greater for the duration of all worker threads,
+        // see FOOTPRINT_LIST::ReadFootprintFiles()
+        LOCALE_IO   top_most_nesting;
+
+        unsigned threadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+        threadCount = std::min( threadCount, (unsigned) groups.size() );
+
+        // Something which will not invoke a thread copy constructor
+        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+
+        MYTHREADS threads;
+
+        for( unsigned ii = 1; ii < threadCount; ii++ )
+            threads.push_back( new boost::thread( &loadFootprintGroups, fptbl, &jobs, &groups,
+                                                  ii, threadCount ) );
+
+        loadFootprintGroups( fptbl, &jobs, &groups, 0, threadCount );
+
+        for( unsigned ii = 0; ii < threads.size(); ++ii )
+            threads[ii].join();
+    }
+
+    // Third pass: give a footprint to each component: the loaded footprint itself to the
+    // first component using it, and a duplicate (faster) to the others.
+    std::vector<bool> jobModuleUsed( jobs.size(), false );
+
+    for( unsigned ii = 0; ii < toLoad.size(); ii++ )
+    {
+        component = toLoad[ii];
+        FOOTPRINT_LOAD_JOB& job = jobs[ toLoadJob[ii] ];
+
+        if( job.m_Failed )
         {
-            // Footprint already loaded from a library, duplicate it (faster)
-            if( module == NULL )
-                continue;            // Module does not exist in any library.
+            IO_ERROR error = job.m_Error;
 
-            module = new MODULE( *module );
+            // Footprints given to components are owned by aNetlist, delete the others
+            for( unsigned jj = 0; jj < jobs.size(); jj++ )
+            {
+                if( !jobModuleUsed[jj] )
+                    delete jobs[jj].m_Module;
+            }
+
+            throw error;
+        }
+
+        if( job.m_Module == NULL )
+        {
+            if( aReporter )
+            {
+                msg.Printf( _( "Component '%s' footprint '%s' was not found in "
+                               "any libraries in the footprint library table.\n" ),
+                            GetChars( component->GetReference() ),
+                            GetChars( component->GetFPID().GetFootprintName() ) );
+                aReporter->Report( msg, REPORTER::RPT_ERROR );
+            }
+
+            continue;
         }
 
-        if( loadFootprint && module != NULL )
-            component->SetModule( module );
+        MODULE* module = job.m_Module;
+
+        if( jobModuleUsed[ toLoadJob[ii] ] )
+            module = new MODULE( *module );
+
+        jobModuleUsed[ toLoadJob[ii] ] = true;
+        component->SetModule( module );
+    }
+
+    // Loaded footprints which are not used by any component (should not happen)
+    for( unsigned jj = 0; jj < jobs.size(); jj++ )
+    {
+        if( !jobModuleUsed[jj] )
+            delete jobs[jj].m_Module;
     }
 }
 
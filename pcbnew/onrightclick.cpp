@@ -463,6 +463,8 @@ bool PCB_EDIT_FRAME::OnRightClick( const wxPoint& aMousePos, wxMenu* aPopMenu )
             commands->AppendSeparator();
             commands->Append( ID_POPUP_PCB_AUTOROUTE_ALL_MODULES,
                               _( "Automatically Route All Footprints" ) );
+            commands->Append( ID_POPUP_PCB_AUTOROUTE_ALL_MODULES_CONCURRENT,
+                              _( "Automatically Route All Footprints (Multithreaded)" ) );
             commands->AppendSeparator();
             commands->Append( ID_POPUP_PCB_AUTOROUTE_RESET_UNROUTED, _( "Reset Unrouted" ) );
             aPopMenu->AppendSeparator();
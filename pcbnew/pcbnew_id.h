@@ -243,6 +243,7 @@ enum pcbnew_ids
 
     ID_POPUP_PCB_AUTOROUTE_COMMANDS,
     ID_POPUP_PCB_AUTOROUTE_ALL_MODULES,
+    ID_POPUP_PCB_AUTOROUTE_ALL_MODULES_CONCURRENT,
     ID_POPUP_PCB_AUTOROUTE_MODULE,
     ID_POPUP_PCB_AUTOROUTE_PAD,
     ID_POPUP_PCB_AUTOROUTE_NET,
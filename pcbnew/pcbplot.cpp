@@ -365,31 +365,41 @@ bool PLOT_CONTROLLER::OpenPlotfile( const wxString &aSuffix,
 
     // Now compute the full filename for the output and start the plot
     // (after ensuring the output directory is OK)
+    if( buildPlotFileName( &m_plotFile, aSuffix, aFormat, GetLayer() ) )
+    {
+        m_plotter = StartPlotBoard( m_board, &GetPlotOptions(), ToLAYER_ID( GetLayer() ),
+                                    m_plotFile.GetFullPath(), aSheetDesc );
+    }
+
+    return( m_plotter != NULL );
+}
+
+
+bool PLOT_CONTROLLER::buildPlotFileName( wxFileName* aPlotFile, const wxString& aSuffix,
+                                         PlotFormat aFormat, LAYER_NUM aLayer )
+{
     wxString outputDirName = GetPlotOptions().GetOutputDirectory() ;
     wxFileName outputDir = wxFileName::DirName( outputDirName );
     wxString boardFilename = m_board->GetFileName();
 
-    if( EnsureFileDirectoryExists( &outputDir, boardFilename ) )
-    {
-        // outputDir contains now the full path of plot files
-        m_plotFile = boardFilename;
-        m_plotFile.SetPath( outputDir.GetPath() );
-        wxString fileExt = GetDefaultPlotExtension( aFormat );
+    if( !EnsureFileDirectoryExists( &outputDir, boardFilename ) )
+        return false;
 
-        // Gerber format can use specific file ext, depending on layers
-        // (now not a good practice, because the official file ext is .gbr)
-        if( GetPlotOptions().GetFormat() == PLOT_FORMAT_GERBER &&
-            GetPlotOptions().GetUseGerberProtelExtensions() )
-            fileExt = GetGerberProtelExtension( GetLayer() );
+    // outputDir contains now the full path of plot files
+    *aPlotFile = boardFilename;
+    aPlotFile->SetPath( outputDir.GetPath() );
+    wxString fileExt = GetDefaultPlotExtension( aFormat );
 
-        // Build plot filenames from the board name and layer names:
-        BuildPlotFileName( &m_plotFile, outputDir.GetPath(), aSuffix, fileExt );
+    // Gerber format can use specific file ext, depending on layers
+    // (now not a good practice, because the official file ext is .gbr)
+    if( aFormat == PLOT_FORMAT_GERBER &&
+        GetPlotOptions().GetUseGerberProtelExtensions() )
+        fileExt = GetGerberProtelExtension( aLayer );
 
-        m_plotter = StartPlotBoard( m_board, &GetPlotOptions(), ToLAYER_ID( GetLayer() ),
-                                    m_plotFile.GetFullPath(), aSheetDesc );
-    }
+    // Build plot filenames from the board name and layer names:
+    BuildPlotFileName( aPlotFile, outputDir.GetPath(), aSuffix, fileExt );
 
-    return( m_plotter != NULL );
+    return true;
 }
 
 
@@ -424,3 +434,84 @@ bool PLOT_CONTROLLER::GetColorMode()
 
     return m_plotter->GetColorMode();
 }
+
+
+void PLOT_CONTROLLER::AddPlotJob( LAYER_NUM aLayer, PlotFormat aFormat,
+                                  const wxString& aSuffix,
+                                  const wxString& aSheetDesc )
+{
+    m_plotJobs.push_back( PLOT_JOB( aLayer, aFormat, aSuffix, aSheetDesc ) );
+}
+
+
+const wxString PLOT_CONTROLLER::GetPlotJobFileName( int aIdx ) const
+{
+    if( aIdx < 0 || aIdx >= (int) m_plotJobs.size() || !m_plotJobs[aIdx].m_Success )
+        return wxEmptyString;
+
+    return m_plotJobs[aIdx].m_FileName;
+}
+
+
+bool PLOT_CONTROLLER::RunPlotJobs()
+{
+    // The locale is set here once for all the jobs: LOCALE_IO is not
+    // instantiated inside the parallel section
+    LOCALE_IO toggle;
+
+    int jobCount = m_plotJobs.size();
+
+    // Each job has its own options (the format is stored in the options,
+    // and some plotter setup modify them) and its own plotter
+    std::vector<PCB_PLOT_PARAMS> jobOptions( jobCount, GetPlotOptions() );
+    std::vector<PLOTTER*> plotters( jobCount, (PLOTTER*) NULL );
+
+    // Open the plot files one after the other: StartPlotBoard also plots
+    // the worksheet, which uses the (shared) page layout description
+    for( int ii = 0; ii < jobCount; ++ii )
+    {
+        PLOT_JOB& job = m_plotJobs[ii];
+        wxFileName plotFile;
+
+        job.m_Success = false;
+        job.m_FileName.Empty();
+        jobOptions[ii].SetFormat( job.m_Format );
+
+        if( !buildPlotFileName( &plotFile, job.m_Suffix, job.m_Format, job.m_Layer ) )
+            continue;
+
+        job.m_FileName = plotFile.GetFullPath();
+        plotters[ii] = StartPlotBoard( m_board, &jobOptions[ii], ToLAYER_ID( job.m_Layer ),
+                                       job.m_FileName, job.m_SheetDesc );
+    }
+
+    // Now plot the layers. The board is only read here, and each job
+    // writes only to its own plotter and its own status: the functions used
+    // to plot a layer must not keep their work buffers in static variables
+    int ii;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif /* USE_OPENMP */
+    for( ii = 0; ii < jobCount; ++ii )
+    {
+        if( !plotters[ii] )
+            continue;
+
+        PlotOneBoardLayer( m_board, plotters[ii], ToLAYER_ID( m_plotJobs[ii].m_Layer ),
+                           jobOptions[ii] );
+
+        // A job fails if its plot file cannot be written or closed
+        m_plotJobs[ii].m_Success = plotters[ii]->EndPlot();
+    }
+
+    bool success = true;
+
+    for( ii = 0; ii < jobCount; ++ii )
+    {
+        success = success && m_plotJobs[ii].m_Success;
+        delete plotters[ii];
+    }
+
+    return success;
+}
@@ -365,27 +365,29 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
             if( pad->GetLayerSet()[F_Cu] )
                 color = ColorFromInt( color | aBoard->GetVisibleElementColor( PAD_FR_VISIBLE ) );
 
-            // Temporary set the pad size to the required plot size:
-            wxSize tmppadsize = pad->GetSize();
-            pad->SetSize( padPlotsSize );
-            switch( pad->GetShape() )
+            // Plot a copy of the pad, sized to the required plot size.
+            // The board pad itself is not modified, so that several layers
+            // can be plotted at the same time (see PLOT_CONTROLLER::RunPlotJobs)
+            D_PAD plotPad( pad->GetParent() );
+            plotPad.Copy( pad );
+            plotPad.SetSize( padPlotsSize );
+
+            switch( plotPad.GetShape() )
             {
             case PAD_SHAPE_CIRCLE:
             case PAD_SHAPE_OVAL:
                 if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
-                    (pad->GetSize() == pad->GetDrillSize()) &&
-                    (pad->GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED) )
+                    (plotPad.GetSize() == plotPad.GetDrillSize()) &&
+                    (plotPad.GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED) )
                     break;
 
                 // Fall through:
             case PAD_SHAPE_TRAPEZOID:
             case PAD_SHAPE_RECT:
             default:
-                itemplotter.PlotPad( pad, color, plotMode );
+                itemplotter.PlotPad( &plotPad, color, plotMode );
                 break;
             }
-
-            pad->SetSize( tmppadsize );     // Restore the pad size
         }
     }
 
@@ -30,6 +30,7 @@
 #ifndef PLOTCONTROLLER_H_
 #define PLOTCONTROLLER_H_
 
+#include <vector>
 #include <pcb_plot_params.h>
 #include <layers_id_colors_and_visibility.h>
 
@@ -37,6 +38,31 @@ class PLOTTER;
 class BOARD;
 
 
+/**
+ * A plot request queued by PLOT_CONTROLLER::AddPlotJob(): one layer,
+ * plotted in one format, to its own plot file
+ */
+struct PLOT_JOB
+{
+    PLOT_JOB( LAYER_NUM aLayer, PlotFormat aFormat,
+              const wxString& aSuffix, const wxString& aSheetDesc ) :
+        m_Layer( aLayer ),
+        m_Format( aFormat ),
+        m_Suffix( aSuffix ),
+        m_SheetDesc( aSheetDesc ),
+        m_Success( false )
+    {
+    }
+
+    LAYER_NUM   m_Layer;        ///< the layer to plot
+    PlotFormat  m_Format;       ///< the plot file format
+    wxString    m_Suffix;       ///< added to the board filename to build the plot filename
+    wxString    m_SheetDesc;    ///< the sheet description used in the worksheet
+    wxString    m_FileName;     ///< the plot full filename, set by RunPlotJobs
+    bool        m_Success;      ///< true if the plot file was written, set by RunPlotJobs
+};
+
+
 /**
  * Batch plotter state object. Keeps the plot options and handles multiple
  * plot requests
@@ -107,7 +133,53 @@ public:
      */
     bool GetColorMode();
 
+    /**
+     * Queue a plot job, to be plotted by RunPlotJobs()
+     * @param aLayer is the layer to plot
+     * @param aFormat is the plot file format identifier
+     * @param aSuffix is a string added to the base filename (derived from
+     * the board filename) to identify the plot file
+     * @param aSheetDesc is the sheet description used in the worksheet
+     */
+    void AddPlotJob( LAYER_NUM aLayer, PlotFormat aFormat,
+                     const wxString& aSuffix,
+                     const wxString& aSheetDesc = wxEmptyString );
+
+    /** Remove all the queued plot jobs
+     */
+    void ClearPlotJobs() { m_plotJobs.clear(); }
+
+    /**
+     * @return the number of queued plot jobs
+     */
+    int GetPlotJobCount() const { return (int) m_plotJobs.size(); }
+
+    /**
+     * @return the full filename of the plot job aIdx, set by RunPlotJobs,
+     * or an empty string if this plot file was not created
+     */
+    const wxString GetPlotJobFileName( int aIdx ) const;
+
+    /**
+     * Plot all the queued jobs, each one in its own plotter and plot file,
+     * using the current plot options (but the format of each job).
+     * The layers are rendered concurrently when OpenMP is available:
+     * the board is only read during the plot, and must not be modified
+     * by the caller until this function returns.
+     * The current plot (if any) is not modified.
+     * @return true if all the plot files were written and closed successfully
+     */
+    bool RunPlotJobs();
+
 private:
+    /**
+     * Build the full filename of a plot file, and ensure the output
+     * directory exists
+     * @return false if the output directory cannot be created
+     */
+    bool buildPlotFileName( wxFileName* aPlotFile, const wxString& aSuffix,
+                            PlotFormat aFormat, LAYER_NUM aLayer );
+
     /// the layer to plot
     LAYER_NUM m_plotLayer;
 
@@ -123,6 +195,9 @@ private:
 
     /// The current plot filename, set by OpenPlotfile
     wxFileName m_plotFile;
+
+    /// The plot jobs queued by AddPlotJob
+    std::vector<PLOT_JOB> m_plotJobs;
 };
 
 #endif
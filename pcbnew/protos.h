@@ -33,6 +33,7 @@
 class wxDC;
 class wxPoint;
 class EDA_DRAW_PANEL;
+class BOARD;
 class BOARD_ITEM;
 class TRACK;
 class MODULE;
@@ -77,6 +78,15 @@ void CalculateSegmentEndPoint( const wxPoint& aPosition, int ox, int oy, int* fx
 bool Project( wxPoint* res, wxPoint on_grid, const TRACK* track );
 TRACK* LocateIntrusion( TRACK* listStart, TRACK* aTrack, LAYER_NUM aLayer, const wxPoint& aRef );
 
+/**
+ * Function BuildFullRatsnest
+ * computes the full ratsnest of \a aPcb, the minimum spanning tree of the pads of each
+ * net, into aPcb->m_FullRatsnest.  All its links are active: the tracks are not used.
+ * It needs no frame, see PCB_BASE_FRAME::Build_Board_Ratsnest().
+ * @return false if a net of a pad was not found.
+ */
+bool BuildFullRatsnest( BOARD* aPcb );
+
 
 
 #endif  /* #define PROTO_H */
@@ -40,6 +40,7 @@
 #include <class_track.h>
 
 #include <pcbnew.h>
+#include <protos.h>
 
 #include <minimun_spanning_tree.h>
 
@@ -228,30 +229,30 @@ static bool sortByNetcode( const D_PAD* const & ref, const D_PAD* const & item )
  *      nb_links = link count for the board (logical connection count)
  *      (there are n-1 links in a net which counting n active pads) .
  */
-void PCB_BASE_FRAME::Build_Board_Ratsnest()
+bool BuildFullRatsnest( BOARD* aPcb )
 {
     D_PAD* pad;
     int    noconn;
 
-    m_Pcb->SetUnconnectedNetCount( 0 );
+    aPcb->SetUnconnectedNetCount( 0 );
 
-    m_Pcb->m_FullRatsnest.clear();
+    aPcb->m_FullRatsnest.clear();
 
-    if( m_Pcb->GetPadCount() == 0 )
-        return;
+    if( aPcb->GetPadCount() == 0 )
+        return true;
 
     // Created pad list and the net_codes if needed
-    if( (m_Pcb->m_Status_Pcb & NET_CODES_OK) == 0 )
-        m_Pcb->BuildListOfNets();
+    if( (aPcb->m_Status_Pcb & NET_CODES_OK) == 0 )
+        aPcb->BuildListOfNets();
 
-    for( unsigned ii = 0; ii<m_Pcb->GetPadCount(); ++ii )
+    for( unsigned ii = 0; ii<aPcb->GetPadCount(); ++ii )
     {
-        pad = m_Pcb->GetPad( ii );
+        pad = aPcb->GetPad( ii );
         pad->SetSubRatsnest( 0 );
     }
 
-    if( m_Pcb->GetNodesCount() == 0 )
-        return;                       // No useful connections.
+    if( aPcb->GetNodesCount() == 0 )
+        return true;                    // No useful connections.
 
     // Ratsnest computation
     unsigned current_net_code = 1;      // First net code is analyzed.
@@ -259,27 +260,36 @@ void PCB_BASE_FRAME::Build_Board_Ratsnest()
     noconn = 0;
     MIN_SPAN_TREE_PADS min_spanning_tree;
 
-    for( ; current_net_code < m_Pcb->GetNetCount(); current_net_code++ )
+    for( ; current_net_code < aPcb->GetNetCount(); current_net_code++ )
     {
-        NETINFO_ITEM* net = m_Pcb->FindNet( current_net_code );
+        NETINFO_ITEM* net = aPcb->FindNet( current_net_code );
 
         if( !net )       // Should not occur
         {
             UTF8 msg = StrPrintf( "%s: error, net %d not found", __func__, current_net_code );
             wxMessageBox( msg );   // BTW, it does happen.
-            return;
+            return false;
         }
 
-        net->m_RatsnestStartIdx = m_Pcb->GetRatsnestsCount();
+        net->m_RatsnestStartIdx = aPcb->GetRatsnestsCount();
 
         min_spanning_tree.MSP_Init( &net->m_PadInNetList );
         min_spanning_tree.BuildTree();
-        min_spanning_tree.AddTreeToRatsnest( &m_Pcb->m_FullRatsnest );
-        net->m_RatsnestEndIdx = m_Pcb->GetRatsnestsCount();
+        min_spanning_tree.AddTreeToRatsnest( &aPcb->m_FullRatsnest );
+        net->m_RatsnestEndIdx = aPcb->GetRatsnestsCount();
     }
 
-    m_Pcb->SetUnconnectedNetCount( noconn );
-    m_Pcb->m_Status_Pcb |= LISTE_RATSNEST_ITEM_OK;
+    aPcb->SetUnconnectedNetCount( noconn );
+    aPcb->m_Status_Pcb |= LISTE_RATSNEST_ITEM_OK;
+
+    return true;
+}
+
+
+void PCB_BASE_FRAME::Build_Board_Ratsnest()
+{
+    if( !BuildFullRatsnest( m_Pcb ) )
+        return;
 
     // Update the ratsnest display option (visible/invisible) flag
     for( unsigned ii = 0; ii < m_Pcb->GetRatsnestsCount(); ii++ )
@@ -37,6 +37,7 @@
 #include <kicad_string.h>
 #include <io_mgr.h>
 #include <macros.h>
+#include <autorout.h>
 #include <stdlib.h>
 
 static PCB_EDIT_FRAME* PcbEditFrame = NULL;
@@ -107,3 +108,9 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 #endif
     return true;
 }
+
+
+int AutorouteBoard( BOARD* aBoard, int aGridSize, bool aConcurrent )
+{
+    return AutorouteAllConnections( aBoard, aGridSize, aConcurrent );
+}
@@ -43,5 +43,17 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function AutorouteBoard
+ * routes all the connections of the ratsnest of \a aBoard with the built in
+ * autorouter, ignoring its existing tracks (see AutorouteAllConnections()).
+ * @param aBoard = the board to route
+ * @param aGridSize = the routing grid in internal units
+ * @param aConcurrent = true to route the connections which do not overlap at the same
+ *                      time, in worker threads
+ * @return the number of connections routed, or -1 if there is not enough memory
+ */
+int     AutorouteBoard( BOARD* aBoard, int aGridSize, bool aConcurrent );
+
 
 #endif
@@ -79,6 +79,7 @@ void SPECCTRA_DB::buildLayerMaps( BOARD* aBoard )
     unsigned layerCount = aBoard->GetCopperLayerCount();
 
     layerIds.clear();
+    layerIndex.clear();
     pcbLayer2kicad.resize( layerCount );
     kicadLayer2pcb.resize( B_Cu + 1 );
 
@@ -118,17 +119,21 @@ void SPECCTRA_DB::buildLayerMaps( BOARD* aBoard )
     }
 
 #endif
+
+    // keep the first one of duplicated names, as a linear search would find it.
+    for( int i = layerIds.size() - 1;  i >= 0;  --i )
+        layerIndex[ layerIds[i] ] = i;
 }
 
 
 int SPECCTRA_DB::findLayerName( const std::string& aLayerName ) const
 {
-    for( int i=0;  i < int(layerIds.size());  ++i )
-    {
-        if( 0 == aLayerName.compare( layerIds[i] ) )
-            return i;
-    }
-    return -1;
+    STRING_INDEX::const_iterator it = layerIndex.find( aLayerName );
+
+    if( it == layerIndex.end() )
+        return -1;
+
+    return it->second;
 }
 
 void SPECCTRA_DB::readCOMPnPIN( std::string* component_id, std::string* pin_id ) throw( IO_ERROR )
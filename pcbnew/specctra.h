@@ -32,6 +32,7 @@
 //  see http://www.boost.org/libs/ptr_container/doc/ptr_set.html
 #include <boost/ptr_container/ptr_set.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <fctsys.h>
 #include <specctra_lexer.h>
@@ -157,6 +158,9 @@ struct POINT
 typedef std::vector<std::string>    STRINGS;
 typedef std::vector<POINT>          POINTS;
 
+/// maps a name or a hash string to an index within a container
+typedef boost::unordered_map<std::string, int>  STRING_INDEX;
+
 struct PROPERTY
 {
     std::string name;
@@ -1790,12 +1794,16 @@ class PLACEMENT : public ELEM
 
     COMPONENTS  components;
 
+    STRING_INDEX componentIndex;    ///< image_id to index in components
+    unsigned    indexedComponents;  ///< count of components in componentIndex
+
 public:
     PLACEMENT( ELEM* aParent ) :
         ELEM( T_placement, aParent )
     {
         unit = 0;
         flip_style = DSN_T( T_NONE );
+        indexedComponents = 0;
     }
 
     ~PLACEMENT()
@@ -1812,12 +1820,18 @@ public:
      */
     COMPONENT* LookupCOMPONENT( const std::string& imageName )
     {
-        for( unsigned i=0; i<components.size();  ++i )
+        // The parser appends to components directly, catch up with it.
+        for( ; indexedComponents<components.size();  ++indexedComponents )
         {
-            if( 0 == components[i].GetImageId().compare( imageName ) )
-                return &components[i];
+            componentIndex.insert( std::make_pair( components[indexedComponents].GetImageId(),
+                                                   (int) indexedComponents ) );
         }
 
+        STRING_INDEX::const_iterator it = componentIndex.find( imageName );
+
+        if( it != componentIndex.end() )
+            return &components[it->second];
+
         COMPONENT* added = new COMPONENT(this);
         components.push_back( added );
         added->SetImageId( imageName );
@@ -2094,6 +2108,7 @@ typedef boost::ptr_vector<IMAGE>    IMAGES;
 class PADSTACK : public ELEM_HOLDER
 {
     friend class SPECCTRA_DB;
+    friend class LIBRARY;
 
     std::string     hash;       ///< a hash string used by Compare(), not Format()ed/exported.
 
@@ -2234,12 +2249,76 @@ class LIBRARY : public ELEM
     PADSTACKS       padstacks;      ///< all except vias, which are in 'vias'
     PADSTACKS       vias;
 
+    /*  Indexes for the lookups below.  The containers are only appended to, also
+        directly by the parser, so an index is brought up to date before each use
+        by adding the elements appended since the previous use.
+    */
+    STRING_INDEX    imageIndex;         ///< image hash to index in images
+    STRING_INDEX    imageIdCount;       ///< image_id to number of images using it
+    unsigned        indexedImages;
+
+    STRING_INDEX    viaIndex;           ///< via key to index in vias, see viaKey()
+    unsigned        indexedVias;
+
+    STRING_INDEX    padstackIndex;      ///< padstack_id to index in padstacks
+    unsigned        indexedPadstacks;
+
+    void indexImages()
+    {
+        for( ; indexedImages < images.size();  ++indexedImages )
+        {
+            IMAGE* image = &images[indexedImages];
+
+            if( !image->hash.size() )
+                image->hash = image->makeHash();
+
+            // keep the first one, as a linear search would find it.
+            imageIndex.insert( std::make_pair( image->hash, (int) indexedImages ) );
+            imageIdCount[image->image_id]++;
+        }
+    }
+
+    /**
+     * Function viaKey
+     * returns a string which is the same for two vias if PADSTACK::Compare() says
+     * they are equal.
+     */
+    static std::string viaKey( PADSTACK* aVia )
+    {
+        if( !aVia->hash.size() )
+            aVia->hash = aVia->makeHash();
+
+        std::string key = aVia->padstack_id;
+
+        key += '\0';
+        key += aVia->hash;
+        return key;
+    }
+
+    void indexVias()
+    {
+        for( ; indexedVias < vias.size();  ++indexedVias )
+            viaIndex.insert( std::make_pair( viaKey( &vias[indexedVias] ), (int) indexedVias ) );
+    }
+
+    void indexPadstacks()
+    {
+        for( ; indexedPadstacks < padstacks.size();  ++indexedPadstacks )
+        {
+            padstackIndex.insert( std::make_pair( padstacks[indexedPadstacks].GetPadstackId(),
+                                                  (int) indexedPadstacks ) );
+        }
+    }
+
 public:
 
     LIBRARY( ELEM* aParent, DSN_T aType = T_library ) :
         ELEM( aType, aParent )
     {
         unit = 0;
+        indexedImages = 0;
+        indexedVias = 0;
+        indexedPadstacks = 0;
 //        via_start_index = -1;       // 0 or greater means there is at least one via
     }
     ~LIBRARY()
@@ -2272,21 +2351,22 @@ public:
      */
     int FindIMAGE( IMAGE* aImage )
     {
-        unsigned i;
-        for( i=0;  i<images.size();  ++i )
-        {
-            if( 0 == IMAGE::Compare( aImage, &images[i] ) )
-                return (int) i;
-        }
+        indexImages();
+
+        if( !aImage->hash.size() )
+            aImage->hash = aImage->makeHash();
+
+        STRING_INDEX::const_iterator it = imageIndex.find( aImage->hash );
+
+        if( it != imageIndex.end() )
+            return it->second;
 
         // There is no match to the IMAGE contents, but now generate a unique
         // name for it.
-        int dups = 1;
-        for( i=0;  i<images.size();  ++i )
-        {
-            if( 0 == aImage->image_id.compare( images[i].image_id ) )
-                aImage->duplicated = dups++;
-        }
+        it = imageIdCount.find( aImage->image_id );
+
+        if( it != imageIdCount.end() )
+            aImage->duplicated = it->second;
 
         return -1;
     }
@@ -2328,11 +2408,13 @@ public:
      */
     int FindVia( PADSTACK* aVia )
     {
-        for( unsigned i=0;  i<vias.size();  ++i )
-        {
-            if( 0 == PADSTACK::Compare( aVia, &vias[i] ) )
-                return int( i );
-        }
+        indexVias();
+
+        STRING_INDEX::const_iterator it = viaIndex.find( viaKey( aVia ) );
+
+        if( it != viaIndex.end() )
+            return it->second;
+
         return -1;
     }
 
@@ -2383,12 +2465,13 @@ public:
      */
     PADSTACK* FindPADSTACK( const std::string& aPadstackId )
     {
-        for( unsigned i=0;  i<padstacks.size();  ++i )
-        {
-            PADSTACK* ps = &padstacks[i];
-            if( 0 == ps->GetPadstackId().compare( aPadstackId ) )
-                return ps;
-        }
+        indexPadstacks();
+
+        STRING_INDEX::const_iterator it = padstackIndex.find( aPadstackId );
+
+        if( it != padstackIndex.end() )
+            return &padstacks[it->second];
+
         return NULL;
     }
 
@@ -3616,6 +3699,7 @@ class SPECCTRA_DB : public SPECCTRA_LEXER
     STRING_FORMATTER sf;
 
     STRINGS         layerIds;       ///< indexed by PCB layer number
+    STRING_INDEX    layerIndex;     ///< layerIds name to PCB layer number
 
     /// maps BOARD layer number to PCB layer numbers
     std::vector<int> kicadLayer2pcb;
@@ -3629,6 +3713,14 @@ class SPECCTRA_DB : public SPECCTRA_LEXER
     /// a copy to avoid passing as an argument, memory for it is not owned here.
     BOARD*          sessionBoard;
 
+    /// the BOARD given to FromBOARD(), whose tracks and vias are written to the
+    /// wiring by ExportPCB() instead of being stored in the pcb tree.
+    BOARD*          exportBoard;
+
+    /// the via PADSTACK registered in the library for each via of exportBoard.
+    typedef std::vector< std::pair<const ::VIA*, PADSTACK*> >  VIA_PADSTACKS;
+    VIA_PADSTACKS   exportVias;
+
     static const KICAD_T scanPADs[];
 
     PADSTACKSET     padstackset;
@@ -3817,6 +3909,16 @@ class SPECCTRA_DB : public SPECCTRA_LEXER
      */
     void exportNETCLASS( boost::shared_ptr<NETCLASS> aNetClass, BOARD* aBoard );
 
+    friend class BOARD_WIRING;
+
+    /**
+     * Function formatBoardWIRING
+     * writes the tracks and vias of exportBoard as the WIREs and WIRE_VIAs of
+     * \a aWiring.  Each WIRE is formatted as soon as it is complete, and is not kept.
+     */
+    void formatBoardWIRING( WIRING* aWiring, OUTPUTFORMATTER* out, int nestLevel )
+        throw( IO_ERROR );
+
     //-----</FromBOARD>------------------------------------------------------
 
     //-----<FromSESSION>-----------------------------------------------------
@@ -3856,6 +3958,7 @@ public:
         // Avoid not initialized members:
         routeResolution = NULL;
         sessionBoard = NULL;
+        exportBoard = NULL;
         m_top_via_layer = 0;
         m_bot_via_layer = 0;
     }
@@ -3938,6 +4041,10 @@ public:
      *
      * See void PCB_EDIT_FRAME::ExportToSpecctra( wxCommandEvent& event )
      * for how this can be done before calling this function.
+     * <p>
+     * The tracks and vias, which are most of a routed board, are not converted
+     * here: they are read from \a aBoard when the wiring is formatted, so the BOARD
+     * must stay unchanged until the PCB is written out.
      *
      * @param aBoard The BOARD to convert to a PCB.
      */
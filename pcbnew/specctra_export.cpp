@@ -40,6 +40,7 @@
 
 #include <set>                  // std::set
 #include <map>                  // std::map
+#include <memory>               // std::auto_ptr
 
 #include <boost/utility.hpp>    // boost::addressof()
 
@@ -1428,6 +1429,32 @@ typedef std::set<std::string>                   STRINGSET;
 typedef std::pair<STRINGSET::iterator, bool>    STRINGSET_PAIR;
 
 
+/**
+ * Class BOARD_WIRING
+ * is the WIRING of a PCB made by FromBOARD(): its WIREs and WIRE_VIAs are made
+ * from the tracks and vias of the BOARD while they are formatted, instead of being
+ * all held in memory before the file is written.
+ */
+class BOARD_WIRING : public WIRING
+{
+    SPECCTRA_DB*    db;
+
+public:
+    BOARD_WIRING( ELEM* aParent, SPECCTRA_DB* aDb ) :
+        WIRING( aParent ),
+        db( aDb )
+    {
+    }
+
+    void FormatContents( OUTPUTFORMATTER* out, int nestLevel ) throw( IO_ERROR )
+    {
+        WIRING::FormatContents( out, nestLevel );
+
+        db->formatBoardWIRING( this, out, nestLevel );
+    }
+};
+
+
 void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
     throw( IO_ERROR, boost::bad_ptr_container_operation )
 {
@@ -1980,16 +2007,93 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
 
 #if 1    // do existing wires and vias
 
+    //-----<register the vias of the existing wiring>-----------------------
+    {
+        // The tracks and vias themselves are written by formatBoardWIRING() while
+        // the pcb is formatted, but the padstacks of the vias must be in the
+        // library before: export all vias, once per unique size and drill
+        // diameter combo.
+        static const KICAD_T scanVIAs[] = { PCB_VIA_T, EOT };
+
+        exportBoard = aBoard;
+        exportVias.clear();
+
+        delete pcb->wiring;
+        pcb->wiring = new BOARD_WIRING( pcb, this );
+
+        items.Collect( aBoard, scanVIAs );
+
+        for( int i = 0; i<items.GetCount(); ++i )
+        {
+            ::VIA* via = (::VIA*) items[i];
+            wxASSERT( via->Type() == PCB_VIA_T );
+
+            int     netcode = via->GetNetCode();
+
+            if( netcode == 0 )
+                continue;
+
+            PADSTACK*   padstack    = makeVia( via );
+            PADSTACK*   registered  = pcb->library->LookupVia( padstack );
+
+            // if the one looked up is not our padstack, then delete our padstack
+            // since it was a duplicate of one already registered.
+            if( padstack != registered )
+            {
+                delete padstack;
+            }
+
+            exportVias.push_back( std::make_pair( via, registered ) );
+        }
+    }
+
+#endif    // do existing wires and vias
+
+    //-----<via_descriptor>-------------------------------------------------
+    {
+        // The pcb->library will output <padstack_descriptors> which is a combined
+        // list of part padstacks and via padstacks.  specctra dsn uses the
+        // <via_descriptors> to say which of those padstacks are vias.
+
+        // Output the vias in the padstack list here, by name only.  This must
+        // be done after exporting existing vias as WIRE_VIAs.
+        VIA* vias = pcb->structure->via;
+
+        for(  unsigned viaNdx = 0; viaNdx < pcb->library->vias.size(); ++viaNdx )
+        {
+            vias->AppendVia( pcb->library->vias[viaNdx].padstack_id.c_str() );
+        }
+    }
+
+
+    //-----<output NETCLASSs>----------------------------------------------------
+    NETCLASSES& nclasses = aBoard->GetDesignSettings().m_NetClasses;
+
+    exportNETCLASS( nclasses.GetDefault(), aBoard );
+
+    for( NETCLASSES::iterator nc = nclasses.begin(); nc != nclasses.end(); ++nc )
+    {
+        NETCLASSPTR netclass = nc->second;
+        exportNETCLASS( netclass, aBoard );
+    }
+}
+
+
+void SPECCTRA_DB::formatBoardWIRING( WIRING* aWiring, OUTPUTFORMATTER* out, int nestLevel )
+    throw( IO_ERROR )
+{
     //-----<create the wires from tracks>-----------------------------------
     {
         // export all of them for now, later we'll decide what controls we need
         // on this.
         static const KICAD_T scanTRACKs[] = { PCB_TRACE_T, EOT };
 
-        items.Collect( aBoard, scanTRACKs );
+        PCB_TYPE_COLLECTOR  items;
+
+        items.Collect( exportBoard, scanTRACKs );
 
         std::string netname;
-        WIRING*     wiring = pcb->wiring;
+        std::auto_ptr<WIRE> wire;
         PATH*       path = 0;
 
         int old_netcode = -1;
@@ -2017,14 +2121,17 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
                 if( old_netcode != netcode )
                 {
                     old_netcode = netcode;
-                    NETINFO_ITEM* net = aBoard->FindNet( netcode );
+                    NETINFO_ITEM* net = exportBoard->FindNet( netcode );
                     wxASSERT( net );
                     netname = TO_UTF8( net->GetNetname() );
                 }
 
-                WIRE* wire = new WIRE( wiring );
+                // the previous wire is complete.
+                if( wire.get() )
+                    wire->Format( out, nestLevel );
+
+                wire.reset( new WIRE( aWiring ) );
 
-                wiring->wires.push_back( wire );
                 wire->net_id = netname;
 
                 wire->wire_type = T_protect;    // @todo, this should be configurable
@@ -2032,7 +2139,7 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
                 LAYER_NUM kiLayer  = track->GetLayer();
                 int pcbLayer = kicadLayer2pcb[kiLayer];
 
-                path = new PATH( wire );
+                path = new PATH( wire.get() );
 
                 wire->SetShape( path );
 
@@ -2045,81 +2152,32 @@ void SPECCTRA_DB::FromBOARD( BOARD* aBoard )
             if( path )  // Should not occur
                 path->AppendPoint( mapPt( track->GetEnd() ) );
         }
+
+        if( wire.get() )
+            wire->Format( out, nestLevel );
     }
 
 
     //-----<export the existing real BOARD instantiated vias>-----------------
     {
-        // Export all vias, once per unique size and drill diameter combo.
-        static const KICAD_T scanVIAs[] = { PCB_VIA_T, EOT };
-
-        items.Collect( aBoard, scanVIAs );
-
-        for( int i = 0; i<items.GetCount(); ++i )
+        for( unsigned i = 0;  i < exportVias.size();  ++i )
         {
-            ::VIA* via = (::VIA*) items[i];
-            wxASSERT( via->Type() == PCB_VIA_T );
-
-            int     netcode = via->GetNetCode();
-
-            if( netcode == 0 )
-                continue;
-
-            PADSTACK*   padstack    = makeVia( via );
-            PADSTACK*   registered  = pcb->library->LookupVia( padstack );
+            const ::VIA*    via = exportVias[i].first;
+            WIRE_VIA        dsnVia( aWiring );
 
-            // if the one looked up is not our padstack, then delete our padstack
-            // since it was a duplicate of one already registered.
-            if( padstack != registered )
-            {
-                delete padstack;
-            }
+            dsnVia.padstack_id = exportVias[i].second->padstack_id;
+            dsnVia.vertexes.push_back( mapPt( via->GetPosition() ) );
 
-            WIRE_VIA* dsnVia = new WIRE_VIA( pcb->wiring );
-
-            pcb->wiring->wire_vias.push_back( dsnVia );
-
-            dsnVia->padstack_id = registered->padstack_id;
-            dsnVia->vertexes.push_back( mapPt( via->GetPosition() ) );
-
-            NETINFO_ITEM* net = aBoard->FindNet( netcode );
+            NETINFO_ITEM* net = exportBoard->FindNet( via->GetNetCode() );
             wxASSERT( net );
 
-            dsnVia->net_id = TO_UTF8( net->GetNetname() );
-
-            dsnVia->via_type = T_protect;     // @todo, this should be configurable
-        }
-    }
-
-#endif    // do existing wires and vias
-
-    //-----<via_descriptor>-------------------------------------------------
-    {
-        // The pcb->library will output <padstack_descriptors> which is a combined
-        // list of part padstacks and via padstacks.  specctra dsn uses the
-        // <via_descriptors> to say which of those padstacks are vias.
+            dsnVia.net_id = TO_UTF8( net->GetNetname() );
 
-        // Output the vias in the padstack list here, by name only.  This must
-        // be done after exporting existing vias as WIRE_VIAs.
-        VIA* vias = pcb->structure->via;
+            dsnVia.via_type = T_protect;     // @todo, this should be configurable
 
-        for(  unsigned viaNdx = 0; viaNdx < pcb->library->vias.size(); ++viaNdx )
-        {
-            vias->AppendVia( pcb->library->vias[viaNdx].padstack_id.c_str() );
+            dsnVia.Format( out, nestLevel );
         }
     }
-
-
-    //-----<output NETCLASSs>----------------------------------------------------
-    NETCLASSES& nclasses = aBoard->GetDesignSettings().m_NetClasses;
-
-    exportNETCLASS( nclasses.GetDefault(), aBoard );
-
-    for( NETCLASSES::iterator nc = nclasses.begin(); nc != nclasses.end(); ++nc )
-    {
-        NETCLASSPTR netclass = nc->second;
-        exportNETCLASS( netclass, aBoard );
-    }
 }
 
 
@@ -47,6 +47,8 @@
 
 #include <specctra.h>
 
+#include <algorithm>
+
 
 using namespace DSN;
 
@@ -348,6 +350,31 @@ TRACK* SPECCTRA_DB::makeTRACK( PATH* aPath, int aPointIndex, int aNetcode ) thro
 }
 
 
+static bool sortTracksByNetcode( const TRACK* const & ref, const TRACK* const & item )
+{
+    return ref->GetNetCode() < item->GetNetCode();
+}
+
+
+/**
+ * Function addTracks
+ * adds the tracks and vias made from the session to \a aBoard, which has no track.
+ * They are appended in the order BOARD::Add() would give by inserting them one by one
+ * before the first track of the same net code, without searching this insertion
+ * point in the whole track list for each of them.
+ */
+static void addTracks( BOARD* aBoard, std::vector<TRACK*>& aTracks )
+{
+    std::reverse( aTracks.begin(), aTracks.end() );
+    std::stable_sort( aTracks.begin(), aTracks.end(), sortTracksByNetcode );
+
+    for( unsigned i = 0;  i < aTracks.size();  ++i )
+        aBoard->Add( aTracks[i], ADD_APPEND );
+
+    aTracks.clear();
+}
+
+
 // no UI code in this function, throw exception to report problems to the
 // UI handler: void PCB_EDIT_FRAME::ImportSpecctraSession( wxCommandEvent& event )
 
@@ -444,117 +471,130 @@ void SPECCTRA_DB::FromSESSION( BOARD* aBoard ) throw( IO_ERROR )
 
     // Walk the NET_OUTs and create tracks and vias anew.
     NET_OUTS& net_outs = session->route->net_outs;
-    for( NET_OUTS::iterator net=net_outs.begin();  net!=net_outs.end();  ++net )
-    {
-        int         netCode = 0;
+    std::vector<TRACK*> newTracks;
 
-        // page 143 of spec says wire's net_id is optional
-        if( net->net_id.size() )
+    try
+    {
+        for( NET_OUTS::iterator net=net_outs.begin();  net!=net_outs.end();  ++net )
         {
-            wxString netName = FROM_UTF8( net->net_id.c_str() );
+            int         netCode = 0;
 
-            NETINFO_ITEM* net = aBoard->FindNet( netName );
-            if( net )
-                netCode = net->GetNet();
-            else  // else netCode remains 0
+            // page 143 of spec says wire's net_id is optional
+            if( net->net_id.size() )
             {
-                // int breakhere = 1;
-            }
-        }
-
-        WIRES& wires = net->wires;
-        for( unsigned i=0;  i<wires.size();  ++i )
-        {
-            WIRE*   wire  = &wires[i];
-            DSN_T   shape = wire->shape->Type();
+                wxString netName = FROM_UTF8( net->net_id.c_str() );
 
-            if( shape != T_path )
-            {
-                /*  shape == T_polygon is expected from freerouter if you have
-                    a zone on a non "power" type layer, i.e. a T_signal layer
-                    and the design does a round trip back in as session here.
-                    We kept our own zones in the BOARD, so ignore this so called
-                    'wire'.
-
-                wxString netId = FROM_UTF8( wire->net_id.c_str() );
-                THROW_IO_ERROR( wxString::Format( _("Unsupported wire shape: \"%s\" for net: \"%s\""),
-                                                    DLEX::GetTokenString(shape).GetData(),
-                                                    netId.GetData()
-                    ) );
-                */
+                NETINFO_ITEM* net = aBoard->FindNet( netName );
+                if( net )
+                    netCode = net->GetNet();
+                else  // else netCode remains 0
+                {
+                    // int breakhere = 1;
+                }
             }
-            else
+
+            WIRES& wires = net->wires;
+            for( unsigned i=0;  i<wires.size();  ++i )
             {
-                PATH*   path = (PATH*) wire->shape;
-                for( unsigned pt=0;  pt<path->points.size()-1;  ++pt )
+                WIRE*   wire  = &wires[i];
+                DSN_T   shape = wire->shape->Type();
+
+                if( shape != T_path )
+                {
+                    /*  shape == T_polygon is expected from freerouter if you have
+                        a zone on a non "power" type layer, i.e. a T_signal layer
+                        and the design does a round trip back in as session here.
+                        We kept our own zones in the BOARD, so ignore this so called
+                        'wire'.
+
+                    wxString netId = FROM_UTF8( wire->net_id.c_str() );
+                    THROW_IO_ERROR( wxString::Format( _("Unsupported wire shape: \"%s\" for net: \"%s\""),
+                                                        DLEX::GetTokenString(shape).GetData(),
+                                                        netId.GetData()
+                        ) );
+                    */
+                }
+                else
                 {
-                    /* a debugging aid, may come in handy
-                    if( path->points[pt].x == 547800
-                    &&  path->points[pt].y == -380250 )
+                    PATH*   path = (PATH*) wire->shape;
+                    for( unsigned pt=0;  pt<path->points.size()-1;  ++pt )
                     {
-                        int breakhere = 1;
+                        /* a debugging aid, may come in handy
+                        if( path->points[pt].x == 547800
+                        &&  path->points[pt].y == -380250 )
+                        {
+                            int breakhere = 1;
+                        }
+                        */
+
+                        TRACK* track = makeTRACK( path, pt, netCode );
+                        newTracks.push_back( track );
                     }
-                    */
-
-                    TRACK* track = makeTRACK( path, pt, netCode );
-                    aBoard->Add( track );
                 }
             }
-        }
 
-        WIRE_VIAS& wire_vias = net->wire_vias;
-        LIBRARY& library = *session->route->library;
-        for( unsigned i=0;  i<wire_vias.size();  ++i )
-        {
-            int         netCode = 0;
-
-            // page 144 of spec says wire_via's net_id is optional
-            if( net->net_id.size() )
+            WIRE_VIAS& wire_vias = net->wire_vias;
+            LIBRARY& library = *session->route->library;
+            for( unsigned i=0;  i<wire_vias.size();  ++i )
             {
-                wxString netName = FROM_UTF8( net->net_id.c_str() );
+                int         netCode = 0;
 
-                NETINFO_ITEM* net = aBoard->FindNet( netName );
-                if( net )
-                    netCode = net->GetNet();
+                // page 144 of spec says wire_via's net_id is optional
+                if( net->net_id.size() )
+                {
+                    wxString netName = FROM_UTF8( net->net_id.c_str() );
 
-                // else netCode remains 0
-            }
+                    NETINFO_ITEM* net = aBoard->FindNet( netName );
+                    if( net )
+                        netCode = net->GetNet();
 
-            WIRE_VIA* wire_via = &wire_vias[i];
+                    // else netCode remains 0
+                }
 
-            // example: (via Via_15:8_mil 149000 -71000 )
+                WIRE_VIA* wire_via = &wire_vias[i];
 
-            PADSTACK* padstack = library.FindPADSTACK( wire_via->GetPadstackId() );
-            if( !padstack )
-            {
-                // Dick  Feb 29, 2008:
-                // Freerouter has a bug where it will not round trip all vias.
-                // Vias which have a (use_via) element will be round tripped.
-                // Vias which do not, don't come back in in the session library,
-                // even though they may be actually used in the pre-routed,
-                // protected wire_vias. So until that is fixed, create the
-                // padstack from its name as a work around.
+                // example: (via Via_15:8_mil 149000 -71000 )
 
+                PADSTACK* padstack = library.FindPADSTACK( wire_via->GetPadstackId() );
+                if( !padstack )
+                {
+                    // Dick  Feb 29, 2008:
+                    // Freerouter has a bug where it will not round trip all vias.
+                    // Vias which have a (use_via) element will be round tripped.
+                    // Vias which do not, don't come back in in the session library,
+                    // even though they may be actually used in the pre-routed,
+                    // protected wire_vias. So until that is fixed, create the
+                    // padstack from its name as a work around.
 
-                // Could use a STRING_FORMATTER here and convert the entire
-                // wire_via to text and put that text into the exception.
-                wxString psid( FROM_UTF8( wire_via->GetPadstackId().c_str() ) );
 
-                THROW_IO_ERROR( wxString::Format( _("A wire_via references a missing padstack \"%s\""),
-                                                  GetChars( psid ) ) );
-            }
+                    // Could use a STRING_FORMATTER here and convert the entire
+                    // wire_via to text and put that text into the exception.
+                    wxString psid( FROM_UTF8( wire_via->GetPadstackId().c_str() ) );
 
-            NETCLASSPTR netclass = aBoard->GetDesignSettings().m_NetClasses.GetDefault();
+                    THROW_IO_ERROR( wxString::Format( _("A wire_via references a missing padstack \"%s\""),
+                                                      GetChars( psid ) ) );
+                }
 
-            int via_drill_default = netclass->GetViaDrill();
+                NETCLASSPTR netclass = aBoard->GetDesignSettings().m_NetClasses.GetDefault();
 
-            for( unsigned v=0;  v<wire_via->vertexes.size();  ++v )
-            {
-                ::VIA* via = makeVIA( padstack, wire_via->vertexes[v], netCode, via_drill_default );
-                aBoard->Add( via );
+                int via_drill_default = netclass->GetViaDrill();
+
+                for( unsigned v=0;  v<wire_via->vertexes.size();  ++v )
+                {
+                    ::VIA* via = makeVIA( padstack, wire_via->vertexes[v], netCode, via_drill_default );
+                    newTracks.push_back( via );
+                }
             }
         }
     }
+    catch( const IO_ERROR& )
+    {
+        // the tracks already made belong to the board, as if they were added one by one.
+        addTracks( aBoard, newTracks );
+        throw;
+    }
+
+    addTracks( aBoard, newTracks );
 }
 
 
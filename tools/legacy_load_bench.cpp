@@ -0,0 +1,189 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+// Benchmark of the field scanning done when loading legacy schematic (*.sch) and
+// library (*.lib) files: every line of the given files is read with a FILE_LINE_READER
+// and split into fields, integer fields being converted, first with strtok() and sscanf()
+// as the legacy loaders used to do, then with LINE_SCANNER.
+//
+// This is a tokenizer microbenchmark: it does not build any SCH_SCREEN or LIB_PART, so
+// it does not measure the legacy loaders themselves, which need the eeschema kiface.
+//
+// Typical use, from the source tree root:
+//     legacy_load_bench -n 200 demos/*/*.sch demos/*/*.lib
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <common.h>
+#include <macros.h>
+#include <richio.h>
+#include <line_scanner.h>
+
+
+struct SCAN_RESULT
+{
+    long long m_Fields;
+    long long m_Sum;
+
+    SCAN_RESULT() : m_Fields( 0 ), m_Sum( 0 ) {}
+};
+
+
+static void usage()
+{
+    fprintf( stderr, "Usage: legacy_load_bench [-n <iterations>] <file.sch|file.lib> ...\n" );
+    exit( 1 );
+}
+
+
+static void scanWithSscanf( LINE_READER& aReader, SCAN_RESULT& aResult )
+{
+    char* line;
+
+    while( ( line = aReader.ReadLine() ) != NULL )
+    {
+        for( char* p = strtok( line, " \t\r\n" ); p; p = strtok( NULL, " \t\r\n" ) )
+        {
+            int value;
+
+            aResult.m_Fields++;
+
+            if( sscanf( p, "%d", &value ) == 1 )
+                aResult.m_Sum += value;
+        }
+    }
+}
+
+
+static void scanWithScanner( LINE_READER& aReader, SCAN_RESULT& aResult )
+{
+    char*        line;
+    LINE_SCANNER scanner;
+
+    while( ( line = aReader.ReadLine() ) != NULL )
+    {
+        scanner.SetLine( line );
+
+        while( !scanner.AtEnd() )
+        {
+            int value;
+
+            aResult.m_Fields++;
+
+            if( !scanner.ParseInt( value ) )
+            {
+                scanner.SkipFields( 1 );
+                continue;
+            }
+
+            aResult.m_Sum += value;
+
+            // Like sscanf(), ignore what follows the number in the same field.
+            char c = *scanner.Position();
+
+            if( c && c != ' ' && c != '\t' && c != '\r' && c != '\n' )
+                scanner.SkipFields( 1 );
+        }
+    }
+}
+
+
+static unsigned runPass( const std::vector<wxString>& aFiles, int aIterations, bool aUseScanner,
+                         SCAN_RESULT& aResult )
+{
+    unsigned start = GetRunningMicroSecs();
+
+    for( int ii = 0; ii < aIterations; ii++ )
+    {
+        for( unsigned jj = 0; jj < aFiles.size(); jj++ )
+        {
+            FILE_LINE_READER reader( aFiles[jj] );
+
+            if( aUseScanner )
+                scanWithScanner( reader, aResult );
+            else
+                scanWithSscanf( reader, aResult );
+        }
+    }
+
+    return GetRunningMicroSecs() - start;
+}
+
+
+int main( int argc, char** argv )
+{
+    int                   iterations = 100;
+    std::vector<wxString> files;
+
+    for( int ii = 1; ii < argc; ii++ )
+    {
+        if( strcmp( argv[ii], "-n" ) == 0 )
+        {
+            if( ++ii >= argc || ( iterations = atoi( argv[ii] ) ) <= 0 )
+                usage();
+        }
+        else
+        {
+            files.push_back( wxString::FromUTF8( argv[ii] ) );
+        }
+    }
+
+    if( files.empty() )
+        usage();
+
+    try
+    {
+        SCAN_RESULT legacy;
+        SCAN_RESULT scanner;
+
+        unsigned legacyTime  = runPass( files, iterations, false, legacy );
+        unsigned scannerTime = runPass( files, iterations, true, scanner );
+
+        printf( "%u files, %d iterations\n", (unsigned) files.size(), iterations );
+        printf( "strtok/sscanf: %8.1f ms  (%lld fields, checksum %lld)\n",
+                legacyTime / 1000.0, legacy.m_Fields, legacy.m_Sum );
+        printf( "LINE_SCANNER:  %8.1f ms  (%lld fields, checksum %lld)\n",
+                scannerTime / 1000.0, scanner.m_Fields, scanner.m_Sum );
+
+        if( scannerTime )
+            printf( "speedup:       %8.2f\n", (double) legacyTime / scannerTime );
+
+        if( legacy.m_Fields != scanner.m_Fields || legacy.m_Sum != scanner.m_Sum )
+        {
+            fprintf( stderr, "error: the two scanners disagree\n" );
+            return 1;
+        }
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "%s\n", TO_UTF8( ioe.errorText ) );
+        return 1;
+    }
+
+    return 0;
+}
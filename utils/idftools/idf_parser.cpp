@@ -29,6 +29,7 @@
 #include <cmath>
 #include <cerrno>
 #include <algorithm>
+#include <vector>
 
 #include <idf_parser.h>
 #include <idf_helpers.h>
@@ -2798,7 +2799,12 @@ bool IDF3_BOARD::ReadFile( const wxString& aFullFileName, bool aNoSubstituteOutl
 // write the library file data
 bool IDF3_BOARD::writeLibFile( const std::string& aFileName )
 {
+    // The records are written in many small pieces: give the stream a buffer
+    // large enough to keep the number of writes to the file low.  It must be
+    // set before the file is opened.
+    std::vector<char> buffer( 65536 );
     std::ofstream lib;
+    lib.rdbuf()->pubsetbuf( &buffer[0], buffer.size() );
     lib.exceptions( std::ofstream::failbit );
 
     try
@@ -2849,7 +2855,9 @@ bool IDF3_BOARD::writeLibFile( const std::string& aFileName )
 // write the board file data
 void IDF3_BOARD::writeBoardFile( const std::string& aFileName )
 {
+    std::vector<char> buffer( 65536 );     // see writeLibFile()
     std::ofstream brd;
+    brd.rdbuf()->pubsetbuf( &buffer[0], buffer.size() );
     brd.exceptions( std::ofstream::failbit );
 
     try
@@ -32,8 +32,9 @@
 
 
 #include <sstream>
+#include <string.h>
+#include <stdio.h>
 #include <string>
-#include <iomanip>
 #include <cmath>
 #include <vrml_layer.h>
 
@@ -46,41 +47,219 @@
 // minimum sides to a circle
 #define MIN_NSIDES 6
 
-static void FormatDoublet( double x, double y, int precision, std::string& strx, std::string& stry )
+// size of the scratch area needed to format one number
+#define VRML_NUMBER_MAX 352
+
+// size of the block of text handed to the output stream at once
+#define VRML_BUFFER_SIZE 65536
+
+// Formats aValue like std::fixed with a precision of aPrecision, trailing zeros
+// removed, at aBuffer; returns the end of the text.  Numbers are converted by hand
+// since going through an ostringstream for every coordinate is what dominates the
+// time spent writing a large board.
+static char* formatFixed( char* aBuffer, double aValue, int aPrecision )
 {
-    std::ostringstream ostr;
+    static const double scales[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+        1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+
+    char* p = aBuffer;
+
+    if( aPrecision < 0 )
+        aPrecision = 0;
+
+    double scaled = 0.0;
+
+    if( aPrecision < 16 )
+        scaled = fabs( aValue ) * scales[aPrecision];
+
+    // Rely on the C library for the values which cannot be handled as an integer
+    // and for those too close to a rounding boundary for the scaled value to tell
+    // which way the exact value rounds.  Below 2^32 the scaling error is less
+    // than 1e-6.
+    if( aPrecision >= 16 || !( scaled < 4.0e9 )
+        || fabs( scaled - floor( scaled ) - 0.5 ) < 2.0e-6 )
+    {
+        p += sprintf( p, "%.*f", aPrecision < 300 ? aPrecision : 300, aValue );
+
+        if( aPrecision > 0 )
+        {
+            while( p > aBuffer && p[-1] == '0' )
+                --p;
+        }
+
+        return p;
+    }
+
+    unsigned long long value = (unsigned long long) ( scaled + 0.5 );
+
+    // -0.0 is negative for printf and std::fixed
+    if( aValue < 0.0 || ( aValue == 0.0 && 1.0 / aValue < 0.0 ) )
+        *p++ = '-';
 
-    ostr << std::fixed << std::setprecision( precision );
+    char digits[24];
+    int  n = 0;
 
-    ostr << x;
-    strx = ostr.str();
+    do
+    {
+        digits[n++] = '0' + (char) ( value % 10 );
+        value /= 10;
+    } while( value );
+
+    // pad the fraction with leading zeros
+    while( n <= aPrecision )
+        digits[n++] = '0';
+
+    while( n > aPrecision )
+        *p++ = digits[--n];
+
+    if( aPrecision == 0 )
+        return p;
 
-    ostr.str( "" );
-    ostr << y;
-    stry = ostr.str();
+    *p++ = '.';
 
-    while( *strx.rbegin() == '0' )
-        strx.erase( strx.size() - 1 );
+    // skip the trailing zeros of the fraction
+    int last = 0;
 
-    while( *stry.rbegin() == '0' )
-        stry.erase( stry.size() - 1 );
+    while( last < n && digits[last] == '0' )
+        ++last;
+
+    while( n > last )
+        *p++ = digits[--n];
+
+    return p;
 }
 
 
-static void FormatSinglet( double x, int precision, std::string& strx )
+// Formats an integer at aBuffer; returns the end of the text.
+static char* formatInt( char* aBuffer, int aValue )
 {
-    std::ostringstream ostr;
+    char* p = aBuffer;
+    unsigned int value = aValue;
+
+    if( aValue < 0 )
+    {
+        *p++ = '-';
+        value = 0u - value;
+    }
+
+    char digits[12];
+    int  n = 0;
 
-    ostr << std::fixed << std::setprecision( precision );
+    do
+    {
+        digits[n++] = '0' + (char) ( value % 10 );
+        value /= 10;
+    } while( value );
 
-    ostr << x;
-    strx = ostr.str();
+    while( n > 0 )
+        *p++ = digits[--n];
 
-    while( *strx.rbegin() == '0' )
-        strx.erase( strx.size() - 1 );
+    return p;
 }
 
 
+/**
+ * Class VRML_WRITER
+ * collects the text written by the Write*() functions of VRML_LAYER and hands it to
+ * the output stream in large blocks.
+ */
+class VRML_WRITER
+{
+    std::ofstream& m_stream;
+    char           m_buffer[VRML_BUFFER_SIZE];
+    int            m_used;
+
+    // make room for aCount more characters
+    void reserve( int aCount )
+    {
+        if( m_used + aCount > VRML_BUFFER_SIZE )
+            Flush();
+    }
+
+public:
+    VRML_WRITER( std::ofstream& aStream ) :
+        m_stream( aStream ), m_used( 0 )
+    {
+    }
+
+    ~VRML_WRITER()
+    {
+        // the text of an aborted write is still passed on, as the stream
+        // would have received it; errors are left in the stream state
+        try
+        {
+            Flush();
+        }
+        catch( ... )
+        {
+        }
+    }
+
+    void Flush()
+    {
+        if( m_used )
+        {
+            int used = m_used;
+
+            m_used = 0;
+            m_stream.write( m_buffer, used );
+        }
+    }
+
+    void Text( const char* aText )
+    {
+        int len = strlen( aText );
+
+        reserve( len );
+
+        if( len > VRML_BUFFER_SIZE )
+        {
+            m_stream.write( aText, len );
+            return;
+        }
+
+        memcpy( m_buffer + m_used, aText, len );
+        m_used += len;
+    }
+
+    void Int( int aValue )
+    {
+        reserve( VRML_NUMBER_MAX );
+        m_used = formatInt( m_buffer + m_used, aValue ) - m_buffer;
+    }
+
+    void Double( double aValue, int aPrecision )
+    {
+        reserve( VRML_NUMBER_MAX );
+        m_used = formatFixed( m_buffer + m_used, aValue, aPrecision ) - m_buffer;
+    }
+
+    // writes "aX aY" followed by a preformatted Z coordinate
+    void Vertex( double aX, double aY, const char* aZ, int aPrecision )
+    {
+        Double( aX, aPrecision );
+        Text( " " );
+        Double( aY, aPrecision );
+        Text( " " );
+        Text( aZ );
+    }
+
+    // writes a facet as "a, b, c, -1"
+    void Triplet( int aI1, int aI2, int aI3 )
+    {
+        Int( aI1 );
+        Text( ", " );
+        Int( aI2 );
+        Text( ", " );
+        Int( aI3 );
+        Text( ", -1" );
+    }
+};
+
+
 int VRML_LAYER::calcNSides( double aRadius, double aAngle )
 {
     // check #segments on ends of arc
@@ -268,6 +447,33 @@ void VRML_LAYER::Clear( void )
 }
 
 
+// copy the contours of another layer; the vertices keep their indices
+bool VRML_LAYER::CopyContours( const VRML_LAYER& aLayer )
+{
+    if( fix || !contours.empty() )
+    {
+        error = "CopyContours(): the layer must be empty";
+        return false;
+    }
+
+    vertices.reserve( aLayer.vertices.size() );
+
+    for( unsigned int i = 0; i < aLayer.vertices.size(); ++i )
+        vertices.push_back( new VERTEX_3D( *aLayer.vertices[i] ) );
+
+    contours.reserve( aLayer.contours.size() );
+
+    for( unsigned int i = 0; i < aLayer.contours.size(); ++i )
+        contours.push_back( new std::list<int>( *aLayer.contours[i] ) );
+
+    pth     = aLayer.pth;
+    areas   = aLayer.areas;
+    idx     = aLayer.idx;
+
+    return true;
+}
+
+
 // clear ephemeral data in between invocations of the tesselation routine
 void VRML_LAYER::clearTmp( void )
 {
@@ -998,11 +1204,12 @@ bool VRML_LAYER::WriteVertices( double aZcoord, std::ofstream& aOutFile, int aPr
     if( !vp )
         return false;
 
-    std::string strx, stry, strz;
-    FormatDoublet( vp->x + offsetX, vp->y + offsetY, aPrecision, strx, stry );
-    FormatSinglet( aZcoord, aPrecision, strz );
+    VRML_WRITER out( aOutFile );
+    char strz[VRML_NUMBER_MAX];
+
+    *formatFixed( strz, aZcoord, aPrecision ) = 0;
 
-    aOutFile << strx << " " << stry << " " << strz;
+    out.Vertex( vp->x + offsetX, vp->y + offsetY, strz, aPrecision );
 
     for( i = 1, j = ordmap.size(); i < j; ++i )
     {
@@ -1011,14 +1218,16 @@ bool VRML_LAYER::WriteVertices( double aZcoord, std::ofstream& aOutFile, int aPr
         if( !vp )
             return false;
 
-        FormatDoublet( vp->x + offsetX, vp->y + offsetY, aPrecision, strx, stry );
-
         if( i & 1 )
-            aOutFile << ", " << strx << " " << stry << " " << strz;
+            out.Text( ", " );
         else
-            aOutFile << ",\n" << strx << " " << stry << " " << strz;
+            out.Text( ",\n" );
+
+        out.Vertex( vp->x + offsetX, vp->y + offsetY, strz, aPrecision );
     }
 
+    out.Flush();
+
     return !aOutFile.fail();
 }
 
@@ -1050,11 +1259,12 @@ bool VRML_LAYER::Write3DVertices( double aTopZ, double aBottomZ,
     if( !vp )
         return false;
 
-    std::string strx, stry, strz;
-    FormatDoublet( vp->x + offsetX, vp->y + offsetY, aPrecision, strx, stry );
-    FormatSinglet( aTopZ, aPrecision, strz );
+    VRML_WRITER out( aOutFile );
+    char strz[VRML_NUMBER_MAX];
+
+    *formatFixed( strz, aTopZ, aPrecision ) = 0;
 
-    aOutFile << strx << " " << stry << " " << strz;
+    out.Vertex( vp->x + offsetX, vp->y + offsetY, strz, aPrecision );
 
     for( i = 1, j = ordmap.size(); i < j; ++i )
     {
@@ -1063,49 +1273,53 @@ bool VRML_LAYER::Write3DVertices( double aTopZ, double aBottomZ,
         if( !vp )
             return false;
 
-        FormatDoublet( vp->x + offsetX, vp->y + offsetY, aPrecision, strx, stry );
-
         if( i & 1 )
-            aOutFile << ", " << strx << " " << stry << " " << strz;
+            out.Text( ", " );
         else
-            aOutFile << ",\n" << strx << " " << stry << " " << strz;
+            out.Text( ",\n" );
+
+        out.Vertex( vp->x + offsetX, vp->y + offsetY, strz, aPrecision );
     }
 
     // repeat for the bottom layer
     vp = getVertexByIndex( ordmap[0], pholes );
-    FormatDoublet( vp->x + offsetX, vp->y + offsetY, aPrecision, strx, stry );
-    FormatSinglet( aBottomZ, aPrecision, strz );
+    *formatFixed( strz, aBottomZ, aPrecision ) = 0;
 
     bool endl;
 
     if( i & 1 )
     {
-        aOutFile << ", " << strx << " " << stry << " " << strz;
+        out.Text( ", " );
         endl = false;
     }
     else
     {
-        aOutFile << ",\n" << strx << " " << stry << " " << strz;
+        out.Text( ",\n" );
         endl = true;
     }
 
+    out.Vertex( vp->x + offsetX, vp->y + offsetY, strz, aPrecision );
+
     for( i = 1, j = ordmap.size(); i < j; ++i )
     {
         vp = getVertexByIndex( ordmap[i], pholes );
-        FormatDoublet( vp->x + offsetX, vp->y + offsetY, aPrecision, strx, stry );
 
         if( endl )
         {
-            aOutFile << ", " << strx << " " << stry << " " << strz;
+            out.Text( ", " );
             endl = false;
         }
         else
         {
-            aOutFile << ",\n" << strx << " " << stry << " " << strz;
+            out.Text( ",\n" );
             endl = true;
         }
+
+        out.Vertex( vp->x + offsetX, vp->y + offsetY, strz, aPrecision );
     }
 
+    out.Flush();
+
     return !aOutFile.fail();
 }
 
@@ -1121,6 +1335,8 @@ bool VRML_LAYER::WriteIndices( bool aTopFlag, std::ofstream& aOutFile )
         return false;
     }
 
+    VRML_WRITER out( aOutFile );
+
     // go through the triplet list and write out the indices based on order
     std::list<TRIPLET_3D>::const_iterator   tbeg    = triplets.begin();
     std::list<TRIPLET_3D>::const_iterator   tend    = triplets.end();
@@ -1128,9 +1344,9 @@ bool VRML_LAYER::WriteIndices( bool aTopFlag, std::ofstream& aOutFile )
     int i = 1;
 
     if( aTopFlag )
-        aOutFile << tbeg->i1 << ", " << tbeg->i2 << ", " << tbeg->i3  << ", -1";
+        out.Triplet( tbeg->i1, tbeg->i2, tbeg->i3 );
     else
-        aOutFile << tbeg->i2 << ", " << tbeg->i1 << ", " << tbeg->i3  << ", -1";
+        out.Triplet( tbeg->i2, tbeg->i1, tbeg->i3 );
 
     ++tbeg;
 
@@ -1139,23 +1355,23 @@ bool VRML_LAYER::WriteIndices( bool aTopFlag, std::ofstream& aOutFile )
         if( (i++ & 7) == 4 )
         {
             i = 1;
-
-            if( aTopFlag )
-                aOutFile << ",\n" << tbeg->i1 << ", " << tbeg->i2 << ", " << tbeg->i3  << ", -1";
-            else
-                aOutFile << ",\n" << tbeg->i2 << ", " << tbeg->i1 << ", " << tbeg->i3  << ", -1";
+            out.Text( ",\n" );
         }
         else
         {
-            if( aTopFlag )
-                aOutFile << ", " << tbeg->i1 << ", " << tbeg->i2 << ", " << tbeg->i3  << ", -1";
-            else
-                aOutFile << ", " << tbeg->i2 << ", " << tbeg->i1 << ", " << tbeg->i3  << ", -1";
+            out.Text( ", " );
         }
 
+        if( aTopFlag )
+            out.Triplet( tbeg->i1, tbeg->i2, tbeg->i3 );
+        else
+            out.Triplet( tbeg->i2, tbeg->i1, tbeg->i3 );
+
         ++tbeg;
     }
 
+    out.Flush();
+
     return !aOutFile.fail();
 }
 
@@ -1169,7 +1385,9 @@ bool VRML_LAYER::Write3DIndices( std::ofstream& aOutFile, bool aIncludePlatedHol
         return false;
     }
 
-    char mark;
+    VRML_WRITER out( aOutFile );
+
+    const char* mark;
     bool holes_only = triplets.empty();
 
     int i = 1;
@@ -1177,14 +1395,14 @@ bool VRML_LAYER::Write3DIndices( std::ofstream& aOutFile, bool aIncludePlatedHol
 
     if( !holes_only )
     {
-        mark = ',';
+        mark = ",";
 
         // go through the triplet list and write out the indices based on order
         std::list<TRIPLET_3D>::const_iterator   tbeg    = triplets.begin();
         std::list<TRIPLET_3D>::const_iterator   tend    = triplets.end();
 
         // print out the top vertices
-        aOutFile << tbeg->i1 << ", " << tbeg->i2 << ", " << tbeg->i3  << ", -1";
+        out.Triplet( tbeg->i1, tbeg->i2, tbeg->i3 );
         ++tbeg;
 
         while( tbeg != tend )
@@ -1192,13 +1410,14 @@ bool VRML_LAYER::Write3DIndices( std::ofstream& aOutFile, bool aIncludePlatedHol
             if( (i++ & 7) == 4 )
             {
                 i = 1;
-                aOutFile << ",\n" << tbeg->i1 << ", " << tbeg->i2 << ", " << tbeg->i3  << ", -1";
+                out.Text( ",\n" );
             }
             else
             {
-                aOutFile << ", " << tbeg->i1 << ", " << tbeg->i2 << ", " << tbeg->i3  << ", -1";
+                out.Text( ", " );
             }
 
+            out.Triplet( tbeg->i1, tbeg->i2, tbeg->i3 );
             ++tbeg;
         }
 
@@ -1210,18 +1429,19 @@ bool VRML_LAYER::Write3DIndices( std::ofstream& aOutFile, bool aIncludePlatedHol
             if( (i++ & 7) == 4 )
             {
                 i = 1;
-                aOutFile << ",\n" << (tbeg->i2 + idx2) << ", " << (tbeg->i1 + idx2) << ", " << (tbeg->i3  + idx2) << ", -1";
+                out.Text( ",\n" );
             }
             else
             {
-                aOutFile << ", " << (tbeg->i2 + idx2) << ", " << (tbeg->i1 + idx2) << ", " << (tbeg->i3  + idx2) << ", -1";
+                out.Text( ", " );
             }
 
+            out.Triplet( tbeg->i2 + idx2, tbeg->i1 + idx2, tbeg->i3 + idx2 );
             ++tbeg;
         }
     }
     else
-        mark = ' ';
+        mark = " ";
 
 
     // print out indices for the walls joining top to bottom
@@ -1264,36 +1484,32 @@ bool VRML_LAYER::Write3DIndices( std::ofstream& aOutFile, bool aIncludePlatedHol
         {
             curPoint = *(cbeg++);
 
+            out.Text( mark );
+
+            if( (i++ & 3) == 2 )
+            {
+                i = 1;
+                out.Text( "\n" );
+            }
+            else
+            {
+                out.Text( " " );
+            }
+
             if( !holes_only )
             {
-                if( (i++ & 3) == 2 )
-                {
-                    i = 1;
-                    aOutFile << mark << "\n" << curPoint << ", " << lastPoint << ", " << curPoint + idx2;
-                    aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint << ", " << lastPoint + idx2 << ", -1";
-                }
-                else
-                {
-                    aOutFile << mark << " " << curPoint << ", " << lastPoint << ", " << curPoint + idx2;
-                    aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint << ", " << lastPoint + idx2 << ", -1";
-                }
+                out.Triplet( curPoint, lastPoint, curPoint + idx2 );
+                out.Text( ", " );
+                out.Triplet( curPoint + idx2, lastPoint, lastPoint + idx2 );
             }
             else
             {
-                if( (i++ & 3) == 2 )
-                {
-                    i = 1;
-                    aOutFile << mark << "\n" << curPoint << ", " << curPoint + idx2 << ", " << lastPoint;
-                    aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint + idx2 << ", " << lastPoint << ", -1";
-                }
-                else
-                {
-                    aOutFile << mark << " " << curPoint << ", " << curPoint + idx2 << ", " << lastPoint;
-                    aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint + idx2 << ", " << lastPoint << ", -1";
-                }
+                out.Triplet( curPoint, curPoint + idx2, lastPoint );
+                out.Text( ", " );
+                out.Triplet( curPoint + idx2, lastPoint + idx2, lastPoint );
             }
 
-            mark = ',';
+            mark = ",";
             lastPoint = curPoint;
         }
 
@@ -1304,37 +1520,30 @@ bool VRML_LAYER::Write3DIndices( std::ofstream& aOutFile, bool aIncludePlatedHol
         curPoint = *(cbeg);
         lastPoint  = *(cend);
 
+        if( (i++ & 3) == 2 )
+            out.Text( ",\n" );
+        else
+            out.Text( ", " );
+
         if( !holes_only )
         {
-            if( (i++ & 3) == 2 )
-            {
-                aOutFile << ",\n" << curPoint << ", " << lastPoint << ", " << curPoint + idx2;
-                aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint << ", " << lastPoint + idx2 << ", -1";
-            }
-            else
-            {
-                aOutFile << ", " << curPoint << ", " << lastPoint << ", " << curPoint + idx2;
-                aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint << ", " << lastPoint + idx2 << ", -1";
-            }
+            out.Triplet( curPoint, lastPoint, curPoint + idx2 );
+            out.Text( ", " );
+            out.Triplet( curPoint + idx2, lastPoint, lastPoint + idx2 );
         }
         else
         {
-            if( (i++ & 3) == 2 )
-            {
-                aOutFile << ",\n" << curPoint << ", " << curPoint + idx2 << ", " << lastPoint;
-                aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint + idx2 << ", " << lastPoint << ", -1";
-            }
-            else
-            {
-                aOutFile << ", " << curPoint << ", " << curPoint + idx2 << ", " << lastPoint;
-                aOutFile << ", -1, " << curPoint + idx2 << ", " << lastPoint + idx2 << ", " << lastPoint << ", -1";
-            }
+            out.Triplet( curPoint, curPoint + idx2, lastPoint );
+            out.Text( ", " );
+            out.Triplet( curPoint + idx2, lastPoint + idx2, lastPoint );
         }
 
         ++obeg;
         ++curContour;
     }
 
+    out.Flush();
+
     return !aOutFile.fail();
 }
 
@@ -180,6 +180,18 @@ public:
      */
     void Clear( void );
 
+    /**
+     * Function CopyContours
+     * copies the contours and vertices of another layer into this empty layer.
+     * Tesselate() renumbers the vertices of the holes it is given, so layers which
+     * are tesselated at the same time must each be given their own copy of the holes.
+     *
+     * @param aLayer is the layer to copy
+     *
+     * @return bool: true if the contours were copied
+     */
+    bool CopyContours( const VRML_LAYER& aLayer );
+
     /**
      * Function GetSize
      * returns the total number of vertices indexed